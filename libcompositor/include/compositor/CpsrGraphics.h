@@ -127,6 +127,7 @@ typedef struct _CpsrViewHost CpsrViewHost;
 typedef enum {
   CPSR_DRIVER_DIRECTX12,
   CPSR_DRIVER_METAL2,
+  CPSR_DRIVER_CPU,
 } CpsrDriverType;
 CPSR_EXPORT CpsrDriverType CpsrGetDriverType();
 
@@ -176,6 +177,11 @@ typedef struct _CpsrFence CpsrFence;
 CPSR_EXPORT CpsrFence *CpsrFenceCreate(const CpsrDevice *device, CpsrFenceType fenceType);
 CPSR_EXPORT void CpsrFenceDestroy(CpsrFence *fence);
 
+// Host-side signals and waits. On Metal the fence must be CPSR_FENCE_SHARED.
+CPSR_EXPORT void CpsrFenceSignal(const CpsrFence *fence, uint64_t value);
+CPSR_EXPORT uint64_t CpsrFenceGetCompletedValue(const CpsrFence *fence);
+CPSR_EXPORT void CpsrFenceWaitUntilCompleted(const CpsrFence *fence, uint64_t value);
+
 // ---
 // Cpsr data descriptor
 // ---
@@ -287,6 +293,14 @@ CPSR_EXPORT CpsrSwapChain *CpsrSwapChainCreate(const CpsrCommandQueue *graphicsC
                                                CpsrViewHost viewHost,
                                                uint8_t bufferCount,
                                                bool vsyncEnable);
+#if defined(__linux__)
+// Headless swap chain presenting into a memfd-backed CpsrSharedFrameRing of frameCount frames.
+// CpsrSwapChainCreate does the same on the CPU driver when viewHost.handle is NULL.
+CPSR_EXPORT CpsrSwapChain *CpsrSwapChainCreateOffscreen(const CpsrCommandQueue *graphicsCommandQueue,
+                                                        CpsrSizeU32 size,
+                                                        CpsrPixelFormat pixelFormat,
+                                                        uint8_t frameCount);
+#endif
 CPSR_EXPORT void CpsrSwapChainDestroy(CpsrSwapChain *swapChain);
 
 CPSR_EXPORT bool CpsrSwapChainNextBuffer(CpsrSwapChain *swapChain);
@@ -299,6 +313,12 @@ CPSR_EXPORT void CpsrSwapChainSetBufferCount(CpsrSwapChain *swapChain, uint8_t b
 
 CPSR_EXPORT void CpsrSwapChainSetColorSpace(CpsrSwapChain *swapChain, CpsrColorSpace colorSpace);
 
+#if defined(__linux__)
+// File descriptor of the shared frame ring, or -1 for a swap chain presenting to a view.
+// It changes whenever the size or the buffer count changes.
+CPSR_EXPORT int CpsrSwapChainGetSharedMemoryFileDescriptor(const CpsrSwapChain *swapChain);
+#endif
+
 // ---
 // CpsrShaderLibrary
 // ---
@@ -565,6 +585,7 @@ CPSR_EXPORT void CpsrGraphicsContextSetRenderTargetFromTexture2D(CpsrGraphicsCon
                                                                  const CpsrTexture2D *renderTarget);
 CPSR_EXPORT void CpsrGraphicsContextSetRenderTargetFromSwapChain(CpsrGraphicsContext *graphicsContext,
                                                                  CpsrSwapChain *swapChain);
+// The first call opens the render pass. Later calls switch the pipeline state inside it; bound resources are kept.
 CPSR_EXPORT bool CpsrGraphicsContextSetPipelineState(CpsrGraphicsContext *graphicsContext,
                                                      CpsrGraphicsPipelineState *pipelineState);
 
@@ -661,6 +682,9 @@ typedef struct _CpsrComputeContext CpsrComputeContext;
 CPSR_EXPORT CpsrComputeContext *CpsrComputeContextCreate(const CpsrCommandBuffer *commandBuffer);
 CPSR_EXPORT void CpsrComputeContextDestroy(CpsrComputeContext *computeContext);
 
+CPSR_EXPORT bool CpsrComputeContextSetPipelineState(CpsrComputeContext *computeContext,
+                                                    CpsrComputePipelineState *pipelineState);
+
 CPSR_EXPORT void CpsrComputeContextSetConstantBuffer(CpsrComputeContext *computeContext,
                                                      uint8_t index,
                                                      const CpsrBuffer *vertexBuffer);
@@ -0,0 +1,94 @@
+#ifndef _CPSR_NATIVE_SHADER_H
+#define _CPSR_NATIVE_SHADER_H
+
+#include "compositor/CpsrGraphics.h"
+#include "compositor/vector/float32x4_t.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---
+// Native shader (CPU driver)
+// ---
+#define CPSR_NATIVE_VARYING_COUNT 4
+#define CPSR_NATIVE_TEXTURE_COUNT 16
+
+typedef struct {
+  const void *vertexBuffers[CPSR_VERTEX_BUFFER_COUNT];
+  const void *constantBuffers[CPSR_CONSTANT_BUFFER_COUNT];
+  const CpsrTexture2D *textures[CPSR_NATIVE_TEXTURE_COUNT];
+  const CpsrTexture2D *writeTextures[CPSR_NATIVE_TEXTURE_COUNT];
+} CpsrNativeShaderResources;
+
+typedef struct {
+  float32x4_t position;
+  float32x4_t varyings[CPSR_NATIVE_VARYING_COUNT];
+} CpsrNativeVertexOut;
+
+typedef void (*CpsrNativeVertexFunction)(const CpsrNativeShaderResources *resources,
+                                         uint32_t vertexId,
+                                         uint32_t instanceId,
+                                         CpsrNativeVertexOut *vertexOut);
+typedef float32x4_t (*CpsrNativePixelFunction)(const CpsrNativeShaderResources *resources,
+                                               const CpsrNativeVertexOut *pixelIn);
+typedef void (*CpsrNativeComputeFunction)(const CpsrNativeShaderResources *resources,
+                                          uint32_t x,
+                                          uint32_t y,
+                                          uint32_t z);
+
+// Row kernels receive the span [x, x + count) of one grid row so the loop over x can be vectorized.
+// Like the per-thread form, they run over the whole threadgroup grid and must clip it to their outputs.
+typedef void (*CpsrNativeComputeRowFunction)(const CpsrNativeShaderResources *resources,
+                                             uint32_t x,
+                                             uint32_t y,
+                                             uint32_t z,
+                                             uint32_t count);
+
+typedef enum {
+  CPSR_NATIVE_SHADER_VERTEX,
+  CPSR_NATIVE_SHADER_PIXEL,
+  CPSR_NATIVE_SHADER_COMPUTE,
+  CPSR_NATIVE_SHADER_COMPUTE_ROW,
+} CpsrNativeShaderStage;
+
+typedef struct {
+  const char *name;
+  CpsrNativeShaderStage stage;
+  uint8_t varyingCount;
+  union {
+    CpsrNativeVertexFunction vertex;
+    CpsrNativePixelFunction pixel;
+    CpsrNativeComputeFunction compute;
+    CpsrNativeComputeRowFunction computeRow;
+  };
+} CpsrNativeShaderEntry;
+
+// Tables are looked up by the path later passed to CpsrShaderLibraryCreate and must outlive every library.
+CPSR_EXPORT bool CpsrShaderLibraryRegisterNative(const char *filePath,
+                                                 const CpsrNativeShaderEntry *entries,
+                                                 size_t count);
+CPSR_EXPORT void CpsrShaderLibraryUnregisterNative(const CpsrNativeShaderEntry *entries);
+
+// ---
+// Texture access from native shaders
+// ---
+CPSR_EXPORT float32x4_t CpsrTexture2DSample(const CpsrTexture2D *texture2D, float u, float v);
+CPSR_EXPORT float32x4_t CpsrTexture2DRead(const CpsrTexture2D *texture2D, uint32_t x, uint32_t y);
+CPSR_EXPORT void CpsrTexture2DStore(const CpsrTexture2D *texture2D, uint32_t x, uint32_t y, float32x4_t color);
+CPSR_EXPORT void CpsrTexture2DReadRow(const CpsrTexture2D *texture2D,
+                                      uint32_t x,
+                                      uint32_t y,
+                                      uint32_t count,
+                                      float32x4_t *colors);
+CPSR_EXPORT void CpsrTexture2DStoreRow(const CpsrTexture2D *texture2D,
+                                       uint32_t x,
+                                       uint32_t y,
+                                       uint32_t count,
+                                       const float32x4_t *colors);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _CPSR_NATIVE_SHADER_H
@@ -0,0 +1,80 @@
+#ifndef _CPSR_SHARED_FRAME_RING_H
+#define _CPSR_SHARED_FRAME_RING_H
+
+#include "compositor/CpsrTypedefs.h"
+
+#ifdef __cplusplus
+#include <atomic>
+#define CPSR_SHARED_ATOMIC(__TYPE__) std::atomic<__TYPE__>
+extern "C" {
+#else
+#include <stdatomic.h>
+#define CPSR_SHARED_ATOMIC(__TYPE__) _Atomic(__TYPE__)
+#endif
+
+// ---
+// CpsrSharedFrameRing
+// ---
+// Memory layout of the shared-memory ring an offscreen swap chain presents into.
+//
+//   [CpsrSharedFrameRingHeader]
+//   frame 0: [CpsrSharedFrameHeader][pixels (bytesPerRow * height)]
+//   frame 1: ...
+//
+// Every block starts at a multiple of CPSR_SHARED_FRAME_RING_ALIGNMENT. A consumer maps the file descriptor
+// read-only and reads frames in place. The producer never waits for it: a consumer that falls behind by
+// frameCount frames reads a torn frame, which it detects with the sequence protocol below.
+//
+// Reading a frame:
+//   1. seq = load_acquire(frame->sequence); skip the frame if seq is 0 or CPSR_SHARED_FRAME_WRITING.
+//   2. Copy or process the pixels and read the timestamp.
+//   3. atomic_thread_fence(acquire); the frame is valid only if frame->sequence still equals seq.
+//
+// When the swap chain is resized or its frame count changes, the producer stores 0 to the ring magic and
+// switches to a new file descriptor. Consumers treat a zero magic as "reconnect".
+#define CPSR_SHARED_FRAME_RING_MAGIC 0x474E495250534343ull  // "CCSPRING"
+#define CPSR_SHARED_FRAME_RING_VERSION 1
+#define CPSR_SHARED_FRAME_RING_ALIGNMENT 64
+#define CPSR_SHARED_FRAME_RING_MAX_FRAME_COUNT 8
+#define CPSR_SHARED_FRAME_WRITING UINT64_MAX
+
+typedef struct {
+  CPSR_SHARED_ATOMIC(uint64_t) magic;
+  uint32_t version;
+  uint32_t frameCount;
+  uint32_t width;
+  uint32_t height;
+  uint32_t pixelFormat;  // CpsrPixelFormat
+  uint32_t colorSpace;   // CpsrColorSpace
+  uint64_t bytesPerRow;
+  uint64_t frameStride;  // Distance between two frame headers
+  uint64_t dataOffset;   // Offset of the pixels from their frame header
+  uint8_t reserved0[8];
+
+  // Sequence number of the most recently presented frame; 0 before the first present.
+  // The frame lives at index (latestSequence - 1) % frameCount.
+  CPSR_SHARED_ATOMIC(uint64_t) latestSequence;
+  uint8_t reserved1[CPSR_SHARED_FRAME_RING_ALIGNMENT - 8];
+} CpsrSharedFrameRingHeader;
+
+typedef struct {
+  CPSR_SHARED_ATOMIC(uint64_t) sequence;  // 0: never written, CPSR_SHARED_FRAME_WRITING: being rendered
+  uint64_t timestamp;                     // CLOCK_MONOTONIC at present, in nanoseconds
+  uint8_t reserved[CPSR_SHARED_FRAME_RING_ALIGNMENT - 16];
+} CpsrSharedFrameHeader;
+
+static inline CpsrSharedFrameHeader *CpsrSharedFrameRingGetFrame(const CpsrSharedFrameRingHeader *ring, uint32_t index) {
+  return (CpsrSharedFrameHeader *)((uint8_t *)ring + sizeof(CpsrSharedFrameRingHeader) + ring->frameStride * index);
+}
+
+static inline uint8_t *CpsrSharedFrameGetData(const CpsrSharedFrameRingHeader *ring, const CpsrSharedFrameHeader *frame) {
+  return (uint8_t *)frame + ring->dataOffset;
+}
+
+#undef CPSR_SHARED_ATOMIC
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _CPSR_SHARED_FRAME_RING_H
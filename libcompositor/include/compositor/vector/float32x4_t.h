@@ -908,6 +908,46 @@ static inline float32x4_t _SIMD_CALLCONV float32x4_normalize(float32x4_t a) {
   return ret;
 }
 
+// ---
+// Rounding
+// ---
+// floor(a)
+static inline float32x4_t _SIMD_CALLCONV float32x4_floor(float32x4_t a) {
+  float32x4_t ret;
+#if defined(_SIMD_ARM64)
+  ret = vrndmq_f32(a);
+#elif defined(_SIMD_ARM_NEON)
+  // Truncate, subtract one where truncation rounded up, keep values already integral (|a| >= 2^23)
+  float32x4_t trunc = vcvtq_f32_s32(vcvtq_s32_f32(a));
+  float32x4_t floor = vsubq_f32(trunc, vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(trunc, a), vreinterpretq_u32_f32(vdupq_n_f32(1.F)))));
+  ret = vbslq_f32(vcltq_f32(vabsq_f32(a), vdupq_n_f32(8388608.F)), floor, a);
+#elif defined(_SIMD_X86_SSE4_1)
+  ret = _mm_floor_ps(a);
+#elif defined(_SIMD_X86_SSE)
+  __m128 trunc = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+  __m128 floor = _mm_sub_ps(trunc, _mm_and_ps(_mm_cmpgt_ps(trunc, a), _mm_set1_ps(1.F)));
+  ret = _simd_mm_sel_ps(a, floor, _mm_cmplt_ps(_simd_mm_abs_ps(a), _mm_set1_ps(8388608.F)));
+#else
+  for (size_t i = 0; i < 4; ++i) {
+    ret.f32[i] = floorf(a.f32[i]);
+  }
+#endif
+  return ret;
+}
+
+// ceil(a)
+static inline float32x4_t _SIMD_CALLCONV float32x4_ceil(float32x4_t a) {
+  float32x4_t ret;
+#if defined(_SIMD_ARM64)
+  ret = vrndpq_f32(a);
+#elif defined(_SIMD_X86_SSE4_1)
+  ret = _mm_ceil_ps(a);
+#else
+  ret = float32x4_neg(float32x4_floor(float32x4_neg(a)));
+#endif
+  return ret;
+}
+
 // ---
 // FMA
 // ---
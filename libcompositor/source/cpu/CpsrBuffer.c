@@ -0,0 +1,115 @@
+#include "CpsrGraphics+Private.h"
+
+static inline CpsrBuffer *CreateBuffer(const CpsrDevice *device, size_t sizeInBytes, CpsrHeapType heapType, CpsrBufferType bufferType) {
+  size_t capacity = AlignUp(sizeInBytes, CPSR_CPU_RESOURCE_ALIGNMENT);
+  uint8_t *data = (uint8_t *)CpsrDeviceAllocate(device, capacity);
+  if (!data) {
+    return NULL;
+  }
+
+  CpsrBuffer *buffer = CpsrAlloc(CpsrBuffer);
+  if (buffer) {
+    buffer->device = device;
+    buffer->data = data;
+    buffer->size = sizeInBytes;
+    buffer->capacity = capacity;
+
+#ifndef NDEBUG
+    buffer->heapType = heapType;
+    buffer->bufferType = bufferType;
+#endif
+  } else {
+    CpsrDeviceDeallocate(device, data, capacity);
+  }
+  return buffer;
+}
+
+CpsrBuffer *CpsrBufferCreateFromSize(const CpsrDevice *device, size_t sizeInBytes, CpsrHeapType heapType, CpsrBufferType bufferType) {
+  CPSR_ASSUME(device);
+
+  CpsrBuffer *buffer = CreateBuffer(device, sizeInBytes, heapType, bufferType);
+  return buffer;
+}
+
+CpsrBuffer *CpsrBufferCreateFromData(const CpsrDevice *device, const void *data, size_t sizeInBytes, CpsrBufferType bufferType) {
+  CPSR_ASSUME(device);
+  CPSR_ASSUME(data);
+
+  CpsrBuffer *buffer = CreateBuffer(device, sizeInBytes, CPSR_HEAP_TYPE_UPLOAD, bufferType);
+  if (buffer) {
+    memcpy(buffer->data, data, sizeInBytes);
+  }
+  return buffer;
+}
+
+void CpsrBufferDestroy(CpsrBuffer *buffer) {
+  CPSR_ASSUME(buffer);
+
+  CpsrDeviceDeallocate(buffer->device, buffer->data, buffer->capacity);
+  CpsrDealloc(buffer);
+}
+
+// ---
+// Get property
+// ---
+size_t CpsrBufferGetSize(const CpsrBuffer *buffer) {
+  CPSR_ASSUME(buffer);
+
+  return buffer->size;
+}
+
+size_t CpsrBufferGetCapacity(const CpsrBuffer *buffer) {
+  CPSR_ASSUME(buffer);
+
+  return buffer->capacity;
+}
+
+// ---
+// Set property
+// ---
+void CpsrBufferSetName(const CpsrBuffer *buffer, const char *name, size_t maxCount) {
+  CPSR_ASSUME(buffer);
+  CPSR_ASSUME(name);
+}
+
+// ---
+// Map/Unmap function
+// ---
+bool CpsrBufferMap(const CpsrBuffer *buffer, void **data) {
+  CPSR_ASSUME(buffer);
+  CPSR_ASSUME(buffer->heapType & CPSR_HEAP_TYPE_UPLOAD || buffer->heapType & CPSR_HEAP_TYPE_READBACK);
+  CPSR_ASSUME(data);
+
+  *data = buffer->data;
+  return false;
+}
+
+void CpsrBufferUnmap(const CpsrBuffer *buffer, CpsrRange range) {
+  CPSR_ASSUME(buffer);
+  CPSR_ASSUME(buffer->heapType & CPSR_HEAP_TYPE_UPLOAD || buffer->heapType & CPSR_HEAP_TYPE_READBACK);
+  assert(buffer->size >= range.location + range.length);
+}
+
+// ---
+// Read function
+// ---
+bool CpsrBufferRead(const CpsrBuffer *buffer, void *data) {
+  CPSR_ASSUME(buffer);
+  CPSR_ASSUME(buffer->heapType & CPSR_HEAP_TYPE_READBACK);
+  CPSR_ASSUME(data);
+
+  memcpy(data, buffer->data, buffer->size);
+  return false;
+}
+
+// ---
+// Write function
+// ---
+bool CpsrBufferWrite(CpsrBuffer *buffer, const void *data) {
+  CPSR_ASSUME(buffer);
+  CPSR_ASSUME(buffer->heapType & CPSR_HEAP_TYPE_UPLOAD);
+  CPSR_ASSUME(data);
+
+  memcpy(buffer->data, data, buffer->size);
+  return false;
+}
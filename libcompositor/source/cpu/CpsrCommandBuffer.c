@@ -0,0 +1,141 @@
+#include "CpsrGraphics+Private.h"
+
+#define CPSR_CPU_COMMAND_BUFFER_INITIAL_CAPACITY 64
+
+CpsrCommandBuffer *CpsrCommandBufferCreate(const CpsrCommandQueue *commandQueue) {
+  CPSR_ASSUME(commandQueue);
+
+  CpsrCommand *commands = (CpsrCommand *)malloc(CPSR_CPU_COMMAND_BUFFER_INITIAL_CAPACITY * sizeof(CpsrCommand));
+  if (!commands) {
+    return NULL;
+  }
+
+  CpsrCommandBuffer *commandBuffer = CpsrAlloc(CpsrCommandBuffer);
+  if (commandBuffer) {
+    commandBuffer->commandQueue = commandQueue;
+    commandBuffer->commands = commands;
+    commandBuffer->count = 0;
+    commandBuffer->capacity = CPSR_CPU_COMMAND_BUFFER_INITIAL_CAPACITY;
+  } else {
+    free(commands);
+  }
+  return commandBuffer;
+}
+
+static inline void CpsrCommandBufferReset(CpsrCommandBuffer *commandBuffer) {
+  for (uint32_t i = 0; i < commandBuffer->count; ++i) {
+    CpsrCommand *command = commandBuffer->commands + i;
+    if (command->type == CPSR_COMMAND_RENDER_PASS && command->renderPass.renderPass) {
+      CpsrRenderPassDestroy(command->renderPass.renderPass);
+      command->renderPass.renderPass = NULL;
+    }
+  }
+  commandBuffer->count = 0;
+}
+
+void CpsrCommandBufferDestroy(CpsrCommandBuffer *commandBuffer) {
+  CPSR_ASSUME(commandBuffer);
+
+  CpsrCommandBufferReset(commandBuffer);
+  free(commandBuffer->commands);
+  CpsrDealloc(commandBuffer);
+}
+
+static inline void CpsrCommandBufferRun(const CpsrCommandBuffer *commandBuffer) {
+  CpsrWorkerPool *workerPool = (CpsrWorkerPool *)&commandBuffer->commandQueue->device->workerPool;
+  for (uint32_t i = 0; i < commandBuffer->count; ++i) {
+    const CpsrCommand *command = commandBuffer->commands + i;
+    switch (command->type) {
+    case CPSR_COMMAND_RENDER_PASS:
+      CpsrRenderPassExecute(&command->renderPass, workerPool);
+      break;
+
+    case CPSR_COMMAND_DRAW:
+      // Binned into the render pass by CpsrGraphicsContextClose
+      break;
+
+    case CPSR_COMMAND_DISPATCH:
+      CpsrComputeDispatch(&command->dispatch, workerPool);
+      break;
+
+    case CPSR_COMMAND_SIGNAL:
+      CpsrFenceSignal(command->fence.fence, command->fence.value);
+      break;
+
+    case CPSR_COMMAND_WAIT:
+      CpsrFenceWait(command->fence.fence, command->fence.value);
+      break;
+    }
+  }
+  CpsrCommandBufferReset((CpsrCommandBuffer *)commandBuffer);
+}
+
+void CpsrCommandBufferExecute(const CpsrCommandBuffer *commandBuffer) {
+  CPSR_ASSUME(commandBuffer);
+
+  CpsrCommandBufferRun(commandBuffer);
+}
+
+void CpsrCommandBufferExecuteAndPresent(const CpsrCommandBuffer *commandBuffer, const CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(commandBuffer);
+  CPSR_ASSUME(swapChain);
+
+  CpsrCommandBufferRun(commandBuffer);
+  CpsrSwapChainPresent((CpsrSwapChain *)swapChain);
+}
+
+void CpsrCommandBufferSingle(const CpsrCommandBuffer *commandBuffer, const CpsrFence *fence, uint64_t value) {
+  CPSR_ASSUME(commandBuffer);
+  CPSR_ASSUME(fence);
+
+  CpsrCommand *command = CpsrCommandBufferAppend(commandBuffer, CPSR_COMMAND_SIGNAL);
+  if (command) {
+    command->fence.fence = (CpsrFence *)fence;
+    command->fence.value = value;
+  }
+}
+
+void CpsrCommandBufferWait(const CpsrCommandBuffer *commandBuffer, const CpsrFence *fence, uint64_t value) {
+  CPSR_ASSUME(commandBuffer);
+  CPSR_ASSUME(fence);
+
+  CpsrCommand *command = CpsrCommandBufferAppend(commandBuffer, CPSR_COMMAND_WAIT);
+  if (command) {
+    command->fence.fence = (CpsrFence *)fence;
+    command->fence.value = value;
+  }
+}
+
+#ifndef NDEBUG
+void _CpsrCommandBufferPushDebugGroup(const CpsrCommandBuffer *commandBuffer, const char *groupName) {
+  CPSR_ASSUME(commandBuffer);
+  CPSR_ASSUME(groupName);
+}
+
+void _CpsrCommandBufferPopDebugGroup(const CpsrCommandBuffer *commandBuffer) {
+  CPSR_ASSUME(commandBuffer);
+}
+#endif
+
+// ---
+// Internal functions
+// ---
+CpsrCommand *CpsrCommandBufferAppend(const CpsrCommandBuffer *commandBuffer, CpsrCommandType type) {
+  CPSR_ASSUME(commandBuffer);
+
+  CpsrCommandBuffer *mutableCommandBuffer = (CpsrCommandBuffer *)commandBuffer;
+  if (mutableCommandBuffer->count == mutableCommandBuffer->capacity) {
+    const uint32_t capacity = 2 * mutableCommandBuffer->capacity;
+    CpsrCommand *commands = (CpsrCommand *)realloc(mutableCommandBuffer->commands, capacity * sizeof(CpsrCommand));
+    if (!commands) {
+      // TODO: log
+      return NULL;
+    }
+    mutableCommandBuffer->commands = commands;
+    mutableCommandBuffer->capacity = capacity;
+  }
+
+  CpsrCommand *command = mutableCommandBuffer->commands + mutableCommandBuffer->count++;
+  command->type = type;
+  return command;
+}
@@ -0,0 +1,17 @@
+#include "CpsrGraphics+Private.h"
+
+CpsrCommandQueue *CpsrCommandQueueCreate(const CpsrDevice *device) {
+  CPSR_ASSUME(device);
+
+  CpsrCommandQueue *commandQueue = CpsrAlloc(CpsrCommandQueue);
+  if (commandQueue) {
+    commandQueue->device = device;
+  }
+  return commandQueue;
+}
+
+void CpsrCommandQueueDestroy(CpsrCommandQueue *commandQueue) {
+  CPSR_ASSUME(commandQueue);
+
+  CpsrDealloc(commandQueue);
+}
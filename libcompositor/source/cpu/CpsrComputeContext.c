@@ -0,0 +1,135 @@
+#include "CpsrGraphics+Private.h"
+
+#define CPSR_CPU_THREADS_PER_THREADGROUP 16
+
+CpsrComputeContext *CpsrComputeContextCreate(const CpsrCommandBuffer *commandBuffer) {
+  CPSR_ASSUME(commandBuffer);
+
+  CpsrComputeContext *computeContext = CpsrAlloc(CpsrComputeContext);
+  if (computeContext) {
+    memset(computeContext, 0, sizeof(CpsrComputeContext));
+    computeContext->commandBuffer = commandBuffer;
+  }
+  return computeContext;
+}
+
+void CpsrComputeContextDestroy(CpsrComputeContext *computeContext) {
+  CPSR_ASSUME(computeContext);
+
+  CpsrDealloc(computeContext);
+}
+
+bool CpsrComputeContextSetPipelineState(CpsrComputeContext *computeContext, CpsrComputePipelineState *pipelineState) {
+  assert(computeContext);
+  assert(!computeContext->encoding);
+  assert(pipelineState);
+
+  if (!pipelineState->function) {
+    // TODO: log
+    return true;
+  }
+
+  computeContext->pipelineState = pipelineState;
+  computeContext->encoding = true;
+  return false;
+}
+
+void CpsrComputeContextSetConstantBuffer(CpsrComputeContext *computeContext,
+                                         uint8_t index,
+                                         const CpsrBuffer *vertexBuffer) {
+  CPSR_ASSUME(computeContext);
+  CPSR_ASSUME(computeContext->encoding);
+  CPSR_ASSUME(index < CPSR_CONSTANT_BUFFER_COUNT);
+  CPSR_ASSUME(vertexBuffer);
+  CPSR_ASSUME(vertexBuffer->bufferType == CPSR_CONSTANT_BUFFER);
+
+  computeContext->resources.constantBuffers[index] = vertexBuffer->data;
+}
+
+void CpsrComputeContextSetReadTexture(CpsrComputeContext *computeContext, uint8_t index, const CpsrTexture2D *texture) {
+  CPSR_ASSUME(computeContext);
+  CPSR_ASSUME(computeContext->encoding);
+  CPSR_ASSUME(index < CPSR_NATIVE_TEXTURE_COUNT);
+  CPSR_ASSUME(texture);
+  CPSR_ASSUME(texture->usage & CPSR_TEXTURE_USAGE_READ);
+
+  computeContext->resources.textures[index] = texture;
+}
+
+void CpsrComputeContextSetWriteTexture(CpsrComputeContext *computeContext,
+                                       uint8_t index,
+                                       const CpsrTexture2D *texture) {
+  CPSR_ASSUME(computeContext);
+  CPSR_ASSUME(computeContext->encoding);
+  CPSR_ASSUME(index < CPSR_NATIVE_TEXTURE_COUNT);
+  CPSR_ASSUME(texture);
+  CPSR_ASSUME(texture->usage & CPSR_TEXTURE_USAGE_WRITE);
+
+  computeContext->resources.writeTextures[index] = texture;
+}
+
+void CpsrComputeContextDispatch(const CpsrComputeContext *computeContext, uint16_t x, uint16_t y, uint16_t z) {
+  CPSR_ASSUME(computeContext);
+  CPSR_ASSUME(computeContext->encoding);
+  CPSR_ASSUME(x > 0);
+  CPSR_ASSUME(y > 0);
+  CPSR_ASSUME(z > 0);
+
+  CpsrCommand *command = CpsrCommandBufferAppend(computeContext->commandBuffer, CPSR_COMMAND_DISPATCH);
+  if (command) {
+    command->dispatch.pipelineState = computeContext->pipelineState;
+    command->dispatch.resources     = computeContext->resources;
+    command->dispatch.x             = x;
+    command->dispatch.y             = y;
+    command->dispatch.z             = z;
+  }
+}
+
+void CpsrComputeContextClose(const CpsrComputeContext *computeContext) {
+  CPSR_ASSUME(computeContext);
+  CPSR_ASSUME(computeContext->encoding);
+
+  ((CpsrComputeContext *)computeContext)->encoding = false;
+}
+
+#ifndef NDEBUG
+void _CpsrComputeContextPushDebugGroup(const CpsrComputeContext *computeContext, const char *groupName) {
+  CPSR_ASSUME(computeContext);
+  CPSR_ASSUME(groupName);
+}
+
+void _CpsrComputeContextPopDebugGroup(const CpsrComputeContext *computeContext) {
+  CPSR_ASSUME(computeContext);
+}
+#endif
+
+// ---
+// Internal functions
+// ---
+static void CpsrComputeDispatchThreadgroupRow(void *context, uint32_t index) {
+  const CpsrDispatchCommand *command = (const CpsrDispatchCommand *)context;
+  const CpsrNativeShaderEntry *entry = command->pipelineState->function->entry;
+  const uint32_t width = (uint32_t)command->x * CPSR_CPU_THREADS_PER_THREADGROUP;
+  const uint32_t gz = index / command->y;
+  const uint32_t firstY = (index % command->y) * CPSR_CPU_THREADS_PER_THREADGROUP;
+  if (entry->stage == CPSR_NATIVE_SHADER_COMPUTE_ROW) {
+    for (uint32_t gy = firstY; gy < firstY + CPSR_CPU_THREADS_PER_THREADGROUP; ++gy) {
+      entry->computeRow(&command->resources, 0, gy, gz, width);
+    }
+  } else {
+    for (uint32_t gy = firstY; gy < firstY + CPSR_CPU_THREADS_PER_THREADGROUP; ++gy) {
+      for (uint32_t gx = 0; gx < width; ++gx) {
+        entry->compute(&command->resources, gx, gy, gz);
+      }
+    }
+  }
+}
+
+void CpsrComputeDispatch(const CpsrDispatchCommand *command, CpsrWorkerPool *workerPool) {
+  CPSR_ASSUME(command);
+  CPSR_ASSUME(workerPool);
+
+  // Same grid as the Metal driver: threadgroups of 16x16x1 threads. A job is one row of threadgroups.
+  const uint32_t jobCount = (uint32_t)command->y * command->z;
+  CpsrWorkerPoolRun(workerPool, jobCount, CpsrComputeDispatchThreadgroupRow, (void *)command);
+}
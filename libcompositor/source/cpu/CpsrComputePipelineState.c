@@ -0,0 +1,33 @@
+#include "CpsrGraphics+Private.h"
+
+CpsrComputePipelineState *CpsrComputePipelineStateCreate(const CpsrDevice *device) {
+  CPSR_ASSUME(device);
+
+  CpsrComputePipelineState *pipelineState = CpsrAlloc(CpsrComputePipelineState);
+  if (!pipelineState) {
+    return NULL;
+  }
+
+  pipelineState->device   = device;
+  pipelineState->function = NULL;
+  return pipelineState;
+}
+
+void CpsrComputePipelineStateDestroy(CpsrComputePipelineState *pipelineState) {
+  CPSR_ASSUME(pipelineState);
+
+  CpsrDealloc(pipelineState);
+}
+
+// ---
+// Property: Compute Function
+// ---
+void CpsrComputePipelineStateSetFunction(CpsrComputePipelineState *pipelineState,
+                                         const CpsrShaderFunction *shaderFunction) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(shaderFunction);
+  assert(shaderFunction->entry->stage == CPSR_NATIVE_SHADER_COMPUTE
+         || shaderFunction->entry->stage == CPSR_NATIVE_SHADER_COMPUTE_ROW);
+
+  pipelineState->function = shaderFunction;
+}
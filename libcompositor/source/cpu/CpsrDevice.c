@@ -0,0 +1,148 @@
+#include "CpsrGraphics+Private.h"
+
+#include <unistd.h>
+
+#define CPSR_CPU_DEVICE_NAME "CPU"
+
+CpsrDriverType CpsrGetDriverType() {
+  return CPSR_DRIVER_CPU;
+}
+
+static inline size_t CpsrGetL2CacheSize() {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+  long l2CacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  if (l2CacheSize > 0) {
+    return (size_t)l2CacheSize;
+  }
+#endif
+  return CPSR_CPU_DEFAULT_L2_CACHE_SIZE;
+}
+
+static inline CpsrDevice *CpsrDeviceCreate() {
+  CpsrDevice *device = CpsrAlloc(CpsrDevice);
+  if (!device) {
+    return NULL;
+  }
+
+  long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+  device->processorCount = processorCount > 0 ? (uint32_t)processorCount : 1;
+  device->l2CacheSize = CpsrGetL2CacheSize();
+  atomic_init(&device->allocatedSize, 0);
+
+  // The thread executing a command buffer joins the workers
+  if (CpsrWorkerPoolInit(&device->workerPool, device->processorCount - 1)) {
+    CpsrDealloc(device);
+    return NULL;
+  }
+  return device;
+}
+
+void CpsrEnumDevice(CpsrDeviceProcedure enumFunc) {
+  CpsrDevice *device = CpsrDeviceCreate();
+  if (device) {
+    enumFunc(device);
+  }
+}
+
+CpsrDevice *CpsrDeviceGetDefault() {
+  return CpsrDeviceCreate();
+}
+
+CpsrDevice *CpsrDeviceGetLowPower() {
+  return CpsrDeviceGetDefault();
+}
+
+void CpsrDeviceDestroy(CpsrDevice *device) {
+  CPSR_ASSUME(device);
+  assert(atomic_load(&device->allocatedSize) == 0);
+
+  CpsrWorkerPoolUninit(&device->workerPool);
+  CpsrDealloc(device);
+}
+
+size_t CpsrDeviceGetName(const CpsrDevice *device, char *deviceName, size_t maxCount) {
+  CPSR_ASSUME(device);
+
+  if (deviceName) {
+    strncpy(deviceName, CPSR_CPU_DEVICE_NAME, maxCount);
+    return strnlen(deviceName, maxCount);
+  } else {
+    return strlen(CPSR_CPU_DEVICE_NAME);
+  }
+}
+
+uint64_t CpsrDeviceGetCurrentAllocatedSize(const CpsrDevice *device) {
+  CPSR_ASSUME(device);
+
+  return atomic_load_explicit(&device->allocatedSize, memory_order_relaxed);
+}
+
+bool CpsrDeviceIsUnifiedMemoryAccess(const CpsrDevice *device) {
+  return true;
+}
+
+bool CpsrDeviceIsMultisampleSupport(const CpsrDevice *device, CpsrPixelFormat pixelFormat, uint8_t sampleCount) {
+  return sampleCount == 1;
+}
+
+CpsrPixelFormatCapabilities CpsrDeviceGetPixelFormatCapabilities(const CpsrDevice *device, CpsrPixelFormat pixelFormat) {
+  CpsrPixelFormatCapabilities capabilities = {0};
+  switch (pixelFormat) {
+  case CPSR_PIXELFORMAT_R8_UNORM:
+  case CPSR_PIXELFORMAT_A8_UNORM:
+  case CPSR_PIXELFORMAT_R16_UNORM:
+  case CPSR_PIXELFORMAT_R16_FLOAT:
+  case CPSR_PIXELFORMAT_RG8_UNORM:
+  case CPSR_PIXELFORMAT_R32_FLOAT:
+  case CPSR_PIXELFORMAT_RG16_UNORM:
+  case CPSR_PIXELFORMAT_RG16_FLOAT:
+  case CPSR_PIXELFORMAT_RGBA8_UNORM:
+  case CPSR_PIXELFORMAT_RGBA8_UNORM_SRGB:
+  case CPSR_PIXELFORMAT_BGRA8_UNORM:
+  case CPSR_PIXELFORMAT_BGRA8_UNORM_SRGB:
+  case CPSR_PIXELFORMAT_RGB10A2_UNORM:
+  case CPSR_PIXELFORMAT_BGR10A2_UNORM:
+  case CPSR_PIXELFORMAT_RG32_FLOAT:
+  case CPSR_PIXELFORMAT_RGBA16_UNORM:
+  case CPSR_PIXELFORMAT_RGBA16_FLOAT:
+    capabilities.load = true;
+    capabilities.sample = true;
+    capabilities.renderTarget = true;
+    capabilities.blend = true;
+    capabilities.write = true;
+    break;
+
+  default:
+    break;
+  }
+  return capabilities;
+}
+
+CpsrDeviceCapabilities CpsrDeviceGetCapabilities(const CpsrDevice *device) {
+  CpsrDeviceCapabilities capabilities;
+  capabilities.bufferOffsetAlignment = 256;
+  capabilities.maximumRenderTargetCount = 1;
+  return capabilities;
+}
+
+// ---
+// Internal functions
+// ---
+void *CpsrDeviceAllocate(const CpsrDevice *device, size_t size) {
+  CPSR_ASSUME(device);
+
+  void *data = aligned_alloc(CPSR_CPU_RESOURCE_ALIGNMENT, AlignUp(size, CPSR_CPU_RESOURCE_ALIGNMENT));
+  if (data) {
+    atomic_fetch_add_explicit(&((CpsrDevice *)device)->allocatedSize, size, memory_order_relaxed);
+  }
+  return data;
+}
+
+void CpsrDeviceDeallocate(const CpsrDevice *device, void *data, size_t size) {
+  CPSR_ASSUME(device);
+
+  if (data) {
+    atomic_fetch_sub_explicit(&((CpsrDevice *)device)->allocatedSize, size, memory_order_relaxed);
+    free(data);
+  }
+}
@@ -0,0 +1,65 @@
+#include "CpsrGraphics+Private.h"
+
+CpsrFence *CpsrFenceCreate(const CpsrDevice *device, CpsrFenceType fenceType) {
+  CPSR_ASSUME(device);
+
+  CpsrFence *fence = CpsrAlloc(CpsrFence);
+  if (fence) {
+    atomic_init(&fence->value, 0);
+    pthread_mutex_init(&fence->mutex, NULL);
+    pthread_cond_init(&fence->cond, NULL);
+
+#ifndef NDEBUG
+    fence->device = device;
+    fence->fenceType = fenceType;
+#endif
+  }
+  return fence;
+}
+
+void CpsrFenceDestroy(CpsrFence *fence) {
+  CPSR_ASSUME(fence);
+
+  pthread_cond_destroy(&fence->cond);
+  pthread_mutex_destroy(&fence->mutex);
+  CpsrDealloc(fence);
+}
+
+void CpsrFenceSignal(const CpsrFence *fence, uint64_t value) {
+  CPSR_ASSUME(fence);
+
+  CpsrFence *mutableFence = (CpsrFence *)fence;
+  pthread_mutex_lock(&mutableFence->mutex);
+  atomic_store_explicit(&mutableFence->value, value, memory_order_release);
+  pthread_cond_broadcast(&mutableFence->cond);
+  pthread_mutex_unlock(&mutableFence->mutex);
+}
+
+uint64_t CpsrFenceGetCompletedValue(const CpsrFence *fence) {
+  CPSR_ASSUME(fence);
+
+  return atomic_load_explicit(&fence->value, memory_order_acquire);
+}
+
+void CpsrFenceWaitUntilCompleted(const CpsrFence *fence, uint64_t value) {
+  CPSR_ASSUME(fence);
+
+  CpsrFenceWait((CpsrFence *)fence, value);
+}
+
+// ---
+// Internal functions
+// ---
+void CpsrFenceWait(CpsrFence *fence, uint64_t value) {
+  CPSR_ASSUME(fence);
+
+  if (atomic_load_explicit(&fence->value, memory_order_acquire) >= value) {
+    return;
+  }
+
+  pthread_mutex_lock(&fence->mutex);
+  while (atomic_load_explicit(&fence->value, memory_order_acquire) < value) {
+    pthread_cond_wait(&fence->cond, &fence->mutex);
+  }
+  pthread_mutex_unlock(&fence->mutex);
+}
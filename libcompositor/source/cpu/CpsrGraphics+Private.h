@@ -0,0 +1,370 @@
+#ifndef _CPSR_GRAPHICS_PRIVATE_H
+#define _CPSR_GRAPHICS_PRIVATE_H
+
+#include "compositor/CpsrGraphics.h"
+#include "compositor/CpsrNativeShader.h"
+#ifdef __linux__
+#include "compositor/CpsrSharedFrameRing.h"
+#endif
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CpsrAlloc(__TYPE__) (__TYPE__ *)malloc(sizeof(__TYPE__))
+#define CpsrDealloc(__OBJ__) free((void *)__OBJ__)
+
+#ifndef NDEBUG
+#if defined(__clang__)
+#define CPSR_ASSUME(__COND__) __builtin_assume(__COND__)
+#elif defined(__GNUC__) || defined(__GNUG__)
+#define CPSR_ASSUME(__COND__) if (!(__COND__)) __builtin_unreachable()
+#elif defined(_MSC_VER)
+#define CPSR_ASSUME(__COND__) __assume(__COND__)
+#else
+#define CPSR_ASSUME(__COND__) assert(__COND__)
+#endif
+#else
+#define CPSR_ASSUME(__COND__) assert(__COND__)
+#endif
+
+#define CPSR_CPU_RESOURCE_ALIGNMENT 64
+#define CPSR_CPU_RENDER_TARGET_COUNT 8
+#define CPSR_CPU_SWAPCHAIN_MAX_BUFFER_COUNT 8
+#define CPSR_CPU_CACHE_LINE_SIZE 64
+#define CPSR_CPU_DEFAULT_L2_CACHE_SIZE (256 * 1024)
+#define CPSR_CPU_MIN_TILE_SIZE 16
+#define CPSR_CPU_MAX_TILE_SIZE 256
+
+static inline size_t AlignUp(size_t inSize, size_t align) {
+  assert(((align - 1) & align) == 0);
+
+  const size_t alignmentMask = align - 1;
+  return ((inSize + alignmentMask) & (~alignmentMask));
+}
+
+// ---
+// Worker pool
+// ---
+typedef void (*CpsrWorkerFunction)(void *context, uint32_t index);
+
+// Each participant owns a contiguous range of job indices and steals from the others once it runs dry.
+typedef struct {
+  _Alignas(CPSR_CPU_CACHE_LINE_SIZE) _Atomic(uint32_t) next;
+  uint32_t end;
+} CpsrWorkerQueue;
+
+typedef struct {
+  pthread_t *threads;
+  uint32_t threadCount;
+  CpsrWorkerQueue *queues;  // threadCount + 1 (the calling thread)
+
+  pthread_mutex_t jobMutex;  // Serializes CpsrWorkerPoolRun
+  pthread_mutex_t mutex;
+  pthread_cond_t startCond;
+  pthread_cond_t finishCond;
+  uint64_t generation;
+  uint32_t activeCount;
+  bool quit;
+
+  CpsrWorkerFunction function;
+  void *context;
+} CpsrWorkerPool;
+
+bool CpsrWorkerPoolInit(CpsrWorkerPool *workerPool, uint32_t threadCount);
+void CpsrWorkerPoolUninit(CpsrWorkerPool *workerPool);
+void CpsrWorkerPoolRun(CpsrWorkerPool *workerPool, uint32_t count, CpsrWorkerFunction function, void *context);
+
+struct _CpsrDevice {
+  uint32_t processorCount;
+  size_t l2CacheSize;
+  _Atomic(uint64_t) allocatedSize;
+  CpsrWorkerPool workerPool;
+};
+
+void *CpsrDeviceAllocate(const CpsrDevice *device, size_t size);
+void CpsrDeviceDeallocate(const CpsrDevice *device, void *data, size_t size);
+
+// ---
+// Pixel format
+// ---
+static inline size_t PixelFormatGetBytesPerPixel(CpsrPixelFormat pixelFormat) {
+  return (size_t)pixelFormat >> 12;
+}
+
+static inline size_t PixelFormatGetBytesPerRow(CpsrPixelFormat pixelFormat, uint32_t width) {
+  return AlignUp(width * PixelFormatGetBytesPerPixel(pixelFormat), CPSR_CPU_RESOURCE_ALIGNMENT);
+}
+
+static inline size_t Texture2DDescriptorGetSize(const CpsrTexture2DDescriptor *desc) {
+  const size_t bytesPerRow = PixelFormatGetBytesPerRow(desc->pixelFormat, desc->size.width);
+  const size_t arrayLength = desc->arrayLength > 1 ? desc->arrayLength : 1;
+  return AlignUp(bytesPerRow * desc->size.height, CPSR_CPU_RESOURCE_ALIGNMENT) * arrayLength;
+}
+
+float32x4_t CpsrPixelLoad(const uint8_t *pixel, CpsrPixelFormat pixelFormat);
+void CpsrPixelStore(uint8_t *pixel, CpsrPixelFormat pixelFormat, float32x4_t color);
+
+struct _CpsrFence {
+  _Atomic(uint64_t) value;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+
+#ifndef NDEBUG
+  const CpsrDevice *device;
+  CpsrFenceType fenceType;
+#endif
+};
+
+void CpsrFenceWait(CpsrFence *fence, uint64_t value);
+
+struct _CpsrHeap {
+  const CpsrDevice *device;
+  uint8_t *data;
+  size_t size;
+  size_t offset;
+  CpsrHeapType heapType : 2;
+};
+
+struct _CpsrBuffer {
+  const CpsrDevice *device;
+  uint8_t *data;
+  size_t size;
+  size_t capacity;
+
+#ifndef NDEBUG
+  CpsrHeapType heapType : 2;
+  CpsrBufferType bufferType : 3;
+#endif
+};
+
+struct _CpsrTexture2D {
+  const CpsrDevice *device;
+  uint8_t *data;
+  size_t bytesPerRow;
+  size_t bytesPerImage;
+  CpsrSizeU32 size;
+  uint16_t arrayLength;
+  CpsrPixelFormat pixelFormat;
+  bool ownsData;
+
+#ifndef NDEBUG
+  CpsrHeapType heapType : 2;
+  CpsrTextureUsage usage : 3;
+#endif
+};
+
+// Wraps memory owned by the caller; the texture never frees it.
+CpsrTexture2D *CpsrTexture2DCreateFromMemory(const CpsrDevice *device, uint8_t *data, const CpsrTexture2DDescriptor *desc, CpsrHeapType heapType);
+
+static inline uint8_t *CpsrTexture2DGetPixelPointer(const CpsrTexture2D *texture2D, uint32_t x, uint32_t y) {
+  return texture2D->data + texture2D->bytesPerRow * y + PixelFormatGetBytesPerPixel(texture2D->pixelFormat) * x;
+}
+
+struct _CpsrSwapChain {
+  const CpsrCommandQueue *graphicsCommandQueue;
+  CpsrViewHandle hostView;
+  CpsrPixelFormat pixelFormat;
+  CpsrColorSpace colorSpace;
+  CpsrSizeU32 size;
+  uint8_t bufferCount;
+  uint8_t currentIndex;
+  CpsrTexture2D *buffers[CPSR_CPU_SWAPCHAIN_MAX_BUFFER_COUNT];
+
+#ifdef __linux__
+  // Offscreen: the buffers point into a memfd-backed CpsrSharedFrameRing
+  int sharedMemoryFd;  // -1 when presenting to a view or while the ring is being recreated
+  CpsrSharedFrameRingHeader *sharedMemory;
+  size_t sharedMemorySize;
+  uint64_t sequence;
+#endif
+};
+
+CpsrTexture2D *CpsrSwapChainGetCurrentTexture(const CpsrSwapChain *swapChain);
+void CpsrSwapChainPresent(CpsrSwapChain *swapChain);
+
+struct _CpsrShaderLibrary {
+  const CpsrDevice *device;
+  char *filePath;
+};
+
+const CpsrNativeShaderEntry *CpsrShaderLibraryFindEntry(const CpsrShaderLibrary *shaderLibrary, const char *functionName);
+
+struct _CpsrShaderFunction {
+  const CpsrNativeShaderEntry *entry;
+};
+
+struct _CpsrCommandQueue {
+  const CpsrDevice *device;
+};
+
+struct _CpsrGraphicsPipelineState {
+  const CpsrDevice *device;
+  const CpsrShaderFunction *vertexFunction;
+  const CpsrShaderFunction *pixelFunction;
+  CpsrBlendDescriptor blendDesc[CPSR_CPU_RENDER_TARGET_COUNT];
+  CpsrRasterizerDescriptor rasterizerDesc;
+  CpsrPrimitiveTopologyType primitiveTopologyType;
+  uint8_t sampleCount;
+  CpsrPixelFormat pixelFormats[CPSR_CPU_RENDER_TARGET_COUNT];
+};
+
+struct _CpsrComputePipelineState {
+  const CpsrDevice *device;
+  const CpsrShaderFunction *function;
+};
+
+// ---
+// Commands
+// ---
+typedef enum {
+  CPSR_COMMAND_RENDER_PASS,
+  CPSR_COMMAND_DRAW,
+  CPSR_COMMAND_DISPATCH,
+  CPSR_COMMAND_SIGNAL,
+  CPSR_COMMAND_WAIT,
+} CpsrCommandType;
+
+typedef struct _CpsrRenderPass CpsrRenderPass;
+
+typedef struct {
+  const CpsrTexture2D *renderTarget;
+  bool clearEnable;
+  CpsrClearColor clearColor;
+  CpsrRenderPass *renderPass;  // Built by CpsrGraphicsContextClose from the draw commands that follow
+} CpsrRenderPassCommand;
+
+typedef struct {
+  const CpsrTexture2D *renderTarget;
+  const CpsrGraphicsPipelineState *pipelineState;
+  CpsrNativeShaderResources resources;
+  CpsrViewport viewport;
+  CpsrScissorRect scissorRect;
+  CpsrPrimitiveTopology primitiveTopology;
+  const uint8_t *indices;
+  CpsrIndexType indexType;
+  uint32_t vertexStart;
+  uint32_t vertexCount;
+  uint32_t instanceCount;
+  int32_t baseVertex;
+  uint32_t baseInstance;
+  bool indexed;
+} CpsrDrawCommand;
+
+typedef struct {
+  const CpsrComputePipelineState *pipelineState;
+  CpsrNativeShaderResources resources;
+  uint16_t x, y, z;
+} CpsrDispatchCommand;
+
+typedef struct {
+  CpsrFence *fence;
+  uint64_t value;
+} CpsrFenceCommand;
+
+typedef struct {
+  CpsrCommandType type;
+  union {
+    CpsrRenderPassCommand renderPass;
+    CpsrDrawCommand draw;
+    CpsrDispatchCommand dispatch;
+    CpsrFenceCommand fence;
+  };
+} CpsrCommand;
+
+struct _CpsrCommandBuffer {
+  const CpsrCommandQueue *commandQueue;
+  CpsrCommand *commands;
+  uint32_t count;
+  uint32_t capacity;
+};
+
+CpsrCommand *CpsrCommandBufferAppend(const CpsrCommandBuffer *commandBuffer, CpsrCommandType type);
+
+void CpsrComputeDispatch(const CpsrDispatchCommand *command, CpsrWorkerPool *workerPool);
+
+// ---
+// Rasterizer
+// ---
+typedef struct {
+  int32_t minX, minY, maxX, maxY;  // Inclusive-exclusive, in pixels
+} CpsrPixelRect;
+
+typedef struct {
+  bool blendEnable;
+  CpsrBlendFactor srcColorBlend, dstColorBlend;
+  CpsrBlendFactor srcAlphaBlend, dstAlphaBlend;
+  CpsrBlendOperation colorOperation, alphaOperation;
+  float32x4_t alphaMask;
+  float32x4_t writeMask;
+  bool writeAll;
+} CpsrBlendState;
+
+typedef struct {
+  const CpsrDrawCommand *command;
+  const CpsrTexture2D *renderTarget;
+  CpsrNativePixelFunction pixelFunction;
+  uint8_t varyingCount;
+  CpsrBlendState blend;
+  CpsrCullMode cullMode;
+  CpsrFillMode fillMode;
+  bool counterClockwise;
+  bool readDestination;
+  CpsrPixelRect clip;  // Render target, viewport and scissor rect
+} CpsrDrawState;
+
+typedef struct {
+  float x, y, z;
+  float invW;
+  float32x4_t varyings[CPSR_NATIVE_VARYING_COUNT];  // Pre-divided by w
+} CpsrScreenVertex;
+
+void CpsrRasterizerClear(const CpsrTexture2D *renderTarget, CpsrClearColor color, const CpsrPixelRect *rect);
+void CpsrDrawStateInit(CpsrDrawState *state, const CpsrDrawCommand *command);
+void CpsrScreenVertexInit(CpsrScreenVertex *screen, const CpsrNativeVertexOut *vertex, const CpsrViewport *viewport, uint8_t varyingCount);
+bool CpsrTriangleIsVisible(const CpsrDrawState *state, const CpsrScreenVertex *v0, const CpsrScreenVertex *v1, const CpsrScreenVertex *v2);
+void CpsrRasterizePoint(const CpsrDrawState *state, const CpsrPixelRect *clip, const CpsrScreenVertex *v0);
+void CpsrRasterizeLine(const CpsrDrawState *state, const CpsrPixelRect *clip, const CpsrScreenVertex *v0, const CpsrScreenVertex *v1);
+void CpsrRasterizeTriangle(const CpsrDrawState *state, const CpsrPixelRect *clip, const CpsrScreenVertex *v0, const CpsrScreenVertex *v1, const CpsrScreenVertex *v2);
+
+// ---
+// Render pass (tile binning)
+// ---
+CpsrRenderPass *CpsrRenderPassCreate(const CpsrDevice *device,
+                                     const CpsrTexture2D *renderTarget,
+                                     const CpsrCommand *draws,
+                                     uint32_t drawCount);
+void CpsrRenderPassDestroy(CpsrRenderPass *renderPass);
+void CpsrRenderPassExecute(const CpsrRenderPassCommand *command, CpsrWorkerPool *workerPool);
+
+struct _CpsrGraphicsContext {
+  const CpsrCommandBuffer         *commandBuffer;
+  const CpsrTexture2D             *renderTarget;
+  const CpsrGraphicsPipelineState *pipelineState;
+  CpsrNativeShaderResources       resources;
+
+  bool                            clearEnable;
+  CpsrClearColor                  clearColor;
+
+  CpsrViewport                    viewport;
+  CpsrScissorRect                 scissorRect;
+
+  CpsrIndexType                   indexType;
+  const CpsrBuffer                *indexBuffer;
+  uint32_t                        indexBufferOffset;
+
+  CpsrPrimitiveTopology           primitiveTopology;
+  uint32_t                        renderPassIndex;
+  bool                            encoding;
+};
+
+struct _CpsrComputeContext {
+  const CpsrCommandBuffer         *commandBuffer;
+  const CpsrComputePipelineState  *pipelineState;
+  CpsrNativeShaderResources       resources;
+  bool                            encoding;
+};
+
+#endif // _CPSR_GRAPHICS_PRIVATE_H
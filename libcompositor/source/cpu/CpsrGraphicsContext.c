@@ -0,0 +1,326 @@
+#include "CpsrGraphics+Private.h"
+
+CpsrGraphicsContext *CpsrGraphicsContextCreate(const CpsrCommandBuffer *commandBuffer) {
+  CPSR_ASSUME(commandBuffer);
+
+  CpsrGraphicsContext *graphicsContext = CpsrAlloc(CpsrGraphicsContext);
+  if (graphicsContext) {
+    memset(graphicsContext, 0, sizeof(CpsrGraphicsContext));
+    graphicsContext->commandBuffer     = commandBuffer;
+    graphicsContext->indexType         = CPSR_INDEX_TYPE_UINT16;
+    graphicsContext->primitiveTopology = CPSR_PRIMITIVE_TOPOLOGY_TRIANGLE;
+  }
+  return graphicsContext;
+}
+
+void CpsrGraphicsContextDestroy(CpsrGraphicsContext *graphicsContext) {
+  assert(graphicsContext);
+
+  CpsrDealloc(graphicsContext);
+}
+
+void CpsrGraphicsContextClearRenderTarget(CpsrGraphicsContext *graphicsContext, uint8_t index, CpsrClearColor color) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(!graphicsContext->encoding);
+  CPSR_ASSUME(index < 1);
+
+  graphicsContext->clearEnable = true;
+  graphicsContext->clearColor  = color;
+}
+
+void CpsrGraphicsContextSetRenderTargetFromTexture2D(CpsrGraphicsContext *graphicsContext, const CpsrTexture2D *renderTarget) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(!graphicsContext->encoding);
+  CPSR_ASSUME(renderTarget);
+  CPSR_ASSUME(renderTarget->usage & CPSR_TEXTURE_USAGE_RENDER_TARGET);
+
+  graphicsContext->renderTarget = renderTarget;
+}
+
+void CpsrGraphicsContextSetRenderTargetFromSwapChain(CpsrGraphicsContext *graphicsContext, CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(!graphicsContext->encoding);
+  CPSR_ASSUME(swapChain);
+
+  graphicsContext->renderTarget = CpsrSwapChainGetCurrentTexture(swapChain);
+}
+
+bool CpsrGraphicsContextSetPipelineState(CpsrGraphicsContext *graphicsContext, CpsrGraphicsPipelineState *pipelineState) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(pipelineState);
+
+  if (!graphicsContext->renderTarget || !pipelineState->vertexFunction || !pipelineState->pixelFunction) {
+    // TODO: log
+    return true;
+  }
+
+  // Switch pipelines inside the open render pass; every draw records the pipeline it was issued with
+  if (graphicsContext->encoding) {
+    graphicsContext->pipelineState = pipelineState;
+    return false;
+  }
+
+  // Draws recorded after this command are binned into it by CpsrGraphicsContextClose
+  CpsrCommand *command = CpsrCommandBufferAppend(graphicsContext->commandBuffer, CPSR_COMMAND_RENDER_PASS);
+  if (!command) {
+    return true;
+  }
+  command->renderPass.renderTarget = graphicsContext->renderTarget;
+  command->renderPass.clearEnable  = graphicsContext->clearEnable;
+  command->renderPass.clearColor   = graphicsContext->clearColor;
+  command->renderPass.renderPass   = NULL;
+  graphicsContext->renderPassIndex = graphicsContext->commandBuffer->count - 1;
+  graphicsContext->clearEnable     = false;
+
+  // Default viewport and scissor rect cover the whole render target
+  const CpsrSizeU32 size = graphicsContext->renderTarget->size;
+  const CpsrViewport viewport = { 0.F, 0.F, (float)size.width, (float)size.height, 0.F, 1.F };
+  const CpsrScissorRect scissorRect = { 0.F, 0.F, (float)size.width, (float)size.height };
+  graphicsContext->viewport    = viewport;
+  graphicsContext->scissorRect = scissorRect;
+
+  graphicsContext->pipelineState = pipelineState;
+  graphicsContext->encoding      = true;
+  return false;
+}
+
+void CpsrGraphicsContextSetViewport(CpsrGraphicsContext *graphicsContext, CpsrViewport viewport) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+
+  graphicsContext->viewport = viewport;
+}
+
+void CpsrGraphicsContextSetScissorRect(CpsrGraphicsContext *graphicsContext, CpsrScissorRect scissorRect) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+
+  graphicsContext->scissorRect = scissorRect;
+}
+
+// ---
+// Constant Buffer
+// ---
+void CpsrGraphicsContextSetConstantBuffer(CpsrGraphicsContext *graphicsContext, uint8_t index, const CpsrBuffer *constantBuffer) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+  CPSR_ASSUME(index < CPSR_CONSTANT_BUFFER_COUNT);
+  CPSR_ASSUME(constantBuffer);
+  CPSR_ASSUME(constantBuffer->bufferType == CPSR_CONSTANT_BUFFER);
+  CPSR_ASSUME(graphicsContext->commandBuffer->commandQueue->device == constantBuffer->device);
+
+  graphicsContext->resources.constantBuffers[index] = constantBuffer->data;
+}
+
+void CpsrGraphicsContextSetConstantBufferWithOffset(CpsrGraphicsContext *graphicsContext,
+                                                    uint8_t index,
+                                                    const CpsrBuffer *constantBuffer,
+                                                    uint32_t offset) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+  CPSR_ASSUME(index < CPSR_CONSTANT_BUFFER_COUNT);
+  CPSR_ASSUME(offset % 256 == 0);
+  CPSR_ASSUME(constantBuffer);
+  CPSR_ASSUME(constantBuffer->bufferType == CPSR_CONSTANT_BUFFER);
+  CPSR_ASSUME(offset < constantBuffer->size);
+  CPSR_ASSUME(graphicsContext->commandBuffer->commandQueue->device == constantBuffer->device);
+
+  graphicsContext->resources.constantBuffers[index] = constantBuffer->data + offset;
+}
+
+// ---
+// Vertex Buffer
+// ---
+void CpsrGraphicsContextSetVertexBuffer(CpsrGraphicsContext *graphicsContext, uint8_t index, const CpsrBuffer *vertexBuffer) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+  CPSR_ASSUME(index < CPSR_VERTEX_BUFFER_COUNT);
+  CPSR_ASSUME(vertexBuffer);
+  CPSR_ASSUME(vertexBuffer->bufferType == CPSR_VERTEX_BUFFER);
+  CPSR_ASSUME(graphicsContext->commandBuffer->commandQueue->device == vertexBuffer->device);
+
+  graphicsContext->resources.vertexBuffers[index] = vertexBuffer->data;
+}
+
+void CpsrGraphicsContextSetVertexBuffers(CpsrGraphicsContext *graphicsContext, CpsrRange range, const CpsrBuffer **vertexBuffers) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+  CPSR_ASSUME(range.location + range.length <= CPSR_VERTEX_BUFFER_COUNT);
+  CPSR_ASSUME(vertexBuffers);
+
+  for (size_t i = 0; i < range.length; ++i) {
+    const CpsrBuffer *vertexBuffer = vertexBuffers[i];
+    CPSR_ASSUME(vertexBuffer);
+    CPSR_ASSUME(vertexBuffer->bufferType == CPSR_VERTEX_BUFFER);
+    CPSR_ASSUME(graphicsContext->commandBuffer->commandQueue->device == vertexBuffer->device);
+
+    graphicsContext->resources.vertexBuffers[range.location + i] = vertexBuffer->data;
+  }
+}
+
+// ---
+// Index Buffer
+// ---
+void CpsrGraphicsContextSetIndexBuffer(CpsrGraphicsContext *graphicsContext, const CpsrBuffer *indexBuffer, CpsrIndexType indexType) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+  CPSR_ASSUME(indexBuffer);
+  CPSR_ASSUME(indexBuffer->bufferType == CPSR_INDEX_BUFFER);
+  CPSR_ASSUME(graphicsContext->commandBuffer->commandQueue->device == indexBuffer->device);
+
+  graphicsContext->indexBuffer       = indexBuffer;
+  graphicsContext->indexType         = indexType;
+  graphicsContext->indexBufferOffset = 0;
+}
+
+void CpsrGraphicsContextSetIndexBufferWithOffset(CpsrGraphicsContext *graphicsContext, const CpsrBuffer *indexBuffer, uint32_t offset, CpsrIndexType indexType) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+  CPSR_ASSUME(indexBuffer);
+  CPSR_ASSUME(indexBuffer->bufferType == CPSR_INDEX_BUFFER);
+  CPSR_ASSUME(offset % 256 == 0);
+  CPSR_ASSUME(graphicsContext->commandBuffer->commandQueue->device == indexBuffer->device);
+
+  graphicsContext->indexBuffer       = indexBuffer;
+  graphicsContext->indexType         = indexType;
+  graphicsContext->indexBufferOffset = offset;
+}
+
+// ---
+// Texture
+// ---
+void CpsrGraphicsContextSetTexture(const CpsrGraphicsContext *graphicsContext, uint8_t index, const CpsrTexture2D *texture) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+  CPSR_ASSUME(index < CPSR_NATIVE_TEXTURE_COUNT);
+  CPSR_ASSUME(texture);
+  CPSR_ASSUME(graphicsContext->commandBuffer->commandQueue->device == texture->device);
+
+  ((CpsrGraphicsContext *)graphicsContext)->resources.textures[index] = texture;
+}
+
+// ---
+// Draw
+// ---
+void CpsrGraphicsContextSetPrimitiveTopology(CpsrGraphicsContext *graphicsContext,
+                                             CpsrPrimitiveTopology primitiveTopology) {
+  CPSR_ASSUME(graphicsContext);
+
+  graphicsContext->primitiveTopology = primitiveTopology;
+}
+
+static inline CpsrDrawCommand *CpsrGraphicsContextAppendDraw(const CpsrGraphicsContext *graphicsContext) {
+  CpsrCommand *command = CpsrCommandBufferAppend(graphicsContext->commandBuffer, CPSR_COMMAND_DRAW);
+  if (!command) {
+    return NULL;
+  }
+
+  CpsrDrawCommand *draw = &command->draw;
+  draw->renderTarget      = graphicsContext->renderTarget;
+  draw->pipelineState     = graphicsContext->pipelineState;
+  draw->resources         = graphicsContext->resources;
+  draw->viewport          = graphicsContext->viewport;
+  draw->scissorRect       = graphicsContext->scissorRect;
+  draw->primitiveTopology = graphicsContext->primitiveTopology;
+  draw->indices           = NULL;
+  draw->indexType         = graphicsContext->indexType;
+  draw->vertexStart       = 0;
+  draw->vertexCount       = 0;
+  draw->instanceCount     = 1;
+  draw->baseVertex        = 0;
+  draw->baseInstance      = 0;
+  draw->indexed           = false;
+  return draw;
+}
+
+void CpsrGraphicsContextDraw(const CpsrGraphicsContext *graphicsContext, uint32_t vertexStart, uint32_t vertexCount) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+
+  CpsrDrawCommand *draw = CpsrGraphicsContextAppendDraw(graphicsContext);
+  if (draw) {
+    draw->vertexStart = vertexStart;
+    draw->vertexCount = vertexCount;
+  }
+}
+
+void CpsrGraphicsContextDrawInstanced(const CpsrGraphicsContext *graphicsContext, uint32_t vertexStart, uint32_t vertexCount, uint32_t instanceCount) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+
+  CpsrDrawCommand *draw = CpsrGraphicsContextAppendDraw(graphicsContext);
+  if (draw) {
+    draw->vertexStart   = vertexStart;
+    draw->vertexCount   = vertexCount;
+    draw->instanceCount = instanceCount;
+  }
+}
+
+void CpsrGraphicsContextDrawIndexed(const CpsrGraphicsContext *graphicsContext, uint32_t indexCount) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+  CPSR_ASSUME(graphicsContext->indexBuffer);
+
+  CpsrDrawCommand *draw = CpsrGraphicsContextAppendDraw(graphicsContext);
+  if (draw) {
+    draw->indices     = graphicsContext->indexBuffer->data + graphicsContext->indexBufferOffset;
+    draw->vertexCount = indexCount;
+    draw->indexed     = true;
+  }
+}
+
+void CpsrGraphicsContextDrawIndexedInstanced(const CpsrGraphicsContext *graphicsContext, uint32_t indexCount, uint32_t instanceCount, int32_t baseVertex, uint32_t baseInstance) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+  CPSR_ASSUME(graphicsContext->indexBuffer);
+
+  CpsrDrawCommand *draw = CpsrGraphicsContextAppendDraw(graphicsContext);
+  if (draw) {
+    draw->indices       = graphicsContext->indexBuffer->data + graphicsContext->indexBufferOffset;
+    draw->vertexCount   = indexCount;
+    draw->instanceCount = instanceCount;
+    draw->baseVertex    = baseVertex;
+    draw->baseInstance  = baseInstance;
+    draw->indexed       = true;
+  }
+}
+
+// ---
+// End encoding
+// ---
+void CpsrGraphicsContextClose(const CpsrGraphicsContext *graphicsContext) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(graphicsContext->encoding);
+
+  // Run the vertex stage and bin the recorded draws into screen tiles. Tiles are rasterized in parallel
+  // by CpsrCommandBufferExecute, so buffers read by vertex functions are captured here.
+  CpsrCommandBuffer *commandBuffer = (CpsrCommandBuffer *)graphicsContext->commandBuffer;
+  const uint32_t renderPassIndex = graphicsContext->renderPassIndex;
+  const CpsrCommand *draws = commandBuffer->commands + renderPassIndex + 1;
+  const uint32_t drawCount = commandBuffer->count - renderPassIndex - 1;
+  CpsrRenderPass *renderPass = CpsrRenderPassCreate(commandBuffer->commandQueue->device,
+                                                    graphicsContext->renderTarget,
+                                                    draws,
+                                                    drawCount);
+  if (!renderPass) {
+    // TODO: log
+  }
+  commandBuffer->commands[renderPassIndex].renderPass.renderPass = renderPass;
+  commandBuffer->count = renderPassIndex + 1;
+
+  ((CpsrGraphicsContext *)graphicsContext)->encoding = false;
+}
+
+// ---
+// Debug
+// ---
+#ifndef NDEBUG
+void _CpsrGraphicsContextPushDebugGroup(const CpsrGraphicsContext *graphicsContext, const char *groupName) {
+  CPSR_ASSUME(graphicsContext);
+  CPSR_ASSUME(groupName);
+}
+
+void _CpsrGraphicsContextPopDebugGroup(const CpsrGraphicsContext *graphicsContext) {
+  CPSR_ASSUME(graphicsContext);
+}
+#endif
@@ -0,0 +1,148 @@
+#include "CpsrGraphics+Private.h"
+
+CpsrGraphicsPipelineState *CpsrGraphicsPipelineStateCreate(const CpsrDevice *device) {
+  CPSR_ASSUME(device);
+
+  CpsrGraphicsPipelineState *pipelineState = CpsrAlloc(CpsrGraphicsPipelineState);
+  if (pipelineState) {
+    pipelineState->device                = device;
+    pipelineState->vertexFunction        = NULL;
+    pipelineState->pixelFunction         = NULL;
+    pipelineState->rasterizerDesc        = kCpsrRasterizerDefault;
+    pipelineState->primitiveTopologyType = CPSR_PRIMITIVE_TOPOLOGY_TYPE_UNSPECIFIED;
+    pipelineState->sampleCount           = 1;
+    for (size_t i = 0; i < CPSR_CPU_RENDER_TARGET_COUNT; ++i) {
+      pipelineState->blendDesc[i]    = kCpsrBlendDefault;
+      pipelineState->pixelFormats[i] = CPSR_PIXELFORMAT_UNKNOWN;
+    }
+  }
+  return pipelineState;
+}
+
+void CpsrGraphicsPipelineStateDestroy(CpsrGraphicsPipelineState *pipelineState) {
+  CPSR_ASSUME(pipelineState);
+
+  CpsrDealloc(pipelineState);
+}
+
+// ---
+// Property: Vertex Function
+// ---
+void CpsrGraphicsPipelineStateSetVertexFunction(CpsrGraphicsPipelineState *pipelineState, const CpsrShaderFunction *shaderFunction) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(shaderFunction);
+
+  if (shaderFunction) {
+    assert(shaderFunction->entry->stage == CPSR_NATIVE_SHADER_VERTEX);
+    pipelineState->vertexFunction = shaderFunction;
+  }
+}
+
+// ---
+// Property: Pixel Function
+// ---
+void CpsrGraphicsPipelineStateSetPixelFunction(CpsrGraphicsPipelineState *pipelineState, const CpsrShaderFunction *shaderFunction) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(shaderFunction);
+
+  if (shaderFunction) {
+    assert(shaderFunction->entry->stage == CPSR_NATIVE_SHADER_PIXEL);
+    pipelineState->pixelFunction = shaderFunction;
+  }
+}
+
+// ---
+// Property: Blend state
+// ---
+void CpsrGraphicsPipelineStateGetBlendState(const CpsrGraphicsPipelineState *pipelineState, uint8_t index, CpsrBlendDescriptor *blendState) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(blendState);
+  CPSR_ASSUME(index < CPSR_CPU_RENDER_TARGET_COUNT);
+
+  memcpy(blendState, pipelineState->blendDesc + index, sizeof(CpsrBlendDescriptor));
+}
+
+void CpsrGraphicsPipelineStateSetBlendState(CpsrGraphicsPipelineState *pipelineState, uint8_t index, const CpsrBlendDescriptor *blendState) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(blendState);
+  CPSR_ASSUME(index < CPSR_CPU_RENDER_TARGET_COUNT);
+
+  memcpy(pipelineState->blendDesc + index, blendState, sizeof(CpsrBlendDescriptor));
+}
+
+// ---
+// Property: Rasterizer state
+// ---
+void CpsrGraphicsPipelineStateGetRasterizerState(const CpsrGraphicsPipelineState *pipelineState, CpsrRasterizerDescriptor *rasterizerState) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(rasterizerState);
+
+  memcpy(rasterizerState, &pipelineState->rasterizerDesc, sizeof(CpsrRasterizerDescriptor));
+}
+
+void CpsrGraphicsPipelineStateSetRasterizerState(CpsrGraphicsPipelineState *pipelineState, const CpsrRasterizerDescriptor *rasterizerState) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(rasterizerState);
+
+  memcpy(&pipelineState->rasterizerDesc, rasterizerState, sizeof(CpsrRasterizerDescriptor));
+}
+
+// ---
+// Property: Primitive topology type
+// ---
+CpsrPrimitiveTopologyType CpsrGraphicsPipelineStateGetPrimitiveTopologyType(const CpsrGraphicsPipelineState *pipelineState) {
+  CPSR_ASSUME(pipelineState);
+
+  return pipelineState->primitiveTopologyType;
+}
+
+void CpsrGraphicsPipelineStateSetPrimitiveTopologyType(CpsrGraphicsPipelineState *pipelineState,
+                                                       CpsrPrimitiveTopologyType primitiveTopologyType) {
+  CPSR_ASSUME(pipelineState);
+
+  pipelineState->primitiveTopologyType = primitiveTopologyType;
+}
+
+// ---
+// Property: Multisample count
+// ---
+uint8_t CpsrGraphicsPipelineStateGetMultisampleCount(const CpsrGraphicsPipelineState *pipelineState) {
+  CPSR_ASSUME(pipelineState);
+
+  return pipelineState->sampleCount;
+}
+
+void CpsrGraphicsPipelineStateSetMultisampleCount(CpsrGraphicsPipelineState *pipelineState, uint8_t multisampleCount) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(multisampleCount > 0);
+  CPSR_ASSUME(multisampleCount <= 16);
+
+  // The CPU rasterizer samples once per pixel; the value is kept for API symmetry.
+  pipelineState->sampleCount = multisampleCount;
+}
+
+// ---
+// Property: Render Target Pixel Format
+// ---
+void CpsrSetRenderTargetPixelFormat(CpsrGraphicsPipelineState *pipelineState, uint8_t index, CpsrPixelFormat pixelFormat) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(index < CPSR_CPU_RENDER_TARGET_COUNT);
+
+  pipelineState->pixelFormats[index] = pixelFormat;
+}
+
+void CpsrSetRenderTargetPixelFormatFromTexture2D(CpsrGraphicsPipelineState *pipelineState, uint8_t index, const CpsrTexture2D *renderTarget) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(index < CPSR_CPU_RENDER_TARGET_COUNT);
+  CPSR_ASSUME(renderTarget);
+
+  pipelineState->pixelFormats[index] = renderTarget->pixelFormat;
+}
+
+void CpsrSetRenderTargetPixelFormatFromSwapChain(CpsrGraphicsPipelineState *pipelineState, uint8_t index, CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(pipelineState);
+  CPSR_ASSUME(index < CPSR_CPU_RENDER_TARGET_COUNT);
+  CPSR_ASSUME(swapChain);
+
+  pipelineState->pixelFormats[index] = swapChain->pixelFormat;
+}
@@ -0,0 +1,48 @@
+#include "CpsrGraphics+Private.h"
+
+CpsrHeap *CpsrHeapCreate(const CpsrDevice *device, size_t size, CpsrHeapType heapType) {
+  CPSR_ASSUME(device);
+
+  uint8_t *data = (uint8_t *)CpsrDeviceAllocate(device, size);
+  if (!data) {
+    return NULL;
+  }
+
+  CpsrHeap *heap = CpsrAlloc(CpsrHeap);
+  if (heap) {
+    heap->device = device;
+    heap->data = data;
+    heap->size = size;
+    heap->offset = 0;
+    heap->heapType = heapType;
+  } else {
+    CpsrDeviceDeallocate(device, data, size);
+  }
+  return heap;
+}
+
+CpsrHeap *CpsrHeapCreateFormTexture2DDescriptor(const CpsrDevice *device, const CpsrTexture2DDescriptor *descriptor, uint8_t count, CpsrHeapType heapType) {
+  CPSR_ASSUME(device);
+  CPSR_ASSUME(descriptor);
+
+  size_t size = count * Texture2DDescriptorGetSize(descriptor);
+  return CpsrHeapCreate(device, size, heapType);
+}
+
+CpsrHeap *CpsrHeapCreateFormTexture2DDescriptors(const CpsrDevice *device, const CpsrTexture2DDescriptor *descriptors, uint8_t maxCount, CpsrHeapType heapType) {
+  CPSR_ASSUME(device);
+  CPSR_ASSUME(descriptors);
+
+  size_t size = 0;
+  for (size_t i = 0; i < maxCount; ++i) {
+    size += Texture2DDescriptorGetSize(descriptors + i);
+  }
+  return CpsrHeapCreate(device, size, heapType);
+}
+
+void CpsrHeapDestroy(CpsrHeap *heap) {
+  CPSR_ASSUME(heap);
+
+  CpsrDeviceDeallocate(heap->device, heap->data, heap->size);
+  CpsrDealloc(heap);
+}
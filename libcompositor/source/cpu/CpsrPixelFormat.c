@@ -0,0 +1,283 @@
+#include "CpsrGraphics+Private.h"
+
+// ---
+// Half float
+// ---
+static inline float HalfToFloat(uint16_t value) {
+  const uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1F;
+  const uint32_t mantissa = value & 0x3FF;
+
+  union {
+    uint32_t u;
+    float f;
+  } ret;
+  if (exponent == 0) {
+    ret.f = ldexpf((float)mantissa, -24);
+    ret.u |= sign;
+  } else if (exponent == 0x1F) {
+    ret.u = sign | 0x7F800000 | (mantissa << 13);
+  } else {
+    ret.u = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+  return ret.f;
+}
+
+static inline uint16_t FloatToHalf(float value) {
+  union {
+    uint32_t u;
+    float f;
+  } v;
+  v.f = value;
+
+  const uint16_t sign = (uint16_t)((v.u >> 16) & 0x8000);
+  const uint32_t absolute = v.u & 0x7FFFFFFF;
+  if (absolute >= 0x7F800000) {
+    return sign | (absolute > 0x7F800000 ? 0x7E00 : 0x7C00);
+  }
+  if (absolute >= 0x477FF000) {
+    return sign | 0x7C00;
+  }
+  if (absolute < 0x38800000) {
+    v.u = absolute;
+    return sign | (uint16_t)lrintf(v.f * 16777216.F);
+  }
+
+  // Round to nearest even
+  const uint32_t rounded = absolute + 0xFFF + ((absolute >> 13) & 1);
+  return sign | (uint16_t)((rounded - 0x38000000) >> 13);
+}
+
+// ---
+// Normalized integer
+// ---
+static inline float UnormToFloat(uint32_t value, float maximum) {
+  return (float)value / maximum;
+}
+
+static inline uint32_t FloatToUnorm(float value, float maximum) {
+  value = value < 0.F ? 0.F : (value > 1.F ? 1.F : value);
+  return (uint32_t)(value * maximum + .5F);
+}
+
+static inline float SrgbToLinear(float value) {
+  return value <= 0.04045F ? value / 12.92F : powf((value + 0.055F) / 1.055F, 2.4F);
+}
+
+static inline float LinearToSrgb(float value) {
+  return value <= 0.0031308F ? value * 12.92F : 1.055F * powf(value, 1.F / 2.4F) - 0.055F;
+}
+
+float32x4_t CpsrPixelLoad(const uint8_t *pixel, CpsrPixelFormat pixelFormat) {
+  switch (pixelFormat) {
+  case CPSR_PIXELFORMAT_R8_UNORM:
+    return float32x4_initv(UnormToFloat(pixel[0], 255.F), 0.F, 0.F, 1.F);
+
+  case CPSR_PIXELFORMAT_A8_UNORM:
+    return float32x4_initv(0.F, 0.F, 0.F, UnormToFloat(pixel[0], 255.F));
+
+  case CPSR_PIXELFORMAT_RG8_UNORM:
+    return float32x4_initv(UnormToFloat(pixel[0], 255.F), UnormToFloat(pixel[1], 255.F), 0.F, 1.F);
+
+  case CPSR_PIXELFORMAT_R16_UNORM:
+    return float32x4_initv(UnormToFloat(*(const uint16_t *)pixel, 65535.F), 0.F, 0.F, 1.F);
+
+  case CPSR_PIXELFORMAT_R16_FLOAT:
+    return float32x4_initv(HalfToFloat(*(const uint16_t *)pixel), 0.F, 0.F, 1.F);
+
+  case CPSR_PIXELFORMAT_R32_FLOAT:
+    return float32x4_initv(*(const float *)pixel, 0.F, 0.F, 1.F);
+
+  case CPSR_PIXELFORMAT_RG16_UNORM: {
+    const uint16_t *p = (const uint16_t *)pixel;
+    return float32x4_initv(UnormToFloat(p[0], 65535.F), UnormToFloat(p[1], 65535.F), 0.F, 1.F);
+  }
+
+  case CPSR_PIXELFORMAT_RG16_FLOAT: {
+    const uint16_t *p = (const uint16_t *)pixel;
+    return float32x4_initv(HalfToFloat(p[0]), HalfToFloat(p[1]), 0.F, 1.F);
+  }
+
+  case CPSR_PIXELFORMAT_RGBA8_UNORM:
+    return float32x4_initv(UnormToFloat(pixel[0], 255.F),
+                           UnormToFloat(pixel[1], 255.F),
+                           UnormToFloat(pixel[2], 255.F),
+                           UnormToFloat(pixel[3], 255.F));
+
+  case CPSR_PIXELFORMAT_RGBA8_UNORM_SRGB:
+    return float32x4_initv(SrgbToLinear(UnormToFloat(pixel[0], 255.F)),
+                           SrgbToLinear(UnormToFloat(pixel[1], 255.F)),
+                           SrgbToLinear(UnormToFloat(pixel[2], 255.F)),
+                           UnormToFloat(pixel[3], 255.F));
+
+  case CPSR_PIXELFORMAT_BGRA8_UNORM:
+    return float32x4_initv(UnormToFloat(pixel[2], 255.F),
+                           UnormToFloat(pixel[1], 255.F),
+                           UnormToFloat(pixel[0], 255.F),
+                           UnormToFloat(pixel[3], 255.F));
+
+  case CPSR_PIXELFORMAT_BGRA8_UNORM_SRGB:
+    return float32x4_initv(SrgbToLinear(UnormToFloat(pixel[2], 255.F)),
+                           SrgbToLinear(UnormToFloat(pixel[1], 255.F)),
+                           SrgbToLinear(UnormToFloat(pixel[0], 255.F)),
+                           UnormToFloat(pixel[3], 255.F));
+
+  case CPSR_PIXELFORMAT_RGB10A2_UNORM: {
+    const uint32_t p = *(const uint32_t *)pixel;
+    return float32x4_initv(UnormToFloat(p & 0x3FF, 1023.F),
+                           UnormToFloat((p >> 10) & 0x3FF, 1023.F),
+                           UnormToFloat((p >> 20) & 0x3FF, 1023.F),
+                           UnormToFloat(p >> 30, 3.F));
+  }
+
+  case CPSR_PIXELFORMAT_BGR10A2_UNORM: {
+    const uint32_t p = *(const uint32_t *)pixel;
+    return float32x4_initv(UnormToFloat((p >> 20) & 0x3FF, 1023.F),
+                           UnormToFloat((p >> 10) & 0x3FF, 1023.F),
+                           UnormToFloat(p & 0x3FF, 1023.F),
+                           UnormToFloat(p >> 30, 3.F));
+  }
+
+  case CPSR_PIXELFORMAT_RG32_FLOAT: {
+    const float *p = (const float *)pixel;
+    return float32x4_initv(p[0], p[1], 0.F, 1.F);
+  }
+
+  case CPSR_PIXELFORMAT_RGBA16_UNORM: {
+    const uint16_t *p = (const uint16_t *)pixel;
+    return float32x4_initv(UnormToFloat(p[0], 65535.F),
+                           UnormToFloat(p[1], 65535.F),
+                           UnormToFloat(p[2], 65535.F),
+                           UnormToFloat(p[3], 65535.F));
+  }
+
+  case CPSR_PIXELFORMAT_RGBA16_FLOAT: {
+    const uint16_t *p = (const uint16_t *)pixel;
+    return float32x4_initv(HalfToFloat(p[0]), HalfToFloat(p[1]), HalfToFloat(p[2]), HalfToFloat(p[3]));
+  }
+
+  default:
+    // TODO: log
+    return float32x4_initv(0.F, 0.F, 0.F, 1.F);
+  }
+}
+
+void CpsrPixelStore(uint8_t *pixel, CpsrPixelFormat pixelFormat, float32x4_t color) {
+  simd_alignas(16) float c[4];
+  float32x4_getxp(color, c + 0);
+  float32x4_getyp(color, c + 1);
+  float32x4_getzp(color, c + 2);
+  float32x4_getwp(color, c + 3);
+
+  switch (pixelFormat) {
+  case CPSR_PIXELFORMAT_R8_UNORM:
+    pixel[0] = (uint8_t)FloatToUnorm(c[0], 255.F);
+    break;
+
+  case CPSR_PIXELFORMAT_A8_UNORM:
+    pixel[0] = (uint8_t)FloatToUnorm(c[3], 255.F);
+    break;
+
+  case CPSR_PIXELFORMAT_RG8_UNORM:
+    pixel[0] = (uint8_t)FloatToUnorm(c[0], 255.F);
+    pixel[1] = (uint8_t)FloatToUnorm(c[1], 255.F);
+    break;
+
+  case CPSR_PIXELFORMAT_R16_UNORM:
+    *(uint16_t *)pixel = (uint16_t)FloatToUnorm(c[0], 65535.F);
+    break;
+
+  case CPSR_PIXELFORMAT_R16_FLOAT:
+    *(uint16_t *)pixel = FloatToHalf(c[0]);
+    break;
+
+  case CPSR_PIXELFORMAT_R32_FLOAT:
+    *(float *)pixel = c[0];
+    break;
+
+  case CPSR_PIXELFORMAT_RG16_UNORM: {
+    uint16_t *p = (uint16_t *)pixel;
+    p[0] = (uint16_t)FloatToUnorm(c[0], 65535.F);
+    p[1] = (uint16_t)FloatToUnorm(c[1], 65535.F);
+    break;
+  }
+
+  case CPSR_PIXELFORMAT_RG16_FLOAT: {
+    uint16_t *p = (uint16_t *)pixel;
+    p[0] = FloatToHalf(c[0]);
+    p[1] = FloatToHalf(c[1]);
+    break;
+  }
+
+  case CPSR_PIXELFORMAT_RGBA8_UNORM:
+    pixel[0] = (uint8_t)FloatToUnorm(c[0], 255.F);
+    pixel[1] = (uint8_t)FloatToUnorm(c[1], 255.F);
+    pixel[2] = (uint8_t)FloatToUnorm(c[2], 255.F);
+    pixel[3] = (uint8_t)FloatToUnorm(c[3], 255.F);
+    break;
+
+  case CPSR_PIXELFORMAT_RGBA8_UNORM_SRGB:
+    pixel[0] = (uint8_t)FloatToUnorm(LinearToSrgb(c[0]), 255.F);
+    pixel[1] = (uint8_t)FloatToUnorm(LinearToSrgb(c[1]), 255.F);
+    pixel[2] = (uint8_t)FloatToUnorm(LinearToSrgb(c[2]), 255.F);
+    pixel[3] = (uint8_t)FloatToUnorm(c[3], 255.F);
+    break;
+
+  case CPSR_PIXELFORMAT_BGRA8_UNORM:
+    pixel[0] = (uint8_t)FloatToUnorm(c[2], 255.F);
+    pixel[1] = (uint8_t)FloatToUnorm(c[1], 255.F);
+    pixel[2] = (uint8_t)FloatToUnorm(c[0], 255.F);
+    pixel[3] = (uint8_t)FloatToUnorm(c[3], 255.F);
+    break;
+
+  case CPSR_PIXELFORMAT_BGRA8_UNORM_SRGB:
+    pixel[0] = (uint8_t)FloatToUnorm(LinearToSrgb(c[2]), 255.F);
+    pixel[1] = (uint8_t)FloatToUnorm(LinearToSrgb(c[1]), 255.F);
+    pixel[2] = (uint8_t)FloatToUnorm(LinearToSrgb(c[0]), 255.F);
+    pixel[3] = (uint8_t)FloatToUnorm(c[3], 255.F);
+    break;
+
+  case CPSR_PIXELFORMAT_RGB10A2_UNORM:
+    *(uint32_t *)pixel = FloatToUnorm(c[0], 1023.F)
+                         | (FloatToUnorm(c[1], 1023.F) << 10)
+                         | (FloatToUnorm(c[2], 1023.F) << 20)
+                         | (FloatToUnorm(c[3], 3.F) << 30);
+    break;
+
+  case CPSR_PIXELFORMAT_BGR10A2_UNORM:
+    *(uint32_t *)pixel = FloatToUnorm(c[2], 1023.F)
+                         | (FloatToUnorm(c[1], 1023.F) << 10)
+                         | (FloatToUnorm(c[0], 1023.F) << 20)
+                         | (FloatToUnorm(c[3], 3.F) << 30);
+    break;
+
+  case CPSR_PIXELFORMAT_RG32_FLOAT: {
+    float *p = (float *)pixel;
+    p[0] = c[0];
+    p[1] = c[1];
+    break;
+  }
+
+  case CPSR_PIXELFORMAT_RGBA16_UNORM: {
+    uint16_t *p = (uint16_t *)pixel;
+    p[0] = (uint16_t)FloatToUnorm(c[0], 65535.F);
+    p[1] = (uint16_t)FloatToUnorm(c[1], 65535.F);
+    p[2] = (uint16_t)FloatToUnorm(c[2], 65535.F);
+    p[3] = (uint16_t)FloatToUnorm(c[3], 65535.F);
+    break;
+  }
+
+  case CPSR_PIXELFORMAT_RGBA16_FLOAT: {
+    uint16_t *p = (uint16_t *)pixel;
+    p[0] = FloatToHalf(c[0]);
+    p[1] = FloatToHalf(c[1]);
+    p[2] = FloatToHalf(c[2]);
+    p[3] = FloatToHalf(c[3]);
+    break;
+  }
+
+  default:
+    // TODO: log
+    break;
+  }
+}
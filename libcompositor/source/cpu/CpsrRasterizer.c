@@ -0,0 +1,346 @@
+#include "CpsrGraphics+Private.h"
+
+#include "compositor/vector/float32x4_t.h"
+
+// ---
+// Clear
+// ---
+void CpsrRasterizerClear(const CpsrTexture2D *renderTarget, CpsrClearColor color, const CpsrPixelRect *rect) {
+  CPSR_ASSUME(renderTarget);
+  CPSR_ASSUME(rect);
+
+  const float32x4_t value = float32x4_initv(color.red, color.green, color.blue, color.alpha);
+  const size_t bytesPerPixel = PixelFormatGetBytesPerPixel(renderTarget->pixelFormat);
+  const size_t rowSize = bytesPerPixel * (size_t)(rect->maxX - rect->minX);
+  if (rect->minX >= rect->maxX || rect->minY >= rect->maxY) {
+    return;
+  }
+
+  // Encode the color once, then replicate it across the first row and copy that row downwards.
+  uint8_t *firstRow = CpsrTexture2DGetPixelPointer(renderTarget, (uint32_t)rect->minX, (uint32_t)rect->minY);
+  CpsrPixelStore(firstRow, renderTarget->pixelFormat, value);
+  for (size_t filled = bytesPerPixel; filled < rowSize;) {
+    const size_t length = filled < rowSize - filled ? filled : rowSize - filled;
+    memcpy(firstRow + filled, firstRow, length);
+    filled += length;
+  }
+  for (int32_t y = 1; y < rect->maxY - rect->minY; ++y) {
+    memcpy(firstRow + renderTarget->bytesPerRow * (size_t)y, firstRow, rowSize);
+  }
+}
+
+// ---
+// Blend
+// ---
+static inline float32x4_t _SIMD_CALLCONV MaskFromBits(uint8_t bits) {
+  simd_alignas(16) uint32_t mask[4] = {
+    (bits & 0x1) ? 0xFFFFFFFF : 0,
+    (bits & 0x2) ? 0xFFFFFFFF : 0,
+    (bits & 0x4) ? 0xFFFFFFFF : 0,
+    (bits & 0x8) ? 0xFFFFFFFF : 0,
+  };
+  return float32x4_inita((const float *)mask);
+}
+
+static inline void CpsrBlendStateInit(CpsrBlendState *state, const CpsrBlendDescriptor *desc) {
+  state->blendEnable    = desc->blendEnable;
+  state->srcColorBlend  = desc->srcColorBlend;
+  state->dstColorBlend  = desc->dstColorBlend;
+  state->colorOperation = desc->colorOperation;
+  state->srcAlphaBlend  = desc->srcAlphaBlend;
+  state->dstAlphaBlend  = desc->dstAlphaBlend;
+  state->alphaOperation = desc->alphaOperation;
+  state->alphaMask      = MaskFromBits(0x8);
+  state->writeMask      = MaskFromBits(desc->writeMask);
+  state->writeAll       = desc->writeMask == 0xF;
+}
+
+static inline float32x4_t _SIMD_CALLCONV SplatW(float32x4_t a) {
+  return float32x4_inits(float32x4_getw(a));
+}
+
+// clang-format off
+static inline float32x4_t _SIMD_CALLCONV BlendFactor(CpsrBlendFactor factor, float32x4_t src, float32x4_t dst) {
+  switch (factor) {
+  case CPSR_BLEND_ZERO:                        return FLOAT32X4_ZERO;
+  case CPSR_BLEND_ONE:                         return FLOAT32X4_ONE;
+  case CPSR_BLEND_SOURCE1_COLOR:
+  case CPSR_BLEND_SOURCE_COLOR:                return src;
+  case CPSR_BLEND_ONE_MINUS_SOURCE1_COLOR:
+  case CPSR_BLEND_ONE_MINUS_SOURCE_COLOR:      return float32x4_sub(FLOAT32X4_ONE, src);
+  case CPSR_BLEND_SOURCE1_ALPHA:
+  case CPSR_BLEND_SOURCE_ALPHA:                return SplatW(src);
+  case CPSR_BLEND_ONE_MINUS_SOURCE1_ALPHA:
+  case CPSR_BLEND_ONE_MINUS_SOURCE_ALPHA:      return float32x4_sub(FLOAT32X4_ONE, SplatW(src));
+  case CPSR_BLEND_DESTINATION_COLOR:           return dst;
+  case CPSR_BLEND_ONE_MINUS_DESTINATION_COLOR: return float32x4_sub(FLOAT32X4_ONE, dst);
+  case CPSR_BLEND_DESTINATION_ALPHA:           return SplatW(dst);
+  case CPSR_BLEND_ONE_MINUS_DESTINATION_ALPHA: return float32x4_sub(FLOAT32X4_ONE, SplatW(dst));
+  case CPSR_BLEND_SOURCE_ALPHA_SATURATED: {
+    const float32x4_t saturated = float32x4_min(SplatW(src), float32x4_sub(FLOAT32X4_ONE, SplatW(dst)));
+    return float32x4_setw(saturated, 1.F);
+  }
+  case CPSR_BLEND_BLEND_FACTOR:                return FLOAT32X4_ZERO;
+  case CPSR_BLEND_ONE_MINUS_BLEND_FACTOR:      return FLOAT32X4_ONE;
+  default:                                     return FLOAT32X4_ONE;
+  }
+}
+
+static inline float32x4_t _SIMD_CALLCONV BlendOperation(CpsrBlendOperation operation, float32x4_t src, float32x4_t srcFactor, float32x4_t dst, float32x4_t dstFactor) {
+  switch (operation) {
+  case CPSR_BLEND_OPERATION_SUBTRACT:         return float32x4_mulsub(src, srcFactor, float32x4_mul(dst, dstFactor));
+  case CPSR_BLEND_OPERATION_REVERSE_SUBTRACT: return float32x4_mulsub(dst, dstFactor, float32x4_mul(src, srcFactor));
+  case CPSR_BLEND_OPERATION_MIN:              return float32x4_min(src, dst);
+  case CPSR_BLEND_OPERATION_MAX:              return float32x4_max(src, dst);
+  case CPSR_BLEND_OPERATION_ADD:
+  default:                                    return float32x4_muladd(src, srcFactor, float32x4_mul(dst, dstFactor));
+  }
+}
+// clang-format on
+
+static inline float32x4_t _SIMD_CALLCONV CpsrBlend(const CpsrBlendState *state, float32x4_t src, float32x4_t dst) {
+  float32x4_t ret = src;
+  if (state->blendEnable) {
+    const float32x4_t color = BlendOperation(state->colorOperation,
+                                             src,
+                                             BlendFactor(state->srcColorBlend, src, dst),
+                                             dst,
+                                             BlendFactor(state->dstColorBlend, src, dst));
+    const float32x4_t alpha = BlendOperation(state->alphaOperation,
+                                             src,
+                                             BlendFactor(state->srcAlphaBlend, src, dst),
+                                             dst,
+                                             BlendFactor(state->dstAlphaBlend, src, dst));
+    ret = float32x4_sel(color, alpha, state->alphaMask);
+  }
+  if (!state->writeAll) {
+    ret = float32x4_sel(dst, ret, state->writeMask);
+  }
+  return ret;
+}
+
+// ---
+// Draw state
+// ---
+static inline int32_t ClampI32(int32_t value, int32_t minimum, int32_t maximum) {
+  return value < minimum ? minimum : (value > maximum ? maximum : value);
+}
+
+void CpsrDrawStateInit(CpsrDrawState *state, const CpsrDrawCommand *command) {
+  const CpsrGraphicsPipelineState *pipelineState = command->pipelineState;
+  state->command          = command;
+  state->renderTarget     = command->renderTarget;
+  state->pixelFunction    = pipelineState->pixelFunction->entry->pixel;
+  state->varyingCount     = pipelineState->vertexFunction->entry->varyingCount;
+  state->cullMode         = pipelineState->rasterizerDesc.cullMode;
+  state->fillMode         = pipelineState->rasterizerDesc.fillMode;
+  state->counterClockwise = pipelineState->rasterizerDesc.counterClockwise;
+  CpsrBlendStateInit(&state->blend, pipelineState->blendDesc + 0);
+  state->readDestination  = state->blend.blendEnable || !state->blend.writeAll;
+
+  // Clip to render target, viewport and scissor rect
+  const CpsrViewport *viewport = &command->viewport;
+  const CpsrScissorRect *scissorRect = &command->scissorRect;
+  int32_t minX = (int32_t)floorf(fmaxf(viewport->originX, scissorRect->x));
+  int32_t minY = (int32_t)floorf(fmaxf(viewport->originY, scissorRect->y));
+  int32_t maxX = (int32_t)ceilf(fminf(viewport->originX + viewport->width, scissorRect->x + scissorRect->width));
+  int32_t maxY = (int32_t)ceilf(fminf(viewport->originY + viewport->height, scissorRect->y + scissorRect->height));
+  state->clip.minX = ClampI32(minX, 0, (int32_t)state->renderTarget->size.width);
+  state->clip.minY = ClampI32(minY, 0, (int32_t)state->renderTarget->size.height);
+  state->clip.maxX = ClampI32(maxX, 0, (int32_t)state->renderTarget->size.width);
+  state->clip.maxY = ClampI32(maxY, 0, (int32_t)state->renderTarget->size.height);
+}
+
+void CpsrScreenVertexInit(CpsrScreenVertex *screen, const CpsrNativeVertexOut *vertex, const CpsrViewport *viewport, uint8_t varyingCount) {
+  simd_alignas(16) float position[4];
+  float32x4_getxp(vertex->position, position + 0);
+  float32x4_getyp(vertex->position, position + 1);
+  float32x4_getzp(vertex->position, position + 2);
+  float32x4_getwp(vertex->position, position + 3);
+
+  const float invW = position[3] != 0.F ? 1.F / position[3] : 0.F;
+  const float ndcX = position[0] * invW;
+  const float ndcY = position[1] * invW;
+  const float ndcZ = position[2] * invW;
+  screen->x    = viewport->originX + (.5F * ndcX + .5F) * viewport->width;
+  screen->y    = viewport->originY + (.5F - .5F * ndcY) * viewport->height;
+  screen->z    = viewport->znear + ndcZ * (viewport->zfar - viewport->znear);
+  screen->invW = position[3] > 0.F ? invW : -1.F;
+
+  const float32x4_t invW4 = float32x4_inits(invW);
+  for (uint8_t i = 0; i < varyingCount; ++i) {
+    screen->varyings[i] = float32x4_mul(vertex->varyings[i], invW4);
+  }
+}
+
+static inline void _SIMD_CALLCONV CpsrShadePixel(const CpsrDrawState *state, int32_t x, int32_t y, const CpsrNativeVertexOut *pixelIn) {
+  const float32x4_t src = state->pixelFunction(&state->command->resources, pixelIn);
+
+  uint8_t *pixel = CpsrTexture2DGetPixelPointer(state->renderTarget, (uint32_t)x, (uint32_t)y);
+  float32x4_t color = src;
+  if (state->readDestination) {
+    const float32x4_t dst = CpsrPixelLoad(pixel, state->renderTarget->pixelFormat);
+    color = CpsrBlend(&state->blend, src, dst);
+  }
+  CpsrPixelStore(pixel, state->renderTarget->pixelFormat, color);
+}
+
+// ---
+// Triangle
+// ---
+static inline bool IsTopLeftEdge(float dx, float dy) {
+  return (dy == 0.F && dx > 0.F) || dy < 0.F;
+}
+
+static inline float TriangleGetArea(const CpsrScreenVertex *v0, const CpsrScreenVertex *v1, const CpsrScreenVertex *v2) {
+  return (v1->x - v0->x) * (v2->y - v0->y) - (v2->x - v0->x) * (v1->y - v0->y);
+}
+
+bool CpsrTriangleIsVisible(const CpsrDrawState *state, const CpsrScreenVertex *v0, const CpsrScreenVertex *v1, const CpsrScreenVertex *v2) {
+  // Clipping against the near plane is not supported; reject primitives behind the eye.
+  if (v0->invW < 0.F || v1->invW < 0.F || v2->invW < 0.F) {
+    return false;
+  }
+
+  const float area = TriangleGetArea(v0, v1, v2);
+  if (area == 0.F) {
+    return false;
+  }
+
+  // Positive area is clockwise in window coordinates (y down)
+  const bool front = state->counterClockwise ? area < 0.F : area > 0.F;
+  return !((state->cullMode == CPSR_CULL_BACK && !front) || (state->cullMode == CPSR_CULL_FRONT && front));
+}
+
+// Primitives are binned after CpsrTriangleIsVisible, so only the tile clip is applied here.
+void CpsrRasterizeTriangle(const CpsrDrawState *state, const CpsrPixelRect *clip, const CpsrScreenVertex *v0, const CpsrScreenVertex *v1, const CpsrScreenVertex *v2) {
+  float area = TriangleGetArea(v0, v1, v2);
+  if (area < 0.F) {
+    const CpsrScreenVertex *tmp = v1;
+    v1 = v2;
+    v2 = tmp;
+    area = -area;
+  }
+
+  int32_t minX = (int32_t)floorf(fminf(v0->x, fminf(v1->x, v2->x)));
+  int32_t minY = (int32_t)floorf(fminf(v0->y, fminf(v1->y, v2->y)));
+  int32_t maxX = (int32_t)ceilf(fmaxf(v0->x, fmaxf(v1->x, v2->x)));
+  int32_t maxY = (int32_t)ceilf(fmaxf(v0->y, fmaxf(v1->y, v2->y)));
+  minX = ClampI32(minX, clip->minX, clip->maxX);
+  minY = ClampI32(minY, clip->minY, clip->maxY);
+  maxX = ClampI32(maxX, clip->minX, clip->maxX);
+  maxY = ClampI32(maxY, clip->minY, clip->maxY);
+  if (minX >= maxX || minY >= maxY) {
+    return;
+  }
+
+  // Edge functions: e12 -> b0, e20 -> b1, e01 -> b2
+  const float a12 = v1->y - v2->y, b12 = v2->x - v1->x;
+  const float a20 = v2->y - v0->y, b20 = v0->x - v2->x;
+  const float a01 = v0->y - v1->y, b01 = v1->x - v0->x;
+  const bool tl12 = IsTopLeftEdge(b12, -a12);
+  const bool tl20 = IsTopLeftEdge(b20, -a20);
+  const bool tl01 = IsTopLeftEdge(b01, -a01);
+
+  const float invArea = 1.F / area;
+  const uint8_t varyingCount = state->varyingCount;
+
+  CpsrNativeVertexOut pixelIn;
+  for (int32_t y = minY; y < maxY; ++y) {
+    const float py = (float)y + .5F;
+    const float px0 = (float)minX + .5F;
+    float e12 = b12 * (py - v1->y) + a12 * (px0 - v1->x);
+    float e20 = b20 * (py - v2->y) + a20 * (px0 - v2->x);
+    float e01 = b01 * (py - v0->y) + a01 * (px0 - v0->x);
+    for (int32_t x = minX; x < maxX; ++x, e12 += a12, e20 += a20, e01 += a01) {
+      if ((e12 < 0.F || (e12 == 0.F && !tl12))
+          || (e20 < 0.F || (e20 == 0.F && !tl20))
+          || (e01 < 0.F || (e01 == 0.F && !tl01))) {
+        continue;
+      }
+
+      const float l0 = e12 * invArea;
+      const float l1 = e20 * invArea;
+      const float l2 = e01 * invArea;
+      const float invW = l0 * v0->invW + l1 * v1->invW + l2 * v2->invW;
+      const float w = invW != 0.F ? 1.F / invW : 0.F;
+      const float z = l0 * v0->z + l1 * v1->z + l2 * v2->z;
+      pixelIn.position = float32x4_initv((float)x + .5F, py, z, w);
+
+      // Perspective-correct interpolation
+      const float32x4_t b0 = float32x4_inits(l0 * w);
+      const float32x4_t b1 = float32x4_inits(l1 * w);
+      const float32x4_t b2 = float32x4_inits(l2 * w);
+      for (uint8_t i = 0; i < varyingCount; ++i) {
+        float32x4_t varying = float32x4_mul(v0->varyings[i], b0);
+        varying = float32x4_muladd(v1->varyings[i], b1, varying);
+        pixelIn.varyings[i] = float32x4_muladd(v2->varyings[i], b2, varying);
+      }
+
+      CpsrShadePixel(state, x, y, &pixelIn);
+    }
+  }
+}
+
+// ---
+// Line
+// ---
+void CpsrRasterizeLine(const CpsrDrawState *state, const CpsrPixelRect *clip, const CpsrScreenVertex *v0, const CpsrScreenVertex *v1) {
+  if (v0->invW < 0.F || v1->invW < 0.F) {
+    return;
+  }
+
+  const float dx = v1->x - v0->x;
+  const float dy = v1->y - v0->y;
+  const float length = fmaxf(fabsf(dx), fabsf(dy));
+  const uint32_t steps = length > 0.F ? (uint32_t)ceilf(length) : 1;
+  const uint8_t varyingCount = state->varyingCount;
+
+  CpsrNativeVertexOut pixelIn;
+  for (uint32_t i = 0; i < steps; ++i) {
+    const float t = ((float)i + .5F) / (float)steps;
+    const int32_t x = (int32_t)floorf(v0->x + t * dx);
+    const int32_t y = (int32_t)floorf(v0->y + t * dy);
+    if (x < clip->minX || x >= clip->maxX || y < clip->minY || y >= clip->maxY) {
+      continue;
+    }
+
+    const float invW = (1.F - t) * v0->invW + t * v1->invW;
+    const float w = invW != 0.F ? 1.F / invW : 0.F;
+    const float z = (1.F - t) * v0->z + t * v1->z;
+    pixelIn.position = float32x4_initv((float)x + .5F, (float)y + .5F, z, w);
+
+    const float32x4_t b0 = float32x4_inits((1.F - t) * w);
+    const float32x4_t b1 = float32x4_inits(t * w);
+    for (uint8_t j = 0; j < varyingCount; ++j) {
+      pixelIn.varyings[j] = float32x4_muladd(v1->varyings[j], b1, float32x4_mul(v0->varyings[j], b0));
+    }
+
+    CpsrShadePixel(state, x, y, &pixelIn);
+  }
+}
+
+// ---
+// Point
+// ---
+void CpsrRasterizePoint(const CpsrDrawState *state, const CpsrPixelRect *clip, const CpsrScreenVertex *v0) {
+  if (v0->invW < 0.F) {
+    return;
+  }
+
+  const int32_t x = (int32_t)floorf(v0->x);
+  const int32_t y = (int32_t)floorf(v0->y);
+  if (x < clip->minX || x >= clip->maxX || y < clip->minY || y >= clip->maxY) {
+    return;
+  }
+
+  const float w = v0->invW != 0.F ? 1.F / v0->invW : 0.F;
+  const float32x4_t w4 = float32x4_inits(w);
+
+  CpsrNativeVertexOut pixelIn;
+  pixelIn.position = float32x4_initv((float)x + .5F, (float)y + .5F, v0->z, w);
+  for (uint8_t i = 0; i < state->varyingCount; ++i) {
+    pixelIn.varyings[i] = float32x4_mul(v0->varyings[i], w4);
+  }
+  CpsrShadePixel(state, x, y, &pixelIn);
+}
@@ -0,0 +1,416 @@
+#include "CpsrGraphics+Private.h"
+
+#include <math.h>
+
+typedef enum {
+  CPSR_PRIMITIVE_POINT,
+  CPSR_PRIMITIVE_LINE,
+  CPSR_PRIMITIVE_TRIANGLE,
+} CpsrPrimitiveType;
+
+typedef struct {
+  CpsrPrimitiveType type;
+  uint32_t drawIndex;
+  uint32_t vertices[3];
+  CpsrPixelRect bounds;
+} CpsrPrimitive;
+
+struct _CpsrRenderPass {
+  const CpsrTexture2D *renderTarget;
+  uint32_t tileSize;
+  uint32_t tileCountX, tileCountY;
+
+  // Draws are copied because the command buffer may grow after the pass is closed
+  CpsrDrawCommand *draws;
+  CpsrDrawState *drawStates;
+  uint32_t drawCount;
+
+  CpsrScreenVertex *vertices;
+  uint32_t vertexCount;
+
+  CpsrPrimitive *primitives;
+  uint32_t primitiveCount;
+
+  // Primitive indices of tile i are binPrimitives[binOffsets[i]..binOffsets[i + 1]], in submission order.
+  uint32_t *binOffsets;
+  uint32_t *binPrimitives;
+};
+
+// ---
+// Tiles
+// ---
+static inline uint32_t CpsrRenderPassGetTileSize(const CpsrDevice *device, CpsrPixelFormat pixelFormat) {
+  // Half of L2 for the tile, the rest for textures and vertices read while shading it
+  const size_t budget = device->l2CacheSize / 2;
+  const size_t bytesPerPixel = PixelFormatGetBytesPerPixel(pixelFormat);
+  uint32_t tileSize = CPSR_CPU_MIN_TILE_SIZE;
+  while (tileSize < CPSR_CPU_MAX_TILE_SIZE && (size_t)(2 * tileSize) * (2 * tileSize) * bytesPerPixel <= budget) {
+    tileSize *= 2;
+  }
+  return tileSize;
+}
+
+static inline CpsrPixelRect CpsrRenderPassGetTileRect(const CpsrRenderPass *renderPass, uint32_t index) {
+  const uint32_t tileSize = renderPass->tileSize;
+  const uint32_t x = (index % renderPass->tileCountX) * tileSize;
+  const uint32_t y = (index / renderPass->tileCountX) * tileSize;
+  const CpsrSizeU32 size = renderPass->renderTarget->size;
+  CpsrPixelRect rect;
+  rect.minX = (int32_t)x;
+  rect.minY = (int32_t)y;
+  rect.maxX = (int32_t)(x + tileSize < size.width ? x + tileSize : size.width);
+  rect.maxY = (int32_t)(y + tileSize < size.height ? y + tileSize : size.height);
+  return rect;
+}
+
+static inline bool CpsrPixelRectIntersect(CpsrPixelRect *rect, const CpsrPixelRect *a, const CpsrPixelRect *b) {
+  rect->minX = a->minX > b->minX ? a->minX : b->minX;
+  rect->minY = a->minY > b->minY ? a->minY : b->minY;
+  rect->maxX = a->maxX < b->maxX ? a->maxX : b->maxX;
+  rect->maxY = a->maxY < b->maxY ? a->maxY : b->maxY;
+  return rect->minX < rect->maxX && rect->minY < rect->maxY;
+}
+
+// ---
+// Primitive assembly
+// ---
+static inline float ClampF(float value, float minimum, float maximum) {
+  return fminf(fmaxf(value, minimum), maximum);
+}
+
+static inline uint32_t GetMaxPrimitiveCount(CpsrPrimitiveTopology primitiveTopology, uint32_t count, bool wireframe) {
+  switch (primitiveTopology) {
+  case CPSR_PRIMITIVE_TOPOLOGY_POINT:
+    return count;
+  case CPSR_PRIMITIVE_TOPOLOGY_LINE:
+    return count / 2;
+  case CPSR_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+    return count > 0 ? count - 1 : 0;
+  case CPSR_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+    return (count > 2 ? count - 2 : 0) * (wireframe ? 3 : 1);
+  case CPSR_PRIMITIVE_TOPOLOGY_TRIANGLE:
+  default:
+    return count / 3 * (wireframe ? 3 : 1);
+  }
+}
+
+static void CpsrRenderPassEmit(CpsrRenderPass *renderPass,
+                               uint32_t drawIndex,
+                               CpsrPrimitiveType type,
+                               uint32_t i0,
+                               uint32_t i1,
+                               uint32_t i2) {
+  const CpsrScreenVertex *vertices = renderPass->vertices;
+  const CpsrScreenVertex *v0 = vertices + i0;
+  const CpsrScreenVertex *v1 = vertices + i1;
+  const CpsrScreenVertex *v2 = vertices + i2;
+  if (v0->invW < 0.F || v1->invW < 0.F || v2->invW < 0.F) {
+    return;
+  }
+
+  // Conservative bounds: the pixel containing the maximum is included
+  const CpsrPixelRect *clip = &renderPass->drawStates[drawIndex].clip;
+  const float clipMinX = (float)clip->minX, clipMaxX = (float)clip->maxX;
+  const float clipMinY = (float)clip->minY, clipMaxY = (float)clip->maxY;
+  CpsrPrimitive *primitive = renderPass->primitives + renderPass->primitiveCount;
+  primitive->bounds.minX = (int32_t)floorf(ClampF(fminf(v0->x, fminf(v1->x, v2->x)), clipMinX, clipMaxX));
+  primitive->bounds.minY = (int32_t)floorf(ClampF(fminf(v0->y, fminf(v1->y, v2->y)), clipMinY, clipMaxY));
+  primitive->bounds.maxX = (int32_t)floorf(ClampF(fmaxf(v0->x, fmaxf(v1->x, v2->x)), clipMinX, clipMaxX)) + 1;
+  primitive->bounds.maxY = (int32_t)floorf(ClampF(fmaxf(v0->y, fmaxf(v1->y, v2->y)), clipMinY, clipMaxY)) + 1;
+  if (!CpsrPixelRectIntersect(&primitive->bounds, &primitive->bounds, clip)) {
+    return;
+  }
+
+  primitive->type        = type;
+  primitive->drawIndex   = drawIndex;
+  primitive->vertices[0] = i0;
+  primitive->vertices[1] = i1;
+  primitive->vertices[2] = i2;
+  ++renderPass->primitiveCount;
+}
+
+static inline void CpsrRenderPassEmitTriangle(CpsrRenderPass *renderPass, uint32_t drawIndex, uint32_t i0, uint32_t i1, uint32_t i2) {
+  const CpsrDrawState *state = renderPass->drawStates + drawIndex;
+  if (state->fillMode == CPSR_FILL_WIREFRAME) {
+    CpsrRenderPassEmit(renderPass, drawIndex, CPSR_PRIMITIVE_LINE, i0, i1, i1);
+    CpsrRenderPassEmit(renderPass, drawIndex, CPSR_PRIMITIVE_LINE, i1, i2, i2);
+    CpsrRenderPassEmit(renderPass, drawIndex, CPSR_PRIMITIVE_LINE, i2, i0, i0);
+  } else {
+    const CpsrScreenVertex *vertices = renderPass->vertices;
+    if (CpsrTriangleIsVisible(state, vertices + i0, vertices + i1, vertices + i2)) {
+      CpsrRenderPassEmit(renderPass, drawIndex, CPSR_PRIMITIVE_TRIANGLE, i0, i1, i2);
+    }
+  }
+}
+
+static void CpsrRenderPassAssemble(CpsrRenderPass *renderPass, uint32_t drawIndex, uint32_t first, uint32_t count) {
+  switch (renderPass->draws[drawIndex].primitiveTopology) {
+  case CPSR_PRIMITIVE_TOPOLOGY_POINT:
+    for (uint32_t i = first; i < first + count; ++i) {
+      CpsrRenderPassEmit(renderPass, drawIndex, CPSR_PRIMITIVE_POINT, i, i, i);
+    }
+    break;
+
+  case CPSR_PRIMITIVE_TOPOLOGY_LINE:
+    for (uint32_t i = first; i + 1 < first + count; i += 2) {
+      CpsrRenderPassEmit(renderPass, drawIndex, CPSR_PRIMITIVE_LINE, i, i + 1, i + 1);
+    }
+    break;
+
+  case CPSR_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+    for (uint32_t i = first; i + 1 < first + count; ++i) {
+      CpsrRenderPassEmit(renderPass, drawIndex, CPSR_PRIMITIVE_LINE, i, i + 1, i + 1);
+    }
+    break;
+
+  case CPSR_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+    for (uint32_t i = first; i + 2 < first + count; ++i) {
+      // Odd triangles swap the first two vertices to keep the winding of the strip
+      if ((i - first) & 1) {
+        CpsrRenderPassEmitTriangle(renderPass, drawIndex, i + 1, i, i + 2);
+      } else {
+        CpsrRenderPassEmitTriangle(renderPass, drawIndex, i, i + 1, i + 2);
+      }
+    }
+    break;
+
+  case CPSR_PRIMITIVE_TOPOLOGY_TRIANGLE:
+  default:
+    for (uint32_t i = first; i + 2 < first + count; i += 3) {
+      CpsrRenderPassEmitTriangle(renderPass, drawIndex, i, i + 1, i + 2);
+    }
+    break;
+  }
+}
+
+// ---
+// Vertex stage
+// ---
+static inline uint32_t CpsrDrawCommandGetVertexId(const CpsrDrawCommand *command, uint32_t index) {
+  if (!command->indexed) {
+    return command->vertexStart + index;
+  }
+
+  uint32_t vertexId;
+  if (command->indexType == CPSR_INDEX_TYPE_UINT16) {
+    vertexId = ((const uint16_t *)command->indices)[index];
+  } else {
+    vertexId = ((const uint32_t *)command->indices)[index];
+  }
+  return (uint32_t)((int32_t)vertexId + command->baseVertex);
+}
+
+static void CpsrRenderPassProcessDraw(CpsrRenderPass *renderPass, uint32_t drawIndex) {
+  const CpsrDrawCommand *command = renderPass->draws + drawIndex;
+  const CpsrDrawState *state = renderPass->drawStates + drawIndex;
+  const CpsrNativeVertexFunction vertexFunction = command->pipelineState->vertexFunction->entry->vertex;
+
+  CpsrNativeVertexOut vertexOut;
+  for (uint32_t instance = 0; instance < command->instanceCount; ++instance) {
+    const uint32_t instanceId = command->baseInstance + instance;
+    const uint32_t first = renderPass->vertexCount;
+    for (uint32_t i = 0; i < command->vertexCount; ++i) {
+      const uint32_t vertexId = CpsrDrawCommandGetVertexId(command, i);
+      vertexFunction(&command->resources, vertexId, instanceId, &vertexOut);
+      CpsrScreenVertexInit(renderPass->vertices + first + i, &vertexOut, &command->viewport, state->varyingCount);
+    }
+    renderPass->vertexCount += command->vertexCount;
+
+    CpsrRenderPassAssemble(renderPass, drawIndex, first, command->vertexCount);
+  }
+}
+
+// ---
+// Binning
+// ---
+static bool CpsrRenderPassBin(CpsrRenderPass *renderPass) {
+  const uint32_t tileSize = renderPass->tileSize;
+  const uint32_t tileCount = renderPass->tileCountX * renderPass->tileCountY;
+  uint32_t *binOffsets = (uint32_t *)calloc(tileCount + 1, sizeof(uint32_t));
+  if (!binOffsets) {
+    return true;
+  }
+
+  // Count primitives per tile, then prefix sum
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < renderPass->primitiveCount; ++i) {
+    const CpsrPixelRect *bounds = &renderPass->primitives[i].bounds;
+    for (uint32_t ty = (uint32_t)bounds->minY / tileSize; ty <= (uint32_t)(bounds->maxY - 1) / tileSize; ++ty) {
+      for (uint32_t tx = (uint32_t)bounds->minX / tileSize; tx <= (uint32_t)(bounds->maxX - 1) / tileSize; ++tx) {
+        ++binOffsets[ty * renderPass->tileCountX + tx + 1];
+        ++total;
+      }
+    }
+  }
+  if (total > UINT32_MAX) {
+    free(binOffsets);
+    return true;
+  }
+  for (uint32_t i = 0; i < tileCount; ++i) {
+    binOffsets[i + 1] += binOffsets[i];
+  }
+
+  uint32_t *binPrimitives = (uint32_t *)malloc((total > 0 ? total : 1) * sizeof(uint32_t));
+  uint32_t *cursors = (uint32_t *)malloc(tileCount * sizeof(uint32_t));
+  if (!binPrimitives || !cursors) {
+    free(cursors);
+    free(binPrimitives);
+    free(binOffsets);
+    return true;
+  }
+  memcpy(cursors, binOffsets, tileCount * sizeof(uint32_t));
+
+  // Fill in submission order so blending within a tile matches the order of the draws
+  for (uint32_t i = 0; i < renderPass->primitiveCount; ++i) {
+    const CpsrPixelRect *bounds = &renderPass->primitives[i].bounds;
+    for (uint32_t ty = (uint32_t)bounds->minY / tileSize; ty <= (uint32_t)(bounds->maxY - 1) / tileSize; ++ty) {
+      for (uint32_t tx = (uint32_t)bounds->minX / tileSize; tx <= (uint32_t)(bounds->maxX - 1) / tileSize; ++tx) {
+        binPrimitives[cursors[ty * renderPass->tileCountX + tx]++] = i;
+      }
+    }
+  }
+  free(cursors);
+
+  renderPass->binOffsets    = binOffsets;
+  renderPass->binPrimitives = binPrimitives;
+  return false;
+}
+
+CpsrRenderPass *CpsrRenderPassCreate(const CpsrDevice *device,
+                                     const CpsrTexture2D *renderTarget,
+                                     const CpsrCommand *draws,
+                                     uint32_t drawCount) {
+  CPSR_ASSUME(device);
+  CPSR_ASSUME(renderTarget);
+
+  CpsrRenderPass *renderPass = CpsrAlloc(CpsrRenderPass);
+  if (!renderPass) {
+    return NULL;
+  }
+  memset(renderPass, 0, sizeof(CpsrRenderPass));
+
+  const uint32_t tileSize = CpsrRenderPassGetTileSize(device, renderTarget->pixelFormat);
+  renderPass->renderTarget = renderTarget;
+  renderPass->tileSize     = tileSize;
+  renderPass->tileCountX   = (renderTarget->size.width + tileSize - 1) / tileSize;
+  renderPass->tileCountY   = (renderTarget->size.height + tileSize - 1) / tileSize;
+
+  if (drawCount > 0) {
+    renderPass->draws = (CpsrDrawCommand *)malloc(drawCount * sizeof(CpsrDrawCommand));
+    renderPass->drawStates = (CpsrDrawState *)malloc(drawCount * sizeof(CpsrDrawState));
+    if (!renderPass->draws || !renderPass->drawStates) {
+      CpsrRenderPassDestroy(renderPass);
+      return NULL;
+    }
+    for (uint32_t i = 0; i < drawCount; ++i) {
+      assert(draws[i].type == CPSR_COMMAND_DRAW);
+      renderPass->draws[i] = draws[i].draw;
+    }
+    renderPass->drawCount = drawCount;
+
+    // Size the vertex and primitive storage for the whole pass
+    uint64_t vertexCount = 0;
+    uint64_t primitiveCount = 0;
+    for (uint32_t i = 0; i < drawCount; ++i) {
+      const CpsrDrawCommand *draw = renderPass->draws + i;
+      CpsrDrawStateInit(renderPass->drawStates + i, draw);
+
+      const bool wireframe = renderPass->drawStates[i].fillMode == CPSR_FILL_WIREFRAME;
+      vertexCount += (uint64_t)draw->vertexCount * draw->instanceCount;
+      primitiveCount += (uint64_t)GetMaxPrimitiveCount(draw->primitiveTopology, draw->vertexCount, wireframe) * draw->instanceCount;
+    }
+    if (vertexCount > UINT32_MAX || primitiveCount > UINT32_MAX) {
+      // TODO: log
+      CpsrRenderPassDestroy(renderPass);
+      return NULL;
+    }
+
+    renderPass->vertices = (CpsrScreenVertex *)aligned_alloc(16, AlignUp((vertexCount > 0 ? vertexCount : 1) * sizeof(CpsrScreenVertex), 16));
+    renderPass->primitives = (CpsrPrimitive *)malloc((primitiveCount > 0 ? primitiveCount : 1) * sizeof(CpsrPrimitive));
+    if (!renderPass->vertices || !renderPass->primitives) {
+      CpsrRenderPassDestroy(renderPass);
+      return NULL;
+    }
+
+    for (uint32_t i = 0; i < drawCount; ++i) {
+      const CpsrDrawState *state = renderPass->drawStates + i;
+      if (state->clip.minX < state->clip.maxX && state->clip.minY < state->clip.maxY) {
+        CpsrRenderPassProcessDraw(renderPass, i);
+      }
+    }
+  }
+
+  if (CpsrRenderPassBin(renderPass)) {
+    CpsrRenderPassDestroy(renderPass);
+    return NULL;
+  }
+  return renderPass;
+}
+
+void CpsrRenderPassDestroy(CpsrRenderPass *renderPass) {
+  CPSR_ASSUME(renderPass);
+
+  free(renderPass->binPrimitives);
+  free(renderPass->binOffsets);
+  free(renderPass->primitives);
+  free(renderPass->vertices);
+  free(renderPass->drawStates);
+  free(renderPass->draws);
+  CpsrDealloc(renderPass);
+}
+
+// ---
+// Execute
+// ---
+static void CpsrRenderPassRasterizeTile(void *context, uint32_t index) {
+  const CpsrRenderPassCommand *command = (const CpsrRenderPassCommand *)context;
+  const CpsrRenderPass *renderPass = command->renderPass;
+  const CpsrPixelRect tile = CpsrRenderPassGetTileRect(renderPass, index);
+  if (command->clearEnable) {
+    CpsrRasterizerClear(renderPass->renderTarget, command->clearColor, &tile);
+  }
+
+  const CpsrScreenVertex *vertices = renderPass->vertices;
+  for (uint32_t i = renderPass->binOffsets[index]; i < renderPass->binOffsets[index + 1]; ++i) {
+    const CpsrPrimitive *primitive = renderPass->primitives + renderPass->binPrimitives[i];
+    const CpsrDrawState *state = renderPass->drawStates + primitive->drawIndex;
+
+    CpsrPixelRect clip;
+    if (!CpsrPixelRectIntersect(&clip, &tile, &primitive->bounds)) {
+      continue;
+    }
+
+    const uint32_t *indices = primitive->vertices;
+    switch (primitive->type) {
+    case CPSR_PRIMITIVE_POINT:
+      CpsrRasterizePoint(state, &clip, vertices + indices[0]);
+      break;
+
+    case CPSR_PRIMITIVE_LINE:
+      CpsrRasterizeLine(state, &clip, vertices + indices[0], vertices + indices[1]);
+      break;
+
+    case CPSR_PRIMITIVE_TRIANGLE:
+      CpsrRasterizeTriangle(state, &clip, vertices + indices[0], vertices + indices[1], vertices + indices[2]);
+      break;
+    }
+  }
+}
+
+void CpsrRenderPassExecute(const CpsrRenderPassCommand *command, CpsrWorkerPool *workerPool) {
+  CPSR_ASSUME(command);
+  CPSR_ASSUME(workerPool);
+
+  const CpsrRenderPass *renderPass = command->renderPass;
+  if (!renderPass) {
+    // Binning failed; only the load action is honored.
+    if (command->clearEnable) {
+      const CpsrPixelRect rect = { 0, 0, (int32_t)command->renderTarget->size.width, (int32_t)command->renderTarget->size.height };
+      CpsrRasterizerClear(command->renderTarget, command->clearColor, &rect);
+    }
+    return;
+  }
+
+  const uint32_t tileCount = renderPass->tileCountX * renderPass->tileCountY;
+  CpsrWorkerPoolRun(workerPool, tileCount, CpsrRenderPassRasterizeTile, (void *)command);
+}
@@ -0,0 +1,29 @@
+#include "CpsrGraphics+Private.h"
+
+static inline CpsrShaderFunction *ShaderFunctionCreate(const CpsrNativeShaderEntry *entry) {
+  CpsrShaderFunction *function = CpsrAlloc(CpsrShaderFunction);
+  if (function) {
+    function->entry = entry;
+  }
+  return function;
+}
+
+CpsrShaderFunction *CpsrShaderFunctionCreateFromLibrary(const CpsrShaderLibrary *shaderLibrary, const char *functionName) {
+  const CpsrNativeShaderEntry *entry = CpsrShaderLibraryFindEntry(shaderLibrary, functionName);
+  if (entry) {
+    CpsrShaderFunction *function = ShaderFunctionCreate(entry);
+    return function;
+  }
+  return NULL;
+}
+
+// Runtime compilation is not available on the CPU driver.
+CpsrShaderFunction *CpsrShaderFunctionCreateFromString(const CpsrDevice *device, const char *functionString, CpsrShaderType shaderType) {
+  return NULL;
+}
+
+void CpsrShaderFunctionDestroy(CpsrShaderFunction *shaderFunction) {
+  CPSR_ASSUME(shaderFunction);
+
+  CpsrDealloc(shaderFunction);
+}
@@ -0,0 +1,107 @@
+#include "CpsrGraphics+Private.h"
+
+#define CPSR_CPU_NATIVE_LIBRARY_COUNT 32
+
+typedef struct {
+  const char *filePath;
+  const CpsrNativeShaderEntry *entries;
+  size_t count;
+} CpsrNativeShaderTable;
+
+static pthread_mutex_t gNativeShaderMutex = PTHREAD_MUTEX_INITIALIZER;
+static CpsrNativeShaderTable gNativeShaderTables[CPSR_CPU_NATIVE_LIBRARY_COUNT];
+
+bool CpsrShaderLibraryRegisterNative(const char *filePath, const CpsrNativeShaderEntry *entries, size_t count) {
+  CPSR_ASSUME(filePath);
+  CPSR_ASSUME(entries);
+
+  bool failed = true;
+  pthread_mutex_lock(&gNativeShaderMutex);
+  for (size_t i = 0; i < CPSR_CPU_NATIVE_LIBRARY_COUNT; ++i) {
+    CpsrNativeShaderTable *table = gNativeShaderTables + i;
+    if (table->entries == entries) {
+      failed = false;
+      break;
+    }
+    if (!table->entries) {
+      table->filePath = filePath;
+      table->entries = entries;
+      table->count = count;
+      failed = false;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&gNativeShaderMutex);
+  return failed;
+}
+
+void CpsrShaderLibraryUnregisterNative(const CpsrNativeShaderEntry *entries) {
+  CPSR_ASSUME(entries);
+
+  pthread_mutex_lock(&gNativeShaderMutex);
+  for (size_t i = 0; i < CPSR_CPU_NATIVE_LIBRARY_COUNT; ++i) {
+    if (gNativeShaderTables[i].entries == entries) {
+      memmove(gNativeShaderTables + i,
+              gNativeShaderTables + i + 1,
+              (CPSR_CPU_NATIVE_LIBRARY_COUNT - i - 1) * sizeof(CpsrNativeShaderTable));
+      memset(gNativeShaderTables + CPSR_CPU_NATIVE_LIBRARY_COUNT - 1, 0, sizeof(CpsrNativeShaderTable));
+      break;
+    }
+  }
+  pthread_mutex_unlock(&gNativeShaderMutex);
+}
+
+CpsrShaderLibrary *CpsrShaderLibraryCreate(const CpsrDevice *device, const char *filePath) {
+  CPSR_ASSUME(device);
+  CPSR_ASSUME(filePath);
+
+  char *filePathCopy = strdup(filePath);
+  if (!filePathCopy) {
+    return NULL;
+  }
+
+  CpsrShaderLibrary *shaderLibrary = CpsrAlloc(CpsrShaderLibrary);
+  if (shaderLibrary) {
+    shaderLibrary->device = device;
+    shaderLibrary->filePath = filePathCopy;
+  } else {
+    free(filePathCopy);
+  }
+  return shaderLibrary;
+}
+
+void CpsrShaderLibraryDestroy(CpsrShaderLibrary *shaderLibrary) {
+  CPSR_ASSUME(shaderLibrary);
+
+  free(shaderLibrary->filePath);
+  CpsrDealloc(shaderLibrary);
+}
+
+// ---
+// Internal functions
+// ---
+const CpsrNativeShaderEntry *CpsrShaderLibraryFindEntry(const CpsrShaderLibrary *shaderLibrary, const char *functionName) {
+  CPSR_ASSUME(shaderLibrary);
+  CPSR_ASSUME(functionName);
+
+  const CpsrNativeShaderEntry *ret = NULL;
+  pthread_mutex_lock(&gNativeShaderMutex);
+  for (size_t i = 0; i < CPSR_CPU_NATIVE_LIBRARY_COUNT && !ret; ++i) {
+    const CpsrNativeShaderTable *table = gNativeShaderTables + i;
+    if (!table->entries) {
+      break;
+    }
+    if (strcmp(table->filePath, shaderLibrary->filePath) != 0) {
+      continue;
+    }
+
+    for (size_t j = 0; j < table->count; ++j) {
+      if (strcmp(table->entries[j].name, functionName) == 0) {
+        ret = table->entries + j;
+        break;
+      }
+    }
+  }
+  pthread_mutex_unlock(&gNativeShaderMutex);
+  return ret;
+}
@@ -0,0 +1,311 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#include "CpsrGraphics+Private.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+static_assert(sizeof(CpsrSharedFrameRingHeader) % CPSR_SHARED_FRAME_RING_ALIGNMENT == 0, "Ring header must keep frames aligned");
+static_assert(sizeof(CpsrSharedFrameHeader) % CPSR_SHARED_FRAME_RING_ALIGNMENT == 0, "Frame header must keep pixels aligned");
+static_assert(CPSR_SHARED_FRAME_RING_MAX_FRAME_COUNT <= CPSR_CPU_SWAPCHAIN_MAX_BUFFER_COUNT, "Ring frames exceed swap chain buffers");
+
+static inline bool CpsrSwapChainIsOffscreen(const CpsrSwapChain *swapChain) {
+  return !swapChain->hostView;
+}
+
+static inline void CpsrSwapChainReleaseSharedMemory(CpsrSwapChain *swapChain) {
+  if (swapChain->sharedMemory) {
+    // Tell consumers still mapping this ring to reconnect
+    atomic_store_explicit(&swapChain->sharedMemory->magic, 0, memory_order_release);
+    munmap(swapChain->sharedMemory, swapChain->sharedMemorySize);
+    swapChain->sharedMemory = NULL;
+    swapChain->sharedMemorySize = 0;
+  }
+  if (swapChain->sharedMemoryFd >= 0) {
+    close(swapChain->sharedMemoryFd);
+    swapChain->sharedMemoryFd = -1;
+  }
+}
+
+static inline bool CpsrSwapChainCreateSharedMemory(CpsrSwapChain *swapChain) {
+  const size_t bytesPerRow = PixelFormatGetBytesPerRow(swapChain->pixelFormat, swapChain->size.width);
+  const size_t dataOffset  = sizeof(CpsrSharedFrameHeader);
+  const size_t frameStride = dataOffset + AlignUp(bytesPerRow * swapChain->size.height, CPSR_SHARED_FRAME_RING_ALIGNMENT);
+  const size_t size        = sizeof(CpsrSharedFrameRingHeader) + frameStride * swapChain->bufferCount;
+
+  const int fd = memfd_create("CpsrSwapChain", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    // TODO: log
+    return true;
+  }
+  if (ftruncate(fd, (off_t)size)) {
+    // TODO: log
+    close(fd);
+    return true;
+  }
+
+  // The ring never changes size; sealing it lets consumers map it without fearing SIGBUS
+  fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    // TODO: log
+    close(fd);
+    return true;
+  }
+
+  // ftruncate zero-fills, so every frame sequence starts at 0 (never written)
+  CpsrSharedFrameRingHeader *ring = (CpsrSharedFrameRingHeader *)memory;
+  ring->version     = CPSR_SHARED_FRAME_RING_VERSION;
+  ring->frameCount  = swapChain->bufferCount;
+  ring->width       = swapChain->size.width;
+  ring->height      = swapChain->size.height;
+  ring->pixelFormat = (uint32_t)swapChain->pixelFormat;
+  ring->colorSpace  = (uint32_t)swapChain->colorSpace;
+  ring->bytesPerRow = bytesPerRow;
+  ring->frameStride = frameStride;
+  ring->dataOffset  = dataOffset;
+  atomic_store_explicit(&ring->latestSequence, 0, memory_order_relaxed);
+  atomic_store_explicit(&ring->magic, CPSR_SHARED_FRAME_RING_MAGIC, memory_order_release);
+
+  swapChain->sharedMemoryFd   = fd;
+  swapChain->sequence         = 0;
+  swapChain->sharedMemory     = ring;
+  swapChain->sharedMemorySize = size;
+  return false;
+}
+#endif
+
+static inline void CpsrSwapChainReleaseBuffers(CpsrSwapChain *swapChain) {
+  for (uint8_t i = 0; i < CPSR_CPU_SWAPCHAIN_MAX_BUFFER_COUNT; ++i) {
+    if (swapChain->buffers[i]) {
+      CpsrTexture2DDestroy(swapChain->buffers[i]);
+      swapChain->buffers[i] = NULL;
+    }
+  }
+#ifdef __linux__
+  if (CpsrSwapChainIsOffscreen(swapChain)) {
+    CpsrSwapChainReleaseSharedMemory(swapChain);
+  }
+#endif
+}
+
+static inline bool CpsrSwapChainCreateBuffers(CpsrSwapChain *swapChain) {
+  CpsrTexture2DDescriptor desc;
+  desc.size = swapChain->size;
+  desc.arrayLength = 1;
+  desc.pixelFormat = swapChain->pixelFormat;
+  desc.usage = CPSR_TEXTURE_USAGE_READ | CPSR_TEXTURE_USAGE_RENDER_TARGET;
+
+  const CpsrDevice *device = swapChain->graphicsCommandQueue->device;
+#ifdef __linux__
+  if (CpsrSwapChainIsOffscreen(swapChain)) {
+    if (CpsrSwapChainCreateSharedMemory(swapChain)) {
+      return true;
+    }
+
+    // Render straight into the ring so presenting copies nothing
+    for (uint8_t i = 0; i < swapChain->bufferCount; ++i) {
+      CpsrSharedFrameHeader *frame = CpsrSharedFrameRingGetFrame(swapChain->sharedMemory, i);
+      CpsrTexture2D *texture = CpsrTexture2DCreateFromMemory(device,
+                                                             CpsrSharedFrameGetData(swapChain->sharedMemory, frame),
+                                                             &desc,
+                                                             CPSR_HEAP_TYPE_READBACK);
+      if (!texture) {
+        CpsrSwapChainReleaseBuffers(swapChain);
+        return true;
+      }
+      swapChain->buffers[i] = texture;
+    }
+    swapChain->currentIndex = 0;
+    return false;
+  }
+#endif
+  for (uint8_t i = 0; i < swapChain->bufferCount; ++i) {
+    CpsrTexture2D *texture = CpsrTexture2DCreate(device, &desc, CPSR_HEAP_TYPE_READBACK);
+    if (!texture) {
+      CpsrSwapChainReleaseBuffers(swapChain);
+      return true;
+    }
+    swapChain->buffers[i] = texture;
+  }
+  swapChain->currentIndex = 0;
+  return false;
+}
+
+CpsrSwapChain *CpsrSwapChainCreate(const CpsrCommandQueue *graphicsCommandQueue, CpsrViewHost viewHost, uint8_t bufferCount, bool vsyncEnable) {
+  CPSR_ASSUME(graphicsCommandQueue);
+  CPSR_ASSUME(bufferCount >= 2 && bufferCount <= 3);
+
+  CpsrSwapChain *swapChain = CpsrAlloc(CpsrSwapChain);
+  if (swapChain) {
+    memset(swapChain->buffers, 0, sizeof(swapChain->buffers));
+    swapChain->graphicsCommandQueue = graphicsCommandQueue;
+    swapChain->hostView             = viewHost.handle;
+    swapChain->pixelFormat          = viewHost.pixelFormat;
+    swapChain->colorSpace           = CPSR_COLORSPACE_DEFAULT;
+    swapChain->size                 = viewHost.size;
+    swapChain->bufferCount          = bufferCount;
+#ifdef __linux__
+    swapChain->sharedMemoryFd       = -1;
+    swapChain->sharedMemory         = NULL;
+    swapChain->sharedMemorySize     = 0;
+    swapChain->sequence             = 0;
+#endif
+    if (CpsrSwapChainCreateBuffers(swapChain)) {
+      CpsrDealloc(swapChain);
+      return NULL;
+    }
+  }
+  return swapChain;
+}
+
+#ifdef __linux__
+CpsrSwapChain *CpsrSwapChainCreateOffscreen(const CpsrCommandQueue *graphicsCommandQueue, CpsrSizeU32 size, CpsrPixelFormat pixelFormat, uint8_t frameCount) {
+  CPSR_ASSUME(graphicsCommandQueue);
+  CPSR_ASSUME(frameCount >= 2 && frameCount <= CPSR_SHARED_FRAME_RING_MAX_FRAME_COUNT);
+
+  CpsrSwapChain *swapChain = CpsrAlloc(CpsrSwapChain);
+  if (swapChain) {
+    memset(swapChain->buffers, 0, sizeof(swapChain->buffers));
+    swapChain->graphicsCommandQueue = graphicsCommandQueue;
+    swapChain->hostView             = NULL;
+    swapChain->pixelFormat          = pixelFormat;
+    swapChain->colorSpace           = CPSR_COLORSPACE_DEFAULT;
+    swapChain->size                 = size;
+    swapChain->bufferCount          = frameCount;
+    swapChain->sharedMemoryFd       = -1;
+    swapChain->sharedMemory         = NULL;
+    swapChain->sharedMemorySize     = 0;
+    swapChain->sequence             = 0;
+    if (CpsrSwapChainCreateBuffers(swapChain)) {
+      CpsrDealloc(swapChain);
+      return NULL;
+    }
+  }
+  return swapChain;
+}
+#endif
+
+void CpsrSwapChainDestroy(CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(swapChain);
+
+  CpsrSwapChainReleaseBuffers(swapChain);
+  CpsrDealloc(swapChain);
+}
+
+bool CpsrSwapChainNextBuffer(CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(swapChain);
+
+#ifdef __linux__
+  if (swapChain->sharedMemory) {
+    // Invalidate the frame before overwriting it; a consumer mid-read sees the sequence change
+    CpsrSharedFrameHeader *frame = CpsrSharedFrameRingGetFrame(swapChain->sharedMemory, swapChain->currentIndex);
+    atomic_store_explicit(&frame->sequence, CPSR_SHARED_FRAME_WRITING, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+  }
+#endif
+  return !swapChain->buffers[swapChain->currentIndex];
+}
+
+// ---
+// Property: Size
+// ---
+CpsrSizeU32 CpsrSwapChainGetSize(CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(swapChain);
+
+  return swapChain->size;
+}
+
+void CpsrSwapChainSetSize(CpsrSwapChain *swapChain, CpsrSizeU32 size) {
+  CPSR_ASSUME(swapChain);
+
+  if (!CpsrSizeU32Equal(swapChain->size, size)) {
+    CpsrSwapChainReleaseBuffers(swapChain);
+    swapChain->size = size;
+    if (CpsrSwapChainCreateBuffers(swapChain)) {
+      // TODO: log
+    }
+  }
+}
+
+// ---
+// Property: Buffer count
+// ---
+uint8_t CpsrSwapChainGetBufferCount(CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(swapChain);
+
+  return swapChain->bufferCount;
+}
+
+void CpsrSwapChainSetBufferCount(CpsrSwapChain *swapChain, uint8_t bufferCount) {
+  CPSR_ASSUME(swapChain);
+#ifdef __linux__
+  CPSR_ASSUME(bufferCount >= 2 && bufferCount <= (swapChain->hostView ? 3 : CPSR_SHARED_FRAME_RING_MAX_FRAME_COUNT));
+#else
+  CPSR_ASSUME(bufferCount >= 2 && bufferCount <= 3);
+#endif
+
+  if (swapChain->bufferCount != bufferCount) {
+    CpsrSwapChainReleaseBuffers(swapChain);
+    swapChain->bufferCount = bufferCount;
+    if (CpsrSwapChainCreateBuffers(swapChain)) {
+      // TODO: log
+    }
+  }
+}
+
+void CpsrSwapChainSetColorSpace(CpsrSwapChain *swapChain, CpsrColorSpace colorSpace) {
+  CPSR_ASSUME(swapChain);
+
+  swapChain->colorSpace = colorSpace;
+#ifdef __linux__
+  if (swapChain->sharedMemory) {
+    swapChain->sharedMemory->colorSpace = (uint32_t)colorSpace;
+  }
+#endif
+}
+
+#ifdef __linux__
+int CpsrSwapChainGetSharedMemoryFileDescriptor(const CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(swapChain);
+
+  return swapChain->sharedMemoryFd;
+}
+#endif
+
+// ---
+// Internal functions
+// ---
+CpsrTexture2D *CpsrSwapChainGetCurrentTexture(const CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(swapChain);
+
+  return swapChain->buffers[swapChain->currentIndex];
+}
+
+void CpsrSwapChainPresent(CpsrSwapChain *swapChain) {
+  CPSR_ASSUME(swapChain);
+
+#ifdef __linux__
+  if (swapChain->sharedMemory) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // Publish without waiting for consumers: pixels and timestamp first, then the sequence
+    const uint64_t sequence = ++swapChain->sequence;
+    CpsrSharedFrameHeader *frame = CpsrSharedFrameRingGetFrame(swapChain->sharedMemory, swapChain->currentIndex);
+    frame->timestamp = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+    atomic_store_explicit(&frame->sequence, sequence, memory_order_release);
+    atomic_store_explicit(&swapChain->sharedMemory->latestSequence, sequence, memory_order_release);
+    swapChain->currentIndex = (swapChain->currentIndex + 1) % swapChain->bufferCount;
+    return;
+  }
+#endif
+
+  // There is no window system on the CPU driver; the rendered buffer stays readable until it is reused.
+  swapChain->currentIndex = (swapChain->currentIndex + 1) % swapChain->bufferCount;
+}
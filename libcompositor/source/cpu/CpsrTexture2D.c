@@ -0,0 +1,169 @@
+#include "CpsrGraphics+Private.h"
+
+static inline CpsrTexture2D *CpsrTexture2DCreateFromData(const CpsrDevice *device, uint8_t *data, bool ownsData, const CpsrTexture2DDescriptor *desc, CpsrHeapType heapType) {
+  if (!data) {
+    return NULL;
+  }
+
+  CpsrTexture2D *texture = CpsrAlloc(CpsrTexture2D);
+  if (texture) {
+    texture->device = device;
+    texture->data = data;
+    texture->bytesPerRow = PixelFormatGetBytesPerRow(desc->pixelFormat, desc->size.width);
+    texture->bytesPerImage = AlignUp(texture->bytesPerRow * desc->size.height, CPSR_CPU_RESOURCE_ALIGNMENT);
+    texture->size = desc->size;
+    texture->arrayLength = desc->arrayLength > 1 ? desc->arrayLength : 1;
+    texture->pixelFormat = desc->pixelFormat;
+    texture->ownsData = ownsData;
+
+#ifndef NDEBUG
+    texture->heapType = heapType;
+    texture->usage = desc->usage;
+#endif
+  }
+  return texture;
+}
+
+CpsrTexture2D *CpsrTexture2DCreate(const CpsrDevice *device, const CpsrTexture2DDescriptor *desc, CpsrHeapType heapType) {
+  CPSR_ASSUME(device);
+  CPSR_ASSUME(desc);
+
+  const size_t size = Texture2DDescriptorGetSize(desc);
+  uint8_t *data = (uint8_t *)CpsrDeviceAllocate(device, size);
+  if (data) {
+    memset(data, 0, size);
+  }
+
+  CpsrTexture2D *texture = CpsrTexture2DCreateFromData(device, data, true, desc, heapType);
+  if (!texture) {
+    CpsrDeviceDeallocate(device, data, size);
+  }
+  return texture;
+}
+
+CpsrTexture2D *CpsrTexture2DCreateFromHeap(const CpsrHeap *heap, const CpsrTexture2DDescriptor *desc) {
+  CPSR_ASSUME(heap);
+  CPSR_ASSUME(desc);
+
+  const size_t size = Texture2DDescriptorGetSize(desc);
+  if (heap->offset + size > heap->size) {
+    // TODO: log
+    return NULL;
+  }
+
+  CpsrHeap *mutableHeap = (CpsrHeap *)heap;
+  uint8_t *data = mutableHeap->data + mutableHeap->offset;
+  mutableHeap->offset += size;
+  return CpsrTexture2DCreateFromData(heap->device, data, false, desc, heap->heapType);
+}
+
+CpsrTexture2D *CpsrTexture2DCreateFromMemory(const CpsrDevice *device, uint8_t *data, const CpsrTexture2DDescriptor *desc, CpsrHeapType heapType) {
+  CPSR_ASSUME(device);
+  CPSR_ASSUME(data);
+  CPSR_ASSUME(desc);
+
+  return CpsrTexture2DCreateFromData(device, data, false, desc, heapType);
+}
+
+void CpsrTexture2DDestroy(CpsrTexture2D *texture2D) {
+  CPSR_ASSUME(texture2D);
+
+  if (texture2D->ownsData) {
+    CpsrDeviceDeallocate(texture2D->device, texture2D->data, texture2D->bytesPerImage * texture2D->arrayLength);
+  }
+  CpsrDealloc(texture2D);
+}
+
+// ---
+// Get property
+// ---
+CpsrSizeU32 CpsrTexture2DGetSize(const CpsrTexture2D *texture2D) {
+  CPSR_ASSUME(texture2D);
+
+  return texture2D->size;
+}
+
+size_t CpsrTexture2DGetLength(const CpsrTexture2D *texture2D) {
+  CPSR_ASSUME(texture2D);
+
+  return texture2D->arrayLength;
+}
+
+// ---
+// Write function
+// ---
+bool CpsrTexture2DWrite(const CpsrTexture2D *texture2D, const void *data, size_t bytesPerRow) {
+  CPSR_ASSUME(texture2D);
+  CPSR_ASSUME(texture2D->heapType & CPSR_HEAP_TYPE_UPLOAD);
+  CPSR_ASSUME(data);
+
+  const size_t rowSize = PixelFormatGetBytesPerPixel(texture2D->pixelFormat) * texture2D->size.width;
+  const uint8_t *src = (const uint8_t *)data;
+  uint8_t *dst = texture2D->data;
+  for (uint32_t y = 0; y < texture2D->size.height; ++y) {
+    memcpy(dst, src, rowSize);
+    src += bytesPerRow;
+    dst += texture2D->bytesPerRow;
+  }
+  return false;
+}
+
+// ---
+// Native shader access
+// ---
+float32x4_t CpsrTexture2DSample(const CpsrTexture2D *texture2D, float u, float v) {
+  CPSR_ASSUME(texture2D);
+
+  // Nearest filter and clamp-to-edge address mode, same as the default Metal sampler.
+  const float width = (float)texture2D->size.width;
+  const float height = (float)texture2D->size.height;
+  int32_t x = (int32_t)floorf(u * width);
+  int32_t y = (int32_t)floorf(v * height);
+  x = x < 0 ? 0 : (x >= (int32_t)texture2D->size.width ? (int32_t)texture2D->size.width - 1 : x);
+  y = y < 0 ? 0 : (y >= (int32_t)texture2D->size.height ? (int32_t)texture2D->size.height - 1 : y);
+  return CpsrPixelLoad(CpsrTexture2DGetPixelPointer(texture2D, (uint32_t)x, (uint32_t)y), texture2D->pixelFormat);
+}
+
+float32x4_t CpsrTexture2DRead(const CpsrTexture2D *texture2D, uint32_t x, uint32_t y) {
+  CPSR_ASSUME(texture2D);
+  CPSR_ASSUME(x < texture2D->size.width);
+  CPSR_ASSUME(y < texture2D->size.height);
+
+  return CpsrPixelLoad(CpsrTexture2DGetPixelPointer(texture2D, x, y), texture2D->pixelFormat);
+}
+
+void CpsrTexture2DStore(const CpsrTexture2D *texture2D, uint32_t x, uint32_t y, float32x4_t color) {
+  CPSR_ASSUME(texture2D);
+  CPSR_ASSUME(x < texture2D->size.width);
+  CPSR_ASSUME(y < texture2D->size.height);
+
+  CpsrPixelStore(CpsrTexture2DGetPixelPointer(texture2D, x, y), texture2D->pixelFormat, color);
+}
+
+void CpsrTexture2DReadRow(const CpsrTexture2D *texture2D, uint32_t x, uint32_t y, uint32_t count, float32x4_t *colors) {
+  CPSR_ASSUME(texture2D);
+  CPSR_ASSUME(x + count <= texture2D->size.width);
+  CPSR_ASSUME(y < texture2D->size.height);
+  CPSR_ASSUME(colors);
+
+  const CpsrPixelFormat pixelFormat = texture2D->pixelFormat;
+  const size_t bytesPerPixel = PixelFormatGetBytesPerPixel(pixelFormat);
+  const uint8_t *pixel = CpsrTexture2DGetPixelPointer(texture2D, x, y);
+  for (uint32_t i = 0; i < count; ++i, pixel += bytesPerPixel) {
+    colors[i] = CpsrPixelLoad(pixel, pixelFormat);
+  }
+}
+
+void CpsrTexture2DStoreRow(const CpsrTexture2D *texture2D, uint32_t x, uint32_t y, uint32_t count, const float32x4_t *colors) {
+  CPSR_ASSUME(texture2D);
+  CPSR_ASSUME(x + count <= texture2D->size.width);
+  CPSR_ASSUME(y < texture2D->size.height);
+  CPSR_ASSUME(colors);
+
+  const CpsrPixelFormat pixelFormat = texture2D->pixelFormat;
+  const size_t bytesPerPixel = PixelFormatGetBytesPerPixel(pixelFormat);
+  uint8_t *pixel = CpsrTexture2DGetPixelPointer(texture2D, x, y);
+  for (uint32_t i = 0; i < count; ++i, pixel += bytesPerPixel) {
+    CpsrPixelStore(pixel, pixelFormat, colors[i]);
+  }
+}
@@ -0,0 +1,150 @@
+#include "CpsrGraphics+Private.h"
+
+typedef struct {
+  CpsrWorkerPool *workerPool;
+  uint32_t index;
+} CpsrWorkerArgs;
+
+static inline void CpsrWorkerPoolDrain(CpsrWorkerPool *workerPool, uint32_t index) {
+  const uint32_t queueCount = workerPool->threadCount + 1;
+  for (uint32_t i = 0; i < queueCount; ++i) {
+    // Own queue first, then steal from the others in order
+    CpsrWorkerQueue *queue = workerPool->queues + (index + i) % queueCount;
+    for (;;) {
+      const uint32_t job = atomic_fetch_add_explicit(&queue->next, 1, memory_order_relaxed);
+      if (job >= queue->end) {
+        break;
+      }
+      workerPool->function(workerPool->context, job);
+    }
+  }
+}
+
+static void *CpsrWorkerPoolMain(void *arg) {
+  CpsrWorkerArgs args = *(CpsrWorkerArgs *)arg;
+  free(arg);
+
+  CpsrWorkerPool *workerPool = args.workerPool;
+  uint64_t generation = 0;
+  pthread_mutex_lock(&workerPool->mutex);
+  for (;;) {
+    while (!workerPool->quit && workerPool->generation == generation) {
+      pthread_cond_wait(&workerPool->startCond, &workerPool->mutex);
+    }
+    if (workerPool->quit) {
+      break;
+    }
+    generation = workerPool->generation;
+    pthread_mutex_unlock(&workerPool->mutex);
+
+    CpsrWorkerPoolDrain(workerPool, args.index);
+
+    pthread_mutex_lock(&workerPool->mutex);
+    if (--workerPool->activeCount == 0) {
+      pthread_cond_signal(&workerPool->finishCond);
+    }
+  }
+  pthread_mutex_unlock(&workerPool->mutex);
+  return NULL;
+}
+
+bool CpsrWorkerPoolInit(CpsrWorkerPool *workerPool, uint32_t threadCount) {
+  CPSR_ASSUME(workerPool);
+
+  memset(workerPool, 0, sizeof(CpsrWorkerPool));
+  workerPool->queues = (CpsrWorkerQueue *)aligned_alloc(CPSR_CPU_CACHE_LINE_SIZE,
+                                                        (threadCount + 1) * sizeof(CpsrWorkerQueue));
+  if (!workerPool->queues) {
+    return true;
+  }
+  if (threadCount > 0) {
+    workerPool->threads = (pthread_t *)malloc(threadCount * sizeof(pthread_t));
+    if (!workerPool->threads) {
+      free(workerPool->queues);
+      return true;
+    }
+  }
+
+  pthread_mutex_init(&workerPool->jobMutex, NULL);
+  pthread_mutex_init(&workerPool->mutex, NULL);
+  pthread_cond_init(&workerPool->startCond, NULL);
+  pthread_cond_init(&workerPool->finishCond, NULL);
+  for (uint32_t i = 0; i < threadCount; ++i) {
+    CpsrWorkerArgs *args = CpsrAlloc(CpsrWorkerArgs);
+    if (!args) {
+      break;
+    }
+    args->workerPool = workerPool;
+    args->index = i;
+    if (pthread_create(workerPool->threads + i, NULL, CpsrWorkerPoolMain, args)) {
+      // TODO: log
+      free(args);
+      break;
+    }
+    ++workerPool->threadCount;
+  }
+  return false;
+}
+
+void CpsrWorkerPoolUninit(CpsrWorkerPool *workerPool) {
+  CPSR_ASSUME(workerPool);
+
+  pthread_mutex_lock(&workerPool->mutex);
+  workerPool->quit = true;
+  pthread_cond_broadcast(&workerPool->startCond);
+  pthread_mutex_unlock(&workerPool->mutex);
+  for (uint32_t i = 0; i < workerPool->threadCount; ++i) {
+    pthread_join(workerPool->threads[i], NULL);
+  }
+
+  pthread_cond_destroy(&workerPool->finishCond);
+  pthread_cond_destroy(&workerPool->startCond);
+  pthread_mutex_destroy(&workerPool->mutex);
+  pthread_mutex_destroy(&workerPool->jobMutex);
+  free(workerPool->threads);
+  free(workerPool->queues);
+}
+
+void CpsrWorkerPoolRun(CpsrWorkerPool *workerPool, uint32_t count, CpsrWorkerFunction function, void *context) {
+  CPSR_ASSUME(workerPool);
+  CPSR_ASSUME(function);
+
+  if (count == 0) {
+    return;
+  }
+  if (count == 1 || workerPool->threadCount == 0) {
+    for (uint32_t i = 0; i < count; ++i) {
+      function(context, i);
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&workerPool->jobMutex);
+
+  // Split the jobs into contiguous ranges so neighbouring jobs stay on one thread until stolen
+  const uint32_t queueCount = workerPool->threadCount + 1;
+  for (uint32_t i = 0; i < queueCount; ++i) {
+    CpsrWorkerQueue *queue = workerPool->queues + i;
+    atomic_store_explicit(&queue->next, (uint32_t)((uint64_t)count * i / queueCount), memory_order_relaxed);
+    queue->end = (uint32_t)((uint64_t)count * (i + 1) / queueCount);
+  }
+  workerPool->function = function;
+  workerPool->context  = context;
+
+  pthread_mutex_lock(&workerPool->mutex);
+  workerPool->activeCount = workerPool->threadCount;
+  ++workerPool->generation;
+  pthread_cond_broadcast(&workerPool->startCond);
+  pthread_mutex_unlock(&workerPool->mutex);
+
+  // The calling thread works on the last queue
+  CpsrWorkerPoolDrain(workerPool, workerPool->threadCount);
+
+  pthread_mutex_lock(&workerPool->mutex);
+  while (workerPool->activeCount > 0) {
+    pthread_cond_wait(&workerPool->finishCond, &workerPool->mutex);
+  }
+  pthread_mutex_unlock(&workerPool->mutex);
+
+  pthread_mutex_unlock(&workerPool->jobMutex);
+}
@@ -32,3 +32,33 @@ void CpsrFenceDestroy(CpsrFence *fence) {
   ID3D12Fence_Release(fence->native);
   CpsrDealloc(fence);
 }
+
+void CpsrFenceSignal(const CpsrFence *fence, uint64_t value) {
+  CPSR_ASSUME(fence);
+
+  ID3D12Fence_Signal(fence->native, value);
+}
+
+uint64_t CpsrFenceGetCompletedValue(const CpsrFence *fence) {
+  CPSR_ASSUME(fence);
+
+  return ID3D12Fence_GetCompletedValue(fence->native);
+}
+
+void CpsrFenceWaitUntilCompleted(const CpsrFence *fence, uint64_t value) {
+  CPSR_ASSUME(fence);
+
+  if (ID3D12Fence_GetCompletedValue(fence->native) >= value) {
+    return;
+  }
+
+  HANDLE event = CreateEventW(NULL, FALSE, FALSE, NULL);
+  if (!event) {
+    // TODO: log
+    return;
+  }
+  if (SUCCEEDED(ID3D12Fence_SetEventOnCompletion(fence->native, value, event))) {
+    WaitForSingleObject(event, INFINITE);
+  }
+  CloseHandle(event);
+}
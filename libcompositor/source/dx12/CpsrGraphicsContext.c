@@ -104,7 +104,6 @@ bool CpsrGraphicsContextSetPipelineState(CpsrGraphicsContext *graphicsContext,
                                          CpsrGraphicsPipelineState *pipelineState) {
   assert(graphicsContext);
   assert(pipelineState);
-  assert(!graphicsContext->native);
 
   ID3D12PipelineState *nativePipelineState = CpsrGraphicsPipelineStateGetNative(pipelineState);
   if (!nativePipelineState) {
@@ -112,6 +111,12 @@ bool CpsrGraphicsContextSetPipelineState(CpsrGraphicsContext *graphicsContext,
     return true;
   }
 
+  // Switch pipelines inside the open command list
+  if (graphicsContext->native) {
+    ID3D12GraphicsCommandList_SetPipelineState(graphicsContext->native, nativePipelineState);
+    return false;
+  }
+
   ID3D12GraphicsCommandList *commandList;
   HRESULT hr = ID3D12Device_CreateCommandList(graphicsContext->commandBuffer->commandQueue->device->nativeDevice,
                                               0,
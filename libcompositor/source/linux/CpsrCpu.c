@@ -0,0 +1,50 @@
+#define _GNU_SOURCE
+#include "compositor/CpsrUtils.h"
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static inline id_t CpsrGetCurrentThreadId() {
+  return (id_t)syscall(SYS_gettid);
+}
+
+enum CpsrThreadPriority CpsrGetCurrentThreadPriority() {
+  int niceValue = getpriority(PRIO_PROCESS, CpsrGetCurrentThreadId());
+  if (niceValue <= -15) {
+    return CSPR_TP_REALTIME;
+  } else if (niceValue <= -10) {
+    return CSPR_TP_HIGHEST;
+  } else if (niceValue < 0) {
+    return CSPR_TP_ABOVE_NORMAL;
+  } else if (niceValue > 0) {
+    return CSPR_TP_BACKGROUND;
+  } else {
+    return CSPR_TP_DEFAULT;
+  }
+}
+
+bool CpsrSetCurrentThreadPriority(enum CpsrThreadPriority threadPriority) {
+  int niceValue;
+  switch (threadPriority) {
+  case CSPR_TP_BACKGROUND:
+    niceValue = 10;
+    break;
+  case CSPR_TP_ABOVE_NORMAL:
+    niceValue = -5;
+    break;
+  case CSPR_TP_HIGHEST:
+    niceValue = -10;
+    break;
+  case CSPR_TP_REALTIME:
+    niceValue = -15;
+    break;
+  case CSPR_TP_DEFAULT:
+  default:
+    niceValue = 0;
+    break;
+  }
+
+  // Linux applies nice values per thread when given a thread id. Raising priority needs CAP_SYS_NICE.
+  return setpriority(PRIO_PROCESS, CpsrGetCurrentThreadId(), niceValue) != 0;
+}
@@ -36,3 +36,36 @@ void CpsrFenceDestroy(CpsrFence *fence) {
   [fence->native release];
   CpsrDealloc(fence);
 }
+
+void CpsrFenceSignal(const CpsrFence *fence, uint64_t value) {
+  CPSR_ASSUME(fence);
+  assert(fence->fenceType == CPSR_FENCE_SHARED);
+  
+  ((id<MTLSharedEvent>)fence->native).signaledValue = value;
+}
+
+uint64_t CpsrFenceGetCompletedValue(const CpsrFence *fence) {
+  CPSR_ASSUME(fence);
+  assert(fence->fenceType == CPSR_FENCE_SHARED);
+  
+  return ((id<MTLSharedEvent>)fence->native).signaledValue;
+}
+
+void CpsrFenceWaitUntilCompleted(const CpsrFence *fence, uint64_t value) {
+  CPSR_ASSUME(fence);
+  assert(fence->fenceType == CPSR_FENCE_SHARED);
+  
+  id<MTLSharedEvent> sharedEvent = (id<MTLSharedEvent>)fence->native;
+  if (sharedEvent.signaledValue >= value) {
+    return;
+  }
+  
+  dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+  MTLSharedEventListener *listener = [[MTLSharedEventListener alloc] init];
+  [sharedEvent notifyListener:listener atValue:value block:^(id<MTLSharedEvent> event, uint64_t signaledValue) {
+    dispatch_semaphore_signal(semaphore);
+  }];
+  dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+  [listener release];
+  dispatch_release(semaphore);
+}
@@ -129,7 +129,6 @@ static inline void SetRasterizerState(id<MTLRenderCommandEncoder> commandEncoder
 
 bool CpsrGraphicsContextSetPipelineState(CpsrGraphicsContext *graphicsContext, CpsrGraphicsPipelineState *pipelineState) {
   CPSR_ASSUME(graphicsContext);
-  CPSR_ASSUME(!graphicsContext->native);
   CPSR_ASSUME(pipelineState);
   
   id<MTLRenderPipelineState> nativePipelineState = CpsrGraphicsPipelineStateGetNative(pipelineState);
@@ -138,6 +137,13 @@ bool CpsrGraphicsContextSetPipelineState(CpsrGraphicsContext *graphicsContext, C
     return true;
   }
   
+  // Switch pipelines inside the open render pass
+  if (graphicsContext->native) {
+    [graphicsContext->native setRenderPipelineState:nativePipelineState];
+    SetRasterizerState(graphicsContext->native, &pipelineState->rasterizerDesc);
+    return false;
+  }
+  
   id<MTLRenderCommandEncoder> commandEncoder = [graphicsContext->commandBuffer->native renderCommandEncoderWithDescriptor:graphicsContext->desc];
   
   // Set pipeline state
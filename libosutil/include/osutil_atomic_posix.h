@@ -74,6 +74,16 @@ static inline intptr_t osutil_atomic_fetch_decrement_pointer(osutil_atomic_intpt
   return atomic_fetch_sub(obj, 1);
 }
 
+static inline bool osutil_atomic_compare_exchange32(osutil_atomic_int32_t *obj, int32_t *expected, int32_t desired) {
+  return atomic_compare_exchange_weak(obj, expected, desired);
+}
+static inline bool osutil_atomic_compare_exchange64(osutil_atomic_int64_t *obj, int64_t *expected, int64_t desired) {
+  return atomic_compare_exchange_weak(obj, expected, desired);
+}
+static inline bool osutil_atomic_compare_exchange_pointer(osutil_atomic_intptr_t *obj, intptr_t *expected, intptr_t desired) {
+  return atomic_compare_exchange_weak(obj, expected, desired);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,6 +23,10 @@ OSUTIL_EXPORT thread_identifier_t osutil_get_thread_identifier();
 
 OSUTIL_EXPORT void osutil_set_thread_name(const char *thread_name);
 
+// Restricts the calling thread to the logical cores set in affinity_mask. macOS only takes it as a hint to
+// keep threads with the same lowest core together. Returns false on success.
+OSUTIL_EXPORT bool osutil_set_thread_affinity(uint64_t affinity_mask);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,28 @@ OSUTIL_EXPORT bool osutil_nssleep(uint64_t nanoseconds);
 
 OSUTIL_EXPORT bool osutil_wait_until_nanoseconds(uint64_t target);
 
+#ifdef __linux__
+// Lateness of the wake-ups of osutil_wait_until_nanoseconds.
+// Bucket 0 counts wake-ups less than 1 us late, bucket i those less than (1 << i) us late,
+// and the last bucket everything later.
+#define OSUTIL_WAIT_HISTOGRAM_BUCKET_COUNT 16
+
+typedef struct {
+  uint64_t counts[OSUTIL_WAIT_HISTOGRAM_BUCKET_COUNT];
+  uint64_t wait_count;
+  uint64_t missed_count;  // Calls whose target had already passed
+  uint64_t total_lateness;
+  uint64_t max_lateness;
+} osutil_wait_histogram_t;
+
+// The wait sleeps until this many nanoseconds before the target and spins for the rest.
+OSUTIL_EXPORT uint64_t osutil_get_wait_spin_nanoseconds();
+OSUTIL_EXPORT void osutil_set_wait_spin_nanoseconds(uint64_t nanoseconds);
+
+OSUTIL_EXPORT void osutil_get_wait_histogram(osutil_wait_histogram_t *histogram);
+OSUTIL_EXPORT void osutil_reset_wait_histogram();
+#endif
+
 #ifdef __cplusplus
 }
 #endif
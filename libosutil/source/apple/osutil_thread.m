@@ -1,6 +1,9 @@
 #include "osutil_thread.h"
 
+#include <pthread.h>
 #include <string.h>
+#include <mach/mach.h>
+#include <mach/thread_policy.h>
 
 #import <Foundation/Foundation.h>
 
@@ -29,3 +32,11 @@ void osutil_set_thread_name(const char *thread_name) {
   [[NSThread currentThread] setName:ns_thread_name];
   [ns_thread_name release];
 }
+
+bool osutil_set_thread_affinity(uint64_t affinity_mask) {
+  // Mach has no hard affinity. Threads sharing a tag are scheduled onto cores sharing a cache.
+  thread_affinity_policy_data_t policy;
+  policy.affinity_tag = affinity_mask ? __builtin_ctzll(affinity_mask) + 1 : THREAD_AFFINITY_TAG_NULL;
+  const mach_port_t thread = pthread_mach_thread_np(pthread_self());
+  return thread_policy_set(thread, THREAD_AFFINITY_POLICY, (thread_policy_t)&policy, THREAD_AFFINITY_POLICY_COUNT) != KERN_SUCCESS;
+}
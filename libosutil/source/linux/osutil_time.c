@@ -1,9 +1,60 @@
 #include "osutil_time.h"
+#include "osutil_atomic.h"
 
+#include <errno.h>
 #include <unistd.h>
 #include <time.h>
 #include <string.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define osutil_cpu_relax() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define osutil_cpu_relax() __asm__ __volatile__("yield")
+#else
+#define osutil_cpu_relax()
+#endif
+
+// The kernel usually wakes a CLOCK_MONOTONIC sleeper 50-100 us late; spinning through this tail absorbs it.
+#define OSUTIL_DEFAULT_WAIT_SPIN_NANOSECONDS 200000
+
+static osutil_atomic_int64_t wait_spin_nanoseconds = OSUTIL_DEFAULT_WAIT_SPIN_NANOSECONDS;
+
+static osutil_atomic_int64_t wait_histogram_counts[OSUTIL_WAIT_HISTOGRAM_BUCKET_COUNT];
+static osutil_atomic_int64_t wait_count           = 0;
+static osutil_atomic_int64_t missed_count         = 0;
+static osutil_atomic_int64_t total_lateness       = 0;
+static osutil_atomic_int64_t max_lateness         = 0;
+
+static inline uint64_t osutil_timespec_to_nanoseconds(const struct timespec *time) {
+  return (uint64_t)time->tv_sec * 1000000000 + (uint64_t)time->tv_nsec;
+}
+
+static inline void osutil_record_wait_lateness(uint64_t lateness) {
+  const uint64_t microseconds = lateness / 1000;
+  uint32_t bucket = 0;
+  if (microseconds > 0) {
+    bucket = 64 - __builtin_clzll(microseconds);
+    if (bucket >= OSUTIL_WAIT_HISTOGRAM_BUCKET_COUNT) {
+      bucket = OSUTIL_WAIT_HISTOGRAM_BUCKET_COUNT - 1;
+    }
+  }
+  osutil_atomic_fetch_increment64(&wait_histogram_counts[bucket]);
+  osutil_atomic_fetch_increment64(&wait_count);
+  osutil_atomic_fetch_add64(&total_lateness, (int64_t)lateness);
+
+  int64_t current_max = osutil_atomic_load64(&max_lateness);
+  while ((int64_t)lateness > current_max
+         && !atomic_compare_exchange_weak(&max_lateness, &current_max, (int64_t)lateness)) {
+  }
+}
+
+uint64_t osutil_gettime_as_nanoseconds() {
+  struct timespec current;
+  clock_gettime(CLOCK_MONOTONIC, &current);
+  return osutil_timespec_to_nanoseconds(&current);
+}
+
 void osutil_sleep(uint32_t seconds) {
   sleep(seconds);
 }
@@ -24,3 +75,58 @@ bool osutil_nssleep(uint64_t nanoseconds) {
   }
   return false;
 }
+
+bool osutil_wait_until_nanoseconds(uint64_t target) {
+  uint64_t current = osutil_gettime_as_nanoseconds();
+  if (current >= target) {
+    osutil_atomic_fetch_increment64(&missed_count);
+    return true;
+  }
+
+  // Sleep on an absolute deadline so neither signals nor preemption between the calls accumulate drift
+  const uint64_t spin = (uint64_t)osutil_atomic_load64(&wait_spin_nanoseconds);
+  if (target - current > spin) {
+    const uint64_t deadline = target - spin;
+    struct timespec request;
+    request.tv_sec = deadline / 1000000000;
+    request.tv_nsec = deadline % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &request, NULL) == EINTR) {
+    }
+    current = osutil_gettime_as_nanoseconds();
+  }
+
+  while (current < target) {
+    osutil_cpu_relax();
+    current = osutil_gettime_as_nanoseconds();
+  }
+  osutil_record_wait_lateness(current - target);
+  return false;
+}
+
+uint64_t osutil_get_wait_spin_nanoseconds() {
+  return (uint64_t)osutil_atomic_load64(&wait_spin_nanoseconds);
+}
+
+void osutil_set_wait_spin_nanoseconds(uint64_t nanoseconds) {
+  osutil_atomic_store64(&wait_spin_nanoseconds, (int64_t)nanoseconds);
+}
+
+void osutil_get_wait_histogram(osutil_wait_histogram_t *histogram) {
+  for (uint32_t i = 0; i < OSUTIL_WAIT_HISTOGRAM_BUCKET_COUNT; ++i) {
+    histogram->counts[i] = (uint64_t)osutil_atomic_load64(&wait_histogram_counts[i]);
+  }
+  histogram->wait_count     = (uint64_t)osutil_atomic_load64(&wait_count);
+  histogram->missed_count   = (uint64_t)osutil_atomic_load64(&missed_count);
+  histogram->total_lateness = (uint64_t)osutil_atomic_load64(&total_lateness);
+  histogram->max_lateness   = (uint64_t)osutil_atomic_load64(&max_lateness);
+}
+
+void osutil_reset_wait_histogram() {
+  for (uint32_t i = 0; i < OSUTIL_WAIT_HISTOGRAM_BUCKET_COUNT; ++i) {
+    osutil_atomic_store64(&wait_histogram_counts[i], 0);
+  }
+  osutil_atomic_store64(&wait_count, 0);
+  osutil_atomic_store64(&missed_count, 0);
+  osutil_atomic_store64(&total_lateness, 0);
+  osutil_atomic_store64(&max_lateness, 0);
+}
@@ -13,3 +13,7 @@ process_identifier_t osutil_get_process_identifier() {
 thread_identifier_t osutil_get_thread_identifier() {
   return GetCurrentThreadId();
 }
+
+bool osutil_set_thread_affinity(uint64_t affinity_mask) {
+  return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)affinity_mask) == 0;
+}
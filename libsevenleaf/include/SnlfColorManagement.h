@@ -0,0 +1,118 @@
+#ifndef _SNLF_COLOR_MANAGEMENT_H
+#define _SNLF_COLOR_MANAGEMENT_H
+
+#include "SnlfCore.h"
+#include "SnlfGraphicsDefines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---
+// Matrices
+// ---
+// 3x3 matrices are row-major and multiply column vectors. They are derived in double precision.
+
+// Linear RGB to CIE 1931 XYZ, with the white point at Y = 1.
+// Returns true when the primaries are degenerate.
+SNLF_EXPORT bool SnlfColorPrimariesGetRGBToXYZMatrix(const SnlfColorPrimaries *primaries, float matrix[9]);
+
+// Bradford chromatic adaptation of XYZ from one white point to another.
+// Returns true when a white point has no luminance.
+SNLF_EXPORT bool SnlfGetBradfordAdaptationMatrix(SnlfColorPrimary sourceWhitePoint, SnlfColorPrimary destinationWhitePoint, float matrix[9]);
+
+// ---
+// Color transform
+// ---
+// Maps linear RGB of the source primaries onto linear RGB of the destination primaries, adapting the white
+// point with Bradford. Colors outside the destination gamut get negative or over-range components; they are
+// not clipped.
+typedef struct {
+  float matrix[9];
+  bool identity;  // Same primaries; the matrix is exactly the identity
+} SnlfColorTransform;
+
+// Transforms are cached per pair of primaries for the whole process, so initializing one per frame is cheap.
+// Returns true when either primaries are degenerate.
+SNLF_EXPORT bool SnlfColorTransformInit(SnlfColorTransform *transform, const SnlfColorPrimaries *source, const SnlfColorPrimaries *destination);
+
+// ---
+// Transfer functions
+// ---
+// Linear light is display-referred, with 1.0 at SNLF_REFERENCE_WHITE_LUMINANCE. SDR curves put their white
+// there; PQ and HLG reach above it. Both directions are interpolated lookup tables:
+//   decode: code 0-1 to linear light, over a uniform grid of 2^precision intervals. Codes outside 0-1 are
+//           clamped.
+//   encode: linear light to code, over a grid with 2^(precision - 7) intervals per octave from 2^-32 of the
+//           peak up to the peak. Lower light is encoded linearly to zero; light above the peak is clamped.
+// The HLG OOTF is applied per component, which is exact for neutral colors only.
+typedef enum {
+  SNLF_TRANSFER_DECODE,
+  SNLF_TRANSFER_ENCODE,
+} SnlfTransferDirection;
+
+typedef struct _SnlfTransferLUT SnlfTransferLUT;
+
+// precision is 10, 12 or 16 bits. The LUT is built on first use and shared for the rest of the process.
+// Returns NULL when the transfer characteristics have no closed form or the LUT cannot be allocated.
+SNLF_EXPORT const SnlfTransferLUT *SnlfGetTransferLUT(SnlfTransferCharacteristicsType type, SnlfTransferDirection direction, uint32_t precision);
+
+// Vectorized lookup for packers and other row loops. source and destination may be the same.
+SNLF_EXPORT void SnlfTransferLUTApply(const SnlfTransferLUT *lut, const float *source, float *destination, size_t count);
+
+// ---
+// Tone mapping
+// ---
+// Compresses linear light from the source peak into the target peak. The curve maps maxRGB, and the color is
+// scaled by the ratio, which keeps hue and saturation. Light up to the target peak is kept as it is when the
+// source peak is no higher.
+//   BT.2390:  the BT.2390 EETF, a Hermite spline knee in the PQ domain, with the source black mapped to zero
+//   Reinhard: extended Reinhard with its white at the source peak
+// Dynamic tone mappers measure a luminance histogram of each frame and adapt the source peak for the next one.
+typedef enum {
+  SNLF_TONE_MAPPING_BT2390,
+  SNLF_TONE_MAPPING_REINHARD,
+} SnlfToneMappingCurve;
+
+// Curve parameters in linear light.
+typedef struct {
+  uint32_t curve;        // SnlfToneMappingCurve
+  float sourcePeak;      // Linear light of the source peak
+  float targetPeak;      // Linear light of the target peak
+  float pqBlack;         // BT.2390: PQ code of the source black
+  float pqRange;         // BT.2390: PQ code of the source peak minus pqBlack
+  float kneeStart;       // BT.2390: KS, normalized like pqRange
+  float maxLuminance;    // BT.2390: the target peak, normalized like pqRange
+  float minLuminance;    // BT.2390: the target black, normalized like pqRange
+} SnlfToneMappingParameters;
+
+typedef struct _SnlfToneMapper *SnlfToneMapperRef;
+
+// targetLuminance is the output peak in cd/m2, e.g. SNLF_REFERENCE_WHITE_LUMINANCE for SDR outputs.
+// The source peak is SNLF_HDR10_PEAK_LUMINANCE until metadata is set.
+SNLF_EXPORT SnlfToneMapperRef SnlfToneMapperInit(SnlfToneMappingCurve curve, float targetLuminance, bool dynamic);
+SNLF_EXPORT void SnlfToneMapperUninit(SnlfToneMapperRef toneMapper);
+
+// Takes the source peak from MaxCLL, else the maximum mastering luminance, and the source black from the
+// minimum mastering luminance. The curve is rebuilt only when they change, so it may be set every frame. It is
+// built aside and takes effect at the next SnlfToneMapperEndFrame, so conversions may run meanwhile. Dynamic
+// tone mappers start over from the new peak.
+SNLF_EXPORT void SnlfToneMapperSetMetadata(SnlfToneMapperRef toneMapper, const SnlfHDR10Descriptor *descriptor);
+
+// Ends a frame and swaps in the curve of new metadata, if any. Otherwise the source peak of a dynamic tone
+// mapper moves toward the SNLF_TONE_MAPPING_PERCENTILE of the frame's histogram, never above the metadata
+// peak. The histogram is cleared for the next frame.
+// Call it between frames from the thread that sets the metadata; conversions that use the tone mapper must not
+// run meanwhile.
+SNLF_EXPORT void SnlfToneMapperEndFrame(SnlfToneMapperRef toneMapper);
+
+SNLF_EXPORT const SnlfToneMappingParameters *SnlfToneMapperGetParameters(SnlfToneMapperRef toneMapper);
+
+// Tone-maps one maxRGB value in linear light with the exact curve. It is slow; the converter uses a LUT.
+SNLF_EXPORT float SnlfToneMappingEvaluate(const SnlfToneMappingParameters *parameters, float light);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SNLF_COLOR_MANAGEMENT_H
@@ -18,6 +18,32 @@
 #define SNLF_OUTPUT_BUFFER_COUNT         4 // Use quad buffer
 #define SNLF_INPUT_BUFFER_COUNT          4 // Use dynamic
 #define SNLF_MAX_DISPLAY_COUNT           8
+#define SNLF_GRAPHICS_PIPELINED          1 // Encode frame N+1 while frame N executes and presents
+#define SNLF_GRAPHICS_STATISTICS_WINDOW  256 // Frames kept for duration statistics
+#define SNLF_GRAPHICS_CATCH_UP_BUDGET    4 // Default intervals SNLF_LATE_FRAME_CATCH_UP may fall behind
+#define SNLF_PREVIEW_FRAME_COUNT         4 // Shared-memory ring for headless displays
+#define SNLF_USE_MPSC_RING               1 // Bounded rings instead of SnlfLockFreeQueue
+#define SNLF_MESSAGE_QUEUE_CAPACITY      256 // Messages pending per graphics data (power of two)
+#define SNLF_MESSAGE_BATCH_COUNT         16 // Messages drained per dequeue batch
+#define SNLF_FRAME_QUEUE_CAPACITY        64 // Free frames per frame allocator (power of two)
+#define SNLF_MESSAGE_ARENA_CAPACITY      256 // Pooled messages per size class before falling back to the heap
+#define SNLF_DRAW_LIST_OCCLUDER_COUNT    8 // Largest opaque rectangles kept for occlusion culling
+#define SNLF_DRAW_BATCH_MAX_INSTANCES    256 // Draw items merged into one instanced draw
+#define SNLF_EPOCH_READER_COUNT          4 // Threads reading source snapshots without locking
+#define SNLF_UPLOAD_RING_BUFFER_SIZE     65536 // Bytes per upload buffer of a frame's constant ring
+#define SNLF_UPLOAD_RING_ALIGNMENT       256 // Constant buffer offset alignment required by every driver
+#define SNLF_TEXTURE_POOL_IDLE_FRAMES    8 // Frames a released texture is kept for reuse (at least SNLF_OUTPUT_BUFFER_COUNT)
+#define SNLF_RENDER_TARGET_PIXEL_FORMAT  CPSR_PIXELFORMAT_RGBA16_FLOAT // Format of every render target generators draw into
+#define SNLF_JOB_WORKER_COUNT_MAX        64 // Job workers, one per logical core (affinity masks are 64-bit)
+#define SNLF_JOB_RESERVED_CORES          1 // Leading logical cores left out of the default job affinity for the graphics threads
+#define SNLF_JOB_BAND_BYTES              262144 // Bytes one row band touches when the L2 cache size is unknown
+#define SNLF_COLOR_TRANSFORM_CACHE_COUNT 32 // Pairs of color primaries whose transforms are kept for the process
+#define SNLF_TRANSFER_LUT_CACHE_COUNT    128 // Transfer LUTs kept for the process (every type, direction and precision fits)
+#define SNLF_REFERENCE_WHITE_LUMINANCE   203.F // cd/m2 of linear 1.0 and of SDR white (BT.2408 reference white)
+#define SNLF_HLG_PEAK_LUMINANCE          1000.F // cd/m2 of the nominal HLG display
+#define SNLF_HDR10_PEAK_LUMINANCE        1000.F // cd/m2 of HDR10 sources without MaxCLL or mastering metadata
+#define SNLF_TONE_MAPPING_PERCENTILE     0.999F // Share of the pixels under the peak a dynamic tone mapper measures
+#define SNLF_TONE_MAPPING_ADAPTATION     0.25F // Part of the way to the measured peak a dynamic tone mapper moves per frame
 
 #define SNLF_DISPLAY_DEFAULT_PADDING 8.F
 
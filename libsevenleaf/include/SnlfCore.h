@@ -2,6 +2,7 @@
 #define _SNLF_CORE_H
 
 #include <osutil.h>
+#include <osutil_atomic.h>
 
 #include <compositor/CpsrGraphics.h>
 #include <compositor/vector/matrix4x4_t.h>
@@ -44,6 +45,7 @@ typedef struct _SnlfGraphicsThreadContext SnlfGraphicsThreadContext;
 typedef struct _SnlfGraphicsGenerator SnlfGraphicsGenerator;
 typedef const struct _SnlfGraphicsGenerator *SnlfGraphicsGeneratorRef;
 typedef struct _SnlfGraphicsTransformer SnlfGraphicsTransformer;
+typedef struct _SnlfRenderPass SnlfRenderPass;
 
 typedef struct _SnlfSoundContext SnlfSoundContext;
 typedef struct _SnlfSoundThreadContext SnlfSoundThreadContext;
@@ -104,15 +106,77 @@ typedef struct {
 typedef struct {
   const SnlfGraphicsContext *context;
   const CpsrTexture2D *renderTarget;
+  SnlfRenderPass *renderPass;  // Open on renderTarget
 } SnlfGraphicsDrawParams;
 
 SNLF_EXPORT const CpsrDevice *SnlfGraphicsContextGetDevice(const SnlfGraphicsContext *context);
 SNLF_EXPORT const CpsrCommandBuffer *SnlfGraphicsContextGetCommandBuffer(const SnlfGraphicsContext *context);
 SNLF_EXPORT CpsrGraphicsContext *SnlfGraphicsContextCreateGraphicsContext(const SnlfGraphicsContext *context);
 
+// A draw item is one instance of the plane (-1, -1)-(1, 1) drawn as a 4-vertex triangle strip from vertex
+// buffer 0. Consecutive items with the same pipeline state, instance size, texture and render target are
+// merged into one instanced draw; the vertex function reads its instance from constant buffer 0 at the
+// instance id. Returns true when the item was not submitted and the caller has to draw it itself.
+typedef struct {
+  CpsrGraphicsPipelineState *pipelineState;
+  const void *instance;
+  uint32_t instanceSize;
+  const CpsrTexture2D *texture;  // Bound to texture 0, or NULL
+} SnlfGraphicsDrawItem;
+
+SNLF_EXPORT bool SnlfGraphicsContextSubmitDrawItem(const SnlfGraphicsContext *context, const CpsrTexture2D *renderTarget, const SnlfGraphicsDrawItem *item);
+
+// Constants allocated from the frame's upload ring stay valid until the frame has executed, so they never race
+// with a frame still in flight. Write them through data and bind buffer at offset with
+// SnlfRenderPassSetConstantBufferWithOffset. Returns true when nothing was allocated.
+typedef struct {
+  const CpsrBuffer *buffer;
+  uint32_t offset;
+  void *data;
+} SnlfGraphicsConstants;
+
+SNLF_EXPORT bool SnlfGraphicsContextAllocateConstants(const SnlfGraphicsContext *context, size_t size, SnlfGraphicsConstants *constants);
+
+// Pipeline states are shared and immutable. The core keeps one per descriptor, so generators that ask for the
+// same shaders, blend, rasterizer, topology and render target format get the same object and compile it once.
+// Acquire them at init and release them before destroying their shader functions. The descriptor defaults to
+// the default blend and rasterizer, triangles, and SNLF_RENDER_TARGET_PIXEL_FORMAT. Returns NULL on failure.
+typedef struct {
+  const CpsrShaderFunction *vertexFunction;
+  const CpsrShaderFunction *pixelFunction;
+  CpsrBlendDescriptor blend;
+  CpsrRasterizerDescriptor rasterizer;
+  CpsrPrimitiveTopologyType primitiveTopologyType;
+  CpsrPixelFormat pixelFormat;
+} SnlfPipelineStateDescriptor;
+
+SNLF_EXPORT void SnlfPipelineStateDescriptorInit(SnlfPipelineStateDescriptor *descriptor, const CpsrShaderFunction *vertexFunction, const CpsrShaderFunction *pixelFunction);
+SNLF_EXPORT CpsrGraphicsPipelineState *SnlfGraphicsContextAcquirePipelineState(const SnlfGraphicsContext *context, const SnlfPipelineStateDescriptor *descriptor);
+SNLF_EXPORT void SnlfGraphicsContextReleasePipelineState(const SnlfGraphicsContext *context, CpsrGraphicsPipelineState *pipelineState);
+
+// Intermediate textures come from a pool of the graphics thread. Release a texture once the last pass reading it
+// has been encoded: an acquire later in the same frame may hand out the same texture again, so textures whose
+// lifetimes do not overlap share memory. Textures stay valid across frames until released. Returns NULL on
+// failure.
+SNLF_EXPORT CpsrTexture2D *SnlfGraphicsContextAcquireTexture(const SnlfGraphicsContext *context, const CpsrTexture2DDescriptor *descriptor);
+SNLF_EXPORT void SnlfGraphicsContextReleaseTexture(const SnlfGraphicsContext *context, CpsrTexture2D *texture);
+
+// The render pass of SnlfGraphicsDrawParams is shared by every generator drawing into the same render target
+// during a frame. Pipeline states have to be acquired for SNLF_RENDER_TARGET_PIXEL_FORMAT; bindings set again
+// with the same object are dropped. Never close it; create a graphics context only for work that needs its own pass.
+SNLF_EXPORT bool SnlfRenderPassSetPipelineState(SnlfRenderPass *renderPass, CpsrGraphicsPipelineState *pipelineState);
+SNLF_EXPORT void SnlfRenderPassSetVertexBuffer(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *vertexBuffer);
+SNLF_EXPORT void SnlfRenderPassSetConstantBuffer(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *constantBuffer);
+SNLF_EXPORT void SnlfRenderPassSetConstantBufferWithOffset(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *constantBuffer, uint32_t offset);
+SNLF_EXPORT void SnlfRenderPassSetTexture(SnlfRenderPass *renderPass, uint8_t index, const CpsrTexture2D *texture);
+SNLF_EXPORT void SnlfRenderPassSetPrimitiveTopology(SnlfRenderPass *renderPass, CpsrPrimitiveTopology primitiveTopology);
+SNLF_EXPORT void SnlfRenderPassDraw(SnlfRenderPass *renderPass, uint32_t vertexStart, uint32_t vertexCount);
+SNLF_EXPORT void SnlfRenderPassDrawInstanced(SnlfRenderPass *renderPass, uint32_t vertexStart, uint32_t vertexCount, uint32_t instanceCount);
+
 typedef enum {
   SNLF_SHADER_VERTEX_DRAW,
   SNLF_SHADER_VERTEX_DRAW_SIMPLE,
+  SNLF_SHADER_VERTEX_DRAW_SIMPLE_INSTANCED,
   SNLF_SHADER_PIXEL_DRAW_HALF,
   SNLF_SHADER_PIXEL_DRAW_SINGLE,
   
@@ -125,6 +189,42 @@ SNLF_EXPORT const CpsrShaderFunction *SnlfGraphicsContextGetShaderFunction(const
 
 SNLF_EXPORT void SnlfGraphicsContextDrawTexture(const SnlfGraphicsContext *context, const CpsrTexture2D *sourceTexture);
 
+// ---
+// Graphics statistics
+// ---
+typedef enum {
+  SNLF_FRAME_STAGE_UPDATE,
+  SNLF_FRAME_STAGE_DRAW,
+  SNLF_FRAME_STAGE_EXECUTE, // Time in CpsrCommandBufferExecute; all rasterization on the CPU driver
+  SNLF_FRAME_STAGE_DISPLAY,
+  SNLF_FRAME_STAGE_COUNT,
+} SnlfFrameStage;
+
+typedef struct {
+  duration_t min, avg, p99, max;
+} SnlfDurationStatistics;
+
+typedef struct {
+  uint64_t frameCount;        // Intervals elapsed
+  uint64_t droppedFrameCount; // Intervals skipped without rendering
+  uint64_t lateFrameCount;    // Frames started after their deadline
+  uint32_t sampleCount;       // Frames in the duration window
+  SnlfDurationStatistics stages[SNLF_FRAME_STAGE_COUNT];
+} SnlfGraphicsStatistics;
+
+typedef enum {
+  SNLF_LATE_FRAME_SKIP,     // Drop the missed intervals and realign to the frame cadence
+  SNLF_LATE_FRAME_STRETCH,  // Restart the cadence from the late frame; nothing drops but the timeline slips
+  SNLF_LATE_FRAME_CATCH_UP, // Render missed frames back to back while at most the budget behind, else skip
+} SnlfLateFramePolicy;
+
+SNLF_EXPORT void SnlfGraphicsGetStatistics(SnlfCoreRef core, SnlfGraphicsStatistics *statistics);
+SNLF_EXPORT void SnlfGraphicsResetStatistics(SnlfCoreRef core);
+
+SNLF_EXPORT SnlfLateFramePolicy SnlfGraphicsGetLateFramePolicy(SnlfCoreRef core);
+SNLF_EXPORT uint32_t SnlfGraphicsGetCatchUpBudget(SnlfCoreRef core);
+SNLF_EXPORT void SnlfGraphicsSetLateFramePolicy(SnlfCoreRef core, SnlfLateFramePolicy policy, uint32_t catchUpBudget);
+
 // ---
 // Object
 // ---
@@ -175,6 +275,8 @@ struct _SnlfGraphicsGenerator {
   void (*uninit)(intptr_t);
   void (*update)(intptr_t, SnlfGraphicsUpdateParams);
   void (*draw)(intptr_t, SnlfGraphicsDrawParams);
+  bool (*isOpaque)(intptr_t); // Optional. true when draw covers its whole plane with opaque pixels
+  bool (*isStatic)(intptr_t); // Optional. true when draw changes only after SnlfSourceInvalidate, which lets bitmap caches keep it
   
   uint32_t (*getPropertyCount)();
   bool (*getPropertyKeys)(identifier_t[], uint32_t);
@@ -201,6 +303,33 @@ struct _SnlfGraphicsTransformer {
 
 // 1. YUV (444, 422, 420, 411)/RGB to linear RGB
 
+// ---
+// Jobs
+// ---
+// Row-wise work such as pixel conversion, scaling and packing is split into row bands that fit the cache.
+// The bands run on the core's worker pool, which has one worker pinned to each logical core. The
+// submitting thread only waits on the counter.
+typedef void (*SnlfRowJobFunction)(intptr_t param, uint32_t firstRow, uint32_t rowCount);
+
+typedef struct {
+  SnlfRowJobFunction function;
+  intptr_t param;         // Has to stay valid until the counter reaches zero
+  uint32_t rowCount;
+  size_t bytesPerRow;     // Bytes one row touches; sizes the bands
+  uint64_t affinityMask;  // Logical cores that may run the bands, or 0 for the default cores
+} SnlfRowJob;
+
+// Zero-initialize. One counter may collect the bands of several jobs.
+typedef struct {
+  uint32_t pending;  // Guarded by the worker pool
+} SnlfJobCounter;
+
+// Runs the job on the calling thread when no worker is pinned to its cores.
+// Returns true when the bands cannot be queued.
+SNLF_EXPORT bool SnlfCoreDispatchRows(SnlfCoreRef core, const SnlfRowJob *job, SnlfJobCounter *counter);
+SNLF_EXPORT void SnlfCoreWaitForJobs(SnlfCoreRef core, SnlfJobCounter *counter);
+SNLF_EXPORT uint64_t SnlfCoreGetJobAffinityMask(SnlfCoreRef core);
+
 // ---
 // Input
 // ---
@@ -239,6 +368,12 @@ SNLF_EXPORT const char *SnlfInputGetFriendlyName(SnlfInputRef input);
 typedef void (*SnlfInputProcedure)(SnlfInputRef input, intptr_t param);
 SNLF_EXPORT void SnlfEnumInputs(SnlfCoreRef core, SnlfInputProcedure enumFunc, intptr_t param);
 
+// Conversions of the input run on the logical cores set in affinityMask, or on the default cores when it
+// is 0.
+SNLF_EXPORT void SnlfInputSetAffinityMask(SnlfInputRef input, uint64_t affinityMask);
+SNLF_EXPORT uint64_t SnlfInputGetAffinityMask(SnlfInputRef input);
+SNLF_EXPORT bool SnlfInputDispatchRows(SnlfInputRef input, const SnlfRowJob *job, SnlfJobCounter *counter);
+
 // ---
 // Output
 // ---
@@ -270,9 +405,21 @@ SNLF_EXPORT SnlfSourceRef SnlfSourceCreate(SnlfCoreRef core);
 SNLF_EXPORT SnlfSourceRef SnlfSourceCreateFromInput(SnlfInputRef input);
 SNLF_EXPORT SnlfSourceRef SnlfSourceCreateFromGraphicsGenerator(SnlfCoreRef core, SnlfGraphicsGeneratorRef generator);
 
+// A reference source draws another source, which may also be placed elsewhere. The referenced source is
+// rendered once per frame into a texture that every reference composites with its own transform. A reference
+// cannot be placed inside the source it references; appending it there fails.
+SNLF_EXPORT SnlfSourceRef SnlfSourceCreateFromReference(SnlfSourceRef reference);
+
 SNLF_EXPORT matrix4x4_t SnlfSourceGetTransform(SnlfSourceRef source);
 SNLF_EXPORT void SnlfSourceSetTransform(SnlfSourceRef source, matrix4x4_t transform);
 
+// A group source that caches as bitmap renders its subtree once and reuses the result until a transform in
+// the subtree, a property or the children change. Generators in a valid cache are not updated, so animated
+// content should call SnlfSourceInvalidate when it needs to be redrawn.
+SNLF_EXPORT bool SnlfSourceGetCacheAsBitmap(SnlfSourceRef source);
+SNLF_EXPORT void SnlfSourceSetCacheAsBitmap(SnlfSourceRef source, bool cacheAsBitmap);
+SNLF_EXPORT void SnlfSourceInvalidate(SnlfSourceRef source);
+
 SNLF_EXPORT uint32_t SnlfSourceGetPropertyCount(SnlfSourceRef source);
 SNLF_EXPORT bool SnlfSourceGetPropertyKeys(SnlfSourceRef source, identifier_t identifiers[], uint32_t count);
 SNLF_EXPORT SnlfBox SnlfSourceGetProperty(SnlfSourceRef source, identifier_t identifier);
@@ -24,6 +24,11 @@ SNLF_EXPORT void SnlfDisplayChangeSize(SnlfDisplay *display, CpsrSizeU32 size);
 SNLF_EXPORT void SnlfDisplayBeginDraw(SnlfDisplay *display);
 SNLF_EXPORT void SnlfDisplayEndDraw(SnlfDisplay *display);
 
+// Memory file descriptor of the frame ring a headless display (created without a view) presents into, for a
+// monitor to map. Returns -1 for a display presenting to a view, before its first draw, or off Linux.
+// The descriptor changes with the size, so fetch it again after SnlfDisplayChangeSize.
+SNLF_EXPORT int SnlfDisplayGetSharedMemoryFileDescriptor(SnlfDisplay *display);
+
 SNLF_EXPORT const SnlfGraphicsContext *SnlfDisplayContextGetGraphicsContext(const SnlfDisplayContext *displayContext);
 SNLF_EXPORT const CpsrTexture2D *SnlfDisplayContextGetSourceTexture(const SnlfDisplayContext *displayContext);
 SNLF_EXPORT CpsrSwapChain *SnlfDisplayContextGetSwapChain(const SnlfDisplayContext *displayContext);
@@ -75,33 +75,9 @@ typedef struct {
   SnlfColorPrimary whitePoint;
 } SnlfColorPrimaries;
 
+// Types without tabulated primaries, such as SNLF_CP_UNSPECIFIED, get BT.709.
 SNLF_EXPORT void SnlfGetColorPrimaries(SnlfColorPrimariesType type, SnlfColorPrimaries *colorPrimaries);
 
-struct _SnlfColorPrimariesList {
-  SnlfColorPrimariesType type;
-  SnlfColorPrimaries descriptor;
-} snlfColorPrimariesList = {
-  { SNLF_CP_BT709,           {{ 0.640   , 0.330    }, { 0.300   , 0.600    }, { 0.150   ,  0.060    }, { 0.3127  , 0.3290   }}},
-  { SNLF_CP_NTSC,            {{ 0.67    , 0.33     }, { 0.21    , 0.71     }, { 0.14    ,  0.08     }, { 0.3127  , 0.3290   }}},
-  { SNLF_CP_BT470BG,         {{ 0.64    , 0.33     }, { 0.29    , 0.60     }, { 0.15    ,  0.06     }, { 0.3127  , 0.3290   }}},
-  { SNLF_CP_BT601,           {{ 0.630   , 0.340    }, { 0.310   , 0.595    }, { 0.155   ,  0.070    }, { 0.3127  , 0.3290   }}},
-  { SNLF_CP_SMPTE240M,       {{ 0.630   , 0.340    }, { 0.310   , 0.595    }, { 0.155   ,  0.070    }, { 0.3127  , 0.3290   }}},
-  { SNLF_CP_FILM,            {{ 0.681   , 0.319    }, { 0.243   , 0.692    }, { 0.145   ,  0.049    }, { 0.310   , 0.316    }}},
-  { SNLF_CP_BT2020,          {{ 0.708   , 0.292    }, { 0.170   , 0.797    }, { 0.131   ,  0.046    }, { 0.3127  , 0.3290   }}},
-  { SNLF_CP_CIE1931XYZ,      {{ 1.0     , 0.0      }, { 0.0     , 1.0      }, { 0.0     ,  0.0      }, { 1.0 / 3 , 1.0 / 3  }}},
-  { SNLF_CP_DCIP3,           {{ 0.680   , 0.320    }, { 0.265   , 0.690    }, { 0.150   ,  0.060    }, { 0.314   , 0.351    }}},
-  { SNLF_CP_DCIP3_D65,       {{ 0.680   , 0.320    }, { 0.265   , 0.690    }, { 0.150   ,  0.060    }, { 0.3127  , 0.3290   }}},
-  { SNLF_CP_JEDEC_P22,       {{ 0.630   , 0.340    }, { 0.295   , 0.605    }, { 0.155   ,  0.077    }, { 0.3127  , 0.3290   }}},
-  { SNLF_CP_NTSC_FCC,        {{ 0.67    , 0.33     }, { 0.21    , 0.71     }, { 0.14    ,  0.08     }, { 0.310   , 0.316    }}},
-  { SNLF_CP_NTSC_J,          {{ 0.67    , 0.33     }, { 0.21    , 0.71     }, { 0.14    ,  0.08     }, { 0.2831  , 0.2970   }}},
-  { SNLF_CP_DCIP3_D60,       {{ 0.680   , 0.320    }, { 0.265   , 0.690    }, { 0.150   ,  0.060    }, { 0.3217  , 0.3378   }}},
-  { SNLF_CP_DCIP3_PLUS,      {{ 0.740   , 0.270    }, { 0.220   , 0.780    }, { 0.090   , -0.090    }, { 0.314   , 0.351    }}},
-  { SNLF_CP_ACES2065,        {{ 0.680   , 0.320    }, { 0.265   , 0.690    }, { 0.150   ,  0.060    }, { 0.32168 , 0.33767  }}},
-  { SNLF_CP_ADOBE_RGB,       {{ 0.6400  , 0.3300   }, { 0.2100  , 0.7100   }, { 0.1500  ,  0.0600   }, { 0.3127  , 0.3290   }}},
-  { SNLF_CP_PRO_PHOTO,       {{ 0.734699, 0.265301 }, { 0.159597, 0.840403 }, { 0.036598,  0.000105 }, { 0.345704, 0.358540 }}},
-  { SNLF_CP_WIDE_GAMUT_RGB,  {{ 0.7347  , 0.2653   }, { 0.1152  , 0.8264   }, { 0.1566  ,  0.0177   }, { 0.3457  , 0.3585   }}},
-};
-
 // ---
 // Transfer characteristics
 // ---
@@ -144,10 +120,22 @@ typedef struct {
   float gamma;
 } SnlfTransferCharacteristicsSimple;
 
+// Closed form of an EOTF. Power-law curves decode V to ((V + offset) / (1 + offset))^gamma, or to
+// V / linearSlope below linearSlope * linearThreshold. PQ and HLG have gamma 0 and use their own formulas.
+// Code 1.0 shows peakLuminance cd/m2.
 typedef struct {
-  
+  SnlfTransferCharacteristicsType type;
+  float gamma;
+  float offset;
+  float linearThreshold;
+  float linearSlope;
+  float peakLuminance;
 } SnlfTransferCharacteristics;
 
+// BT.709, BT.601, SMPTE 240M and BT.2020 decode with the BT.1886 EOTF of a display with zero black.
+// Returns true for the logarithmic, xvYCC, BT.1361 and SNLF_TC_GAMMA23H types, which have no closed form here.
+SNLF_EXPORT bool SnlfGetTransferCharacteristics(SnlfTransferCharacteristicsType type, SnlfTransferCharacteristics *transferCharacteristics);
+
 // ---
 // Matrix coefficients
 // ---
@@ -242,4 +230,4 @@ typedef struct {
   //SnlfLuminance luminance;
 } SnlfNormalizedFrameDescriptor;
 
-#endif _SNLF_GRAPHICS_DEFINES_H
+#endif // _SNLF_GRAPHICS_DEFINES_H
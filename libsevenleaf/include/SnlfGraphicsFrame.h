@@ -4,6 +4,7 @@
 #include <osutil_atomic.h>
 
 #include "SnlfCore.h"
+#include "SnlfColorManagement.h"
 #include "SnlfGraphicsDefines.h"
 
 #ifdef __cplusplus
@@ -87,6 +88,7 @@ typedef enum {
   SNLF_GRAPHICS_FRAME_Y010 = 'Y010',  // Packed, 4:2:0
   SNLF_GRAPHICS_FRAME_Y210 = 'Y210',  // Packed, 4:2:2
   SNLF_GRAPHICS_FRAME_Y410 = 'Y410',  // Packed, 4:4:4 (v410)
+  SNLF_GRAPHICS_FRAME_V210 = 'v210',  // Packed, 4:2:2, 6 pixels in 16 bytes
   
   // 12-bit YUV
   SNLF_GRAPHICS_FRAME_P012 = 'P012',  // Planar, 4:2:0
@@ -163,6 +165,78 @@ bool SnlfGraphicsFrameAllocatorSetFormat(SnlfGraphicsFrameAllocatorRef allocator
 CpsrSizeU32 SnlfGraphicsFrameAllocatorGetSize(SnlfGraphicsFrameAllocatorRef allocator);
 void SnlfGraphicsFrameAllocatorSetSize(SnlfGraphicsFrameAllocatorRef allocator, CpsrSizeU32 size);
 
+// ---
+// Converter
+// ---
+// Converts CPU frames of any supported SnlfGraphicsFrameFormat into the RGBA16F working format.
+// Every row is unpacked into four 16-bit components at full resolution, then one matrix stage applies the
+// ranges, matrix coefficients and color transform. Chroma is replicated, not interpolated. Output is
+// normalized non-linear R'G'B' and is not clamped, unless transfer characteristics are set. A tone mapper
+// compresses HDR sources in linear light between the color transform and the encode lookup.
+// Y010, Y012 and Y016 have no defined layout and are not supported.
+typedef struct {
+  CpsrSizeU32 size;
+  const uint8_t *planes[3];  // In memory order, e.g. Y, V and U for YV12
+  size_t bytesPerRow[3];
+} SnlfFrameConverterSource;
+
+typedef struct {
+  const struct _SnlfFrameLayout *layout;
+  float matrix[12];      // R, G and B rows of (c0, c1, c2, offset), applied to 16-bit component codes
+  float colorMatrix[9];  // Applied to the result of matrix; the identity unless a color transform is set
+  const SnlfTransferLUT *decode;  // Linearizes the result of matrix, or NULL
+  const SnlfTransferLUT *encode;  // Encodes the result of colorMatrix, or NULL
+  SnlfToneMapperRef toneMapper;   // Tone-maps the result of colorMatrix, or NULL
+} SnlfFrameConverter;
+
+// Returns true when the converter reads format as YUV, which needs a descriptor.
+SNLF_EXPORT bool SnlfGraphicsFrameFormatIsYUV(SnlfGraphicsFrameFormat format);
+
+// Ranges of the descriptor are normalized to the largest code value; chroma is centered between black and
+// peak. RGB formats use yRange as the RGB range, or full range when descriptor is NULL.
+// Returns true when the format or the matrix coefficients are not supported.
+SNLF_EXPORT bool SnlfFrameConverterInit(SnlfFrameConverter *converter, SnlfGraphicsFrameFormat format, const SnlfYUVFrameDescriptor *descriptor);
+
+// Maps the output onto other primaries, e.g. a transform from descriptor->primaries to BT.709. Without
+// transfer characteristics the transform is folded into the matrix stage, so it costs nothing per pixel, and
+// applies to the components as decoded. That is exact for linear-light sources only.
+SNLF_EXPORT void SnlfFrameConverterSetColorTransform(SnlfFrameConverter *converter, const SnlfColorTransform *transform);
+
+// Decodes the components with the source EOTF before the color transform and encodes them with the
+// destination one after it, so that the transform works on linear light. SNLF_TC_LINEAR skips either lookup;
+// a linear destination leaves the output in linear light. Decode LUTs follow the component depth; encode
+// LUTs are 12-bit, beyond the precision of the half-float output.
+// Returns true when either transfer characteristics have no LUT.
+SNLF_EXPORT bool SnlfFrameConverterSetTransfer(SnlfFrameConverter *converter, SnlfTransferCharacteristicsType source, SnlfTransferCharacteristicsType destination);
+
+// Tone-maps linear light, so the source needs transfer characteristics, e.g. PQ with a BT.709 destination
+// for HDR10 to SDR. Conversions of a dynamic tone mapper count the frame's histogram on every row band. End
+// every frame with SnlfToneMapperEndFrame once they are done, which also applies new metadata. toneMapper may
+// be NULL.
+SNLF_EXPORT void SnlfFrameConverterSetToneMapper(SnlfFrameConverter *converter, SnlfToneMapperRef toneMapper);
+
+// Describes a frame whose planes follow each other in one buffer. Chroma planes share the luma stride, except
+// those of I420, YV12, I422 and I444, whose stride is narrowed with the chroma width.
+SNLF_EXPORT void SnlfFrameConverterSourceInit(const SnlfFrameConverter *converter, CpsrSizeU32 size, const uint8_t *data, size_t bytesPerRow, SnlfFrameConverterSource *source);
+
+// Converts rowCount rows from firstRow on. destination points at row 0 of the RGBA16F image.
+// Returns true when the scratch rows cannot be allocated.
+SNLF_EXPORT bool SnlfFrameConverterConvert(const SnlfFrameConverter *converter, const SnlfFrameConverterSource *source, uint32_t firstRow, uint32_t rowCount, uint16_t *destination, size_t bytesPerRow);
+
+// Scalar conversion without SIMD. The result matches SnlfFrameConverterConvert within one unit in the last
+// place.
+SNLF_EXPORT bool SnlfFrameConverterConvertReference(const SnlfFrameConverter *converter, const SnlfFrameConverterSource *source, uint32_t firstRow, uint32_t rowCount, uint16_t *destination, size_t bytesPerRow);
+
+// Converts a frame in row bands on the job workers. The conversion is the job's parameter.
+typedef struct {
+  const SnlfFrameConverter *converter;
+  const SnlfFrameConverterSource *source;
+  uint16_t *destination;
+  size_t bytesPerRow;
+} SnlfFrameConversion;
+
+SNLF_EXPORT void SnlfFrameConversionInitRowJob(const SnlfFrameConversion *conversion, SnlfRowJob *job);
+
 // ---
 // Functions
 // ---
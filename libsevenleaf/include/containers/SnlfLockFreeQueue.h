@@ -90,10 +90,22 @@ static inline intptr_t SnlfLockFreeQueueDequeue(SnlfLockFreeQueue *queue) {
   }
 }
 
+static inline size_t SnlfLockFreeQueueDequeueBatch(SnlfLockFreeQueue *queue, intptr_t *items, size_t maxCount) {
+  size_t count = 0;
+  for (; count < maxCount; ++count) {
+    const intptr_t data = SnlfLockFreeQueueDequeue(queue);
+    if (!data) {
+      break;
+    }
+    items[count] = data;
+  }
+  return count;
+}
+
 static inline void SnlfLockFreeQueueUninit(SnlfLockFreeQueue *queue) {
   while (SnlfLockFreeQueueDequeue(queue)) {
   }
-  SnlfDealloc(queue);
+  SnlfDealloc(queue->head);
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,152 @@
+#ifndef _SNLF_CONTAINERS_MPSCRING_H
+#define _SNLF_CONTAINERS_MPSCRING_H
+
+#ifdef _WIN32
+#  ifndef STRICT
+#    define STRICT
+#  endif
+#  define WIN32_LEAN_AND_MEAN
+#  include <Windows.h>
+#endif
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef _MSC_VER
+#include <stdatomic.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bounded multi-producer/single-consumer ring. Capacity is a power of two and nothing is allocated after init.
+// Every cell carries a sequence number: a producer claims the cell at position pos when its sequence is pos,
+// and publishes it by storing pos + 1; the consumer releases it for the next lap by storing pos + capacity.
+#define SNLF_MPSC_RING_CACHE_LINE_SIZE 64
+
+#ifdef _MSC_VER
+// Aligned volatile accesses have acquire/release semantics under /volatile:ms
+typedef volatile size_t SnlfMpscRingIndex;
+
+#define SnlfMpscRingLoad(__OBJ__)             (*(__OBJ__))
+#define SnlfMpscRingStore(__OBJ__, __VALUE__) (*(__OBJ__) = (__VALUE__))
+
+static inline bool SnlfMpscRingCompareExchange(SnlfMpscRingIndex *obj, size_t *expected, size_t desired) {
+  const size_t previous = (size_t)InterlockedCompareExchangePointer((PVOID volatile *)obj, (PVOID)desired, (PVOID)*expected);
+  if (previous == *expected) {
+    return true;
+  }
+  *expected = previous;
+  return false;
+}
+#else
+typedef atomic_size_t SnlfMpscRingIndex;
+
+#define SnlfMpscRingLoad(__OBJ__)             atomic_load_explicit(__OBJ__, memory_order_acquire)
+#define SnlfMpscRingStore(__OBJ__, __VALUE__) atomic_store_explicit(__OBJ__, __VALUE__, memory_order_release)
+#define SnlfMpscRingCompareExchange(__OBJ__, __EXPECTED__, __DESIRED__) \
+  atomic_compare_exchange_weak_explicit(__OBJ__, __EXPECTED__, __DESIRED__, memory_order_relaxed, memory_order_relaxed)
+#endif
+
+typedef struct {
+  SnlfMpscRingIndex sequence;
+  intptr_t data;
+} SnlfMpscRingCell;
+
+struct _SnlfMpscRing {
+  // Producers and the consumer each own a cache line
+  SnlfMpscRingIndex tail;
+  uint8_t _padding0[SNLF_MPSC_RING_CACHE_LINE_SIZE - sizeof(SnlfMpscRingIndex)];
+  size_t head;
+  uint8_t _padding1[SNLF_MPSC_RING_CACHE_LINE_SIZE - sizeof(size_t)];
+  SnlfMpscRingCell *cells;
+  size_t mask;
+};
+typedef struct _SnlfMpscRing SnlfMpscRing;
+
+static inline bool SnlfMpscRingInit(SnlfMpscRing *ring, size_t capacity) {
+  assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+
+  SnlfMpscRingCell *cells = (SnlfMpscRingCell *)malloc(capacity * sizeof(SnlfMpscRingCell));
+  if (!cells) {
+    return true;
+  }
+  for (size_t i = 0; i < capacity; ++i) {
+    SnlfMpscRingStore(&cells[i].sequence, i);
+    cells[i].data = 0;
+  }
+
+  SnlfMpscRingStore(&ring->tail, 0);
+  ring->head = 0;
+  ring->cells = cells;
+  ring->mask = capacity - 1;
+  return false;
+}
+
+static inline void SnlfMpscRingUninit(SnlfMpscRing *ring) {
+  free(ring->cells);
+  ring->cells = NULL;
+}
+
+// Returns true when the ring is full.
+static inline bool SnlfMpscRingEnqueue(SnlfMpscRing *ring, intptr_t data) {
+  SnlfMpscRingCell *cell;
+  size_t position = SnlfMpscRingLoad(&ring->tail);
+  while (1) {
+    cell = ring->cells + (position & ring->mask);
+    const size_t sequence = SnlfMpscRingLoad(&cell->sequence);
+    const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+    if (difference == 0) {
+      if (SnlfMpscRingCompareExchange(&ring->tail, &position, position + 1)) {
+        break;
+      }
+    } else if (difference < 0) {
+      return true;
+    } else {
+      position = SnlfMpscRingLoad(&ring->tail);
+    }
+  }
+
+  cell->data = data;
+  SnlfMpscRingStore(&cell->sequence, position + 1);
+  return false;
+}
+
+// Consumer only. Returns 0 when the ring is empty.
+static inline intptr_t SnlfMpscRingDequeue(SnlfMpscRing *ring) {
+  const size_t position = ring->head;
+  SnlfMpscRingCell *cell = ring->cells + (position & ring->mask);
+  if (SnlfMpscRingLoad(&cell->sequence) != position + 1) {
+    return 0;
+  }
+
+  const intptr_t data = cell->data;
+  SnlfMpscRingStore(&cell->sequence, position + ring->mask + 1);
+  ring->head = position + 1;
+  return data;
+}
+
+// Consumer only. Dequeues up to maxCount items and returns how many were stored into items.
+static inline size_t SnlfMpscRingDequeueBatch(SnlfMpscRing *ring, intptr_t *items, size_t maxCount) {
+  size_t position = ring->head;
+  size_t count = 0;
+  for (; count < maxCount; ++count, ++position) {
+    SnlfMpscRingCell *cell = ring->cells + (position & ring->mask);
+    if (SnlfMpscRingLoad(&cell->sequence) != position + 1) {
+      break;
+    }
+    items[count] = cell->data;
+    SnlfMpscRingStore(&cell->sequence, position + ring->mask + 1);
+  }
+  ring->head = position;
+  return count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SNLF_CONTAINERS_MPSCRING_H
@@ -0,0 +1,187 @@
+#ifndef _SNLF_COLOR_MANAGEMENT_PRIVATE_H
+#define _SNLF_COLOR_MANAGEMENT_PRIVATE_H
+
+#include "SnlfColorManagement.h"
+
+#include "compositor/vector/float32x4_t.h"
+
+#include <osutil_atomic.h>
+#include <string.h>
+
+// ---
+// Transfer LUT
+// ---
+#define SNLF_TRANSFER_LUT_MIN_EXPONENT (-32)
+#define SNLF_TRANSFER_LUT_LOWEST       2.3283064365386963e-10F // 2^-32 of the peak, the first encode grid point
+
+struct _SnlfTransferLUT {
+  SnlfTransferCharacteristicsType type;
+  SnlfTransferDirection direction;
+  uint32_t precision;
+  uint32_t count;       // Intervals of the grid
+  uint32_t shift;       // Encode: float bits below the interval index
+  float fractionScale;  // Encode: 2^-shift
+  float scale;          // Encode: 1 / linear light of code 1.0, where the grid ends
+  float lowSlope;       // Encode: slope from zero up to the first grid point
+  float entries[];      // count + 2 values; the last one repeats so that the last grid point interpolates
+};
+
+// Curves on light normalized to the peak luminance.
+double SnlfTransferDecode(const SnlfTransferCharacteristics *tc, double code);
+double SnlfTransferEncode(const SnlfTransferCharacteristics *tc, double light);
+
+// Maps a grid point, a code for decode LUTs and normalized light for encode LUTs, to its entry.
+typedef double (*SnlfTransferCurve)(const void *param, double value);
+
+// Allocates a LUT of type SNLF_TC_CUSTOM that is not cached. Free it with SnlfDealloc.
+SnlfTransferLUT *SnlfTransferLUTAlloc(SnlfTransferDirection direction, uint32_t precision);
+
+// Samples curve at every grid point. Encode grids end at peak, in linear light.
+void SnlfTransferLUTFill(SnlfTransferLUT *lut, double peak, SnlfTransferCurve curve, const void *param);
+
+// Scalar lookup. NaN becomes zero.
+static inline float SnlfTransferLUTEvaluate(const SnlfTransferLUT *lut, float value) {
+  uint32_t index;
+  float fraction;
+  if (lut->direction == SNLF_TRANSFER_DECODE) {
+    const float t = (value > 0.F ? (value < 1.F ? value : 1.F) : 0.F) * (float)lut->count;
+    index = (uint32_t)t;
+    fraction = t - (float)index;
+  } else {
+    value *= lut->scale;
+    if (!(value >= SNLF_TRANSFER_LUT_LOWEST)) {
+      return value > 0.F ? value * lut->lowSlope : 0.F;
+    }
+  
+    // Octaves of the grid follow the float exponent, intervals within them the top mantissa bits
+    const float lowest = SNLF_TRANSFER_LUT_LOWEST;
+    const float clamped = value < 1.F ? value : 1.F;
+    uint32_t bits, lowestBits;
+    memcpy(&bits, &clamped, sizeof(uint32_t));
+    memcpy(&lowestBits, &lowest, sizeof(uint32_t));
+    bits -= lowestBits;
+    index = bits >> lut->shift;
+    fraction = (float)(bits & ((1U << lut->shift) - 1)) * lut->fractionScale;
+  }
+  
+  const float low = lut->entries[index];
+  return low + (lut->entries[index + 1] - low) * fraction;
+}
+
+// SnlfTransferLUTEvaluate on four lanes. There is no gather instruction before AVX2, so the entries are
+// loaded lane by lane.
+#if defined(_SIMD_X86_SSE4_1)
+#define SNLF_TRANSFER_LUT_SIMD 1
+
+static inline float32x4_t SnlfTransferLUTEvaluate4(const SnlfTransferLUT *lut, float32x4_t value) {
+  const __m128 zero = _mm_setzero_ps();
+  __m128i index;
+  __m128 fraction;
+  if (lut->direction == SNLF_TRANSFER_DECODE) {
+    // max returns its second operand for NaN
+    const __m128 t = _mm_mul_ps(_mm_min_ps(_mm_max_ps(value, zero), _mm_set1_ps(1.F)), _mm_set1_ps((float)lut->count));
+    index = _mm_cvttps_epi32(t);
+    fraction = _mm_sub_ps(t, _mm_cvtepi32_ps(index));
+  } else {
+    value = _mm_mul_ps(value, _mm_set1_ps(lut->scale));
+    const __m128 lowest = _mm_set1_ps(SNLF_TRANSFER_LUT_LOWEST);
+    const __m128 clamped = _mm_min_ps(_mm_max_ps(value, lowest), _mm_set1_ps(1.F));
+    const __m128i bits = _mm_sub_epi32(_mm_castps_si128(clamped), _mm_castps_si128(lowest));
+    index = _mm_srl_epi32(bits, _mm_cvtsi32_si128((int)lut->shift));
+    fraction = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(bits, _mm_set1_epi32((int)((1U << lut->shift) - 1)))), _mm_set1_ps(lut->fractionScale));
+  }
+  
+  const float *e0 = lut->entries + _mm_cvtsi128_si32(index);
+  const float *e1 = lut->entries + _mm_extract_epi32(index, 1);
+  const float *e2 = lut->entries + _mm_extract_epi32(index, 2);
+  const float *e3 = lut->entries + _mm_extract_epi32(index, 3);
+  const __m128 low = _mm_setr_ps(e0[0], e1[0], e2[0], e3[0]);
+  const __m128 high = _mm_setr_ps(e0[1], e1[1], e2[1], e3[1]);
+  const __m128 result = _mm_add_ps(low, _mm_mul_ps(_mm_sub_ps(high, low), fraction));
+  if (lut->direction == SNLF_TRANSFER_DECODE) {
+    return result;
+  }
+  
+  const __m128 below = _mm_cmpnge_ps(value, _mm_set1_ps(SNLF_TRANSFER_LUT_LOWEST));
+  return _mm_blendv_ps(result, _mm_mul_ps(_mm_max_ps(value, zero), _mm_set1_ps(lut->lowSlope)), below);
+}
+#elif defined(_SIMD_ARM_NEON)
+#define SNLF_TRANSFER_LUT_SIMD 1
+
+static inline float32x4_t SnlfTransferLUTEvaluate4(const SnlfTransferLUT *lut, float32x4_t value) {
+  // NEON min and max propagate NaN, which would make an index out of bounds
+  const float32x4_t zero = vdupq_n_f32(0.F);
+  value = vbslq_f32(vceqq_f32(value, value), value, zero);
+  
+  uint32x4_t index;
+  float32x4_t fraction;
+  if (lut->direction == SNLF_TRANSFER_DECODE) {
+    const float32x4_t t = vmulq_n_f32(vminq_f32(vmaxq_f32(value, zero), vdupq_n_f32(1.F)), (float)lut->count);
+    index = vcvtq_u32_f32(t);
+    fraction = vsubq_f32(t, vcvtq_f32_u32(index));
+  } else {
+    value = vmulq_n_f32(value, lut->scale);
+    const float32x4_t lowest = vdupq_n_f32(SNLF_TRANSFER_LUT_LOWEST);
+    const float32x4_t clamped = vminq_f32(vmaxq_f32(value, lowest), vdupq_n_f32(1.F));
+    const uint32x4_t bits = vsubq_u32(vreinterpretq_u32_f32(clamped), vreinterpretq_u32_f32(lowest));
+    index = vshlq_u32(bits, vdupq_n_s32(-(int32_t)lut->shift));
+    fraction = vmulq_n_f32(vcvtq_f32_u32(vandq_u32(bits, vdupq_n_u32((1U << lut->shift) - 1))), lut->fractionScale);
+  }
+  
+  const float *e0 = lut->entries + vgetq_lane_u32(index, 0);
+  const float *e1 = lut->entries + vgetq_lane_u32(index, 1);
+  const float *e2 = lut->entries + vgetq_lane_u32(index, 2);
+  const float *e3 = lut->entries + vgetq_lane_u32(index, 3);
+  const float lows[4] = { e0[0], e1[0], e2[0], e3[0] };
+  const float highs[4] = { e0[1], e1[1], e2[1], e3[1] };
+  const float32x4_t low = vld1q_f32(lows);
+  const float32x4_t result = vmlaq_f32(low, vsubq_f32(vld1q_f32(highs), low), fraction);
+  if (lut->direction == SNLF_TRANSFER_DECODE) {
+    return result;
+  }
+  
+  const uint32x4_t below = vcltq_f32(value, vdupq_n_f32(SNLF_TRANSFER_LUT_LOWEST));
+  return vbslq_f32(below, vmulq_n_f32(vmaxq_f32(value, zero), lut->lowSlope), result);
+}
+#endif
+
+// ---
+// Tone mapper
+// ---
+// Histogram bins of maxRGB: 2^SNLF_LUMINANCE_HISTOGRAM_BIN_BITS per octave from 2^-8 of reference white
+// (0.8 cd/m2) up to 2^6 (13000 cd/m2). Lower light falls into the first bin, higher light into the last.
+#define SNLF_LUMINANCE_HISTOGRAM_MIN_EXPONENT (-8)
+#define SNLF_LUMINANCE_HISTOGRAM_OCTAVES      14
+#define SNLF_LUMINANCE_HISTOGRAM_BIN_BITS     3
+#define SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT    (SNLF_LUMINANCE_HISTOGRAM_OCTAVES << SNLF_LUMINANCE_HISTOGRAM_BIN_BITS)
+#define SNLF_LUMINANCE_HISTOGRAM_LOWEST       0.00390625F // 2^-8
+
+// Conversions read curve while the next one is built into the other buffer, which SnlfToneMapperEndFrame
+// swaps in between frames.
+struct _SnlfToneMapper {
+  SnlfToneMappingParameters parameters;         // Of curve
+  SnlfToneMappingParameters pendingParameters;  // Of the other buffer, when pending
+  float metadataPeakLuminance;  // cd/m2 of the source peak from the HDR10 metadata
+  float blackLuminance;         // cd/m2 of the source black from the HDR10 metadata
+  bool dynamic;
+  bool pending;                 // The other buffer holds a curve for the next frame
+  SnlfTransferLUT *curves[2];
+  SnlfTransferLUT *curve;       // Encode grid of maxRGB to tone-mapped maxRGB, one of curves
+  osutil_atomic_int32_t histogram[SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT];
+};
+
+static inline uint32_t SnlfLuminanceHistogramGetBin(float value) {
+  // Same float bit trick as the encode LUT; NaN falls into the first bin
+  const float lowest = SNLF_LUMINANCE_HISTOGRAM_LOWEST;
+  const float clamped = value > lowest ? value : lowest;
+  uint32_t bits, lowestBits;
+  memcpy(&bits, &clamped, sizeof(uint32_t));
+  memcpy(&lowestBits, &lowest, sizeof(uint32_t));
+  const uint32_t bin = (bits - lowestBits) >> (23 - SNLF_LUMINANCE_HISTOGRAM_BIN_BITS);
+  return bin < SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT ? bin : SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT - 1;
+}
+
+// Adds a histogram one row band counted on its own.
+void SnlfToneMapperMergeHistogram(SnlfToneMapperRef toneMapper, const uint32_t bins[SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT]);
+
+#endif // _SNLF_COLOR_MANAGEMENT_PRIVATE_H
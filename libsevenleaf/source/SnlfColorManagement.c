@@ -0,0 +1,283 @@
+#include "SnlfCore+Private.h"
+#include "SnlfColorManagement.h"
+
+#include <assert.h>
+
+#define LOCK()   pthread_mutex_lock(&gColorTransformMutex)
+#define UNLOCK() pthread_mutex_unlock(&gColorTransformMutex)
+
+// ---
+// Color primaries
+// ---
+static const struct _SnlfColorPrimariesList {
+  SnlfColorPrimariesType type;
+  SnlfColorPrimaries descriptor;
+} snlfColorPrimariesList[] = {
+  { SNLF_CP_BT709,           {{ 0.640   , 0.330    }, { 0.300   , 0.600    }, { 0.150   ,  0.060    }, { 0.3127  , 0.3290   }}},
+  { SNLF_CP_NTSC,            {{ 0.67    , 0.33     }, { 0.21    , 0.71     }, { 0.14    ,  0.08     }, { 0.3127  , 0.3290   }}},
+  { SNLF_CP_BT470BG,         {{ 0.64    , 0.33     }, { 0.29    , 0.60     }, { 0.15    ,  0.06     }, { 0.3127  , 0.3290   }}},
+  { SNLF_CP_BT601,           {{ 0.630   , 0.340    }, { 0.310   , 0.595    }, { 0.155   ,  0.070    }, { 0.3127  , 0.3290   }}},
+  { SNLF_CP_SMPTE240M,       {{ 0.630   , 0.340    }, { 0.310   , 0.595    }, { 0.155   ,  0.070    }, { 0.3127  , 0.3290   }}},
+  { SNLF_CP_FILM,            {{ 0.681   , 0.319    }, { 0.243   , 0.692    }, { 0.145   ,  0.049    }, { 0.310   , 0.316    }}},
+  { SNLF_CP_BT2020,          {{ 0.708   , 0.292    }, { 0.170   , 0.797    }, { 0.131   ,  0.046    }, { 0.3127  , 0.3290   }}},
+  { SNLF_CP_CIE1931XYZ,      {{ 1.0     , 0.0      }, { 0.0     , 1.0      }, { 0.0     ,  0.0      }, { 1.0 / 3 , 1.0 / 3  }}},
+  { SNLF_CP_DCIP3,           {{ 0.680   , 0.320    }, { 0.265   , 0.690    }, { 0.150   ,  0.060    }, { 0.314   , 0.351    }}},
+  { SNLF_CP_DCIP3_D65,       {{ 0.680   , 0.320    }, { 0.265   , 0.690    }, { 0.150   ,  0.060    }, { 0.3127  , 0.3290   }}},
+  { SNLF_CP_JEDEC_P22,       {{ 0.630   , 0.340    }, { 0.295   , 0.605    }, { 0.155   ,  0.077    }, { 0.3127  , 0.3290   }}},
+  { SNLF_CP_NTSC_FCC,        {{ 0.67    , 0.33     }, { 0.21    , 0.71     }, { 0.14    ,  0.08     }, { 0.310   , 0.316    }}},
+  { SNLF_CP_NTSC_J,          {{ 0.67    , 0.33     }, { 0.21    , 0.71     }, { 0.14    ,  0.08     }, { 0.2831  , 0.2970   }}},
+  { SNLF_CP_DCIP3_D60,       {{ 0.680   , 0.320    }, { 0.265   , 0.690    }, { 0.150   ,  0.060    }, { 0.3217  , 0.3378   }}},
+  { SNLF_CP_DCIP3_PLUS,      {{ 0.740   , 0.270    }, { 0.220   , 0.780    }, { 0.090   , -0.090    }, { 0.314   , 0.351    }}},
+  { SNLF_CP_ACES2065,        {{ 0.7347  , 0.2653   }, { 0.0     , 1.0      }, { 0.0001  , -0.0770   }, { 0.32168 , 0.33767  }}},
+  { SNLF_CP_ADOBE_RGB,       {{ 0.6400  , 0.3300   }, { 0.2100  , 0.7100   }, { 0.1500  ,  0.0600   }, { 0.3127  , 0.3290   }}},
+  { SNLF_CP_PRO_PHOTO,       {{ 0.734699, 0.265301 }, { 0.159597, 0.840403 }, { 0.036598,  0.000105 }, { 0.345704, 0.358540 }}},
+  { SNLF_CP_WIDE_GAMUT_RGB,  {{ 0.7347  , 0.2653   }, { 0.1152  , 0.8264   }, { 0.1566  ,  0.0177   }, { 0.3457  , 0.3585   }}},
+};
+
+static inline const SnlfColorPrimaries *SnlfColorPrimariesFind(SnlfColorPrimariesType type) {
+  for (size_t i = 0; i < sizeof(snlfColorPrimariesList) / sizeof(snlfColorPrimariesList[0]); ++i) {
+    if (snlfColorPrimariesList[i].type == type) {
+      return &snlfColorPrimariesList[i].descriptor;
+    }
+  }
+  return NULL;
+}
+
+void SnlfGetColorPrimaries(SnlfColorPrimariesType type, SnlfColorPrimaries *colorPrimaries) {
+  assert(colorPrimaries);
+  
+  const SnlfColorPrimaries *primaries = SnlfColorPrimariesFind(type);
+  *colorPrimaries = primaries ? *primaries : *SnlfColorPrimariesFind(SNLF_CP_BT709);
+}
+
+static inline bool SnlfColorPrimaryEqual(SnlfColorPrimary a, SnlfColorPrimary b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+static inline bool SnlfColorPrimariesEqual(const SnlfColorPrimaries *a, const SnlfColorPrimaries *b) {
+  return SnlfColorPrimaryEqual(a->redPrimary, b->redPrimary)
+    && SnlfColorPrimaryEqual(a->greenPrimary, b->greenPrimary)
+    && SnlfColorPrimaryEqual(a->bluePrimary, b->bluePrimary)
+    && SnlfColorPrimaryEqual(a->whitePoint, b->whitePoint);
+}
+
+// ---
+// Matrix helpers
+// ---
+static inline void SnlfMatrix3Multiply(const double a[9], const double b[9], double result[9]) {
+  double product[9];
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      product[3 * i + j] = a[3 * i] * b[j] + a[3 * i + 1] * b[3 + j] + a[3 * i + 2] * b[6 + j];
+    }
+  }
+  memcpy(result, product, sizeof(product));
+}
+
+// Returns true when the matrix is singular.
+static inline bool SnlfMatrix3Invert(const double m[9], double result[9]) {
+  const double c0 = m[4] * m[8] - m[5] * m[7];
+  const double c1 = m[5] * m[6] - m[3] * m[8];
+  const double c2 = m[3] * m[7] - m[4] * m[6];
+  const double determinant = m[0] * c0 + m[1] * c1 + m[2] * c2;
+  if (determinant == 0.0) {
+    return true;
+  }
+  
+  const double inverse = 1.0 / determinant;
+  const double adjugate[9] = {
+    c0, m[2] * m[7] - m[1] * m[8], m[1] * m[5] - m[2] * m[4],
+    c1, m[0] * m[8] - m[2] * m[6], m[2] * m[3] - m[0] * m[5],
+    c2, m[1] * m[6] - m[0] * m[7], m[0] * m[4] - m[1] * m[3],
+  };
+  for (size_t i = 0; i < 9; ++i) {
+    result[i] = adjugate[i] * inverse;
+  }
+  return false;
+}
+
+static inline void SnlfMatrix3ToFloat(const double m[9], float matrix[9]) {
+  for (size_t i = 0; i < 9; ++i) {
+    matrix[i] = (float)m[i];
+  }
+}
+
+// XYZ with Y = 1. Returns true when the chromaticity has no luminance.
+static inline bool SnlfColorPrimaryToXYZ(SnlfColorPrimary primary, double xyz[3]) {
+  if (primary.y == 0.F) {
+    return true;
+  }
+  
+  xyz[0] = (double)primary.x / primary.y;
+  xyz[1] = 1.0;
+  xyz[2] = (1.0 - primary.x - primary.y) / primary.y;
+  return false;
+}
+
+// ---
+// Matrices
+// ---
+static bool SnlfColorPrimariesGetRGBToXYZ(const SnlfColorPrimaries *primaries, double matrix[9]) {
+  // CIE 1931 XYZ has two primaries without luminance
+  if (SnlfColorPrimariesEqual(primaries, SnlfColorPrimariesFind(SNLF_CP_CIE1931XYZ))) {
+    const double identity[9] = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+    memcpy(matrix, identity, sizeof(identity));
+    return false;
+  }
+  
+  double red[3], green[3], blue[3], white[3];
+  if (SnlfColorPrimaryToXYZ(primaries->redPrimary, red)
+      || SnlfColorPrimaryToXYZ(primaries->greenPrimary, green)
+      || SnlfColorPrimaryToXYZ(primaries->bluePrimary, blue)
+      || SnlfColorPrimaryToXYZ(primaries->whitePoint, white)) {
+    return true;
+  }
+  
+  // Scale the primaries so that they add up to the white point
+  const double unscaled[9] = {
+    red[0], green[0], blue[0],
+    red[1], green[1], blue[1],
+    red[2], green[2], blue[2],
+  };
+  double inverse[9];
+  if (SnlfMatrix3Invert(unscaled, inverse)) {
+    return true;
+  }
+  for (size_t j = 0; j < 3; ++j) {
+    const double scale = inverse[3 * j] * white[0] + inverse[3 * j + 1] * white[1] + inverse[3 * j + 2] * white[2];
+    for (size_t i = 0; i < 3; ++i) {
+      matrix[3 * i + j] = unscaled[3 * i + j] * scale;
+    }
+  }
+  return false;
+}
+
+static bool SnlfGetBradfordAdaptation(SnlfColorPrimary sourceWhitePoint, SnlfColorPrimary destinationWhitePoint, double matrix[9]) {
+  static const double bradford[9] = {
+     0.8951,  0.2664, -0.1614,
+    -0.7502,  1.7135,  0.0367,
+     0.0389, -0.0685,  1.0296,
+  };
+  
+  double source[3], destination[3];
+  if (SnlfColorPrimaryToXYZ(sourceWhitePoint, source)
+      || SnlfColorPrimaryToXYZ(destinationWhitePoint, destination)) {
+    return true;
+  }
+  
+  // Scale the cone responses of the source white onto those of the destination white
+  double scale[9] = { 0.0 };
+  for (size_t i = 0; i < 3; ++i) {
+    const double sourceCone = bradford[3 * i] * source[0] + bradford[3 * i + 1] * source[1] + bradford[3 * i + 2] * source[2];
+    const double destinationCone = bradford[3 * i] * destination[0] + bradford[3 * i + 1] * destination[1] + bradford[3 * i + 2] * destination[2];
+    scale[4 * i] = destinationCone / sourceCone;
+  }
+  
+  double inverse[9];
+  SnlfMatrix3Invert(bradford, inverse);
+  SnlfMatrix3Multiply(scale, bradford, matrix);
+  SnlfMatrix3Multiply(inverse, matrix, matrix);
+  return false;
+}
+
+bool SnlfColorPrimariesGetRGBToXYZMatrix(const SnlfColorPrimaries *primaries, float matrix[9]) {
+  assert(primaries);
+  assert(matrix);
+  
+  double rgbToXYZ[9];
+  if (SnlfColorPrimariesGetRGBToXYZ(primaries, rgbToXYZ)) {
+    return true;
+  }
+  SnlfMatrix3ToFloat(rgbToXYZ, matrix);
+  return false;
+}
+
+bool SnlfGetBradfordAdaptationMatrix(SnlfColorPrimary sourceWhitePoint, SnlfColorPrimary destinationWhitePoint, float matrix[9]) {
+  assert(matrix);
+  
+  double adaptation[9];
+  if (SnlfGetBradfordAdaptation(sourceWhitePoint, destinationWhitePoint, adaptation)) {
+    return true;
+  }
+  SnlfMatrix3ToFloat(adaptation, matrix);
+  return false;
+}
+
+// ---
+// Color transform
+// ---
+typedef struct {
+  SnlfColorPrimaries source;
+  SnlfColorPrimaries destination;
+  SnlfColorTransform transform;
+} SnlfColorTransformCacheEntry;
+
+static pthread_mutex_t gColorTransformMutex = PTHREAD_MUTEX_INITIALIZER;
+static SnlfColorTransformCacheEntry gColorTransforms[SNLF_COLOR_TRANSFORM_CACHE_COUNT];
+static size_t gColorTransformCount = 0;
+static size_t gColorTransformNext = 0;
+
+static bool SnlfColorTransformBuild(SnlfColorTransform *transform, const SnlfColorPrimaries *source, const SnlfColorPrimaries *destination) {
+  double sourceToXYZ[9], destinationToXYZ[9], xyzToDestination[9], adaptation[9];
+  if (SnlfColorPrimariesGetRGBToXYZ(source, sourceToXYZ)
+      || SnlfColorPrimariesGetRGBToXYZ(destination, destinationToXYZ)
+      || SnlfMatrix3Invert(destinationToXYZ, xyzToDestination)
+      || SnlfGetBradfordAdaptation(source->whitePoint, destination->whitePoint, adaptation)) {
+    return true;
+  }
+  
+  double matrix[9];
+  SnlfMatrix3Multiply(adaptation, sourceToXYZ, matrix);
+  SnlfMatrix3Multiply(xyzToDestination, matrix, matrix);
+  SnlfMatrix3ToFloat(matrix, transform->matrix);
+  transform->identity = false;
+  return false;
+}
+
+bool SnlfColorTransformInit(SnlfColorTransform *transform, const SnlfColorPrimaries *source, const SnlfColorPrimaries *destination) {
+  assert(transform);
+  assert(source);
+  assert(destination);
+  
+  if (SnlfColorPrimariesEqual(source, destination)) {
+    const float identity[9] = { 1.F, 0.F, 0.F, 0.F, 1.F, 0.F, 0.F, 0.F, 1.F };
+    memcpy(transform->matrix, identity, sizeof(identity));
+    transform->identity = true;
+    return false;
+  }
+  
+  if (LOCK()) {
+    SnlfMutexLockError();
+    return SnlfColorTransformBuild(transform, source, destination);
+  }
+  
+  for (size_t i = 0; i < gColorTransformCount; ++i) {
+    const SnlfColorTransformCacheEntry *entry = gColorTransforms + i;
+    if (SnlfColorPrimariesEqual(&entry->source, source) && SnlfColorPrimariesEqual(&entry->destination, destination)) {
+      *transform = entry->transform;
+      UNLOCK();
+      return false;
+    }
+  }
+  
+  if (SnlfColorTransformBuild(transform, source, destination)) {
+    UNLOCK();
+    SnlfErrorLog("Degenerate color primaries.");
+    return true;
+  }
+  
+  // Replaces the oldest entry once the cache is full
+  SnlfColorTransformCacheEntry *entry = gColorTransforms + gColorTransformNext;
+  entry->source = *source;
+  entry->destination = *destination;
+  entry->transform = *transform;
+  gColorTransformNext = (gColorTransformNext + 1) % SNLF_COLOR_TRANSFORM_CACHE_COUNT;
+  if (gColorTransformCount < SNLF_COLOR_TRANSFORM_CACHE_COUNT) {
+    ++gColorTransformCount;
+  }
+  
+  if (UNLOCK()) {
+    SnlfMutexUnlockError();
+  }
+  return false;
+}
@@ -3,6 +3,7 @@
 
 #include "SnlfLog.h"
 #include "SnlfCore.h"
+#include "SnlfEpoch.h"
 #include "SnlfMessage.h"
 #include "SnlfUtils+Private.h"
 
@@ -60,18 +61,74 @@ typedef struct _SnlfArrayChangedBag {
   intptr_t param;
 } SnlfArrayChangedBag;
 
+// ---
+// Graphics statistics
+// ---
+typedef struct {
+  duration_t stages[SNLF_FRAME_STAGE_COUNT];
+} SnlfFrameTiming;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  uint64_t frameCount, droppedFrameCount, lateFrameCount;
+  uint64_t timingCount;
+  SnlfFrameTiming timings[SNLF_GRAPHICS_STATISTICS_WINDOW];
+} SnlfGraphicsStatisticsData;
+
+// ---
+// Jobs
+// ---
+typedef struct {
+  SnlfRowJobFunction function;
+  intptr_t param;
+  uint32_t firstRow, rowCount;
+  uint64_t affinityMask;
+  SnlfJobCounter *counter;
+} SnlfJobBand;
+
+typedef struct _SnlfJobPool SnlfJobPool;
+
+typedef struct {
+  SnlfJobPool *pool;
+  pthread_t thread;
+  uint32_t logicalCore;
+} SnlfJobWorker;
+
+struct _SnlfJobPool {
+  pthread_mutex_t mutex;
+  pthread_cond_t workCond;  // Bands were queued or the pool is stopping
+  pthread_cond_t doneCond;  // A counter reached zero
+  bool active;
+  size_t bandCount, bandCapacity;
+  SnlfJobBand *bands;
+  size_t bandBytes;
+  uint64_t workerMask;      // Logical cores with a worker
+  uint64_t defaultMask;
+  uint32_t workerCount;
+  SnlfJobWorker workers[SNLF_JOB_WORKER_COUNT_MAX];
+};
+
 // ---
 // Core
 // ---
 struct _SnlfCore {
   SNLF_ARRAY(SnlfModuleRef) modules;
   
+  // Messages
+  SnlfMessageArena messageArena;
+  
+  // Jobs
+  SnlfJobPool jobPool;
+  
   // Graphics
   CpsrDevice *device;
   pthread_mutex_t videoThreadMutex;
   bool videoActive;
   pthread_t videoThread;
   SnlfGraphicsThreadContext *graphicsThreadContext;
+  SnlfGraphicsStatisticsData graphicsStatistics;
+  osutil_atomic_int32_t lateFramePolicy;
+  osutil_atomic_int32_t catchUpBudget;
   
   // Generators
   SNLF_ARRAY(SnlfGraphicsGeneratorRef) graphicsGenerators;
@@ -89,6 +146,7 @@ struct _SnlfCore {
   
   // Sources
   pthread_mutex_t sourceMutex;
+  SnlfEpoch sourceEpoch;  // Reclaims source snapshots
   SNLF_ARRAY(SnlfSourceRef) sources;
   SNLF_ARRAY(SnlfArrayChangedBag *) sourceHandlers;
   
@@ -99,6 +157,10 @@ struct _SnlfCore {
   pthread_t displayThread;
 };
 
+bool SnlfCoreInitForMessages(SnlfCoreRef core);
+bool SnlfCoreUninitForMessages(SnlfCoreRef core);
+bool SnlfCoreInitForJobs(SnlfCoreRef core);
+bool SnlfCoreUninitForJobs(SnlfCoreRef core);
 bool SnlfCoreInitForGenerators(SnlfCoreRef core);
 bool SnlfCoreUninitForGenerators(SnlfCoreRef core);
 bool SnlfCoreInitForInputs(SnlfCoreRef core);
@@ -127,6 +189,7 @@ struct _SnlfObject {
 struct _SnlfInput {
   DEFINE_SNLF_OBJECT_COMMON_DATA;
   osutil_atomic_int32_t activeCount;
+  osutil_atomic_int64_t affinityMask;
   identifier_t          identifier;
   SnlfInputDescriptor   descriptor;
   intptr_t              context;
@@ -146,6 +209,13 @@ typedef enum {
   SNLF_SOURCE_SOUND_GENERATOR,    // SnlfSoundGeneratorRef
 } SnlfSourceType;
 
+// Immutable state the graphics thread reads without locking. Writers publish a new snapshot with an atomic
+// swap and retire the previous one through the core's source epoch.
+typedef struct {
+  matrix4x4_t transform;
+  int32_t revision;  // Incremented with every new snapshot
+} SnlfSourceSnapshot;
+
 struct _SnlfSource {
   DEFINE_SNLF_OBJECT_COMMON_DATA;
   identifier_t identifier;
@@ -169,7 +239,9 @@ struct _SnlfSource {
   
   // Graphics
   SnlfBoundsType boundsType;
-  matrix4x4_t transform;
+  osutil_atomic_intptr_t snapshot;         // SnlfSourceSnapshot *
+  osutil_atomic_int32_t contentRevision;   // Incremented after every change that alters how the source draws
+  osutil_atomic_int32_t cacheAsBitmap;     // bool. Render the subtree once and reuse it until it changes
   SNLF_ARRAY(SnlfGraphicsData *) graphicsData;
   SNLF_ARRAY(SnlfGraphicsTransformer *) backdropTransformers;
   SNLF_ARRAY(SnlfGraphicsTransformer *) userTransformers;
@@ -12,7 +12,9 @@ SnlfCoreRef SnlfCoreInit(SnlfCoreStartupArgs args) {
   SnlfArrayInit(core->modules);
   
   // Init
-  if (SnlfCoreInitForGenerators(core)
+  if (SnlfCoreInitForMessages(core)
+      || SnlfCoreInitForJobs(core)
+      || SnlfCoreInitForGenerators(core)
       || SnlfCoreInitForInputs(core)
       || SnlfCoreInitForTransition(core)
       || SnlfCoreInitForSources(core)
@@ -43,5 +45,7 @@ void SnlfCoreUninit(SnlfCoreRef core) {
   SnlfCoreUninitForTransition(core);
   SnlfCoreUninitForInputs(core);
   SnlfCoreUninitForGenerators(core);
+  SnlfCoreUninitForJobs(core);
+  SnlfCoreUninitForMessages(core);
   SnlfDealloc(core);
 }
@@ -197,6 +197,30 @@ void SnlfDisplayEndDraw(SnlfDisplay *display) {
   }
 }
 
+int SnlfDisplayGetSharedMemoryFileDescriptor(SnlfDisplay *display) {
+  assert(display);
+  
+#ifdef __linux__
+  if (LOCK(display->core)) {
+    SnlfMutexLockError();
+    return -1;
+  }
+  
+  // The swap chain is created by the first draw after BeginDraw
+  int fd = -1;
+  if (!display->handle && display->swapChain) {
+    fd = CpsrSwapChainGetSharedMemoryFileDescriptor(display->swapChain);
+  }
+  
+  if (UNLOCK(display->core)) {
+    SnlfMutexUnlockError();
+  }
+  return fd;
+#else
+  return -1;
+#endif
+}
+
 // ---
 // Draw
 // ---
@@ -280,7 +304,14 @@ void SnlfDisplayMain(SnlfDisplayContext *displayContext) {
       viewHost.pixelFormat = display->pixelFormat;
       viewHost.size = display->size;
       
+#ifdef __linux__
+      // A display without a view is a headless preview; present into a shared-memory ring a monitor can map
+      CpsrSwapChain *swapChain = display->handle
+        ? CpsrSwapChainCreate(displayContext->graphicsContext->commandQueue, viewHost, 2, false)
+        : CpsrSwapChainCreateOffscreen(displayContext->graphicsContext->commandQueue, display->size, display->pixelFormat, SNLF_PREVIEW_FRAME_COUNT);
+#else
       CpsrSwapChain *swapChain = CpsrSwapChainCreate(displayContext->graphicsContext->commandQueue, viewHost, 2, false);
+#endif
       CpsrSwapChainSetColorSpace(swapChain, CPSR_COLORSPACE_BT709);
       
       display->swapChain = swapChain;
@@ -305,14 +336,12 @@ void SnlfDisplayMain(SnlfDisplayContext *displayContext) {
   }
 }
 
-void SnlfDisplayMainFromGraphicsThreadContext(const SnlfGraphicsThreadContext *graphicsThreadContext) {
+void SnlfDisplayMainFromGraphicsContext(SnlfCoreRef core, const SnlfGraphicsContext *graphicsContext, size_t renderTargetIndex) {
   SnlfDisplayContext displayContext;
-  displayContext.core = graphicsThreadContext->core;
+  displayContext.core = core;
   displayContext.display = NULL;
-  
-  const SnlfGraphicsContext *graphicsContext = &graphicsThreadContext->graphics;
   displayContext.graphicsContext = graphicsContext;
-  displayContext.sourceTexture = graphicsContext->renderTargets[graphicsContext->renderTargetCurrentIndex];
+  displayContext.sourceTexture = graphicsContext->renderTargets[renderTargetIndex];
   
   SnlfDisplayMain(&displayContext);
 }
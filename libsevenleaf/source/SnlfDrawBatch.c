@@ -0,0 +1,86 @@
+#include "SnlfGraphics+Private.h"
+
+// ---
+// Draw Batch
+// ---
+void SnlfDrawBatchInit(SnlfDrawBatch *batch) {
+  assert(batch);
+  memset(batch, 0, sizeof(SnlfDrawBatch));
+}
+
+void SnlfDrawBatchUninit(SnlfDrawBatch *batch) {
+  assert(batch);
+  SnlfDealloc(batch->data);
+  memset(batch, 0, sizeof(SnlfDrawBatch));
+}
+
+void SnlfDrawBatchFlush(SnlfDrawBatch *batch, const SnlfGraphicsContext *context) {
+  assert(batch);
+  assert(context);
+  
+  if (!batch->instanceCount) {
+    return;
+  }
+  
+  const uint32_t instanceCount = batch->instanceCount;
+  batch->instanceCount = 0;
+  
+  const size_t size = (size_t)batch->instanceSize * instanceCount;
+  SnlfGraphicsConstants instances;
+  if (SnlfGraphicsContextAllocateConstants(context, size, &instances)) {
+    return;
+  }
+  memcpy(instances.data, batch->data, size);
+  
+  SnlfRenderPass *renderPass = context->renderPass;
+  SnlfRenderPassBegin(renderPass, batch->renderTarget);
+  if (!_SnlfRenderPassSetPipelineState(renderPass, batch->pipelineState)) {
+    _SnlfRenderPassSetVertexBuffer(renderPass, 0, context->planeVertexBuffer);
+    _SnlfRenderPassSetConstantBufferWithOffset(renderPass, 0, instances.buffer, instances.offset);
+    if (batch->texture) {
+      _SnlfRenderPassSetTexture(renderPass, 0, batch->texture);
+    }
+    _SnlfRenderPassSetPrimitiveTopology(renderPass, CPSR_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
+    SnlfRenderPassDrawInstanced(renderPass, 0, 4, instanceCount);
+  }
+}
+
+bool SnlfGraphicsContextSubmitDrawItem(const SnlfGraphicsContext *context, const CpsrTexture2D *renderTarget, const SnlfGraphicsDrawItem *item) {
+  assert(context);
+  assert(renderTarget);
+  assert(item && item->pipelineState && item->instance && item->instanceSize);
+  
+  SnlfDrawBatch *batch = context->drawBatch;
+  if (!batch) {
+    return true;
+  }
+  
+  // Merge only into a batch drawn with the same pipeline, instance layout, texture and render target
+  if (batch->instanceCount
+      && (batch->pipelineState != item->pipelineState
+          || batch->instanceSize != item->instanceSize
+          || batch->texture != item->texture
+          || batch->renderTarget != renderTarget
+          || batch->instanceCount == SNLF_DRAW_BATCH_MAX_INSTANCES)) {
+    SnlfDrawBatchFlush(batch, context);
+  }
+  
+  const size_t capacity = (size_t)item->instanceSize * SNLF_DRAW_BATCH_MAX_INSTANCES;
+  if (batch->dataCapacity < capacity) {
+    uint8_t *data = (uint8_t *)realloc(batch->data, capacity);
+    if (!data) {
+      SnlfOutOfMemoryError();
+      return true;
+    }
+    batch->data = data;
+    batch->dataCapacity = capacity;
+  }
+  
+  batch->pipelineState = item->pipelineState;
+  batch->texture = item->texture;
+  batch->renderTarget = renderTarget;
+  batch->instanceSize = item->instanceSize;
+  memcpy(batch->data + (size_t)item->instanceSize * batch->instanceCount, item->instance, item->instanceSize);
+  ++batch->instanceCount;
+  return false;
+}
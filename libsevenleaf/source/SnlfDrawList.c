@@ -0,0 +1,662 @@
+#include "SnlfGraphics+Private.h"
+
+#define SNLF_DRAW_LIST_INITIAL_CAPACITY 16
+
+// ---
+// Draw List
+// ---
+void SnlfDrawListInit(SnlfDrawList *drawList, SnlfTexturePool *texturePool) {
+  assert(drawList);
+  assert(texturePool);
+  memset(drawList, 0, sizeof(SnlfDrawList));
+  drawList->dirty = true;
+  drawList->texturePool = texturePool;
+}
+
+static inline bool SnlfDrawListGrow(void **array, size_t itemSize, size_t capacity) {
+  void *newArray = realloc(*array, itemSize * capacity);
+  if (!newArray) {
+    return true;
+  }
+  *array = newArray;
+  return false;
+}
+
+// Returns the textures of the current caches to the pool.
+static inline void SnlfDrawListReleaseCaches(SnlfDrawList *drawList) {
+  for (size_t i = 0; i < drawList->cacheCount; ++i) {
+    CpsrTexture2D *texture = drawList->caches[i].texture;
+    if (texture) {
+      SnlfTexturePoolRelease(drawList->texturePool, texture);
+    }
+  }
+  drawList->cacheCount = 0;
+}
+
+void SnlfDrawListUninit(SnlfDrawList *drawList) {
+  assert(drawList);
+  SnlfDrawListReleaseCaches(drawList);
+  
+  SnlfDealloc(drawList->nodeParents);
+  SnlfDealloc(drawList->nodeSources);
+  SnlfDealloc(drawList->nodeWorlds);
+  SnlfDealloc(drawList->nodeRevisions);
+  SnlfDealloc(drawList->nodeContentRevisions);
+  SnlfDealloc(drawList->nodeDirty);
+  SnlfDealloc(drawList->nodeChanged);
+  SnlfDealloc(drawList->itemNodes);
+  SnlfDealloc(drawList->itemGenerators);
+  SnlfDealloc(drawList->itemContexts);
+  SnlfDealloc(drawList->itemVisible);
+  SnlfDealloc(drawList->caches);
+  SnlfDealloc(drawList->shareds);
+  SnlfDealloc(drawList->targets);
+  memset(drawList, 0, sizeof(SnlfDrawList));
+}
+
+int32_t SnlfDrawListAppendNode(SnlfDrawList *drawList, int32_t parent, SnlfSourceRef source) {
+  assert(drawList);
+  assert(parent < (int32_t)drawList->nodeCount);
+  
+  if (drawList->nodeCount == drawList->nodeCapacity) {
+    const size_t capacity = drawList->nodeCapacity ? 2 * drawList->nodeCapacity : SNLF_DRAW_LIST_INITIAL_CAPACITY;
+    if (SnlfDrawListGrow((void **)&drawList->nodeParents, sizeof(int32_t), capacity)
+        || SnlfDrawListGrow((void **)&drawList->nodeSources, sizeof(SnlfSourceRef), capacity)
+        || SnlfDrawListGrow((void **)&drawList->nodeWorlds, sizeof(matrix4x4_t), capacity)
+        || SnlfDrawListGrow((void **)&drawList->nodeRevisions, sizeof(int32_t), capacity)
+        || SnlfDrawListGrow((void **)&drawList->nodeContentRevisions, sizeof(int32_t), capacity)
+        || SnlfDrawListGrow((void **)&drawList->nodeDirty, sizeof(bool), capacity)
+        || SnlfDrawListGrow((void **)&drawList->nodeChanged, sizeof(bool), capacity)) {
+      SnlfOutOfMemoryError();
+      return -1;
+    }
+    drawList->nodeCapacity = capacity;
+  }
+  
+  const size_t node = drawList->nodeCount++;
+  drawList->nodeParents[node] = parent;
+  drawList->nodeSources[node] = source;
+  drawList->nodeContentRevisions[node] = osutil_atomic_load32(&source->contentRevision);
+  return (int32_t)node;
+}
+
+bool SnlfDrawListAppendItem(SnlfDrawList *drawList, int32_t node, SnlfGraphicsGeneratorRef generator, intptr_t context) {
+  assert(drawList);
+  assert(node >= 0 && node < (int32_t)drawList->nodeCount);
+  
+  if (drawList->itemCount == drawList->itemCapacity) {
+    const size_t capacity = drawList->itemCapacity ? 2 * drawList->itemCapacity : SNLF_DRAW_LIST_INITIAL_CAPACITY;
+    if (SnlfDrawListGrow((void **)&drawList->itemNodes, sizeof(uint32_t), capacity)
+        || SnlfDrawListGrow((void **)&drawList->itemGenerators, sizeof(SnlfGraphicsGeneratorRef), capacity)
+        || SnlfDrawListGrow((void **)&drawList->itemContexts, sizeof(intptr_t), capacity)
+        || SnlfDrawListGrow((void **)&drawList->itemVisible, sizeof(bool), capacity)) {
+      SnlfOutOfMemoryError();
+      return true;
+    }
+    drawList->itemCapacity = capacity;
+  }
+  
+  const size_t item = drawList->itemCount++;
+  drawList->itemNodes[item] = (uint32_t)node;
+  drawList->itemGenerators[item] = generator;
+  drawList->itemContexts[item] = context;
+  drawList->itemVisible[item] = true;
+  if (drawList->compilingCache && generator && !(generator->isStatic && generator->isStatic(context))) {
+    drawList->caches[drawList->cacheCount].animated = true;
+  }
+  return false;
+}
+
+// Appends an item compositing the shared render of source. The first reference to a source registers data to
+// be compiled after the main tree.
+bool SnlfDrawListAppendReference(SnlfDrawList *drawList, int32_t node, SnlfSourceRef source, SnlfGraphicsData *data) {
+  assert(drawList);
+  assert(source);
+  assert(data);
+  
+  size_t shared = 0;
+  while (shared < drawList->sharedCount && drawList->shareds[shared].source != source) {
+    ++shared;
+  }
+  if (shared == drawList->sharedCount) {
+    if (drawList->sharedCount == drawList->sharedCapacity) {
+      const size_t capacity = drawList->sharedCapacity ? 2 * drawList->sharedCapacity : 4;
+      if (SnlfDrawListGrow((void **)&drawList->shareds, sizeof(SnlfDrawListShared), capacity)) {
+        SnlfOutOfMemoryError();
+        return true;
+      }
+      drawList->sharedCapacity = capacity;
+    }
+    
+    SnlfDrawListShared *entry = drawList->shareds + drawList->sharedCount++;
+    entry->source = source;
+    entry->data = data;
+    entry->cache = -1;
+    entry->rendering = false;
+  }
+  
+  if (SnlfDrawListAppendItem(drawList, node, NULL, (intptr_t)shared)) {
+    return true;
+  }
+  if (drawList->compilingCache) {
+    drawList->caches[drawList->cacheCount].references = true;
+  }
+  return false;
+}
+
+// Starts a cache over the nodes and items appended until SnlfDrawListEndCache. Returns true when the subtree
+// cannot be cached by itself because it is nested in another cache or memory ran out.
+bool SnlfDrawListBeginCache(SnlfDrawList *drawList) {
+  assert(drawList);
+  
+  if (drawList->compilingCache) {
+    return true;
+  }
+  
+  if (drawList->cacheCount == drawList->cacheCapacity) {
+    const size_t capacity = drawList->cacheCapacity ? 2 * drawList->cacheCapacity : 4;
+    if (SnlfDrawListGrow((void **)&drawList->caches, sizeof(SnlfDrawListCache), capacity)) {
+      SnlfOutOfMemoryError();
+      return true;
+    }
+    drawList->cacheCapacity = capacity;
+  }
+  
+  SnlfDrawListCache *cache = drawList->caches + drawList->cacheCount;
+  cache->firstNode = (uint32_t)drawList->nodeCount;
+  cache->firstItem = (uint32_t)drawList->itemCount;
+  cache->texture = NULL;
+  cache->valid = false;
+  cache->references = false;
+  cache->animated = false;
+  drawList->compilingCache = true;
+  return false;
+}
+
+void SnlfDrawListEndCache(SnlfDrawList *drawList) {
+  assert(drawList);
+  assert(drawList->compilingCache);
+  
+  SnlfDrawListCache *cache = drawList->caches + drawList->cacheCount;
+  cache->nodeEnd = (uint32_t)drawList->nodeCount;
+  cache->itemEnd = (uint32_t)drawList->itemCount;
+  drawList->compilingCache = false;
+  
+  // A subtree without items has nothing to cache
+  if (cache->itemEnd > cache->firstItem) {
+    ++drawList->cacheCount;
+  }
+}
+
+void SnlfDrawListCompile(SnlfDrawList *drawList, SnlfGraphicsData *root) {
+  assert(drawList);
+  assert(root);
+  
+  SnlfDrawListReleaseCaches(drawList);
+  drawList->nodeCount = 0;
+  drawList->itemCount = 0;
+  drawList->sharedCount = 0;
+  drawList->dirty = false;
+  drawList->worldsDirty = true;
+  SnlfGraphicsDataCompile(root, drawList, -1);
+  drawList->mainNodeCount = drawList->nodeCount;
+  drawList->mainItemCount = drawList->itemCount;
+  
+  // Referenced sources compile once each, including those first referenced from a shared cache
+  for (size_t i = 0; i < drawList->sharedCount; ++i) {
+    if (SnlfDrawListBeginCache(drawList)) {
+      break;
+    }
+    
+    const size_t cache = drawList->cacheCount;
+    SnlfGraphicsDataCompile(drawList->shareds[i].data, drawList, -1);
+    SnlfDrawListEndCache(drawList);
+    drawList->shareds[i].cache = drawList->cacheCount > cache ? (int32_t)cache : -1;
+  }
+}
+
+// ---
+// Targets
+// ---
+// Returns the graphics data of source shared by every reference to it, creating it on the first acquire.
+SnlfGraphicsData *SnlfDrawListAcquireTarget(SnlfDrawList *drawList, SnlfSourceRef source, const SnlfGraphicsContext *context) {
+  assert(drawList);
+  assert(source);
+  
+  for (size_t i = 0; i < drawList->targetCount; ++i) {
+    SnlfDrawListTarget *target = drawList->targets + i;
+    if (target->source == source) {
+      if (!target->data) {
+        SnlfErrorLog("A reference source references itself while its graphics data initializes.");
+        return NULL;
+      }
+      ++target->referenceCount;
+      return target->data;
+    }
+  }
+  
+  if (drawList->targetCount == drawList->targetCapacity) {
+    const size_t capacity = drawList->targetCapacity ? 2 * drawList->targetCapacity : 4;
+    if (SnlfDrawListGrow((void **)&drawList->targets, sizeof(SnlfDrawListTarget), capacity)) {
+      SnlfOutOfMemoryError();
+      return NULL;
+    }
+    drawList->targetCapacity = capacity;
+  }
+  
+  // The entry is listed while the graphics data initializes, so a reference back into the source is caught
+  SnlfDrawListTarget *target = drawList->targets + drawList->targetCount++;
+  target->source = source;
+  target->data = NULL;
+  target->referenceCount = 1;
+  
+  SnlfGraphicsData *data = SnlfGraphicsDataInitFromSource(source, context);
+  
+  // Nested acquires and releases may have moved the entry
+  for (size_t i = 0; i < drawList->targetCount; ++i) {
+    target = drawList->targets + i;
+    if (target->source != source) {
+      continue;
+    }
+    if (data) {
+      target->data = data;
+    } else {
+      memmove(target, target + 1, (drawList->targetCount - i - 1) * sizeof(SnlfDrawListTarget));
+      --drawList->targetCount;
+    }
+    break;
+  }
+  return data;
+}
+
+void SnlfDrawListReleaseTarget(SnlfDrawList *drawList, SnlfGraphicsData *data) {
+  assert(drawList);
+  assert(data);
+  
+  for (size_t i = 0; i < drawList->targetCount; ++i) {
+    SnlfDrawListTarget *target = drawList->targets + i;
+    if (target->data != data) {
+      continue;
+    }
+    if (--target->referenceCount) {
+      return;
+    }
+    
+    // Keep the order, so processing is not skipped for a target released while targets are processed
+    memmove(target, target + 1, (drawList->targetCount - i - 1) * sizeof(SnlfDrawListTarget));
+    --drawList->targetCount;
+    SnlfGraphicsDataUninit(data);
+    return;
+  }
+  assert(false);
+}
+
+// Processes the messages of every shared target once, however many references it has.
+void SnlfDrawListProcessTargets(SnlfDrawList *drawList, const SnlfGraphicsContext *context) {
+  assert(drawList);
+  
+  // A target may acquire or release nested targets while it is processed, so the count is reloaded
+  for (size_t i = 0; i < drawList->targetCount; ++i) {
+    SnlfGraphicsData *data = drawList->targets[i].data;
+    SnlfGraphicsDataProcessMessage(data, context);
+  }
+}
+
+// ---
+// Culling
+// ---
+// Generators draw the plane (-1, -1)-(1, 1) at z = 1 through their world matrix. Returns true when the plane
+// crosses w <= 0, where its bounds are unknown. axisAligned is set when the bounds are exactly the plane.
+static inline bool SnlfDrawListComputeBounds(matrix4x4_t world, SnlfDrawListBounds *bounds, bool *axisAligned) {
+  const float32x4_t center = float32x4_add(world.v3, world.v4);
+  const float32x4_t corners[4] = {
+    float32x4_sub(float32x4_sub(center, world.v1), world.v2),
+    float32x4_add(float32x4_sub(center, world.v1), world.v2),
+    float32x4_sub(float32x4_add(center, world.v1), world.v2),
+    float32x4_add(float32x4_add(center, world.v1), world.v2),
+  };
+  
+  bounds->minX = bounds->minY = INFINITY;
+  bounds->maxX = bounds->maxY = -INFINITY;
+  for (size_t i = 0; i < 4; ++i) {
+    const float32_t w = float32x4_getw(corners[i]);
+    if (!(w > 0.F)) {
+      return true;
+    }
+    
+    const float32_t x = float32x4_getx(corners[i]) / w;
+    const float32_t y = float32x4_gety(corners[i]) / w;
+    bounds->minX = fminf(bounds->minX, x);
+    bounds->minY = fminf(bounds->minY, y);
+    bounds->maxX = fmaxf(bounds->maxX, x);
+    bounds->maxY = fmaxf(bounds->maxY, y);
+  }
+  
+  *axisAligned = float32x4_gety(world.v1) == 0.F && float32x4_getx(world.v2) == 0.F
+    && float32x4_getw(world.v1) == 0.F && float32x4_getw(world.v2) == 0.F;
+  return false;
+}
+
+static inline bool SnlfDrawListBoundsContains(SnlfDrawListBounds outer, SnlfDrawListBounds inner) {
+  return outer.minX <= inner.minX && outer.minY <= inner.minY && outer.maxX >= inner.maxX && outer.maxY >= inner.maxY;
+}
+
+static inline float32_t SnlfDrawListBoundsGetArea(SnlfDrawListBounds bounds) {
+  return (bounds.maxX - bounds.minX) * (bounds.maxY - bounds.minY);
+}
+
+// Letterboxing bounds types leave part of the plane uncovered.
+static inline bool SnlfBoundsTypeFillsPlane(SnlfBoundsType boundsType) {
+  switch (boundsType) {
+  case SNLF_BOUNDS_ASPECT_FIT:
+  case SNLF_BOUNDS_ASPECT_WIDTH:
+  case SNLF_BOUNDS_ASPECT_HEIGHT:
+    return false;
+    
+  default:
+    return true;
+  }
+}
+
+static inline void SnlfDrawListCull(SnlfDrawList *drawList) {
+  SnlfDrawListBounds occluders[SNLF_DRAW_LIST_OCCLUDER_COUNT];
+  size_t occluderCount = 0;
+  
+  size_t cacheIndex = drawList->cacheCount;
+  for (size_t i = drawList->itemCount; i-- > 0;) {
+    // Shared caches are drawn elsewhere, so nothing in them occludes the main tree
+    if (i + 1 == drawList->mainItemCount) {
+      occluderCount = 0;
+    }
+    
+    while (cacheIndex > 0 && drawList->caches[cacheIndex - 1].firstItem > i) {
+      --cacheIndex;
+    }
+    const bool cached = cacheIndex > 0 && i < drawList->caches[cacheIndex - 1].itemEnd;
+    
+    const uint32_t node = drawList->itemNodes[i];
+    SnlfDrawListBounds bounds;
+    bool axisAligned;
+    if (SnlfDrawListComputeBounds(drawList->nodeWorlds[node], &bounds, &axisAligned)) {
+      drawList->itemVisible[i] = true;
+      continue;
+    }
+    
+    // Outside the viewport
+    if (bounds.maxX <= -1.F || bounds.minX >= 1.F || bounds.maxY <= -1.F || bounds.minY >= 1.F) {
+      drawList->itemVisible[i] = false;
+      continue;
+    }
+    
+    // Under an opaque item
+    bool visible = true;
+    for (size_t j = 0; !cached && visible && j < occluderCount; ++j) {
+      visible = !SnlfDrawListBoundsContains(occluders[j], bounds);
+    }
+    drawList->itemVisible[i] = visible;
+    if (!visible || !axisAligned) {
+      continue;
+    }
+    
+    SnlfGraphicsGeneratorRef generator = drawList->itemGenerators[i];
+    if (!generator
+        || !generator->isOpaque
+        || !SnlfBoundsTypeFillsPlane(drawList->nodeSources[node]->boundsType)
+        || !generator->isOpaque(drawList->itemContexts[i])) {
+      continue;
+    }
+    
+    // Keep the largest occluders
+    if (occluderCount < SNLF_DRAW_LIST_OCCLUDER_COUNT) {
+      occluders[occluderCount++] = bounds;
+    } else {
+      size_t smallest = 0;
+      for (size_t j = 1; j < occluderCount; ++j) {
+        if (SnlfDrawListBoundsGetArea(occluders[j]) < SnlfDrawListBoundsGetArea(occluders[smallest])) {
+          smallest = j;
+        }
+      }
+      if (SnlfDrawListBoundsGetArea(occluders[smallest]) < SnlfDrawListBoundsGetArea(bounds)) {
+        occluders[smallest] = bounds;
+      }
+    }
+  }
+}
+
+// ---
+// Update/Draw
+// ---
+void SnlfDrawListUpdate(SnlfDrawList *drawList, SnlfGraphicsUpdateParams params) {
+  assert(drawList);
+  
+  const bool worldsDirty = drawList->worldsDirty;
+  const bool rootDirty = worldsDirty || memcmp(&drawList->rootWorld, &params.world, sizeof(matrix4x4_t));
+  drawList->worldsDirty = false;
+  drawList->rootWorld = params.world;
+  
+  // Parents precede their children, so every parent world and dirty flag is final when it is read.
+  // Shared caches are rooted at the identity, because every reference applies its own world.
+  const matrix4x4_t identity = matrix4x4_idt();
+  const int32_t *parents = drawList->nodeParents;
+  const SnlfSourceRef *sources = drawList->nodeSources;
+  matrix4x4_t *worlds = drawList->nodeWorlds;
+  int32_t *revisions = drawList->nodeRevisions;
+  int32_t *contentRevisions = drawList->nodeContentRevisions;
+  bool *dirty = drawList->nodeDirty;
+  bool *changed = drawList->nodeChanged;
+  for (size_t i = 0; i < drawList->nodeCount; ++i) {
+    const int32_t parent = parents[i];
+    const bool shared = i >= drawList->mainNodeCount;
+    const SnlfSourceSnapshot *snapshot = (const SnlfSourceSnapshot *)osutil_atomic_load_pointer(&sources[i]->snapshot);
+    const int32_t revision = snapshot->revision;
+    dirty[i] = revision != revisions[i] || (parent >= 0 ? dirty[parent] : shared ? worldsDirty : rootDirty);
+    if (dirty[i]) {
+      const matrix4x4_t parentWorld = parent >= 0 ? worlds[parent] : shared ? identity : params.world;
+      worlds[i] = matrix4x4_mul(parentWorld, snapshot->transform);
+      revisions[i] = revision;
+    }
+    
+    const int32_t contentRevision = osutil_atomic_load32(&sources[i]->contentRevision);
+    changed[i] = dirty[i] || contentRevision != contentRevisions[i];
+    contentRevisions[i] = contentRevision;
+  }
+  
+  for (size_t i = 0; i < drawList->cacheCount; ++i) {
+    SnlfDrawListCache *cache = drawList->caches + i;
+    cache->valid = cache->valid && !cache->animated;
+    for (uint32_t j = cache->firstNode; cache->valid && j < cache->nodeEnd; ++j) {
+      cache->valid = !changed[j];
+    }
+  }
+  
+  // A cache is also stale when a shared cache it references is, which may in turn be referenced
+  for (bool propagate = true; propagate;) {
+    propagate = false;
+    for (size_t i = 0; i < drawList->cacheCount; ++i) {
+      SnlfDrawListCache *cache = drawList->caches + i;
+      for (uint32_t j = cache->firstItem; cache->references && cache->valid && j < cache->itemEnd; ++j) {
+        if (drawList->itemGenerators[j]) {
+          continue;
+        }
+        
+        const int32_t sharedCache = drawList->shareds[drawList->itemContexts[j]].cache;
+        if (sharedCache >= 0 && !drawList->caches[sharedCache].valid) {
+          cache->valid = false;
+          propagate = true;
+        }
+      }
+    }
+  }
+  
+  SnlfDrawListCull(drawList);
+  
+  size_t cacheIndex = 0;
+  for (size_t i = 0; i < drawList->itemCount;) {
+    if (cacheIndex < drawList->cacheCount && drawList->caches[cacheIndex].firstItem == i) {
+      const SnlfDrawListCache *cache = drawList->caches + cacheIndex++;
+      if (cache->valid) {
+        i = cache->itemEnd;
+        continue;
+      }
+    }
+    // Reference items have nothing to update
+    SnlfGraphicsGeneratorRef generator = drawList->itemGenerators[i];
+    if (!generator || !drawList->itemVisible[i]) {
+      ++i;
+      continue;
+    }
+    
+    params.world = worlds[drawList->itemNodes[i]];
+    generator->update(drawList->itemContexts[i], params);
+    ++i;
+  }
+}
+
+static inline CpsrTexture2D *SnlfDrawListAcquireTexture(SnlfDrawList *drawList, SnlfGraphicsDrawParams params) {
+  CpsrTexture2DDescriptor desc;
+  desc.size = CpsrTexture2DGetSize(params.renderTarget);
+  desc.arrayLength = 1;
+  desc.pixelFormat = SNLF_RENDER_TARGET_PIXEL_FORMAT;
+  desc.usage = CPSR_TEXTURE_USAGE_READ | CPSR_TEXTURE_USAGE_RENDER_TARGET;
+  return SnlfTexturePoolAcquire(drawList->texturePool, &desc);
+}
+
+// References are submitted as draw items, so every reference to the same source shares one instanced draw.
+static inline void SnlfDrawListDrawReference(const SnlfDrawList *drawList, size_t item, SnlfGraphicsDrawParams params) {
+  const SnlfDrawListShared *shared = drawList->shareds + drawList->itemContexts[item];
+  if (shared->cache < 0 || shared->rendering) {
+    return;
+  }
+  
+  const CpsrTexture2D *texture = drawList->caches[shared->cache].texture;
+  if (!texture) {
+    return;
+  }
+  
+  SnlfGraphicsDrawItem drawItem;
+  drawItem.pipelineState = params.context->drawReferencePipelineState;
+  drawItem.instance = drawList->nodeWorlds + drawList->itemNodes[item];
+  drawItem.instanceSize = sizeof(matrix4x4_t);
+  drawItem.texture = texture;
+  if (SnlfGraphicsContextSubmitDrawItem(params.context, params.renderTarget, &drawItem)) {
+    SnlfWarningLog("Dropped a reference draw.");
+  }
+}
+
+static inline void SnlfDrawListDrawItem(const SnlfDrawList *drawList, size_t item, SnlfGraphicsDrawParams params) {
+  SnlfGraphicsGeneratorRef generator = drawList->itemGenerators[item];
+  if (generator) {
+    generator->draw(drawList->itemContexts[item], params);
+  } else {
+    SnlfDrawListDrawReference(drawList, item, params);
+  }
+}
+
+static inline void SnlfDrawListDrawCache(SnlfDrawList *drawList, SnlfDrawListCache *cache, SnlfGraphicsDrawParams params) {
+  if (!cache->texture) {
+    cache->texture = SnlfDrawListAcquireTexture(drawList, params);
+    if (!cache->texture) {
+      // Draw the subtree uncached
+      for (uint32_t i = cache->firstItem; i < cache->itemEnd; ++i) {
+        if (drawList->itemVisible[i]) {
+          SnlfDrawListDrawItem(drawList, i, params);
+        }
+      }
+      return;
+    }
+  }
+  
+  SnlfRenderPass *renderPass = params.renderPass;
+  if (!cache->valid) {
+    // Render the subtree into the cache, cleared to transparent
+    const CpsrClearColor transparent = { 0.F, 0.F, 0.F, 0.F };
+    SnlfRenderPassBegin(renderPass, cache->texture);
+    SnlfRenderPassClear(renderPass, transparent);
+    
+    SnlfGraphicsDrawParams cacheParams = params;
+    cacheParams.renderTarget = cache->texture;
+    for (uint32_t i = cache->firstItem; i < cache->itemEnd; ++i) {
+      if (drawList->itemVisible[i]) {
+        SnlfDrawListDrawItem(drawList, i, cacheParams);
+      }
+    }
+    cache->valid = true;
+  }
+  
+  const SnlfGraphicsContext *context = params.context;
+  SnlfRenderPassBegin(renderPass, params.renderTarget);
+  if (!SnlfRenderPassSetPipelineState(renderPass, context->drawCachePipelineState)) {
+    SnlfRenderPassSetVertexBuffer(renderPass, 0, context->planeVertexBuffer);
+    SnlfRenderPassSetConstantBuffer(renderPass, 0, context->identityTransformBuffer);
+    SnlfRenderPassSetTexture(renderPass, 0, cache->texture);
+    SnlfRenderPassSetPrimitiveTopology(renderPass, CPSR_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
+    SnlfRenderPassDraw(renderPass, 0, 4);
+  }
+}
+
+// Renders a stale shared cache after the shared caches it references. A reference cycle is cut at the shared
+// cache being rendered, whose references draw nothing.
+static void SnlfDrawListRenderShared(SnlfDrawList *drawList, size_t index, SnlfGraphicsDrawParams params) {
+  SnlfDrawListShared *shared = drawList->shareds + index;
+  if (shared->cache < 0 || shared->rendering) {
+    return;
+  }
+  
+  SnlfDrawListCache *cache = drawList->caches + shared->cache;
+  if (cache->valid) {
+    return;
+  }
+  
+  shared->rendering = true;
+  for (uint32_t i = cache->firstItem; cache->references && i < cache->itemEnd; ++i) {
+    if (!drawList->itemGenerators[i] && drawList->itemVisible[i]) {
+      SnlfDrawListRenderShared(drawList, (size_t)drawList->itemContexts[i], params);
+    }
+  }
+  
+  if (!cache->texture) {
+    cache->texture = SnlfDrawListAcquireTexture(drawList, params);
+  }
+  if (cache->texture) {
+    const CpsrClearColor transparent = { 0.F, 0.F, 0.F, 0.F };
+    SnlfRenderPassBegin(params.renderPass, cache->texture);
+    SnlfRenderPassClear(params.renderPass, transparent);
+    
+    SnlfGraphicsDrawParams sharedParams = params;
+    sharedParams.renderTarget = cache->texture;
+    for (uint32_t i = cache->firstItem; i < cache->itemEnd; ++i) {
+      if (drawList->itemVisible[i]) {
+        SnlfDrawListDrawItem(drawList, i, sharedParams);
+      }
+    }
+    cache->valid = true;
+  }
+  shared->rendering = false;
+}
+
+void SnlfDrawListDraw(SnlfDrawList *drawList, SnlfGraphicsDrawParams params) {
+  assert(drawList);
+  assert(params.renderPass);
+  
+  for (size_t i = 0; i < drawList->sharedCount; ++i) {
+    SnlfDrawListRenderShared(drawList, i, params);
+  }
+  
+  SnlfRenderPassBegin(params.renderPass, params.renderTarget);
+  
+  size_t cacheIndex = 0;
+  for (size_t i = 0; i < drawList->mainItemCount;) {
+    if (cacheIndex < drawList->cacheCount && drawList->caches[cacheIndex].firstItem == i) {
+      SnlfDrawListCache *cache = drawList->caches + cacheIndex++;
+      SnlfDrawListDrawCache(drawList, cache, params);
+      i = cache->itemEnd;
+      continue;
+    }
+    
+    if (drawList->itemVisible[i]) {
+      SnlfDrawListDrawItem(drawList, i, params);
+    }
+    ++i;
+  }
+  SnlfRenderPassEnd(params.renderPass);
+}
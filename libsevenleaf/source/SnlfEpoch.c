@@ -0,0 +1,124 @@
+#include "SnlfCore+Private.h"
+
+#include <osutil_time.h>
+
+#define LOCK(__EPOCH__)   pthread_mutex_lock(&__EPOCH__->mutex)
+#define UNLOCK(__EPOCH__) pthread_mutex_unlock(&__EPOCH__->mutex)
+
+// ---
+// Init/Uninit
+// ---
+bool SnlfEpochInit(SnlfEpoch *epoch) {
+  assert(epoch);
+  
+  osutil_atomic_store64(&epoch->epoch, 0);
+  for (size_t i = 0; i < SNLF_EPOCH_READER_COUNT; ++i) {
+    osutil_atomic_store64(epoch->readers + i, SNLF_EPOCH_UNUSED);
+  }
+  epoch->retiredCount = 0;
+  epoch->retiredCapacity = 0;
+  epoch->retired = NULL;
+  return SnlfMutexCreate(&epoch->mutex);
+}
+
+// Every reader has to be unregistered.
+bool SnlfEpochUninit(SnlfEpoch *epoch) {
+  assert(epoch);
+  
+  for (size_t i = 0; i < epoch->retiredCount; ++i) {
+    SnlfDealloc(epoch->retired[i].pointer);
+  }
+  SnlfDealloc(epoch->retired);
+  epoch->retired = NULL;
+  epoch->retiredCount = 0;
+  epoch->retiredCapacity = 0;
+  return SnlfMutexDestroy(&epoch->mutex);
+}
+
+// ---
+// Readers
+// ---
+int32_t SnlfEpochRegisterReader(SnlfEpoch *epoch) {
+  assert(epoch);
+  
+  for (int32_t i = 0; i < SNLF_EPOCH_READER_COUNT; ++i) {
+    int64_t expected = SNLF_EPOCH_UNUSED;
+    if (osutil_atomic_compare_exchange64(epoch->readers + i, &expected, SNLF_EPOCH_INACTIVE)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void SnlfEpochUnregisterReader(SnlfEpoch *epoch, int32_t reader) {
+  assert(epoch);
+  assert(reader >= 0 && reader < SNLF_EPOCH_READER_COUNT);
+  osutil_atomic_store64(epoch->readers + reader, SNLF_EPOCH_UNUSED);
+}
+
+// ---
+// Reclamation
+// ---
+// Returns the oldest epoch a reader is pinned at, or INT64_MAX when nobody reads.
+static inline int64_t SnlfEpochGetOldestReader(SnlfEpoch *epoch) {
+  int64_t oldest = INT64_MAX;
+  for (size_t i = 0; i < SNLF_EPOCH_READER_COUNT; ++i) {
+    const int64_t reader = osutil_atomic_load64(epoch->readers + i);
+    if (reader >= 0 && reader < oldest) {
+      oldest = reader;
+    }
+  }
+  return oldest;
+}
+
+static inline void SnlfEpochCollect(SnlfEpoch *epoch) {
+  const int64_t oldest = SnlfEpochGetOldestReader(epoch);
+  
+  size_t count = 0;
+  for (size_t i = 0; i < epoch->retiredCount; ++i) {
+    if (epoch->retired[i].epoch < oldest) {
+      SnlfDealloc(epoch->retired[i].pointer);
+    } else {
+      epoch->retired[count++] = epoch->retired[i];
+    }
+  }
+  epoch->retiredCount = count;
+}
+
+void SnlfEpochRetire(SnlfEpoch *epoch, void *pointer) {
+  assert(epoch);
+  assert(pointer);
+  
+  if (LOCK(epoch)) {
+    SnlfMutexLockError();
+    return;
+  }
+  
+  const int64_t tag = osutil_atomic_fetch_increment64(&epoch->epoch);
+  if (epoch->retiredCount == epoch->retiredCapacity) {
+    const size_t capacity = epoch->retiredCapacity ? 2 * epoch->retiredCapacity : 16;
+    SnlfEpochRetired *retired = (SnlfEpochRetired *)realloc(epoch->retired, sizeof(SnlfEpochRetired) * capacity);
+    if (!retired) {
+      // Wait out the readers instead of keeping the pointer
+      SnlfOutOfMemoryError();
+      while (SnlfEpochGetOldestReader(epoch) <= tag) {
+        osutil_mssleep(1);
+      }
+      SnlfDealloc(pointer);
+      pointer = NULL;
+    } else {
+      epoch->retired = retired;
+      epoch->retiredCapacity = capacity;
+    }
+  }
+  if (pointer) {
+    SnlfEpochRetired *retired = epoch->retired + epoch->retiredCount++;
+    retired->pointer = pointer;
+    retired->epoch = tag;
+  }
+  SnlfEpochCollect(epoch);
+  
+  if (UNLOCK(epoch)) {
+    SnlfMutexUnlockError();
+  }
+}
@@ -0,0 +1,62 @@
+#ifndef _SNLF_EPOCH_H
+#define _SNLF_EPOCH_H
+
+#include "SnlfUtils+Private.h"
+
+#include <osutil_atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---
+// Epoch
+// ---
+// Epoch-based reclamation for data that readers load through an atomic pointer without any lock.
+// A writer publishes a new version with an atomic swap, then passes the old one to SnlfEpochRetire. That call
+// tags the old version with the current epoch and advances the epoch.
+// A reader pins the epoch it observed between SnlfEpochEnter and SnlfEpochExit. A retired version is freed
+// once no reader is pinned at or before its tag. Readers never lock or wait. Writers share a mutex for the
+// retired list.
+#define SNLF_EPOCH_UNUSED   -2  // Reader slot is free
+#define SNLF_EPOCH_INACTIVE -1  // Reader is registered but not reading
+
+typedef struct {
+  void *pointer;
+  int64_t epoch;
+} SnlfEpochRetired;
+
+typedef struct {
+  osutil_atomic_int64_t epoch;
+  osutil_atomic_int64_t readers[SNLF_EPOCH_READER_COUNT];
+  
+  pthread_mutex_t mutex;
+  size_t retiredCount, retiredCapacity;
+  SnlfEpochRetired *retired;
+} SnlfEpoch;
+
+bool SnlfEpochInit(SnlfEpoch *epoch);
+bool SnlfEpochUninit(SnlfEpoch *epoch);
+
+// Returns the reader slot, or -1 when every slot is taken.
+int32_t SnlfEpochRegisterReader(SnlfEpoch *epoch);
+void SnlfEpochUnregisterReader(SnlfEpoch *epoch, int32_t reader);
+
+// Frees pointer with SnlfDealloc once no reader can still hold it.
+void SnlfEpochRetire(SnlfEpoch *epoch, void *pointer);
+
+// Both accesses are sequentially consistent. A writer whose scan misses the pin has therefore swapped before
+// any load the reader makes after entering.
+static inline void SnlfEpochEnter(SnlfEpoch *epoch, int32_t reader) {
+  osutil_atomic_store64(epoch->readers + reader, osutil_atomic_load64(&epoch->epoch));
+}
+
+static inline void SnlfEpochExit(SnlfEpoch *epoch, int32_t reader) {
+  osutil_atomic_store64(epoch->readers + reader, SNLF_EPOCH_INACTIVE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SNLF_EPOCH_H
@@ -0,0 +1,1043 @@
+#include "SnlfCore+Private.h"
+#include "SnlfColorManagement+Private.h"
+#include "SnlfGraphicsFrame+Private.h"
+
+#include "compositor/vector/float32x4_t.h"
+
+#include <float.h>
+#include <math.h>
+
+#define SNLF_FRAME_LAYOUT_NONE  0xFF
+#define SNLF_FRAME_BLOCK_PIXELS 16
+
+// ---
+// Layout
+// ---
+typedef enum {
+  SNLF_FRAME_LAYOUT_PACKED,       // Bit fields of one 16- or 32-bit word per pixel
+  SNLF_FRAME_LAYOUT_INTERLEAVED,  // Four 8- or 16-bit components per pixel
+  SNLF_FRAME_LAYOUT_PLANAR,       // 8-bit Y, U and V planes
+  SNLF_FRAME_LAYOUT_SEMIPLANAR,   // Y plane and interleaved UV plane
+  SNLF_FRAME_LAYOUT_HALFSTRIDE,   // 8-bit Y plane and one plane whose rows hold both chroma halves
+  SNLF_FRAME_LAYOUT_PACKED422,    // Y0, U, Y1 and V in one macropixel of two pixels
+  SNLF_FRAME_LAYOUT_V210,         // 10-bit components, three to a 32-bit word, six pixels to four words
+} SnlfFrameLayoutType;
+
+// offsets hold, per component (R, G, B, A or Y, U, V, A):
+//   packed:      bit offset in the word
+//   interleaved: component index in the pixel
+//   planar:      plane index
+//   semiplanar:  component index in the chroma pair
+//   halfstride:  half of the chroma row
+//   packed422:   component index in the macropixel, with Y1 in place of A
+struct _SnlfFrameLayout {
+  SnlfGraphicsFrameFormat format;
+  uint8_t type;
+  uint8_t size;              // Bytes per word (packed) or per component
+  uint8_t depth;             // Significant bits of 16-bit components
+  uint8_t shiftX, shiftY;    // Chroma subsampling
+  uint8_t yuv;
+  uint8_t offsets[4];
+  uint8_t bits[4];           // Bits per component (packed)
+};
+typedef struct _SnlfFrameLayout SnlfFrameLayout;
+
+#define N SNLF_FRAME_LAYOUT_NONE
+#define PACKED(__FORMAT__, __SIZE__, __R__, __G__, __B__, __A__, __RB__, __GB__, __BB__, __AB__) \
+  { __FORMAT__, SNLF_FRAME_LAYOUT_PACKED, __SIZE__, 0, 0, 0, false, { __R__, __G__, __B__, __A__ }, { __RB__, __GB__, __BB__, __AB__ } }
+#define INTERLEAVED(__FORMAT__, __SIZE__, __DEPTH__, __YUV__, __C0__, __C1__, __C2__, __C3__) \
+  { __FORMAT__, SNLF_FRAME_LAYOUT_INTERLEAVED, __SIZE__, __DEPTH__, 0, 0, __YUV__, { __C0__, __C1__, __C2__, __C3__ }, { 0 } }
+#define YUV(__FORMAT__, __TYPE__, __SIZE__, __DEPTH__, __SX__, __SY__, __Y__, __U__, __V__, __A__) \
+  { __FORMAT__, __TYPE__, __SIZE__, __DEPTH__, __SX__, __SY__, true, { __Y__, __U__, __V__, __A__ }, { 0 } }
+
+// Names list components from the least significant bit.
+static const SnlfFrameLayout snlfFrameLayouts[] = {
+  PACKED(SNLF_GRAPHICS_FRAME_RGBX4, 2, 0, 4, 8, N, 4, 4, 4, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_RGBA4, 2, 0, 4, 8, 12, 4, 4, 4, 4),
+  PACKED(SNLF_GRAPHICS_FRAME_XBGR4, 2, 12, 8, 4, N, 4, 4, 4, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_ABGR4, 2, 12, 8, 4, 0, 4, 4, 4, 4),
+  
+  PACKED(SNLF_GRAPHICS_FRAME_RGB5X1, 2, 0, 5, 10, N, 5, 5, 5, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_RGB5A1, 2, 0, 5, 10, 15, 5, 5, 5, 1),
+  PACKED(SNLF_GRAPHICS_FRAME_BGR5X1, 2, 10, 5, 0, N, 5, 5, 5, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_BGR5A1, 2, 10, 5, 0, 15, 5, 5, 5, 1),
+  PACKED(SNLF_GRAPHICS_FRAME_X1RGB5, 2, 1, 6, 11, N, 5, 5, 5, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_A1RGB5, 2, 1, 6, 11, 0, 5, 5, 5, 1),
+  PACKED(SNLF_GRAPHICS_FRAME_X1BGR5, 2, 11, 6, 1, N, 5, 5, 5, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_A1BGR5, 2, 11, 6, 1, 0, 5, 5, 5, 1),
+  PACKED(SNLF_GRAPHICS_FRAME_R5G6B5, 2, 0, 5, 11, N, 5, 6, 5, 0),
+  
+  INTERLEAVED(SNLF_GRAPHICS_FRAME_RGBX8, 1, 8, false, 0, 1, 2, N),
+  INTERLEAVED(SNLF_GRAPHICS_FRAME_RGBA8, 1, 8, false, 0, 1, 2, 3),
+  INTERLEAVED(SNLF_GRAPHICS_FRAME_BGRX8, 1, 8, false, 2, 1, 0, N),
+  INTERLEAVED(SNLF_GRAPHICS_FRAME_BGRA8, 1, 8, false, 2, 1, 0, 3),
+  
+  PACKED(SNLF_GRAPHICS_FRAME_RGB10X2, 4, 0, 10, 20, N, 10, 10, 10, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_RGB10A2, 4, 0, 10, 20, 30, 10, 10, 10, 2),
+  PACKED(SNLF_GRAPHICS_FRAME_BGR10X2, 4, 20, 10, 0, N, 10, 10, 10, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_BGR10A2, 4, 20, 10, 0, 30, 10, 10, 10, 2),
+  PACKED(SNLF_GRAPHICS_FRAME_X2RGB10, 4, 2, 12, 22, N, 10, 10, 10, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_A2RGB10, 4, 2, 12, 22, 0, 10, 10, 10, 2),
+  PACKED(SNLF_GRAPHICS_FRAME_X2BGR10, 4, 22, 12, 2, N, 10, 10, 10, 0),
+  PACKED(SNLF_GRAPHICS_FRAME_A2BGR10, 4, 22, 12, 2, 0, 10, 10, 10, 2),
+  
+  INTERLEAVED(SNLF_GRAPHICS_FRAME_RGBX16, 2, 16, false, 0, 1, 2, N),
+  INTERLEAVED(SNLF_GRAPHICS_FRAME_RGBA16, 2, 16, false, 0, 1, 2, 3),
+  
+  YUV(SNLF_GRAPHICS_FRAME_NV11, SNLF_FRAME_LAYOUT_SEMIPLANAR, 1, 8, 2, 0, 0, 0, 1, N),
+  YUV(SNLF_GRAPHICS_FRAME_NV12, SNLF_FRAME_LAYOUT_SEMIPLANAR, 1, 8, 1, 1, 0, 0, 1, N),
+  YUV(SNLF_GRAPHICS_FRAME_NV21, SNLF_FRAME_LAYOUT_SEMIPLANAR, 1, 8, 1, 1, 0, 1, 0, N),
+  YUV(SNLF_GRAPHICS_FRAME_I420, SNLF_FRAME_LAYOUT_PLANAR, 1, 8, 1, 1, 0, 1, 2, N),
+  YUV(SNLF_GRAPHICS_FRAME_YV12, SNLF_FRAME_LAYOUT_PLANAR, 1, 8, 1, 1, 0, 2, 1, N),
+  YUV(SNLF_GRAPHICS_FRAME_IMC2, SNLF_FRAME_LAYOUT_HALFSTRIDE, 1, 8, 1, 1, 0, 1, 0, N),
+  YUV(SNLF_GRAPHICS_FRAME_IMC3, SNLF_FRAME_LAYOUT_PLANAR, 1, 8, 1, 1, 0, 1, 2, N),
+  YUV(SNLF_GRAPHICS_FRAME_IMC4, SNLF_FRAME_LAYOUT_HALFSTRIDE, 1, 8, 1, 1, 0, 0, 1, N),
+  
+  YUV(SNLF_GRAPHICS_FRAME_I422, SNLF_FRAME_LAYOUT_PLANAR, 1, 8, 1, 0, 0, 1, 2, N),
+  YUV(SNLF_GRAPHICS_FRAME_UYVY, SNLF_FRAME_LAYOUT_PACKED422, 1, 8, 1, 0, 1, 0, 2, 3),
+  YUV(SNLF_GRAPHICS_FRAME_VYUY, SNLF_FRAME_LAYOUT_PACKED422, 1, 8, 1, 0, 1, 2, 0, 3),
+  YUV(SNLF_GRAPHICS_FRAME_YUYV, SNLF_FRAME_LAYOUT_PACKED422, 1, 8, 1, 0, 0, 1, 3, 2),
+  YUV(SNLF_GRAPHICS_FRAME_YVYU, SNLF_FRAME_LAYOUT_PACKED422, 1, 8, 1, 0, 0, 3, 1, 2),
+  
+  YUV(SNLF_GRAPHICS_FRAME_I444, SNLF_FRAME_LAYOUT_PLANAR, 1, 8, 0, 0, 0, 1, 2, N),
+  INTERLEAVED(SNLF_GRAPHICS_FRAME_AYUV, 1, 8, true, 2, 1, 0, 3),
+  
+  YUV(SNLF_GRAPHICS_FRAME_P010, SNLF_FRAME_LAYOUT_SEMIPLANAR, 2, 10, 1, 1, 0, 0, 1, N),
+  YUV(SNLF_GRAPHICS_FRAME_P210, SNLF_FRAME_LAYOUT_SEMIPLANAR, 2, 10, 1, 0, 0, 0, 1, N),
+  YUV(SNLF_GRAPHICS_FRAME_Y210, SNLF_FRAME_LAYOUT_PACKED422, 2, 10, 1, 0, 0, 1, 3, 2),
+  { SNLF_GRAPHICS_FRAME_Y410, SNLF_FRAME_LAYOUT_PACKED, 4, 0, 0, 0, true, { 10, 0, 20, 30 }, { 10, 10, 10, 2 } },
+  YUV(SNLF_GRAPHICS_FRAME_V210, SNLF_FRAME_LAYOUT_V210, 4, 10, 1, 0, 0, 0, 0, N),
+  
+  YUV(SNLF_GRAPHICS_FRAME_P012, SNLF_FRAME_LAYOUT_SEMIPLANAR, 2, 12, 1, 1, 0, 0, 1, N),
+  YUV(SNLF_GRAPHICS_FRAME_P212, SNLF_FRAME_LAYOUT_SEMIPLANAR, 2, 12, 1, 0, 0, 0, 1, N),
+  YUV(SNLF_GRAPHICS_FRAME_Y212, SNLF_FRAME_LAYOUT_PACKED422, 2, 12, 1, 0, 0, 1, 3, 2),
+  INTERLEAVED(SNLF_GRAPHICS_FRAME_Y412, 2, 12, true, 1, 0, 2, 3),
+  
+  YUV(SNLF_GRAPHICS_FRAME_P016, SNLF_FRAME_LAYOUT_SEMIPLANAR, 2, 16, 1, 1, 0, 0, 1, N),
+  YUV(SNLF_GRAPHICS_FRAME_P216, SNLF_FRAME_LAYOUT_SEMIPLANAR, 2, 16, 1, 0, 0, 0, 1, N),
+  YUV(SNLF_GRAPHICS_FRAME_Y216, SNLF_FRAME_LAYOUT_PACKED422, 2, 16, 1, 0, 0, 1, 3, 2),
+  INTERLEAVED(SNLF_GRAPHICS_FRAME_Y416, 2, 16, true, 1, 0, 2, 3),
+};
+
+#undef YUV
+#undef INTERLEAVED
+#undef PACKED
+#undef N
+
+static inline const SnlfFrameLayout *SnlfFrameLayoutFind(SnlfGraphicsFrameFormat format) {
+  for (size_t i = 0; i < sizeof(snlfFrameLayouts) / sizeof(SnlfFrameLayout); ++i) {
+    if (snlfFrameLayouts[i].format == format) {
+      return snlfFrameLayouts + i;
+    }
+  }
+  return NULL;
+}
+
+static inline bool SnlfFrameLayoutHasAlpha(const SnlfFrameLayout *layout) {
+  return (layout->type == SNLF_FRAME_LAYOUT_PACKED || layout->type == SNLF_FRAME_LAYOUT_INTERLEAVED)
+    && layout->offsets[3] != SNLF_FRAME_LAYOUT_NONE;
+}
+
+// ---
+// Scalar helpers
+// ---
+static inline uint16_t SnlfFrameLoad16(const uint8_t *data) {
+  uint16_t value;
+  memcpy(&value, data, sizeof(uint16_t));
+  return value;
+}
+
+static inline uint32_t SnlfFrameLoad32(const uint8_t *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(uint32_t));
+  return value;
+}
+
+// Fills the low bits of a code whose depth significant bits sit at the top of 16 bits with copies of its
+// high bits, so that the largest code of every depth becomes 0xFFFF.
+static inline uint16_t SnlfFrameReplicate(uint32_t value, uint32_t depth) {
+  for (uint32_t shift = depth; shift < 16; shift *= 2) {
+    value |= value >> shift;
+  }
+  return (uint16_t)value;
+}
+
+static inline uint16_t SnlfFrameExpandBits(uint32_t value, uint32_t bits) {
+  return SnlfFrameReplicate((value & ((1U << bits) - 1)) << (16 - bits), bits);
+}
+
+// Rounds to nearest even. Overflow becomes infinity.
+static inline uint16_t SnlfFloatToHalf(float value) {
+  uint32_t f;
+  memcpy(&f, &value, sizeof(uint32_t));
+  
+  const uint32_t sign = (f >> 16) & 0x8000;
+  f &= 0x7FFFFFFF;
+  
+  uint32_t half;
+  if (f >= 0x47800000) {
+    half = f > 0x7F800000 ? 0x7E00 : 0x7C00;
+  } else if (f < 0x38800000) {
+    // Subnormal; the addition rounds the mantissa into place
+    float subnormal;
+    memcpy(&subnormal, &f, sizeof(float));
+    subnormal += 0.5F;
+    memcpy(&half, &subnormal, sizeof(uint32_t));
+    half -= 0x3F000000;
+  } else {
+    const uint32_t odd = (f >> 13) & 1;
+    half = (f + 0xC8000FFF + odd) >> 13;
+  }
+  return (uint16_t)(half | sign);
+}
+
+// ---
+// Scalar loader
+// ---
+// Writes the components of pixels [begin, end) of row into the four channels.
+static void SnlfFrameLoadScalar(const SnlfFrameLayout *layout, const SnlfFrameConverterSource *source, uint32_t row, uint32_t begin, uint32_t end, uint16_t *const channels[4]) {
+  const uint8_t *data = source->planes[0] + row * source->bytesPerRow[0];
+  const uint32_t chromaRow = row >> layout->shiftY;
+  switch (layout->type) {
+  case SNLF_FRAME_LAYOUT_PACKED:
+    for (uint32_t x = begin; x < end; ++x) {
+      const uint32_t word = layout->size == 2 ? SnlfFrameLoad16(data + 2 * x) : SnlfFrameLoad32(data + 4 * x);
+      for (size_t c = 0; c < 4; ++c) {
+        if (layout->offsets[c] != SNLF_FRAME_LAYOUT_NONE) {
+          channels[c][x] = SnlfFrameExpandBits(word >> layout->offsets[c], layout->bits[c]);
+        }
+      }
+    }
+    break;
+  
+  case SNLF_FRAME_LAYOUT_INTERLEAVED:
+    for (uint32_t x = begin; x < end; ++x) {
+      for (size_t c = 0; c < 4; ++c) {
+        if (layout->offsets[c] == SNLF_FRAME_LAYOUT_NONE) {
+          continue;
+        }
+  
+        const size_t index = 4 * x + layout->offsets[c];
+        channels[c][x] = layout->size == 1
+          ? SnlfFrameReplicate((uint32_t)data[index] << 8, 8)
+          : SnlfFrameReplicate(SnlfFrameLoad16(data + 2 * index), layout->depth);
+      }
+    }
+    break;
+  
+  case SNLF_FRAME_LAYOUT_PLANAR: {
+    const uint8_t *u = source->planes[layout->offsets[1]] + chromaRow * source->bytesPerRow[layout->offsets[1]];
+    const uint8_t *v = source->planes[layout->offsets[2]] + chromaRow * source->bytesPerRow[layout->offsets[2]];
+    for (uint32_t x = begin; x < end; ++x) {
+      const uint32_t chroma = x >> layout->shiftX;
+      channels[0][x] = SnlfFrameReplicate((uint32_t)data[x] << 8, 8);
+      channels[1][x] = SnlfFrameReplicate((uint32_t)u[chroma] << 8, 8);
+      channels[2][x] = SnlfFrameReplicate((uint32_t)v[chroma] << 8, 8);
+    }
+    break;
+  }
+  
+  case SNLF_FRAME_LAYOUT_SEMIPLANAR: {
+    const uint8_t *uv = source->planes[1] + chromaRow * source->bytesPerRow[1];
+    for (uint32_t x = begin; x < end; ++x) {
+      const size_t pair = 2 * (x >> layout->shiftX);
+      if (layout->size == 1) {
+        channels[0][x] = SnlfFrameReplicate((uint32_t)data[x] << 8, 8);
+        channels[1][x] = SnlfFrameReplicate((uint32_t)uv[pair + layout->offsets[1]] << 8, 8);
+        channels[2][x] = SnlfFrameReplicate((uint32_t)uv[pair + layout->offsets[2]] << 8, 8);
+      } else {
+        channels[0][x] = SnlfFrameReplicate(SnlfFrameLoad16(data + 2 * x), layout->depth);
+        channels[1][x] = SnlfFrameReplicate(SnlfFrameLoad16(uv + 2 * (pair + layout->offsets[1])), layout->depth);
+        channels[2][x] = SnlfFrameReplicate(SnlfFrameLoad16(uv + 2 * (pair + layout->offsets[2])), layout->depth);
+      }
+    }
+    break;
+  }
+  
+  case SNLF_FRAME_LAYOUT_HALFSTRIDE: {
+    const uint8_t *chroma = source->planes[1] + chromaRow * source->bytesPerRow[1];
+    const uint8_t *u = chroma + layout->offsets[1] * (source->bytesPerRow[1] / 2);
+    const uint8_t *v = chroma + layout->offsets[2] * (source->bytesPerRow[1] / 2);
+    for (uint32_t x = begin; x < end; ++x) {
+      channels[0][x] = SnlfFrameReplicate((uint32_t)data[x] << 8, 8);
+      channels[1][x] = SnlfFrameReplicate((uint32_t)u[x >> layout->shiftX] << 8, 8);
+      channels[2][x] = SnlfFrameReplicate((uint32_t)v[x >> layout->shiftX] << 8, 8);
+    }
+    break;
+  }
+  
+  case SNLF_FRAME_LAYOUT_PACKED422:
+    for (uint32_t x = begin; x < end; ++x) {
+      const size_t base = 4 * (x >> 1);
+      const size_t y = base + layout->offsets[x & 1 ? 3 : 0];
+      const size_t u = base + layout->offsets[1];
+      const size_t v = base + layout->offsets[2];
+      if (layout->size == 1) {
+        channels[0][x] = SnlfFrameReplicate((uint32_t)data[y] << 8, 8);
+        channels[1][x] = SnlfFrameReplicate((uint32_t)data[u] << 8, 8);
+        channels[2][x] = SnlfFrameReplicate((uint32_t)data[v] << 8, 8);
+      } else {
+        channels[0][x] = SnlfFrameReplicate(SnlfFrameLoad16(data + 2 * y), layout->depth);
+        channels[1][x] = SnlfFrameReplicate(SnlfFrameLoad16(data + 2 * u), layout->depth);
+        channels[2][x] = SnlfFrameReplicate(SnlfFrameLoad16(data + 2 * v), layout->depth);
+      }
+    }
+    break;
+  
+  case SNLF_FRAME_LAYOUT_V210:
+    // Cb0 Y0 Cr0 | Y1 Cb1 Y2 | Cr1 Y3 Cb2 | Y4 Cr2 Y5
+    for (uint32_t x = begin; x < end; ++x) {
+      const uint8_t *group = data + 16 * (x / 6);
+      const uint32_t pixel = x % 6;
+      const uint32_t indices[3] = { 2 * pixel + 1, 4 * (pixel / 2), 4 * (pixel / 2) + 2 };
+      for (size_t c = 0; c < 3; ++c) {
+        const uint32_t word = SnlfFrameLoad32(group + 4 * (indices[c] / 3));
+        channels[c][x] = SnlfFrameExpandBits(word >> (10 * (indices[c] % 3)), 10);
+      }
+    }
+    break;
+  
+  default:
+    assert(false);
+    break;
+  }
+}
+
+// ---
+// SIMD loader
+// ---
+// Each block function converts SNLF_FRAME_BLOCK_PIXELS pixels. 8-bit codes become 16-bit ones by
+// interleaving a byte with itself, which multiplies it by 257.
+#if defined(_SIMD_X86_SSE4_1)
+#define SNLF_FRAME_CONVERTER_SIMD 1
+
+static inline void SnlfFrameExpand8Block(const uint8_t *source, uint16_t *destination) {
+  const __m128i v = _mm_loadu_si128((const __m128i *)source);
+  _mm_storeu_si128((__m128i *)destination, _mm_unpacklo_epi8(v, v));
+  _mm_storeu_si128((__m128i *)(destination + 8), _mm_unpackhi_epi8(v, v));
+}
+
+// Every source byte feeds two pixels.
+static inline void SnlfFrameExpand8x2Block(const uint8_t *source, uint16_t *destination) {
+  const __m128i v = _mm_loadl_epi64((const __m128i *)source);
+  const __m128i twice = _mm_unpacklo_epi8(v, v);
+  _mm_storeu_si128((__m128i *)destination, _mm_unpacklo_epi8(twice, twice));
+  _mm_storeu_si128((__m128i *)(destination + 8), _mm_unpackhi_epi8(twice, twice));
+}
+
+static inline void SnlfFramePairs8x2Block(const uint8_t *source, uint16_t *first, uint16_t *second) {
+  const __m128i v = _mm_loadu_si128((const __m128i *)source);
+  _mm_storeu_si128((__m128i *)first, _mm_shuffle_epi8(v, _mm_setr_epi8(0, 0, 0, 0, 2, 2, 2, 2, 4, 4, 4, 4, 6, 6, 6, 6)));
+  _mm_storeu_si128((__m128i *)(first + 8), _mm_shuffle_epi8(v, _mm_setr_epi8(8, 8, 8, 8, 10, 10, 10, 10, 12, 12, 12, 12, 14, 14, 14, 14)));
+  _mm_storeu_si128((__m128i *)second, _mm_shuffle_epi8(v, _mm_setr_epi8(1, 1, 1, 1, 3, 3, 3, 3, 5, 5, 5, 5, 7, 7, 7, 7)));
+  _mm_storeu_si128((__m128i *)(second + 8), _mm_shuffle_epi8(v, _mm_setr_epi8(9, 9, 9, 9, 11, 11, 11, 11, 13, 13, 13, 13, 15, 15, 15, 15)));
+}
+
+static inline __m128i SnlfFrameReplicate16(__m128i v, uint32_t depth) {
+  return _mm_or_si128(v, _mm_srl_epi16(v, _mm_cvtsi32_si128((int)depth)));
+}
+
+static inline void SnlfFramePlane16Block(const uint8_t *source, uint16_t *destination, uint32_t depth) {
+  const __m128i v0 = _mm_loadu_si128((const __m128i *)source);
+  const __m128i v1 = _mm_loadu_si128((const __m128i *)(source + 16));
+  _mm_storeu_si128((__m128i *)destination, SnlfFrameReplicate16(v0, depth));
+  _mm_storeu_si128((__m128i *)(destination + 8), SnlfFrameReplicate16(v1, depth));
+}
+
+static inline void SnlfFramePairs16x2Block(const uint8_t *source, uint16_t *first, uint16_t *second, uint32_t depth) {
+  const __m128i firstMask = _mm_setr_epi8(0, 1, 0, 1, 4, 5, 4, 5, 8, 9, 8, 9, 12, 13, 12, 13);
+  const __m128i secondMask = _mm_setr_epi8(2, 3, 2, 3, 6, 7, 6, 7, 10, 11, 10, 11, 14, 15, 14, 15);
+  for (size_t i = 0; i < 2; ++i) {
+    const __m128i v = _mm_loadu_si128((const __m128i *)(source + 16 * i));
+    _mm_storeu_si128((__m128i *)(first + 8 * i), SnlfFrameReplicate16(_mm_shuffle_epi8(v, firstMask), depth));
+    _mm_storeu_si128((__m128i *)(second + 8 * i), SnlfFrameReplicate16(_mm_shuffle_epi8(v, secondMask), depth));
+  }
+}
+
+// Picks bytes a and b of each 4-byte macropixel, each twice.
+static inline __m128i SnlfFramePacked422Mask(int a, int b) {
+  return _mm_setr_epi8(a, a, b, b, 4 + a, 4 + a, 4 + b, 4 + b, 8 + a, 8 + a, 8 + b, 8 + b, 12 + a, 12 + a, 12 + b, 12 + b);
+}
+
+static inline void SnlfFramePacked422Block(const uint8_t *source, const uint8_t offsets[4], uint16_t *const channels[4], uint32_t x) {
+  const __m128i yMask = SnlfFramePacked422Mask(offsets[0], offsets[3]);
+  const __m128i uMask = SnlfFramePacked422Mask(offsets[1], offsets[1]);
+  const __m128i vMask = SnlfFramePacked422Mask(offsets[2], offsets[2]);
+  for (size_t i = 0; i < 2; ++i) {
+    const __m128i v = _mm_loadu_si128((const __m128i *)(source + 16 * i));
+    _mm_storeu_si128((__m128i *)(channels[0] + x + 8 * i), _mm_shuffle_epi8(v, yMask));
+    _mm_storeu_si128((__m128i *)(channels[1] + x + 8 * i), _mm_shuffle_epi8(v, uMask));
+    _mm_storeu_si128((__m128i *)(channels[2] + x + 8 * i), _mm_shuffle_epi8(v, vMask));
+  }
+}
+
+static inline void SnlfFrameInterleaved8Block(const uint8_t *source, const uint8_t offsets[4], uint16_t *const channels[4], uint32_t x) {
+  for (size_t c = 0; c < 4; ++c) {
+    if (offsets[c] == SNLF_FRAME_LAYOUT_NONE) {
+      continue;
+    }
+  
+    const int o = offsets[c];
+    const __m128i mask = _mm_setr_epi8(o, o, 4 + o, 4 + o, 8 + o, 8 + o, 12 + o, 12 + o, -1, -1, -1, -1, -1, -1, -1, -1);
+    for (size_t i = 0; i < 2; ++i) {
+      const __m128i v0 = _mm_loadu_si128((const __m128i *)(source + 32 * i));
+      const __m128i v1 = _mm_loadu_si128((const __m128i *)(source + 32 * i + 16));
+      const __m128i v = _mm_unpacklo_epi64(_mm_shuffle_epi8(v0, mask), _mm_shuffle_epi8(v1, mask));
+      _mm_storeu_si128((__m128i *)(channels[c] + x + 8 * i), v);
+    }
+  }
+}
+#elif defined(_SIMD_ARM_NEON)
+#define SNLF_FRAME_CONVERTER_SIMD 1
+
+static inline void SnlfFrameStoreExpanded8(uint8x16_t v, uint16_t *destination) {
+  const uint8x16x2_t twice = vzipq_u8(v, v);
+  vst1q_u16(destination, vreinterpretq_u16_u8(twice.val[0]));
+  vst1q_u16(destination + 8, vreinterpretq_u16_u8(twice.val[1]));
+}
+
+static inline void SnlfFrameStoreExpanded8x2(uint8x8_t v, uint16_t *destination) {
+  const uint8x8x2_t twice = vzip_u8(v, v);
+  SnlfFrameStoreExpanded8(vcombine_u8(twice.val[0], twice.val[1]), destination);
+}
+
+static inline void SnlfFrameExpand8Block(const uint8_t *source, uint16_t *destination) {
+  SnlfFrameStoreExpanded8(vld1q_u8(source), destination);
+}
+
+// Every source byte feeds two pixels.
+static inline void SnlfFrameExpand8x2Block(const uint8_t *source, uint16_t *destination) {
+  SnlfFrameStoreExpanded8x2(vld1_u8(source), destination);
+}
+
+static inline void SnlfFramePairs8x2Block(const uint8_t *source, uint16_t *first, uint16_t *second) {
+  const uint8x8x2_t pairs = vld2_u8(source);
+  SnlfFrameStoreExpanded8x2(pairs.val[0], first);
+  SnlfFrameStoreExpanded8x2(pairs.val[1], second);
+}
+
+static inline uint16x8_t SnlfFrameReplicate16(uint16x8_t v, uint32_t depth) {
+  return vorrq_u16(v, vshlq_u16(v, vdupq_n_s16(-(int16_t)depth)));
+}
+
+static inline void SnlfFramePlane16Block(const uint8_t *source, uint16_t *destination, uint32_t depth) {
+  vst1q_u16(destination, SnlfFrameReplicate16(vld1q_u16((const uint16_t *)source), depth));
+  vst1q_u16(destination + 8, SnlfFrameReplicate16(vld1q_u16((const uint16_t *)source + 8), depth));
+}
+
+static inline void SnlfFramePairs16x2Block(const uint8_t *source, uint16_t *first, uint16_t *second, uint32_t depth) {
+  const uint16x8x2_t pairs = vld2q_u16((const uint16_t *)source);
+  const uint16x8x2_t firsts = vzipq_u16(pairs.val[0], pairs.val[0]);
+  const uint16x8x2_t seconds = vzipq_u16(pairs.val[1], pairs.val[1]);
+  vst1q_u16(first, SnlfFrameReplicate16(firsts.val[0], depth));
+  vst1q_u16(first + 8, SnlfFrameReplicate16(firsts.val[1], depth));
+  vst1q_u16(second, SnlfFrameReplicate16(seconds.val[0], depth));
+  vst1q_u16(second + 8, SnlfFrameReplicate16(seconds.val[1], depth));
+}
+
+static inline void SnlfFramePacked422Block(const uint8_t *source, const uint8_t offsets[4], uint16_t *const channels[4], uint32_t x) {
+  const uint8x8x4_t macropixels = vld4_u8(source);
+  const uint8x8x2_t y = vzip_u8(macropixels.val[offsets[0]], macropixels.val[offsets[3]]);
+  SnlfFrameStoreExpanded8(vcombine_u8(y.val[0], y.val[1]), channels[0] + x);
+  SnlfFrameStoreExpanded8x2(macropixels.val[offsets[1]], channels[1] + x);
+  SnlfFrameStoreExpanded8x2(macropixels.val[offsets[2]], channels[2] + x);
+}
+
+static inline void SnlfFrameInterleaved8Block(const uint8_t *source, const uint8_t offsets[4], uint16_t *const channels[4], uint32_t x) {
+  const uint8x16x4_t pixels = vld4q_u8(source);
+  for (size_t c = 0; c < 4; ++c) {
+    if (offsets[c] != SNLF_FRAME_LAYOUT_NONE) {
+      SnlfFrameStoreExpanded8(pixels.val[offsets[c]], channels[c] + x);
+    }
+  }
+}
+#endif
+
+// Loads whole blocks with SIMD and leaves the rest of the row to the scalar loader.
+static void SnlfFrameLoad(const SnlfFrameLayout *layout, const SnlfFrameConverterSource *source, uint32_t row, uint32_t width, uint16_t *const channels[4]) {
+  uint32_t x = 0;
+#ifdef SNLF_FRAME_CONVERTER_SIMD
+  const uint8_t *data = source->planes[0] + row * source->bytesPerRow[0];
+  const uint32_t chromaRow = row >> layout->shiftY;
+  const uint32_t blocks = width - width % SNLF_FRAME_BLOCK_PIXELS;
+  switch (layout->type) {
+  case SNLF_FRAME_LAYOUT_INTERLEAVED:
+    if (layout->size == 1) {
+      for (; x < blocks; x += SNLF_FRAME_BLOCK_PIXELS) {
+        SnlfFrameInterleaved8Block(data + 4 * x, layout->offsets, channels, x);
+      }
+    }
+    break;
+  
+  case SNLF_FRAME_LAYOUT_PLANAR:
+    if (layout->shiftX <= 1) {
+      const uint8_t *u = source->planes[layout->offsets[1]] + chromaRow * source->bytesPerRow[layout->offsets[1]];
+      const uint8_t *v = source->planes[layout->offsets[2]] + chromaRow * source->bytesPerRow[layout->offsets[2]];
+      for (; x < blocks; x += SNLF_FRAME_BLOCK_PIXELS) {
+        SnlfFrameExpand8Block(data + x, channels[0] + x);
+        if (layout->shiftX) {
+          SnlfFrameExpand8x2Block(u + x / 2, channels[1] + x);
+          SnlfFrameExpand8x2Block(v + x / 2, channels[2] + x);
+        } else {
+          SnlfFrameExpand8Block(u + x, channels[1] + x);
+          SnlfFrameExpand8Block(v + x, channels[2] + x);
+        }
+      }
+    }
+    break;
+  
+  case SNLF_FRAME_LAYOUT_SEMIPLANAR:
+    if (layout->shiftX == 1) {
+      const uint8_t *uv = source->planes[1] + chromaRow * source->bytesPerRow[1];
+      uint16_t *first = channels[layout->offsets[1] ? 2 : 1];
+      uint16_t *second = channels[layout->offsets[1] ? 1 : 2];
+      for (; x < blocks; x += SNLF_FRAME_BLOCK_PIXELS) {
+        if (layout->size == 1) {
+          SnlfFrameExpand8Block(data + x, channels[0] + x);
+          SnlfFramePairs8x2Block(uv + x, first + x, second + x);
+        } else {
+          SnlfFramePlane16Block(data + 2 * x, channels[0] + x, layout->depth);
+          SnlfFramePairs16x2Block(uv + 2 * x, first + x, second + x, layout->depth);
+        }
+      }
+    }
+    break;
+  
+  case SNLF_FRAME_LAYOUT_PACKED422:
+    if (layout->size == 1) {
+      for (; x < blocks; x += SNLF_FRAME_BLOCK_PIXELS) {
+        SnlfFramePacked422Block(data + 2 * x, layout->offsets, channels, x);
+      }
+    }
+    break;
+  
+  default:
+    break;
+  }
+#endif
+  if (x < width) {
+    SnlfFrameLoadScalar(layout, source, row, x, width, channels);
+  }
+}
+
+// ---
+// SIMD matrix
+// ---
+static inline float32x4_t SnlfFrameLoadChannel(const uint16_t *channel) {
+  float32x4_t ret;
+#if defined(_SIMD_ARM_NEON)
+  ret = vcvtq_f32_u32(vmovl_u16(vld1_u16(channel)));
+#elif defined(_SIMD_X86_SSE4_1)
+  ret = _mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)channel)));
+#else
+  ret = float32x4_initv(channel[0], channel[1], channel[2], channel[3]);
+#endif
+  return ret;
+}
+
+#if defined(_SIMD_X86_SSE4_1)
+// SnlfFloatToHalf on four lanes; the halves are left in the low 16 bits of each 32-bit lane.
+static inline __m128i SnlfFrameFloatToHalf4(__m128 value) {
+  const __m128 sign = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000)));
+  const __m128 absolute = _mm_xor_ps(value, sign);
+  const __m128i bits = _mm_castps_si128(absolute);
+  
+  const __m128i regular = _mm_cmpgt_epi32(_mm_set1_epi32(0x47800000), bits);
+  const __m128i nan = _mm_and_si128(_mm_castps_si128(_mm_cmpunord_ps(absolute, absolute)), _mm_set1_epi32(0x0200));
+  const __m128i special = _mm_or_si128(nan, _mm_set1_epi32(0x7C00));
+  
+  const __m128i subnormal = _mm_cmpgt_epi32(_mm_set1_epi32(0x38800000), bits);
+  const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(0x3F000000));
+  const __m128i subnormalHalf = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, magic)), _mm_castps_si128(magic));
+  
+  const __m128i odd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+  const __m128i normalHalf = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(bits, _mm_set1_epi32((int)0xC8000FFF)), odd), 13);
+  
+  const __m128i finite = _simd_mm_sel_si128(normalHalf, subnormalHalf, subnormal);
+  const __m128i half = _simd_mm_sel_si128(special, finite, regular);
+  return _mm_or_si128(half, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+}
+#endif
+
+// Stores four RGBA16F pixels.
+static inline void SnlfFrameStorePixels(float32x4_t r, float32x4_t g, float32x4_t b, float32x4_t a, uint16_t *destination) {
+#if defined(_SIMD_X86_SSE4_1)
+  const __m128i rg = _mm_packus_epi32(SnlfFrameFloatToHalf4(r), SnlfFrameFloatToHalf4(g));
+  const __m128i ba = _mm_packus_epi32(SnlfFrameFloatToHalf4(b), SnlfFrameFloatToHalf4(a));
+  const __m128i rb = _mm_unpacklo_epi16(rg, ba);
+  const __m128i ga = _mm_unpackhi_epi16(rg, ba);
+  _mm_storeu_si128((__m128i *)destination, _mm_unpacklo_epi16(rb, ga));
+  _mm_storeu_si128((__m128i *)(destination + 8), _mm_unpackhi_epi16(rb, ga));
+#elif defined(_SIMD_ARM_NEON) && (defined(_SIMD_ARM64) || (__ARM_FP & 2))
+  uint16x4x4_t pixels;
+  pixels.val[0] = vreinterpret_u16_f16(vcvt_f16_f32(r));
+  pixels.val[1] = vreinterpret_u16_f16(vcvt_f16_f32(g));
+  pixels.val[2] = vreinterpret_u16_f16(vcvt_f16_f32(b));
+  pixels.val[3] = vreinterpret_u16_f16(vcvt_f16_f32(a));
+  vst4_u16(destination, pixels);
+#else
+  const float32x4_t components[4] = { r, g, b, a };
+  for (size_t c = 0; c < 4; ++c) {
+    destination[c] = SnlfFloatToHalf(float32x4_getx(components[c]));
+    destination[c + 4] = SnlfFloatToHalf(float32x4_gety(components[c]));
+    destination[c + 8] = SnlfFloatToHalf(float32x4_getz(components[c]));
+    destination[c + 12] = SnlfFloatToHalf(float32x4_getw(components[c]));
+  }
+#endif
+}
+
+// The color matrix times the affine component matrix.
+static inline void SnlfFrameGetFusedMatrix(const SnlfFrameConverter *converter, float matrix[12]) {
+  const float *color = converter->colorMatrix;
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      matrix[4 * i + j] = color[3 * i] * converter->matrix[j]
+        + color[3 * i + 1] * converter->matrix[4 + j]
+        + color[3 * i + 2] * converter->matrix[8 + j];
+    }
+  }
+}
+
+static inline float32x4_t SnlfFrameLookup(const SnlfTransferLUT *lut, float32x4_t value) {
+#ifdef SNLF_TRANSFER_LUT_SIMD
+  return SnlfTransferLUTEvaluate4(lut, value);
+#else
+  return float32x4_initv(
+    SnlfTransferLUTEvaluate(lut, float32x4_getx(value)),
+    SnlfTransferLUTEvaluate(lut, float32x4_gety(value)),
+    SnlfTransferLUTEvaluate(lut, float32x4_getz(value)),
+    SnlfTransferLUTEvaluate(lut, float32x4_getw(value)));
+#endif
+}
+
+// Scales four pixels by curve(maxRGB) / maxRGB. The first lanes pixels are counted into bins unless it is
+// NULL.
+static inline void SnlfFrameToneMap(SnlfToneMapperRef toneMapper, float32x4_t *r, float32x4_t *g, float32x4_t *b, uint32_t lanes, uint32_t *bins) {
+  const float32x4_t peak = float32x4_max(float32x4_max(*r, *g), *b);
+  if (bins) {
+    const float peaks[4] = { float32x4_getx(peak), float32x4_gety(peak), float32x4_getz(peak), float32x4_getw(peak) };
+    for (uint32_t i = 0; i < lanes; ++i) {
+      ++bins[SnlfLuminanceHistogramGetBin(peaks[i])];
+    }
+  }
+  
+  // The curve is zero for dark pixels, so the ratio is too
+  const float32x4_t ratio = float32x4_div(SnlfFrameLookup(toneMapper->curve, peak), float32x4_max(peak, float32x4_inits(FLT_MIN)));
+  *r = float32x4_mul(*r, ratio);
+  *g = float32x4_mul(*g, ratio);
+  *b = float32x4_mul(*b, ratio);
+}
+
+// Decode, color matrix, tone mapping and encode on four pixels.
+static inline void SnlfFrameTransfer(const SnlfFrameConverter *converter, float32x4_t *r, float32x4_t *g, float32x4_t *b, uint32_t lanes, uint32_t *bins) {
+  if (converter->decode) {
+    *r = SnlfFrameLookup(converter->decode, *r);
+    *g = SnlfFrameLookup(converter->decode, *g);
+    *b = SnlfFrameLookup(converter->decode, *b);
+  }
+  
+  const float *m = converter->colorMatrix;
+  const float32x4_t red = float32x4_muladd(*b, float32x4_inits(m[2]), float32x4_muladd(*g, float32x4_inits(m[1]), float32x4_mul(*r, float32x4_inits(m[0]))));
+  const float32x4_t green = float32x4_muladd(*b, float32x4_inits(m[5]), float32x4_muladd(*g, float32x4_inits(m[4]), float32x4_mul(*r, float32x4_inits(m[3]))));
+  const float32x4_t blue = float32x4_muladd(*b, float32x4_inits(m[8]), float32x4_muladd(*g, float32x4_inits(m[7]), float32x4_mul(*r, float32x4_inits(m[6]))));
+  *r = red;
+  *g = green;
+  *b = blue;
+  if (converter->toneMapper) {
+    SnlfFrameToneMap(converter->toneMapper, r, g, b, lanes, bins);
+  }
+  if (converter->encode) {
+    *r = SnlfFrameLookup(converter->encode, *r);
+    *g = SnlfFrameLookup(converter->encode, *g);
+    *b = SnlfFrameLookup(converter->encode, *b);
+  }
+}
+
+// The channels hold at least width rounded up to a whole block.
+static void SnlfFrameStoreRow(const SnlfFrameConverter *converter, uint16_t *const channels[4], uint32_t width, uint16_t *destination, uint32_t *bins) {
+  // Without lookups between them, both matrices are one
+  const bool transfer = converter->decode || converter->encode || converter->toneMapper;
+  float m[12];
+  if (transfer) {
+    memcpy(m, converter->matrix, sizeof(m));
+  } else {
+    SnlfFrameGetFusedMatrix(converter, m);
+  }
+  const float32x4_t rY = float32x4_inits(m[0]), rU = float32x4_inits(m[1]), rV = float32x4_inits(m[2]), rO = float32x4_inits(m[3]);
+  const float32x4_t gY = float32x4_inits(m[4]), gU = float32x4_inits(m[5]), gV = float32x4_inits(m[6]), gO = float32x4_inits(m[7]);
+  const float32x4_t bY = float32x4_inits(m[8]), bU = float32x4_inits(m[9]), bV = float32x4_inits(m[10]), bO = float32x4_inits(m[11]);
+  const float32x4_t alphaScale = float32x4_inits(1.F / 65535.F);
+  for (uint32_t x = 0; x < width; x += 4) {
+    const float32x4_t c0 = SnlfFrameLoadChannel(channels[0] + x);
+    const float32x4_t c1 = SnlfFrameLoadChannel(channels[1] + x);
+    const float32x4_t c2 = SnlfFrameLoadChannel(channels[2] + x);
+    const float32x4_t c3 = SnlfFrameLoadChannel(channels[3] + x);
+    float32x4_t r = float32x4_muladd(c2, rV, float32x4_muladd(c1, rU, float32x4_muladd(c0, rY, rO)));
+    float32x4_t g = float32x4_muladd(c2, gV, float32x4_muladd(c1, gU, float32x4_muladd(c0, gY, gO)));
+    float32x4_t b = float32x4_muladd(c2, bV, float32x4_muladd(c1, bU, float32x4_muladd(c0, bY, bO)));
+    const float32x4_t a = float32x4_mul(c3, alphaScale);
+    if (transfer) {
+      SnlfFrameTransfer(converter, &r, &g, &b, width - x < 4 ? width - x : 4, bins);
+    }
+    if (x + 4 <= width) {
+      SnlfFrameStorePixels(r, g, b, a, destination + 4 * x);
+    } else {
+      uint16_t pixels[16];
+      SnlfFrameStorePixels(r, g, b, a, pixels);
+      memcpy(destination + 4 * x, pixels, 4 * sizeof(uint16_t) * (width - x));
+    }
+  }
+}
+
+// ---
+// Init
+// ---
+// Rows R, G and B of the matrix from Y'PbPr (or the permuted components for GBR) to R'G'B'.
+static inline bool SnlfFrameGetMatrix(SnlfMatrixCoefficientsType coefficients, float matrix[9]) {
+  float kr, kb;
+  switch (coefficients) {
+  case SNLF_CM_GBR: {
+    const float gbr[9] = { 0.F, 0.F, 1.F, 1.F, 0.F, 0.F, 0.F, 1.F, 0.F };
+    memcpy(matrix, gbr, sizeof(gbr));
+    return false;
+  }
+  case SNLF_CM_YCGCO: {
+    const float ycgco[9] = { 1.F, -1.F, 1.F, 1.F, 1.F, 0.F, 1.F, -1.F, -1.F };
+    memcpy(matrix, ycgco, sizeof(ycgco));
+    return false;
+  }
+  case SNLF_CM_BT709:
+  case SNLF_CM_UNSPECIFIED:
+    kr = 0.2126F;
+    kb = 0.0722F;
+    break;
+  case SNLF_CM_FCC:
+    kr = 0.30F;
+    kb = 0.11F;
+    break;
+  case SNLF_CM_BT470BG:
+  case SNLF_CM_SMPTE170M:
+    kr = 0.299F;
+    kb = 0.114F;
+    break;
+  case SNLF_CM_SMPTE240M:
+    kr = 0.212F;
+    kb = 0.087F;
+    break;
+  case SNLF_CM_BT2020NCL:
+    kr = 0.2627F;
+    kb = 0.0593F;
+    break;
+  default:
+    // Constant luminance, YDZDX and ICTCP need the transfer function
+    return true;
+  }
+  
+  const float kg = 1.F - kr - kb;
+  matrix[0] = 1.F;
+  matrix[1] = 0.F;
+  matrix[2] = 2.F * (1.F - kr);
+  matrix[3] = 1.F;
+  matrix[4] = -2.F * kb * (1.F - kb) / kg;
+  matrix[5] = -2.F * kr * (1.F - kr) / kg;
+  matrix[6] = 1.F;
+  matrix[7] = 2.F * (1.F - kb);
+  matrix[8] = 0.F;
+  return false;
+}
+
+bool SnlfGraphicsFrameFormatIsYUV(SnlfGraphicsFrameFormat format) {
+  const SnlfFrameLayout *layout = SnlfFrameLayoutFind(format);
+  return layout && layout->yuv;
+}
+
+bool SnlfFrameConverterInit(SnlfFrameConverter *converter, SnlfGraphicsFrameFormat format, const SnlfYUVFrameDescriptor *descriptor) {
+  assert(converter);
+  
+  const SnlfFrameLayout *layout = SnlfFrameLayoutFind(format);
+  if (!layout) {
+    SnlfErrorLogFormat("Unsupported frame format (%08x).", (uint32_t)format);
+    return true;
+  }
+  
+  float matrix[9];
+  SnlfColorRange range = { 0.F, 1.F };
+  SnlfColorRange chromaRange;
+  if (layout->yuv) {
+    if (!descriptor) {
+      SnlfErrorLog("YUV frames need a descriptor.");
+      return true;
+    }
+    if (SnlfFrameGetMatrix(descriptor->coefficients, matrix)) {
+      SnlfErrorLogFormat("Unsupported matrix coefficients (%d).", (int)descriptor->coefficients);
+      return true;
+    }
+    range = descriptor->yRange;
+    chromaRange = descriptor->coefficients == SNLF_CM_GBR ? descriptor->yRange : descriptor->uvRange;
+  } else {
+    const float identity[9] = { 1.F, 0.F, 0.F, 0.F, 1.F, 0.F, 0.F, 0.F, 1.F };
+    memcpy(matrix, identity, sizeof(identity));
+    if (descriptor) {
+      range = descriptor->yRange;
+    }
+    chromaRange = range;
+  }
+  if (range.peak == range.black || chromaRange.peak == chromaRange.black) {
+    SnlfErrorLog("Empty color range.");
+    return true;
+  }
+  
+  // Component c0 is scaled from 16-bit codes to 0-1 over the range. GBR and RGB sources scale c1 and c2 the
+  // same way; YUV chroma becomes -0.5-0.5 around the middle of its range.
+  const bool centered = layout->yuv && descriptor->coefficients != SNLF_CM_GBR;
+  const float scales[3] = {
+    1.F / (65535.F * (range.peak - range.black)),
+    1.F / (65535.F * (chromaRange.peak - chromaRange.black)),
+    1.F / (65535.F * (chromaRange.peak - chromaRange.black)),
+  };
+  const float chromaBlack = centered ? 0.5F * (chromaRange.black + chromaRange.peak) : chromaRange.black;
+  const float offsets[3] = {
+    -range.black / (range.peak - range.black),
+    -chromaBlack / (chromaRange.peak - chromaRange.black),
+    -chromaBlack / (chromaRange.peak - chromaRange.black),
+  };
+  
+  converter->layout = layout;
+  for (size_t i = 0; i < 3; ++i) {
+    float offset = 0.F;
+    for (size_t j = 0; j < 3; ++j) {
+      converter->matrix[4 * i + j] = matrix[3 * i + j] * scales[j];
+      offset += matrix[3 * i + j] * offsets[j];
+    }
+    converter->matrix[4 * i + 3] = offset;
+  }
+  
+  const float identity[9] = { 1.F, 0.F, 0.F, 0.F, 1.F, 0.F, 0.F, 0.F, 1.F };
+  memcpy(converter->colorMatrix, identity, sizeof(identity));
+  converter->decode = NULL;
+  converter->encode = NULL;
+  converter->toneMapper = NULL;
+  return false;
+}
+
+void SnlfFrameConverterSetColorTransform(SnlfFrameConverter *converter, const SnlfColorTransform *transform) {
+  assert(converter);
+  assert(transform);
+  
+  memcpy(converter->colorMatrix, transform->matrix, sizeof(converter->colorMatrix));
+}
+
+bool SnlfFrameConverterSetTransfer(SnlfFrameConverter *converter, SnlfTransferCharacteristicsType source, SnlfTransferCharacteristicsType destination) {
+  assert(converter);
+  assert(converter->layout);
+  
+  // 8-bit and packed components have no depth
+  const uint32_t depth = converter->layout->depth;
+  const uint32_t precision = depth <= 10 ? 10 : depth <= 12 ? 12 : 16;
+  const SnlfTransferLUT *decode = NULL, *encode = NULL;
+  if (source != SNLF_TC_LINEAR) {
+    decode = SnlfGetTransferLUT(source, SNLF_TRANSFER_DECODE, precision);
+    if (!decode) {
+      return true;
+    }
+  }
+  if (destination != SNLF_TC_LINEAR) {
+    encode = SnlfGetTransferLUT(destination, SNLF_TRANSFER_ENCODE, 12);
+    if (!encode) {
+      return true;
+    }
+  }
+  converter->decode = decode;
+  converter->encode = encode;
+  return false;
+}
+
+void SnlfFrameConverterSetToneMapper(SnlfFrameConverter *converter, SnlfToneMapperRef toneMapper) {
+  assert(converter);
+  
+  converter->toneMapper = toneMapper;
+}
+
+void SnlfFrameConverterSourceInit(const SnlfFrameConverter *converter, CpsrSizeU32 size, const uint8_t *data, size_t bytesPerRow, SnlfFrameConverterSource *source) {
+  assert(converter);
+  assert(data);
+  assert(source);
+  
+  const SnlfFrameLayout *layout = converter->layout;
+  const uint32_t chromaHeight = (size.height + (1U << layout->shiftY) - 1) >> layout->shiftY;
+  source->size = size;
+  source->planes[0] = data;
+  source->planes[1] = NULL;
+  source->planes[2] = NULL;
+  source->bytesPerRow[0] = bytesPerRow;
+  source->bytesPerRow[1] = 0;
+  source->bytesPerRow[2] = 0;
+  switch (layout->type) {
+  case SNLF_FRAME_LAYOUT_PLANAR: {
+    // IMC3 keeps the luma stride for its chroma planes; the others narrow it with the chroma width
+    const size_t chromaBytesPerRow = layout->format == SNLF_GRAPHICS_FRAME_IMC3 ? bytesPerRow : bytesPerRow >> layout->shiftX;
+    source->planes[1] = data + size.height * bytesPerRow;
+    source->planes[2] = source->planes[1] + chromaHeight * chromaBytesPerRow;
+    source->bytesPerRow[1] = chromaBytesPerRow;
+    source->bytesPerRow[2] = chromaBytesPerRow;
+    break;
+  }
+  
+  case SNLF_FRAME_LAYOUT_SEMIPLANAR:
+  case SNLF_FRAME_LAYOUT_HALFSTRIDE:
+    source->planes[1] = data + size.height * bytesPerRow;
+    source->bytesPerRow[1] = bytesPerRow;
+    break;
+  
+  default:
+    break;
+  }
+}
+
+// ---
+// Convert
+// ---
+static inline uint16_t *SnlfFrameAllocChannels(const SnlfFrameLayout *layout, uint32_t width, uint16_t *channels[4]) {
+  const size_t capacity = width + SNLF_FRAME_BLOCK_PIXELS - width % SNLF_FRAME_BLOCK_PIXELS;
+  uint16_t *scratch = (uint16_t *)calloc(4 * capacity, sizeof(uint16_t));
+  if (!scratch) {
+    SnlfOutOfMemoryError();
+    return NULL;
+  }
+  
+  for (size_t c = 0; c < 4; ++c) {
+    channels[c] = scratch + c * capacity;
+  }
+  if (!SnlfFrameLayoutHasAlpha(layout)) {
+    for (size_t x = 0; x < capacity; ++x) {
+      channels[3][x] = 0xFFFF;
+    }
+  }
+  return scratch;
+}
+
+bool SnlfFrameConverterConvert(const SnlfFrameConverter *converter, const SnlfFrameConverterSource *source, uint32_t firstRow, uint32_t rowCount, uint16_t *destination, size_t bytesPerRow) {
+  assert(converter);
+  assert(converter->layout);
+  assert(source);
+  assert(destination);
+  assert(firstRow + rowCount <= source->size.height);
+  
+  const uint32_t width = source->size.width;
+  uint16_t *channels[4];
+  uint16_t *scratch = SnlfFrameAllocChannels(converter->layout, width, channels);
+  if (!scratch) {
+    return true;
+  }
+  
+  // Bands count their own histogram and merge it once
+  uint32_t bins[SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT];
+  const bool dynamic = converter->toneMapper && converter->toneMapper->dynamic;
+  if (dynamic) {
+    memset(bins, 0, sizeof(bins));
+  }
+  
+  for (uint32_t row = firstRow; row < firstRow + rowCount; ++row) {
+    SnlfFrameLoad(converter->layout, source, row, width, channels);
+    SnlfFrameStoreRow(converter, channels, width, (uint16_t *)((uint8_t *)destination + row * bytesPerRow), dynamic ? bins : NULL);
+  }
+  SnlfDealloc(scratch);
+  
+  if (dynamic) {
+    SnlfToneMapperMergeHistogram(converter->toneMapper, bins);
+  }
+  return false;
+}
+
+bool SnlfFrameConverterConvertReference(const SnlfFrameConverter *converter, const SnlfFrameConverterSource *source, uint32_t firstRow, uint32_t rowCount, uint16_t *destination, size_t bytesPerRow) {
+  assert(converter);
+  assert(converter->layout);
+  assert(source);
+  assert(destination);
+  assert(firstRow + rowCount <= source->size.height);
+  
+  const uint32_t width = source->size.width;
+  uint16_t *channels[4];
+  uint16_t *scratch = SnlfFrameAllocChannels(converter->layout, width, channels);
+  if (!scratch) {
+    return true;
+  }
+  
+  uint32_t bins[SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT];
+  const bool dynamic = converter->toneMapper && converter->toneMapper->dynamic;
+  if (dynamic) {
+    memset(bins, 0, sizeof(bins));
+  }
+  
+  const float *m = converter->matrix;
+  const float *color = converter->colorMatrix;
+  for (uint32_t row = firstRow; row < firstRow + rowCount; ++row) {
+    SnlfFrameLoadScalar(converter->layout, source, row, 0, width, channels);
+  
+    uint16_t *pixel = (uint16_t *)((uint8_t *)destination + row * bytesPerRow);
+    for (uint32_t x = 0; x < width; ++x, pixel += 4) {
+      const float c0 = channels[0][x], c1 = channels[1][x], c2 = channels[2][x];
+      float r = m[0] * c0 + m[1] * c1 + m[2] * c2 + m[3];
+      float g = m[4] * c0 + m[5] * c1 + m[6] * c2 + m[7];
+      float b = m[8] * c0 + m[9] * c1 + m[10] * c2 + m[11];
+      if (converter->decode) {
+        r = SnlfTransferLUTEvaluate(converter->decode, r);
+        g = SnlfTransferLUTEvaluate(converter->decode, g);
+        b = SnlfTransferLUTEvaluate(converter->decode, b);
+      }
+  
+      float rgb[3] = {
+        color[0] * r + color[1] * g + color[2] * b,
+        color[3] * r + color[4] * g + color[5] * b,
+        color[6] * r + color[7] * g + color[8] * b,
+      };
+      if (converter->toneMapper) {
+        const float peak = fmaxf(fmaxf(rgb[0], rgb[1]), rgb[2]);
+        if (dynamic) {
+          ++bins[SnlfLuminanceHistogramGetBin(peak)];
+        }
+        const float ratio = SnlfTransferLUTEvaluate(converter->toneMapper->curve, peak) / fmaxf(peak, FLT_MIN);
+        for (size_t c = 0; c < 3; ++c) {
+          rgb[c] *= ratio;
+        }
+      }
+      if (converter->encode) {
+        for (size_t c = 0; c < 3; ++c) {
+          rgb[c] = SnlfTransferLUTEvaluate(converter->encode, rgb[c]);
+        }
+      }
+      pixel[0] = SnlfFloatToHalf(rgb[0]);
+      pixel[1] = SnlfFloatToHalf(rgb[1]);
+      pixel[2] = SnlfFloatToHalf(rgb[2]);
+      pixel[3] = SnlfFloatToHalf(channels[3][x] * (1.F / 65535.F));
+    }
+  }
+  SnlfDealloc(scratch);
+  
+  if (dynamic) {
+    SnlfToneMapperMergeHistogram(converter->toneMapper, bins);
+  }
+  return false;
+}
+
+// ---
+// Row jobs
+// ---
+static void SnlfFrameConversionRows(intptr_t param, uint32_t firstRow, uint32_t rowCount) {
+  const SnlfFrameConversion *conversion = (const SnlfFrameConversion *)param;
+  SnlfFrameConverterConvert(conversion->converter, conversion->source, firstRow, rowCount, conversion->destination, conversion->bytesPerRow);
+}
+
+void SnlfFrameConversionInitRowJob(const SnlfFrameConversion *conversion, SnlfRowJob *job) {
+  assert(conversion);
+  assert(job);
+  
+  // A row touches the source rows, the four scratch channels and the destination row
+  const SnlfFrameConverterSource *source = conversion->source;
+  job->function = SnlfFrameConversionRows;
+  job->param = (intptr_t)conversion;
+  job->rowCount = source->size.height;
+  job->bytesPerRow = source->bytesPerRow[0] + source->bytesPerRow[1] + source->bytesPerRow[2]
+    + 4 * sizeof(uint16_t) * source->size.width + conversion->bytesPerRow;
+  job->affinityMask = 0;
+}
@@ -17,40 +17,35 @@ static void SnlfGeneratorSourceGraphicsData_ProcessMessage(intptr_t _data, const
   SnlfAssume(_data);
   SnlfGeneratorSourceGraphicsData *data = (SnlfGeneratorSourceGraphicsData *)_data;
   
-  const SnlfBasicMessage *message;
-  while ((message = (const SnlfBasicMessage *)SnlfLockFreeQueueDequeue(&data->messageQueue))) {
-    switch (message->type) {
-    case SNLF_MESSAGE_SOURCE_ANIMATION:
-      break;
-        
-    default:
+  intptr_t messages[SNLF_MESSAGE_BATCH_COUNT];
+  size_t count;
+  while ((count = SnlfQueueDequeueBatch(&data->messageQueue, messages, SNLF_MESSAGE_BATCH_COUNT))) {
+    for (size_t i = 0; i < count; ++i) {
+      const SnlfBasicMessage *message = (const SnlfBasicMessage *)messages[i];
+      switch (message->type) {
+      case SNLF_MESSAGE_SOURCE_ANIMATION:
         break;
+        
+      default:
+          break;
+      }
+      SnlfMessageRelease(message);
     }
-    SnlfDealloc(message);
   }
 }
 
-static void SnlfGeneratorSourceGraphicsData_Update(intptr_t _data, SnlfGraphicsUpdateParams params) {
+static void SnlfGeneratorSourceGraphicsData_Compile(intptr_t _data, SnlfDrawList *drawList, int32_t parent) {
   SnlfAssume(_data);
   SnlfGeneratorSourceGraphicsData *data = (SnlfGeneratorSourceGraphicsData *)_data;
   if (data->enabled) {
-    params.world = matrix4x4_mul(params.world, data->source->transform);
-    
     SnlfGraphicsGeneratorRef generator = data->source->graphicsGenerator;
     SnlfAssume(generator);
     
-    generator->update(data->context, params);
-  }
-}
-
-static void SnlfGeneratorSourceGraphicsData_Draw(intptr_t _data, SnlfGraphicsDrawParams params) {
-  SnlfAssume(_data);
-  SnlfGeneratorSourceGraphicsData *data = (SnlfGeneratorSourceGraphicsData *)_data;
-  if (data->enabled) {
-    SnlfGraphicsGeneratorRef generator = data->source->graphicsGenerator;
-    SnlfAssume(generator);
-    
-    generator->draw(data->context, params);
+    const int32_t node = SnlfDrawListAppendNode(drawList, parent, data->source);
+    if (node < 0) {
+      return;
+    }
+    SnlfDrawListAppendItem(drawList, node, generator, data->context);
   }
 }
 
@@ -58,6 +53,8 @@ void SnlfGeneratorSourceGraphicsData_Uninit(intptr_t _data) {
   SnlfAssume(_data);
   SnlfGeneratorSourceGraphicsData *data = (SnlfGeneratorSourceGraphicsData *)_data;
   data->source->graphicsGenerator->uninit(data->context);
+  SnlfSourceDetachGraphicsData(data->source, (SnlfGraphicsData *)data);
+  SnlfQueueUninit(&data->messageQueue);
   SnlfDealloc(data);
 }
 
@@ -76,10 +73,9 @@ SnlfGraphicsData *SnlfGraphicsDataInitForGraphicsGenerator(SnlfSourceRef source,
     return NULL;
   }
   
-  SnlfLockFreeQueueInit(&data->messageQueue);
+  SnlfQueueInit(&data->messageQueue, SNLF_MESSAGE_QUEUE_CAPACITY);
   data->processMessage = SnlfGeneratorSourceGraphicsData_ProcessMessage;
-  data->update = SnlfGeneratorSourceGraphicsData_Update;
-  data->draw = SnlfGeneratorSourceGraphicsData_Draw;
+  data->compile = SnlfGeneratorSourceGraphicsData_Compile;
   data->uninit = SnlfGeneratorSourceGraphicsData_Uninit;
   
   data->source = source;
@@ -3,38 +3,339 @@
 
 #include "SnlfCore+Private.h"
 
-#include <containers/SnlfLockFreeQueue.h>
+#include "SnlfQueue+Private.h"
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <compositor/CpsrNativeShader.h>
+
+// Native shaders for the CPU driver (source/cpu)
+extern const CpsrNativeShaderEntry kSnlfDrawShaders[];
+extern const size_t kSnlfDrawShadersCount;
+extern const CpsrNativeShaderEntry kSnlfDrawColorShaders[];
+extern const size_t kSnlfDrawColorShadersCount;
+extern const CpsrNativeShaderEntry kSnlfPosterizationShaders[];
+extern const size_t kSnlfPosterizationShadersCount;
+#endif
 
 // ---
 // Graphics Data
 // ---
 typedef struct _SnlfTransitionGraphicsData SnlfTransitionGraphicsData;
+typedef struct _SnlfDrawList SnlfDrawList;
+typedef struct _SnlfTexturePool SnlfTexturePool;
 
+// compile appends the data's nodes and items to the draw list below the given parent node.
 #define DEFINE_SNLF_GRAPHICS_COMMON_DATA \
-  SnlfLockFreeQueue messageQueue; \
+  SnlfQueue messageQueue; \
   void (*processMessage)(intptr_t, const SnlfGraphicsContext *); \
-  void (*update)(intptr_t, SnlfGraphicsUpdateParams); \
-  void (*draw)(intptr_t, SnlfGraphicsDrawParams); \
+  void (*compile)(intptr_t, SnlfDrawList *, int32_t); \
   void (*uninit)(intptr_t)
 
-#define SnlfGraphicsDataProcessMessage(__DATA__, __CTX__) __DATA__->processMessage(__DATA__, __CTX__);
-#define SnlfGraphicsDataUpdate(__DATA__, __PARAMS__)      __DATA__->update(__DATA__, __PARAMS__);
+#define SnlfGraphicsDataProcessMessage(__DATA__, __CTX__)           __DATA__->processMessage(__DATA__, __CTX__);
+#define SnlfGraphicsDataCompile(__DATA__, __DRAW_LIST__, __PARENT__) __DATA__->compile(__DATA__, __DRAW_LIST__, __PARENT__);
 
 struct _SnlfGraphicsData {
   DEFINE_SNLF_GRAPHICS_COMMON_DATA;
 };
 
-inline void SnlfGraphicsDataDraw(SnlfGraphicsData *data, SnlfGraphicsDrawParams params) {
-  data->draw(data, params);
-}
-
 inline void SnlfGraphicsDataUninit(SnlfGraphicsData *data) {
   data->uninit(data);
 }
 
 SnlfTransitionGraphicsData *SnlfTransitionGraphicsDataInit(SnlfCoreRef core, const SnlfGraphicsContext *context);
+void SnlfTransitionGraphicsDataUpdate(SnlfTransitionGraphicsData *data, timestamp_t timestamp);
 SnlfGraphicsData *SnlfGraphicsDataInitFromSource(SnlfSourceRef source, const SnlfGraphicsContext *context);
 
+// Stops dispatching the source's messages to data. Called by uninit.
+void SnlfSourceDetachGraphicsData(SnlfSourceRef source, SnlfGraphicsData *data);
+
+// ---
+// Draw List
+// ---
+// The graphics data tree compiled into contiguous arrays. Nodes are stored in pre-order, so a parent always
+// precedes its children and world matrices resolve in a single pass. Items are the generators in draw order.
+// The list is rebuilt only after the tree has been invalidated.
+//
+// World matrices are cached. A node is recomputed only when its source's snapshot revision moved, its parent
+// was recomputed, or the root world changed, so a static scene costs one comparison per node.
+//
+// A group source flagged with cacheAsBitmap compiles into a cache: the node and item ranges of its subtree.
+// The items are rendered once into a pooled texture, which is then drawn as a single quad. The texture holds
+// the subtree in render-target space, so the cache is invalidated when any node in it is recomputed, including
+// the group itself, or when a node's content revision moves. A cache holding a generator that is not static is
+// invalidated every frame, so its content never freezes. Items of a valid cache are neither updated nor drawn.
+// Caches nested in a cached group are part of the outer cache, and every compile invalidates all caches.
+//
+// Every update culls items back to front. An item is skipped when the plane it draws lies outside the viewport
+// or inside an opaque, axis-aligned item drawn above it. Items in caches are only culled against the viewport,
+// because the cache would otherwise keep the hole after the occluder moves.
+//
+// Reference sources share one render of the source they reference. The first reference to a source compiles
+// it after the main tree into a cache of its own, rooted at the root world, and every reference appends an
+// item that composites the cache texture through its world matrix. References of one source are merged into
+// one instanced draw. A shared cache is also invalidated when a shared cache it references is, and it is
+// rendered before the main pass, after the shared caches it references. A reference back into a shared cache
+// being rendered draws nothing.
+//
+// The graphics data of a referenced source is shared as well. The draw list creates it on the first acquire,
+// processes its messages once per frame, and uninits it after the last reference releases it, so a reference
+// holds only its own node and instance transform.
+typedef struct {
+  float32_t minX, minY, maxX, maxY;  // Normalized device coordinates
+} SnlfDrawListBounds;
+
+typedef struct {
+  uint32_t firstNode, nodeEnd;
+  uint32_t firstItem, itemEnd;
+  CpsrTexture2D *texture;  // NULL until the cache is first drawn
+  bool valid;
+  bool references;  // Contains reference items
+  bool animated;    // Contains items that are not static, which redraw every frame
+} SnlfDrawListCache;
+
+typedef struct {
+  SnlfSourceRef source;    // Referenced source
+  SnlfGraphicsData *data;  // Shared graphics data of source
+  int32_t cache;           // -1: the source has no items
+  bool rendering;
+} SnlfDrawListShared;
+
+typedef struct {
+  SnlfSourceRef source;    // Referenced source
+  SnlfGraphicsData *data;  // Shared by every reference to source
+  uint32_t referenceCount;
+} SnlfDrawListTarget;
+
+struct _SnlfDrawList {
+  bool dirty;
+  bool worldsDirty;
+  bool compilingCache;
+  matrix4x4_t rootWorld;
+  
+  // Nodes and items of the main tree come first, then those of the shared caches
+  size_t mainNodeCount, mainItemCount;
+  
+  // Nodes
+  size_t nodeCount, nodeCapacity;
+  int32_t *nodeParents;  // -1: child of the root
+  SnlfSourceRef *nodeSources;
+  matrix4x4_t *nodeWorlds;
+  int32_t *nodeRevisions;         // Snapshot revision the cached world was computed from
+  int32_t *nodeContentRevisions;  // Content revision seen by the previous update
+  bool *nodeDirty;                // World recomputed during the current update
+  bool *nodeChanged;              // World recomputed or content changed during the current update
+  
+  // Items
+  size_t itemCount, itemCapacity;
+  uint32_t *itemNodes;
+  SnlfGraphicsGeneratorRef *itemGenerators;  // NULL: reference item
+  intptr_t *itemContexts;                    // Shared index for reference items
+  bool *itemVisible;  // Survived culling during the current update
+  
+  // Caches, in item order
+  size_t cacheCount, cacheCapacity;
+  SnlfDrawListCache *caches;
+  
+  // Referenced sources, in compile order
+  size_t sharedCount, sharedCapacity;
+  SnlfDrawListShared *shareds;
+  
+  // Graphics data of referenced sources, which outlive compiles
+  size_t targetCount, targetCapacity;
+  SnlfDrawListTarget *targets;
+  
+  // Cache textures are acquired from and released to the graphics thread's pool
+  SnlfTexturePool *texturePool;
+};
+
+#define SnlfDrawListInvalidate(__DRAW_LIST__) (__DRAW_LIST__)->dirty = true
+
+void SnlfDrawListInit(SnlfDrawList *drawList, SnlfTexturePool *texturePool);
+void SnlfDrawListUninit(SnlfDrawList *drawList);
+void SnlfDrawListCompile(SnlfDrawList *drawList, SnlfGraphicsData *root);
+int32_t SnlfDrawListAppendNode(SnlfDrawList *drawList, int32_t parent, SnlfSourceRef source);
+bool SnlfDrawListAppendItem(SnlfDrawList *drawList, int32_t node, SnlfGraphicsGeneratorRef generator, intptr_t context);
+bool SnlfDrawListAppendReference(SnlfDrawList *drawList, int32_t node, SnlfSourceRef source, SnlfGraphicsData *data);
+bool SnlfDrawListBeginCache(SnlfDrawList *drawList);
+void SnlfDrawListEndCache(SnlfDrawList *drawList);
+SnlfGraphicsData *SnlfDrawListAcquireTarget(SnlfDrawList *drawList, SnlfSourceRef source, const SnlfGraphicsContext *context);
+void SnlfDrawListReleaseTarget(SnlfDrawList *drawList, SnlfGraphicsData *data);
+void SnlfDrawListProcessTargets(SnlfDrawList *drawList, const SnlfGraphicsContext *context);
+void SnlfDrawListUpdate(SnlfDrawList *drawList, SnlfGraphicsUpdateParams params);  // Reads source snapshots
+void SnlfDrawListDraw(SnlfDrawList *drawList, SnlfGraphicsDrawParams params);
+
+// ---
+// Pipeline Cache
+// ---
+// Owns every pipeline state of a device. Entries are reference counted and removed when the last reference
+// is released, so a key never outlives the shader functions it points to. Lookups are linear; a process holds
+// a few dozen pipeline states at most. Shared by the graphics and present threads under a mutex.
+//
+// Frames still in flight may draw with a released pipeline state, so it is retired with the number of the
+// last submitted frame and destroyed once the frame fence has passed that frame.
+typedef struct {
+  SnlfPipelineStateDescriptor descriptor;
+  CpsrGraphicsPipelineState *pipelineState;
+  uint32_t referenceCount;
+} SnlfPipelineCacheEntry;
+
+typedef struct {
+  CpsrGraphicsPipelineState *pipelineState;
+  uint64_t frameNumber;  // Last frame that may use the pipeline state
+} SnlfPipelineCacheRetired;
+
+typedef struct {
+  const CpsrDevice *device;
+  pthread_mutex_t mutex;
+  size_t entryCount, entryCapacity;
+  SnlfPipelineCacheEntry *entries;
+  uint64_t frameNumber;  // Last submitted frame
+  size_t retiredCount, retiredCapacity;
+  SnlfPipelineCacheRetired *retireds;
+} SnlfPipelineCache;
+
+bool SnlfPipelineCacheInit(SnlfPipelineCache *cache, const CpsrDevice *device);
+void SnlfPipelineCacheUninit(SnlfPipelineCache *cache);
+CpsrGraphicsPipelineState *SnlfPipelineCacheAcquire(SnlfPipelineCache *cache, const SnlfPipelineStateDescriptor *descriptor);
+void SnlfPipelineCacheRelease(SnlfPipelineCache *cache, CpsrGraphicsPipelineState *pipelineState);
+void SnlfPipelineCacheEndFrame(SnlfPipelineCache *cache, uint64_t submittedFrameNumber, uint64_t completedFrameNumber);
+
+// ---
+// Graphics Data Retirement
+// ---
+// Frames still in flight may draw with the resources of graphics data removed from the tree, so removed
+// graphics data is retired with the number of the last submitted frame and uninitialized once the frame fence
+// has passed that frame, like released pipeline states. Used by the graphics thread only.
+typedef struct {
+  SnlfGraphicsData *data;
+  uint64_t frameNumber;  // Last frame that may use the graphics data
+} SnlfGraphicsDataRetired;
+
+typedef struct {
+  uint64_t frameNumber;  // Last submitted frame
+  size_t retiredCount, retiredCapacity;
+  SnlfGraphicsDataRetired *retireds;
+} SnlfGraphicsDataRetirement;
+
+void SnlfGraphicsDataRetirementInit(SnlfGraphicsDataRetirement *retirement);
+void SnlfGraphicsDataRetirementUninit(SnlfGraphicsDataRetirement *retirement);
+void SnlfGraphicsDataRetire(SnlfGraphicsDataRetirement *retirement, SnlfGraphicsData *data);
+void SnlfGraphicsDataRetirementEndFrame(SnlfGraphicsDataRetirement *retirement, uint64_t submittedFrameNumber, uint64_t completedFrameNumber);
+
+// ---
+// Texture Pool
+// ---
+// Intermediate textures of the graphics thread, keyed by their descriptor. A texture released during a frame is
+// handed to the next acquire with the same descriptor, even within that frame: passes are encoded in order, so
+// a later pass writing it cannot overtake an earlier one sampling it. Textures whose lifetimes do not overlap
+// therefore share memory, and the pool stays as large as the most textures alive at once.
+typedef struct {
+  CpsrTexture2D *texture;
+  CpsrTexture2DDescriptor descriptor;
+  uint64_t frameNumber;  // Frame of the last acquire or release
+} SnlfTexturePoolEntry;
+
+struct _SnlfTexturePool {
+  const CpsrDevice *device;
+  uint64_t frameNumber;
+  size_t freeCount, freeCapacity;
+  SnlfTexturePoolEntry *frees;
+  size_t usedCount, usedCapacity;
+  SnlfTexturePoolEntry *useds;
+};
+
+void SnlfTexturePoolInit(SnlfTexturePool *pool, const CpsrDevice *device);
+void SnlfTexturePoolUninit(SnlfTexturePool *pool);
+void SnlfTexturePoolBegin(SnlfTexturePool *pool);
+CpsrTexture2D *SnlfTexturePoolAcquire(SnlfTexturePool *pool, const CpsrTexture2DDescriptor *descriptor);
+void SnlfTexturePoolRelease(SnlfTexturePool *pool, CpsrTexture2D *texture);
+
+// ---
+// Upload Ring
+// ---
+// Linear allocator for per-draw constants. Every render target slot owns a list of persistently mapped upload
+// buffers that allocations bump through. A slot is rewound when its render target is reused, which happens
+// only after the frame that last used it has completed, so pipelined frames never share constants.
+// Offsets are aligned for CpsrGraphicsContextSetConstantBufferWithOffset.
+typedef struct {
+  CpsrBuffer *buffer;
+  uint8_t *data;  // Mapped for the buffer's lifetime
+  size_t size;
+} SnlfUploadRingBuffer;
+
+typedef struct {
+  size_t bufferCount, bufferCapacity;
+  size_t bufferIndex, offset;  // Next allocation
+  SnlfUploadRingBuffer *buffers;
+} SnlfUploadRingFrame;
+
+typedef struct {
+  const CpsrDevice *device;
+  size_t frameIndex;
+  SnlfUploadRingFrame frames[SNLF_OUTPUT_BUFFER_COUNT];
+} SnlfUploadRing;
+
+void SnlfUploadRingInit(SnlfUploadRing *ring, const CpsrDevice *device);
+void SnlfUploadRingUninit(SnlfUploadRing *ring);
+void SnlfUploadRingBegin(SnlfUploadRing *ring, size_t frameIndex);
+bool SnlfUploadRingAllocate(SnlfUploadRing *ring, size_t size, SnlfGraphicsConstants *constants);
+
+// ---
+// Draw Batch
+// ---
+// Collects draw items submitted by generators and merges consecutive items with the same pipeline state,
+// instance size, texture and render target into one instanced draw of the plane. Instance data is uploaded
+// through the frame's upload ring. Batches are drawn into the frame's shared render pass, and every direct use
+// of that pass flushes them first.
+typedef struct {
+  CpsrGraphicsPipelineState *pipelineState;
+  const CpsrTexture2D *texture;
+  const CpsrTexture2D *renderTarget;
+  uint32_t instanceSize, instanceCount;
+  uint8_t *data;
+  size_t dataCapacity;
+} SnlfDrawBatch;
+
+void SnlfDrawBatchInit(SnlfDrawBatch *batch);
+void SnlfDrawBatchUninit(SnlfDrawBatch *batch);
+void SnlfDrawBatchFlush(SnlfDrawBatch *batch, const SnlfGraphicsContext *context);
+
+// ---
+// Render Pass
+// ---
+// One graphics context per render target per frame, shared by every generator drawing into it. The pass is
+// opened by the first pipeline state and closed when the target changes, a clear is requested, someone
+// creates their own graphics context, or the frame ends. Bindings are cached and repeated sets are dropped.
+#define SNLF_RENDER_PASS_TEXTURE_COUNT 8
+
+struct _SnlfRenderPass {
+  const SnlfGraphicsContext *context;
+  const CpsrTexture2D *renderTarget;       // NULL while no pass is begun
+  CpsrGraphicsContext *graphicsContext;   // NULL until the first pipeline state
+  bool clearEnable;
+  CpsrClearColor clearColor;
+  
+  // Bound state
+  CpsrGraphicsPipelineState *pipelineState;
+  int32_t primitiveTopology;  // -1: not set
+  const CpsrBuffer *vertexBuffers[CPSR_VERTEX_BUFFER_COUNT];
+  const CpsrBuffer *constantBuffers[CPSR_CONSTANT_BUFFER_COUNT];
+  uint32_t constantBufferOffsets[CPSR_CONSTANT_BUFFER_COUNT];
+  const CpsrTexture2D *textures[SNLF_RENDER_PASS_TEXTURE_COUNT];
+};
+
+void SnlfRenderPassInit(SnlfRenderPass *renderPass, const SnlfGraphicsContext *context);
+void SnlfRenderPassBegin(SnlfRenderPass *renderPass, const CpsrTexture2D *renderTarget);
+void SnlfRenderPassClear(SnlfRenderPass *renderPass, CpsrClearColor color);
+void SnlfRenderPassEnd(SnlfRenderPass *renderPass);
+
+bool _SnlfRenderPassSetPipelineState(SnlfRenderPass *renderPass, CpsrGraphicsPipelineState *pipelineState);
+void _SnlfRenderPassSetVertexBuffer(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *vertexBuffer);
+void _SnlfRenderPassSetConstantBuffer(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *constantBuffer);
+void _SnlfRenderPassSetConstantBufferWithOffset(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *constantBuffer, uint32_t offset);
+void _SnlfRenderPassSetTexture(SnlfRenderPass *renderPass, uint8_t index, const CpsrTexture2D *texture);
+void _SnlfRenderPassSetPrimitiveTopology(SnlfRenderPass *renderPass, CpsrPrimitiveTopology primitiveTopology);
+
 // ---
 // Graphics Context
 // ---
@@ -42,15 +343,25 @@ struct _SnlfGraphicsContext {
   const CpsrDevice *device;
   CpsrCommandQueue *commandQueue;
   CpsrCommandBuffer *commandBuffer;
+  SnlfDrawList *drawList;
+  SnlfPipelineCache *pipelineCache;
+  SnlfTexturePool *texturePool;  // NULL for the present thread's copy
+  SnlfUploadRing *uploadRing;    // NULL for the present thread's copy
+  SnlfDrawBatch *drawBatch;      // NULL for the present thread's copy
+  SnlfRenderPass *renderPass;    // NULL for the present thread's copy
+  SnlfGraphicsDataRetirement *retirement;  // NULL for the present thread's copy
   
   // Shaders
   CpsrShaderLibrary *shaderDefaultLibrary;
   
   CpsrShaderFunction *drawVS;
   CpsrShaderFunction *drawSimpleVS;
+  CpsrShaderFunction *drawSimpleInstancedVS;
   CpsrShaderFunction *drawHalfPS;
   CpsrShaderFunction *drawSinglePS;
-  CpsrGraphicsPipelineState *drawSimplePipelineState;
+  CpsrGraphicsPipelineState *drawSimplePipelineState;     // Acquired from the pipeline cache at init
+  CpsrGraphicsPipelineState *drawCachePipelineState;      // drawSimplePipelineState with premultiplied "over" blending
+  CpsrGraphicsPipelineState *drawReferencePipelineState;  // drawCachePipelineState with instanced transforms
   
   CpsrShaderFunction *drawColorVS;
   CpsrShaderFunction *drawColorInstancedVS;
@@ -58,6 +369,7 @@ struct _SnlfGraphicsContext {
   
   // Primitive vertex
   CpsrBuffer *planeVertexBuffer;
+  CpsrBuffer *identityTransformBuffer;
   
   // Render targets
   size_t renderTargetCurrentIndex;
@@ -68,7 +380,8 @@ struct _SnlfGraphicsContext {
 bool SnlfGraphicsContextInit(SnlfGraphicsContext *context, const CpsrDevice *device, CpsrSizeU32 resolution);
 void SnlfGraphicsContextUninit(SnlfGraphicsContext *context);
 
-void SnlfGraphicsContextDrawToSwapChain(const SnlfGraphicsContext *context, const CpsrTexture2D *source, CpsrSwapChain *destination, const CpsrBuffer *transformBuffer);
+// pipelineState has to be acquired for the pixel format of destination.
+void SnlfGraphicsContextDrawToSwapChain(const SnlfGraphicsContext *context, CpsrGraphicsPipelineState *pipelineState, const CpsrTexture2D *source, CpsrSwapChain *destination, const CpsrBuffer *transformBuffer);
 
 // ---
 // Graphics
@@ -82,8 +395,16 @@ typedef struct {
   thread_id_t threadId;
   CpsrSizeU32 resolution;
   SnlfFramerateU framerate;
+  bool pipelined;
 } SnlfGraphicsArgs;
 
+typedef struct {
+  CpsrCommandBuffer *commandBuffer;
+  size_t renderTargetIndex;
+  uint64_t frameNumber;
+  SnlfFrameTiming timing;  // Update and draw are filled in by the graphics thread
+} SnlfGraphicsSubmission;
+
 struct _SnlfGraphicsThreadContext {
   SnlfCoreRef core;
   thread_id_t threadId;
@@ -95,7 +416,29 @@ struct _SnlfGraphicsThreadContext {
   SnlfFramerateU framerate;
   
   SnlfGraphicsData *root;
+  int32_t epochReader;  // Slot in the core's source epoch, held while the draw list reads snapshots
+  SnlfDrawList drawList;
+  SnlfTexturePool texturePool;
+  SnlfPipelineCache pipelineCache;
+  SnlfGraphicsDataRetirement retirement;
+  SnlfUploadRing uploadRing;
+  SnlfDrawBatch drawBatch;
+  SnlfRenderPass renderPass;
   SnlfGraphicsContext graphics;
+  
+  // Pipelined mode: the graphics thread updates and encodes frame N+1 while the present thread executes
+  // and displays frame N. Render targets are reused once frameFence reaches the frame that last used them.
+  bool pipelined;
+  pthread_t presentThread;
+  pthread_mutex_t presentMutex;
+  pthread_cond_t presentCond;
+  bool presentActive;
+  bool submissionPending;
+  SnlfGraphicsSubmission submission;
+  SnlfGraphicsContext presentGraphics;  // Copy of graphics whose command buffer belongs to the present thread
+  CpsrFence *frameFence;
+  uint64_t frameNumber;
+  uint64_t renderTargetFrameNumbers[SNLF_OUTPUT_BUFFER_COUNT];
 };
 
 void *SnlfGraphicsLoop(void *param);
@@ -6,7 +6,6 @@
 
 #include "osutil_uint128_t.h"
 
-extern inline void SnlfGraphicsDataDraw(SnlfGraphicsData *data, SnlfGraphicsDrawParams params);
 extern inline void SnlfGraphicsDataUninit(SnlfGraphicsData *data);
 
 static inline void GraphicsThreadCleanUp(SnlfGraphicsArgs *args) {
@@ -28,6 +27,7 @@ static inline SnlfGraphicsArgs *SnlfGraphicsThreadStateCreate(SnlfCoreRef core)
   args->resolution.height = 720;
   args->framerate.numerator = 60000;
   args->framerate.denominator = 1001;
+  args->pipelined = SNLF_GRAPHICS_PIPELINED;
   return args;
 }
 
@@ -88,6 +88,15 @@ bool SnlfGraphicsInit(SnlfCoreRef core) {
     return true;
   }
 
+  if (pthread_mutex_init(&core->graphicsStatistics.mutex, NULL)) {
+    CpsrDeviceDestroy(device);
+    pthread_mutex_destroy(&videoThreadMutex);
+    return true;
+  }
+  SnlfGraphicsResetStatistics(core);
+  osutil_atomic_store32(&core->lateFramePolicy, SNLF_LATE_FRAME_SKIP);
+  osutil_atomic_store32(&core->catchUpBudget, SNLF_GRAPHICS_CATCH_UP_BUDGET);
+
   core->device = device;
   core->videoThreadMutex = videoThreadMutex;
   core->graphicsThreadContext = NULL;
@@ -99,17 +108,253 @@ void SnlfGraphicsUninit(SnlfCoreRef core) {
 
   SnlfGraphicsThreadFinish(core);
   CpsrDeviceDestroy(core->device);
+  pthread_mutex_destroy(&core->graphicsStatistics.mutex);
   pthread_mutex_destroy(&core->videoThreadMutex);
   SnlfDealloc(core);
 }
 
+// ---
+// Statistics
+// ---
+static inline void SnlfGraphicsStatisticsAppend(SnlfCoreRef core, const SnlfFrameTiming *timing) {
+  SnlfGraphicsStatisticsData *statistics = &core->graphicsStatistics;
+  pthread_mutex_lock(&statistics->mutex);
+  statistics->timings[statistics->timingCount++ % SNLF_GRAPHICS_STATISTICS_WINDOW] = *timing;
+  pthread_mutex_unlock(&statistics->mutex);
+}
+
+static inline void SnlfGraphicsStatisticsAddFrames(SnlfCoreRef core, uint64_t frameCount, uint64_t droppedFrameCount, bool late) {
+  SnlfGraphicsStatisticsData *statistics = &core->graphicsStatistics;
+  pthread_mutex_lock(&statistics->mutex);
+  statistics->frameCount += frameCount;
+  statistics->droppedFrameCount += droppedFrameCount;
+  statistics->lateFrameCount += late ? 1 : 0;
+  pthread_mutex_unlock(&statistics->mutex);
+}
+
+static int SnlfDurationCompare(const void *a, const void *b) {
+  const duration_t lhs = *(const duration_t *)a;
+  const duration_t rhs = *(const duration_t *)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+void SnlfGraphicsGetStatistics(SnlfCoreRef core, SnlfGraphicsStatistics *statistics) {
+  assert(core);
+  assert(statistics);
+
+  // Copy out under the lock; sorting for the percentile happens outside it
+  duration_t durations[SNLF_FRAME_STAGE_COUNT][SNLF_GRAPHICS_STATISTICS_WINDOW];
+  SnlfGraphicsStatisticsData *data = &core->graphicsStatistics;
+  pthread_mutex_lock(&data->mutex);
+  statistics->frameCount = data->frameCount;
+  statistics->droppedFrameCount = data->droppedFrameCount;
+  statistics->lateFrameCount = data->lateFrameCount;
+
+  const uint32_t sampleCount = (uint32_t)(data->timingCount < SNLF_GRAPHICS_STATISTICS_WINDOW
+                                          ? data->timingCount
+                                          : SNLF_GRAPHICS_STATISTICS_WINDOW);
+  for (uint32_t i = 0; i < sampleCount; ++i) {
+    for (uint32_t stage = 0; stage < SNLF_FRAME_STAGE_COUNT; ++stage) {
+      durations[stage][i] = data->timings[i].stages[stage];
+    }
+  }
+  pthread_mutex_unlock(&data->mutex);
+
+  statistics->sampleCount = sampleCount;
+  for (uint32_t stage = 0; stage < SNLF_FRAME_STAGE_COUNT; ++stage) {
+    SnlfDurationStatistics *result = &statistics->stages[stage];
+    if (sampleCount == 0) {
+      memset(result, 0, sizeof(SnlfDurationStatistics));
+      continue;
+    }
+
+    duration_t *samples = durations[stage];
+    qsort(samples, sampleCount, sizeof(duration_t), SnlfDurationCompare);
+
+    duration_t sum = 0;
+    for (uint32_t i = 0; i < sampleCount; ++i) {
+      sum += samples[i];
+    }
+    result->min = samples[0];
+    result->avg = sum / sampleCount;
+    result->p99 = samples[(sampleCount * 99 + 99) / 100 - 1];
+    result->max = samples[sampleCount - 1];
+  }
+}
+
+void SnlfGraphicsResetStatistics(SnlfCoreRef core) {
+  assert(core);
+
+  SnlfGraphicsStatisticsData *statistics = &core->graphicsStatistics;
+  pthread_mutex_lock(&statistics->mutex);
+  statistics->frameCount = 0;
+  statistics->droppedFrameCount = 0;
+  statistics->lateFrameCount = 0;
+  statistics->timingCount = 0;
+  pthread_mutex_unlock(&statistics->mutex);
+}
+
+// ---
+// Late frame policy
+// ---
+SnlfLateFramePolicy SnlfGraphicsGetLateFramePolicy(SnlfCoreRef core) {
+  assert(core);
+
+  return (SnlfLateFramePolicy)osutil_atomic_load32(&core->lateFramePolicy);
+}
+
+uint32_t SnlfGraphicsGetCatchUpBudget(SnlfCoreRef core) {
+  assert(core);
+
+  return (uint32_t)osutil_atomic_load32(&core->catchUpBudget);
+}
+
+void SnlfGraphicsSetLateFramePolicy(SnlfCoreRef core, SnlfLateFramePolicy policy, uint32_t catchUpBudget) {
+  assert(core);
+
+  osutil_atomic_store32(&core->catchUpBudget, (int32_t)catchUpBudget);
+  osutil_atomic_store32(&core->lateFramePolicy, (int32_t)policy);
+}
+
+// ---
+// Present thread
+// ---
+void SnlfDisplayMainFromGraphicsContext(SnlfCoreRef core, const SnlfGraphicsContext *graphicsContext, size_t renderTargetIndex);
+
+static inline void SnlfGraphicsPresentFrame(SnlfGraphicsThreadContext *graphicsThreadContext, SnlfGraphicsSubmission submission) {
+  CpsrCommandBuffer *commandBuffer = submission.commandBuffer;
+  const uint64_t executeTime = osutil_gettime_as_nanoseconds();
+  CpsrCommandBufferExecute(commandBuffer);
+
+  // Display draws are recorded into the same command buffer by the display handlers
+  const uint64_t displayTime = osutil_gettime_as_nanoseconds();
+  SnlfGraphicsContext *presentGraphics = &graphicsThreadContext->presentGraphics;
+  presentGraphics->commandBuffer = commandBuffer;
+  SnlfDisplayMainFromGraphicsContext(graphicsThreadContext->core, presentGraphics, submission.renderTargetIndex);
+  presentGraphics->commandBuffer = NULL;
+
+  // Release the render target once everything reading it has run. The buffer is committed by now, so a
+  // signal encoded into it would never run; execution has completed, so signal from the host.
+  CpsrCommandBufferExecute(commandBuffer);
+  CpsrCommandBufferDestroy(commandBuffer);
+  CpsrFenceSignal(graphicsThreadContext->frameFence, submission.frameNumber);
+
+  const uint64_t endTime = osutil_gettime_as_nanoseconds();
+  submission.timing.stages[SNLF_FRAME_STAGE_EXECUTE] = displayTime - executeTime;
+  submission.timing.stages[SNLF_FRAME_STAGE_DISPLAY] = endTime - displayTime;
+  SnlfGraphicsStatisticsAppend(graphicsThreadContext->core, &submission.timing);
+}
+
+static void *SnlfGraphicsPresentLoop(void *param) {
+  SnlfGraphicsThreadContext *graphicsThreadContext = (SnlfGraphicsThreadContext *)param;
+
+  osutil_set_thread_name("Present Thread");
+  CpsrSetCurrentThreadPriority(CSPR_TP_GRAPHICS);
+
+  pthread_mutex_lock(&graphicsThreadContext->presentMutex);
+  for (;;) {
+    while (graphicsThreadContext->presentActive && !graphicsThreadContext->submissionPending) {
+      pthread_cond_wait(&graphicsThreadContext->presentCond, &graphicsThreadContext->presentMutex);
+    }
+    if (!graphicsThreadContext->submissionPending) {
+      break;
+    }
+
+    SnlfGraphicsSubmission submission = graphicsThreadContext->submission;
+    graphicsThreadContext->submissionPending = false;
+    pthread_mutex_unlock(&graphicsThreadContext->presentMutex);
+
+    SnlfGraphicsPresentFrame(graphicsThreadContext, submission);
+
+    pthread_mutex_lock(&graphicsThreadContext->presentMutex);
+  }
+  pthread_mutex_unlock(&graphicsThreadContext->presentMutex);
+  return NULL;
+}
+
+static inline bool SnlfGraphicsPresentThreadBegin(SnlfGraphicsThreadContext *graphicsThreadContext) {
+#ifdef __APPLE__
+  // Metal can only wait on shared events from the host
+  const CpsrFenceType fenceType = CPSR_FENCE_SHARED;
+#else
+  const CpsrFenceType fenceType = CPSR_FENCE_DEFAULT;
+#endif
+  CpsrFence *frameFence = CpsrFenceCreate(graphicsThreadContext->graphics.device, fenceType);
+  if (!frameFence) {
+    return true;
+  }
+
+  graphicsThreadContext->frameFence = frameFence;
+  graphicsThreadContext->frameNumber = 0;
+  memset(graphicsThreadContext->renderTargetFrameNumbers, 0, sizeof(graphicsThreadContext->renderTargetFrameNumbers));
+  graphicsThreadContext->presentGraphics = graphicsThreadContext->graphics;
+  graphicsThreadContext->presentGraphics.texturePool = NULL;
+  graphicsThreadContext->presentGraphics.uploadRing = NULL;
+  graphicsThreadContext->presentGraphics.drawBatch = NULL;
+  graphicsThreadContext->presentGraphics.renderPass = NULL;
+  graphicsThreadContext->presentGraphics.retirement = NULL;
+  graphicsThreadContext->presentActive = true;
+  graphicsThreadContext->submissionPending = false;
+  pthread_mutex_init(&graphicsThreadContext->presentMutex, NULL);
+  pthread_cond_init(&graphicsThreadContext->presentCond, NULL);
+  if (pthread_create(&graphicsThreadContext->presentThread, NULL, SnlfGraphicsPresentLoop, graphicsThreadContext)) {
+    pthread_cond_destroy(&graphicsThreadContext->presentCond);
+    pthread_mutex_destroy(&graphicsThreadContext->presentMutex);
+    CpsrFenceDestroy(frameFence);
+    graphicsThreadContext->frameFence = NULL;
+    return true;
+  }
+  return false;
+}
+
+static inline void SnlfGraphicsPresentThreadFinish(SnlfGraphicsThreadContext *graphicsThreadContext) {
+  // The present thread drains a pending submission before it quits
+  pthread_mutex_lock(&graphicsThreadContext->presentMutex);
+  graphicsThreadContext->presentActive = false;
+  pthread_cond_signal(&graphicsThreadContext->presentCond);
+  pthread_mutex_unlock(&graphicsThreadContext->presentMutex);
+  pthread_join(graphicsThreadContext->presentThread, NULL);
+
+  pthread_cond_destroy(&graphicsThreadContext->presentCond);
+  pthread_mutex_destroy(&graphicsThreadContext->presentMutex);
+  CpsrFenceDestroy(graphicsThreadContext->frameFence);
+  graphicsThreadContext->frameFence = NULL;
+}
+
+static inline void SnlfGraphicsPresentThreadSubmit(SnlfGraphicsThreadContext *graphicsThreadContext, SnlfGraphicsSubmission submission) {
+  // Keep at most one frame in flight so pipelining adds no more than a frame of latency
+  CpsrFenceWaitUntilCompleted(graphicsThreadContext->frameFence, submission.frameNumber - 1);
+
+  pthread_mutex_lock(&graphicsThreadContext->presentMutex);
+  graphicsThreadContext->submission = submission;
+  graphicsThreadContext->submissionPending = true;
+  pthread_cond_signal(&graphicsThreadContext->presentCond);
+  pthread_mutex_unlock(&graphicsThreadContext->presentMutex);
+}
+
 // ---
 // Graphics thread uninit
 // ---
 static inline void SnlfGraphicsThreadUninit(SnlfGraphicsThreadContext *graphicsThreadContext) {
   // TODO: release rootGraphicsData
 
+  if (graphicsThreadContext->frameFence) {
+    SnlfGraphicsPresentThreadFinish(graphicsThreadContext);
+  }
+  if (graphicsThreadContext->graphics.retirement) {
+    SnlfGraphicsDataRetirementUninit(&graphicsThreadContext->retirement);
+  }
   SnlfGraphicsContextUninit(&graphicsThreadContext->graphics);
+  SnlfDrawListUninit(&graphicsThreadContext->drawList);
+  SnlfTexturePoolUninit(&graphicsThreadContext->texturePool);
+  SnlfDrawBatchUninit(&graphicsThreadContext->drawBatch);
+  SnlfUploadRingUninit(&graphicsThreadContext->uploadRing);
+  if (graphicsThreadContext->graphics.pipelineCache) {
+    SnlfPipelineCacheUninit(&graphicsThreadContext->pipelineCache);
+  }
+  if (graphicsThreadContext->epochReader >= 0) {
+    SnlfEpochUnregisterReader(&graphicsThreadContext->core->sourceEpoch, graphicsThreadContext->epochReader);
+  }
   SnlfDealloc(graphicsThreadContext);
 }
 
@@ -129,11 +374,35 @@ static inline SnlfGraphicsThreadContext *SnlfGraphicsThreadInit(SnlfGraphicsArgs
   graphicsThreadContext->core = args->core;
   graphicsThreadContext->threadId = args->threadId;
 
+  graphicsThreadContext->epochReader = SnlfEpochRegisterReader(&args->core->sourceEpoch);
+  if (graphicsThreadContext->epochReader < 0) {
+    SnlfErrorLog("No reader slot is left in the source epoch.");
+    SnlfDealloc(graphicsThreadContext);
+    return NULL;
+  }
+
   graphicsThreadContext->framerate = args->framerate;
   graphicsThreadContext->interval =
       osutil_udiv128(osutil_umul64x64(1000000000, args->framerate.denominator), args->framerate.numerator);
 
   graphicsThreadContext->graphics.device = device;
+  graphicsThreadContext->graphics.drawList = &graphicsThreadContext->drawList;
+  graphicsThreadContext->graphics.texturePool = &graphicsThreadContext->texturePool;
+  SnlfTexturePoolInit(&graphicsThreadContext->texturePool, device);
+  SnlfDrawListInit(&graphicsThreadContext->drawList, &graphicsThreadContext->texturePool);
+  if (SnlfPipelineCacheInit(&graphicsThreadContext->pipelineCache, device)) {
+    SnlfGraphicsThreadUninit(graphicsThreadContext);
+    return NULL;
+  }
+  graphicsThreadContext->graphics.pipelineCache = &graphicsThreadContext->pipelineCache;
+  graphicsThreadContext->graphics.retirement = &graphicsThreadContext->retirement;
+  SnlfGraphicsDataRetirementInit(&graphicsThreadContext->retirement);
+  graphicsThreadContext->graphics.uploadRing = &graphicsThreadContext->uploadRing;
+  SnlfUploadRingInit(&graphicsThreadContext->uploadRing, device);
+  graphicsThreadContext->graphics.drawBatch = &graphicsThreadContext->drawBatch;
+  SnlfDrawBatchInit(&graphicsThreadContext->drawBatch);
+  graphicsThreadContext->graphics.renderPass = &graphicsThreadContext->renderPass;
+  SnlfRenderPassInit(&graphicsThreadContext->renderPass, &graphicsThreadContext->graphics);
 
   // Initialize graphics context
   if (SnlfGraphicsContextInit(&graphicsThreadContext->graphics, device, args->resolution)) {
@@ -150,6 +419,13 @@ static inline SnlfGraphicsThreadContext *SnlfGraphicsThreadInit(SnlfGraphicsArgs
   }
   graphicsThreadContext->root = (SnlfGraphicsData *)rootGraphicsData;
 
+  // Start present thread
+  graphicsThreadContext->pipelined = args->pipelined;
+  if (graphicsThreadContext->pipelined && SnlfGraphicsPresentThreadBegin(graphicsThreadContext)) {
+    SnlfWarningLog("Failed to start present thread; falling back to serial frames");
+    graphicsThreadContext->pipelined = false;
+  }
+
   return graphicsThreadContext;
 }
 
@@ -157,25 +433,51 @@ static inline SnlfGraphicsThreadContext *SnlfGraphicsThreadInit(SnlfGraphicsArgs
 // Graphics thread sleep
 // ---
 static inline void SnlfGraphicsThreadSleep(SnlfGraphicsThreadContext *graphicsThreadContext) {
+  SnlfCoreRef core = graphicsThreadContext->core;
   uint64_t interval = graphicsThreadContext->interval;
   uint64_t lastFrameTime = graphicsThreadContext->lastFrameTime;
   uint64_t currentFrameTime = lastFrameTime + interval;
   if (!osutil_wait_until_nanoseconds(currentFrameTime)) {
     graphicsThreadContext->frameCount += 1;
     graphicsThreadContext->lastFrameTime = currentFrameTime;
-  } else {
-    uint64_t frameCount = (osutil_gettime_as_nanoseconds() - lastFrameTime) / interval;
-    graphicsThreadContext->frameCount += frameCount;
-    graphicsThreadContext->droppedFrameCount += frameCount - 1;
-    graphicsThreadContext->lastFrameTime = lastFrameTime + interval * frameCount;
+    SnlfGraphicsStatisticsAddFrames(core, 1, 0, false);
+    return;
   }
+
+  const uint64_t currentTime = osutil_gettime_as_nanoseconds();
+  uint64_t frameCount = (currentTime - lastFrameTime) / interval;
+  switch (SnlfGraphicsGetLateFramePolicy(core)) {
+  case SNLF_LATE_FRAME_STRETCH:
+    // Start the next frame now and keep every timestamp one interval apart
+    graphicsThreadContext->frameCount += 1;
+    graphicsThreadContext->lastFrameTime = currentTime;
+    SnlfGraphicsStatisticsAddFrames(core, 1, 0, true);
+    return;
+
+  case SNLF_LATE_FRAME_CATCH_UP:
+    // Advance by a single interval so the next frames run without sleeping until the cadence is regained
+    if (frameCount <= SnlfGraphicsGetCatchUpBudget(core)) {
+      graphicsThreadContext->frameCount += 1;
+      graphicsThreadContext->lastFrameTime = currentFrameTime;
+      SnlfGraphicsStatisticsAddFrames(core, 1, 0, true);
+      return;
+    }
+    break;
+
+  case SNLF_LATE_FRAME_SKIP:
+  default:
+    break;
+  }
+
+  graphicsThreadContext->frameCount += frameCount;
+  graphicsThreadContext->droppedFrameCount += frameCount - 1;
+  graphicsThreadContext->lastFrameTime = lastFrameTime + interval * frameCount;
+  SnlfGraphicsStatisticsAddFrames(core, frameCount, frameCount - 1, true);
 }
 
 // ---
 // Graphics thread main loop
 // ---
-void SnlfDisplayMainFromGraphicsThreadContext(const SnlfGraphicsThreadContext *graphicsThreadContext);
-
 void *SnlfGraphicsLoop(void *param) {
   SnlfGraphicsArgs *args = (SnlfGraphicsArgs *)param;
   SnlfCoreRef core = args->core;
@@ -195,13 +497,23 @@ void *SnlfGraphicsLoop(void *param) {
 
   while (core->videoActive) {
     // Process commands
+    SnlfFrameTiming timing;
+    const uint64_t updateTime = osutil_gettime_as_nanoseconds();
     SnlfGraphicsDataProcessMessage(graphicsThreadContext->root, &graphicsThreadContext->graphics);
+    SnlfDrawListProcessTargets(&graphicsThreadContext->drawList, &graphicsThreadContext->graphics);
 
     // Trace appropriate timestamp
     SnlfGraphicsUpdateParams updateParams;
     updateParams.timestamp = graphicsThreadContext->lastFrameTime + graphicsThreadContext->interval;
     updateParams.world = matrix4x4_idt();
-    SnlfGraphicsDataUpdate(graphicsThreadContext->root, updateParams);
+    SnlfTransitionGraphicsDataUpdate((SnlfTransitionGraphicsData *)graphicsThreadContext->root, updateParams.timestamp);
+    if (graphicsThreadContext->drawList.dirty) {
+      SnlfDrawListCompile(&graphicsThreadContext->drawList, graphicsThreadContext->root);
+    }
+    SnlfEpochEnter(&core->sourceEpoch, graphicsThreadContext->epochReader);
+    SnlfDrawListUpdate(&graphicsThreadContext->drawList, updateParams);
+    SnlfEpochExit(&core->sourceEpoch, graphicsThreadContext->epochReader);
+    timing.stages[SNLF_FRAME_STAGE_UPDATE] = osutil_gettime_as_nanoseconds() - updateTime;
 
     // Create current command queue
     CpsrCommandBuffer *commandBuffer = CpsrCommandBufferCreate(graphicsThreadContext->graphics.commandQueue);
@@ -212,20 +524,56 @@ void *SnlfGraphicsLoop(void *param) {
       graphicsThreadContext->graphics.renderTargetCurrentIndex = 0;
     }
 
+    const size_t renderTargetIndex = graphicsThreadContext->graphics.renderTargetCurrentIndex;
+    if (graphicsThreadContext->pipelined) {
+      // Wait until the frame that last rendered into this target has been displayed
+      CpsrFenceWaitUntilCompleted(graphicsThreadContext->frameFence,
+                                  graphicsThreadContext->renderTargetFrameNumbers[renderTargetIndex]);
+    }
+
+    const uint64_t drawTime = osutil_gettime_as_nanoseconds();
     SnlfGraphicsDrawParams drawParams;
     drawParams.context = &graphicsThreadContext->graphics;
-    drawParams.renderTarget =
-        graphicsThreadContext->graphics.renderTargets[graphicsThreadContext->graphics.renderTargetCurrentIndex];
-    SnlfGraphicsDataDraw(graphicsThreadContext->root, drawParams);
-    CpsrCommandBufferExecute(graphicsThreadContext->graphics.commandBuffer);
-
-    // Notify display thread
-    SnlfDisplayMainFromGraphicsThreadContext(graphicsThreadContext);
-
-    // Clean up command queue
-    CpsrCommandBufferDestroy(commandBuffer);
+    drawParams.renderTarget = graphicsThreadContext->graphics.renderTargets[renderTargetIndex];
+    drawParams.renderPass = &graphicsThreadContext->renderPass;
+    SnlfTexturePoolBegin(&graphicsThreadContext->texturePool);
+    SnlfUploadRingBegin(&graphicsThreadContext->uploadRing, renderTargetIndex);
+    SnlfDrawListDraw(&graphicsThreadContext->drawList, drawParams);
+    timing.stages[SNLF_FRAME_STAGE_DRAW] = osutil_gettime_as_nanoseconds() - drawTime;
+
+    if (graphicsThreadContext->pipelined) {
+      // Hand the frame to the present thread, which executes, displays and destroys it
+      SnlfGraphicsSubmission submission;
+      submission.commandBuffer = commandBuffer;
+      submission.renderTargetIndex = renderTargetIndex;
+      submission.frameNumber = ++graphicsThreadContext->frameNumber;
+      graphicsThreadContext->renderTargetFrameNumbers[renderTargetIndex] = submission.frameNumber;
+      submission.timing = timing;
+      SnlfGraphicsPresentThreadSubmit(graphicsThreadContext, submission);
+    } else {
+      const uint64_t executeTime = osutil_gettime_as_nanoseconds();
+      CpsrCommandBufferExecute(commandBuffer);
+
+      // Notify display thread
+      const uint64_t displayTime = osutil_gettime_as_nanoseconds();
+      SnlfDisplayMainFromGraphicsContext(core, &graphicsThreadContext->graphics, renderTargetIndex);
+
+      // Clean up command queue
+      CpsrCommandBufferDestroy(commandBuffer);
+
+      timing.stages[SNLF_FRAME_STAGE_EXECUTE] = displayTime - executeTime;
+      timing.stages[SNLF_FRAME_STAGE_DISPLAY] = osutil_gettime_as_nanoseconds() - displayTime;
+      SnlfGraphicsStatisticsAppend(core, &timing);
+    }
     graphicsThreadContext->graphics.commandBuffer = NULL;
 
+    // Destroy pipeline states and uninit graphics data released before frames that have completed
+    const uint64_t completedFrameNumber = graphicsThreadContext->pipelined
+      ? CpsrFenceGetCompletedValue(graphicsThreadContext->frameFence)
+      : graphicsThreadContext->frameNumber;
+    SnlfPipelineCacheEndFrame(&graphicsThreadContext->pipelineCache, graphicsThreadContext->frameNumber, completedFrameNumber);
+    SnlfGraphicsDataRetirementEndFrame(&graphicsThreadContext->retirement, graphicsThreadContext->frameNumber, completedFrameNumber);
+
     // Sleep graphics thread
     SnlfGraphicsThreadSleep(graphicsThreadContext);
   }
@@ -12,18 +12,23 @@ const CpsrCommandBuffer *SnlfGraphicsContextGetCommandBuffer(const SnlfGraphicsC
 }
 
 CpsrGraphicsContext *SnlfGraphicsContextCreateGraphicsContext(const SnlfGraphicsContext *context) {
+  // Close the shared pass, so draws encoded in it stay ordered before whatever the caller encodes
+  if (context->renderPass) {
+    SnlfRenderPassEnd(context->renderPass);
+  }
   return CpsrGraphicsContextCreate(context->commandBuffer);
 }
 
 const CpsrShaderFunction *SnlfGraphicsContextGetShaderFunction(const SnlfGraphicsContext *context, SnlfShaderFunction function) {
   switch (function) {
-  case SNLF_SHADER_VERTEX_DRAW:                 return context->drawVS;
-  case SNLF_SHADER_VERTEX_DRAW_SIMPLE:          return context->drawSimpleVS;
-  case SNLF_SHADER_PIXEL_DRAW_HALF:             return context->drawHalfPS;
-  case SNLF_SHADER_PIXEL_DRAW_SINGLE:           return context->drawSinglePS;
-  case SNLF_SHADER_VERTEX_DRAW_COLOR:           return context->drawColorVS;
-  case SNLF_SHADER_VERTEX_DRAW_COLOR_INSTANCED: return context->drawColorInstancedVS;
-  case SNLF_SHADER_PIXEL_DRAW_COLOR:            return context->drawColorPS;
+  case SNLF_SHADER_VERTEX_DRAW:                  return context->drawVS;
+  case SNLF_SHADER_VERTEX_DRAW_SIMPLE:           return context->drawSimpleVS;
+  case SNLF_SHADER_VERTEX_DRAW_SIMPLE_INSTANCED: return context->drawSimpleInstancedVS;
+  case SNLF_SHADER_PIXEL_DRAW_HALF:              return context->drawHalfPS;
+  case SNLF_SHADER_PIXEL_DRAW_SINGLE:            return context->drawSinglePS;
+  case SNLF_SHADER_VERTEX_DRAW_COLOR:            return context->drawColorVS;
+  case SNLF_SHADER_VERTEX_DRAW_COLOR_INSTANCED:  return context->drawColorInstancedVS;
+  case SNLF_SHADER_PIXEL_DRAW_COLOR:             return context->drawColorPS;
   default:
     return NULL;
   }
@@ -34,6 +39,11 @@ const CpsrShaderFunction *SnlfGraphicsContextGetShaderFunction(const SnlfGraphic
 // ---
 bool SnlfGraphicsContextInit(SnlfGraphicsContext *context, const CpsrDevice *device, CpsrSizeU32 resolution) {
   // Initialize graphics resources
+#if !defined(_WIN32) && !defined(__APPLE__)
+  CpsrShaderLibraryRegisterNative("./Resources/", kSnlfDrawShaders, kSnlfDrawShadersCount);
+  CpsrShaderLibraryRegisterNative("./Resources/", kSnlfDrawColorShaders, kSnlfDrawColorShadersCount);
+  CpsrShaderLibraryRegisterNative("./Resources/", kSnlfPosterizationShaders, kSnlfPosterizationShadersCount);
+#endif
   CpsrShaderLibrary *library = CpsrShaderLibraryCreate(device, "./Resources/");
   if (!library) {
     SnlfErrorLog("Create shader default library failed.");
@@ -51,23 +61,33 @@ bool SnlfGraphicsContextInit(SnlfGraphicsContext *context, const CpsrDevice *dev
   } \
   context->__NAME__ = __NAME__
   
-#define INIT_PIPELINE_STATE(__NAME__, __VERTEX_FN__, __PIXEL_FN__) \
-  CpsrGraphicsPipelineState *__NAME__ = CpsrGraphicsPipelineStateCreate(device); \
+  // Built-in pipeline states are created once here and shared through the pipeline cache
+  SnlfPipelineStateDescriptor pipelineDescriptor;
+#define INIT_PIPELINE_STATE(__NAME__, __VERTEX_FN__, __PIXEL_FN__, __BLEND__) \
+  SnlfPipelineStateDescriptorInit(&pipelineDescriptor, __VERTEX_FN__, __PIXEL_FN__); \
+  pipelineDescriptor.blend = __BLEND__; \
+  CpsrGraphicsPipelineState *__NAME__ = SnlfPipelineCacheAcquire(context->pipelineCache, &pipelineDescriptor); \
   if (!__NAME__) { \
     SnlfErrorLogFormat("Create pipeline state \"%s\" failed.", #__NAME__); \
     SnlfGraphicsContextUninit(context); \
     return NULL;\
   } \
-  CpsrGraphicsPipelineStateSetPrimitiveTopologyType(__NAME__, CPSR_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE); \
-  CpsrGraphicsPipelineStateSetVertexFunction(__NAME__, __VERTEX_FN__); \
-  CpsrGraphicsPipelineStateSetPixelFunction(__NAME__, __PIXEL_FN__); \
   context->__NAME__ = __NAME__
   
   INIT_SHADER_FUNCTION(drawVS, DrawVS);
   INIT_SHADER_FUNCTION(drawSimpleVS, DrawSimpleVS);
+  INIT_SHADER_FUNCTION(drawSimpleInstancedVS, DrawSimpleInstancedVS);
   INIT_SHADER_FUNCTION(drawHalfPS, DrawHalfPS);
   INIT_SHADER_FUNCTION(drawSinglePS, DrawSinglePS);
-  INIT_PIPELINE_STATE(drawSimplePipelineState, drawSimpleVS, drawHalfPS);
+  INIT_PIPELINE_STATE(drawSimplePipelineState, drawSimpleVS, drawHalfPS, kCpsrBlendDefault);
+  
+  // Cached subtrees are premultiplied and mostly transparent, so they are composited with "over"
+  static const CpsrBlendDescriptor kSnlfBlendCache = {
+    true,           CPSR_BLEND_ONE,                    CPSR_BLEND_ONE_MINUS_SOURCE_ALPHA, CPSR_BLEND_OPERATION_ADD,
+    CPSR_BLEND_ONE, CPSR_BLEND_ONE_MINUS_SOURCE_ALPHA, CPSR_BLEND_OPERATION_ADD,          { { true, true, true, true } }
+  };
+  INIT_PIPELINE_STATE(drawCachePipelineState, drawSimpleVS, drawHalfPS, kSnlfBlendCache);
+  INIT_PIPELINE_STATE(drawReferencePipelineState, drawSimpleInstancedVS, drawHalfPS, kSnlfBlendCache);
   
   INIT_SHADER_FUNCTION(drawColorVS, DrawColorVS);
   INIT_SHADER_FUNCTION(drawColorInstancedVS, DrawColorInstancedVS);
@@ -90,11 +110,20 @@ bool SnlfGraphicsContextInit(SnlfGraphicsContext *context, const CpsrDevice *dev
   }
   context->planeVertexBuffer = planeVertexBuffer;
   
+  const matrix4x4_t identity = matrix4x4_idt();
+  CpsrBuffer *identityTransformBuffer = CpsrBufferCreateFromData(device, &identity, sizeof(matrix4x4_t), CPSR_CONSTANT_BUFFER);
+  if (!identityTransformBuffer) {
+    SnlfAssertWithOutOfMemory("Create identity transform buffer failed");
+    SnlfGraphicsContextUninit(context);
+    return true;
+  }
+  context->identityTransformBuffer = identityTransformBuffer;
+  
   // Initialize render target
   CpsrTexture2DDescriptor desc;
   desc.size = resolution;
   desc.arrayLength = 1;
-  desc.pixelFormat = CPSR_PIXELFORMAT_RGBA16_FLOAT;
+  desc.pixelFormat = SNLF_RENDER_TARGET_PIXEL_FORMAT;
   desc.usage = CPSR_TEXTURE_USAGE_READ | CPSR_TEXTURE_USAGE_RENDER_TARGET;
   CpsrHeap *renderTargetsHeap = CpsrHeapCreateFormTexture2DDescriptor(device, &desc, SNLF_OUTPUT_BUFFER_COUNT, CPSR_HEAP_TYPE_DEFAULT);
   if (!renderTargetsHeap) {
@@ -135,6 +164,10 @@ void SnlfGraphicsContextUninit(SnlfGraphicsContext *context) {
     CpsrBufferDestroy(context->planeVertexBuffer);
     context->planeVertexBuffer = NULL;
   }
+  if (context->identityTransformBuffer) {
+    CpsrBufferDestroy(context->identityTransformBuffer);
+    context->identityTransformBuffer = NULL;
+  }
 
   for (size_t i = 0; i < SNLF_OUTPUT_BUFFER_COUNT; ++i) {
     CpsrTexture2D *renderTarget = context->renderTargets[i];
@@ -156,13 +189,16 @@ void SnlfGraphicsContextUninit(SnlfGraphicsContext *context) {
   
 #define RELEASE_PIPELINE_STATE(__NAME__) \
   if (context->__NAME__) { \
-    CpsrGraphicsPipelineStateDestroy(context->__NAME__); \
+    SnlfPipelineCacheRelease(context->pipelineCache, context->__NAME__); \
     context->__NAME__ = NULL; \
   }
   
   RELEASE_PIPELINE_STATE(drawSimplePipelineState);
+  RELEASE_PIPELINE_STATE(drawCachePipelineState);
+  RELEASE_PIPELINE_STATE(drawReferencePipelineState);
   RELEASE_SHADER_FUNCTION(drawVS);
   RELEASE_SHADER_FUNCTION(drawSimpleVS);
+  RELEASE_SHADER_FUNCTION(drawSimpleInstancedVS);
   RELEASE_SHADER_FUNCTION(drawHalfPS);
   RELEASE_SHADER_FUNCTION(drawSinglePS);
   
@@ -182,10 +218,7 @@ void SnlfGraphicsContextUninit(SnlfGraphicsContext *context) {
 // ---
 // Draw primitive
 // ---
-void SnlfGraphicsContextDrawToSwapChain(const SnlfGraphicsContext *context, const CpsrTexture2D *source, CpsrSwapChain *destination, const CpsrBuffer *transformBuffer) {
-  CpsrGraphicsPipelineState *pipelineState = context->drawSimplePipelineState;
-  CpsrSetRenderTargetPixelFormatFromSwapChain(pipelineState, 0, destination);
-  
+void SnlfGraphicsContextDrawToSwapChain(const SnlfGraphicsContext *context, CpsrGraphicsPipelineState *pipelineState, const CpsrTexture2D *source, CpsrSwapChain *destination, const CpsrBuffer *transformBuffer) {
   CpsrCommandBuffer *commandBuffer = context->commandBuffer;
   CpsrGraphicsContext *graphicsContext = CpsrGraphicsContextCreate(commandBuffer);
   CpsrGraphicsContextSetRenderTargetFromSwapChain(graphicsContext, destination);
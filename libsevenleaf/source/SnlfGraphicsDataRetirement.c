@@ -0,0 +1,65 @@
+#include "SnlfGraphics+Private.h"
+
+// ---
+// Init/Uninit
+// ---
+void SnlfGraphicsDataRetirementInit(SnlfGraphicsDataRetirement *retirement) {
+  assert(retirement);
+  
+  retirement->frameNumber = 0;
+  retirement->retiredCount = 0;
+  retirement->retiredCapacity = 0;
+  retirement->retireds = NULL;
+}
+
+// Uninitializes the graphics data still retired as well. No frame may be in flight.
+void SnlfGraphicsDataRetirementUninit(SnlfGraphicsDataRetirement *retirement) {
+  assert(retirement);
+  
+  SnlfGraphicsDataRetirementEndFrame(retirement, retirement->frameNumber, retirement->frameNumber);
+  SnlfDealloc(retirement->retireds);
+  retirement->retireds = NULL;
+  retirement->retiredCapacity = 0;
+}
+
+// ---
+// Retirement
+// ---
+// data has to be out of the tree already, so no later frame draws it.
+void SnlfGraphicsDataRetire(SnlfGraphicsDataRetirement *retirement, SnlfGraphicsData *data) {
+  assert(retirement);
+  assert(data);
+  
+  if (retirement->retiredCount == retirement->retiredCapacity) {
+    const size_t capacity = retirement->retiredCapacity ? 2 * retirement->retiredCapacity : 4;
+    SnlfGraphicsDataRetired *retireds = (SnlfGraphicsDataRetired *)realloc(retirement->retireds, sizeof(SnlfGraphicsDataRetired) * capacity);
+    if (!retireds) {
+      // Leak rather than free resources a frame in flight may still use
+      SnlfOutOfMemoryError();
+      return;
+    }
+    retirement->retireds = retireds;
+    retirement->retiredCapacity = capacity;
+  }
+  
+  SnlfGraphicsDataRetired *retired = retirement->retireds + retirement->retiredCount++;
+  retired->data = data;
+  retired->frameNumber = retirement->frameNumber;
+}
+
+// Called by the graphics thread after each frame. completedFrameNumber is the last frame the frame fence has
+// passed; without a present thread every frame has completed on submission.
+void SnlfGraphicsDataRetirementEndFrame(SnlfGraphicsDataRetirement *retirement, uint64_t submittedFrameNumber, uint64_t completedFrameNumber) {
+  assert(retirement);
+  
+  retirement->frameNumber = submittedFrameNumber;
+  for (size_t i = 0; i < retirement->retiredCount;) {
+    const SnlfGraphicsDataRetired retired = retirement->retireds[i];
+    if (retired.frameNumber > completedFrameNumber) {
+      ++i;
+      continue;
+    }
+    retirement->retireds[i] = retirement->retireds[--retirement->retiredCount];
+    SnlfGraphicsDataUninit(retired.data);
+  }
+}
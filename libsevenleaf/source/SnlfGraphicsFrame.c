@@ -1,7 +1,7 @@
 #include "SnlfCore+Private.h"
 #include "SnlfGraphicsFrame+Private.h"
 
-#include "containers/SnlfLockFreeQueue.h"
+#include "SnlfQueue+Private.h"
 
 // ---
 // Data types
@@ -12,7 +12,12 @@ struct _SnlfGraphicsFrameAllocator {
   SnlfGraphicsFrameFormat format;
   CpsrPixelFormat nativeFormat;
   CpsrSizeU32 size;
-  SnlfLockFreeQueue frameQueue;
+  SnlfQueue frameQueue;
+  
+  // Formats the device cannot load are converted on the CPU into RGBA16F textures
+  bool converting;
+  SnlfFrameConverter converter;
+  uint16_t *conversionBuffer;  // Allocated on the first write after a size change
 };
 
 typedef struct {
@@ -65,12 +70,12 @@ int32_t SnlfGraphicsFrameRelease(SnlfGraphicsFrameHeader *graphicsFrame) {
   SnlfVerboseLogFormat("Release reference count: %d on %p (SnlfGraphicsFrame)", ret - 1, obj);
 #endif
   if (ret == 1) {
-    SnlfGraphicsFrameAllocatorRef allocator = graphicsFrame->heapData->allocator;
-    if (CpsrSizeU32Equal(allocator->size, CpsrTexture2DGetSize(graphicsFrame->frame))) {
-      SnlfLockFreeQueueEnqueue(&allocator->frameQueue, (intptr_t)graphicsFrame);
-    } else {
+    SnlfGraphicsFrameGPUHeapData *heapData = (SnlfGraphicsFrameGPUHeapData *)graphicsFrame->heapData;
+    SnlfGraphicsFrameAllocatorRef allocator = heapData->allocator;
+    if (!CpsrSizeU32Equal(allocator->size, CpsrTexture2DGetSize(graphicsFrame->frame))
+        || SnlfQueueEnqueue(&allocator->frameQueue, graphicsFrame)) {
       SnlfGraphicsFrameDestroy(graphicsFrame);
-      SnlfGraphicsFrameGpuHeapRelease((SnlfGraphicsFrameGPUHeapData *)graphicsFrame->heapData);
+      SnlfGraphicsFrameGpuHeapRelease(heapData);
     }
   }
   return --ret;
@@ -86,7 +91,29 @@ void SnlfRGBSDRGraphicsFrameWrite(SnlfRGBSDRGraphicsFrame *graphicsFrame, intptr
   assert(graphicsFrame->heapData->allocator->heapType == CPSR_HEAP_TYPE_UPLOAD);
   
   const CpsrTexture2D *texture = graphicsFrame->frame;
-  CpsrTexture2DWrite(texture, (void *)data, bytesPerRow);
+  SnlfGraphicsFrameAllocatorRef allocator = graphicsFrame->heapData->allocator;
+  if (!allocator->converting) {
+    CpsrTexture2DWrite(texture, (void *)data, bytesPerRow);
+    return;
+  }
+  
+  const CpsrSizeU32 size = CpsrTexture2DGetSize(texture);
+  const size_t convertedBytesPerRow = 4 * sizeof(uint16_t) * size.width;
+  if (!allocator->conversionBuffer) {
+    allocator->conversionBuffer = (uint16_t *)malloc(convertedBytesPerRow * size.height);
+    if (!allocator->conversionBuffer) {
+      SnlfOutOfMemoryError();
+      return;
+    }
+  }
+  
+  SnlfFrameConverterSource source;
+  SnlfFrameConverterSourceInit(&allocator->converter, size, (const uint8_t *)data, bytesPerRow, &source);
+  if (SnlfFrameConverterConvert(&allocator->converter, &source, 0, size.height, allocator->conversionBuffer, convertedBytesPerRow)) {
+    SnlfOutOfMemoryError();
+    return;
+  }
+  CpsrTexture2DWrite(texture, allocator->conversionBuffer, convertedBytesPerRow);
 }
 
 // ---
@@ -134,7 +161,10 @@ SnlfGraphicsFrameGPUHeapData *SnlfGraphicsFrameGpuHeapCreate(SnlfGraphicsFrameAl
   for (size_t i = 0; i < count; ++i) {
     CpsrTexture2D *texture = CpsrTexture2DCreateFromHeap(heap, &textureDesc);
     SnlfRGBSDRGraphicsFrame *frame = SnlfRGBSDRGraphicsFrameCreate((SnlfGraphicsFrameHeapData *)gpuHeap, texture);
-    SnlfLockFreeQueueEnqueue(&allocator->frameQueue, (intptr_t)frame);
+    if (SnlfQueueEnqueue(&allocator->frameQueue, frame)) {
+      SnlfGraphicsFrameDestroy((SnlfGraphicsFrameHeader *)frame);
+      SnlfGraphicsFrameGpuHeapRelease(gpuHeap);
+    }
   }
   return gpuHeap;
 }
@@ -161,7 +191,9 @@ void SnlfGraphicsFrameAllocatorInitPrivate(SnlfGraphicsFrameAllocatorRef allocat
   allocator->heapType = heapType;
   allocator->format = format;
   allocator->size = size;
-  SnlfLockFreeQueueInit(&allocator->frameQueue);
+  SnlfQueueInit(&allocator->frameQueue, SNLF_FRAME_QUEUE_CAPACITY);
+  allocator->converting = false;
+  allocator->conversionBuffer = NULL;
 }
 
 SnlfGraphicsFrameAllocatorRef SnlfGraphicsFrameAllocatorInit(const CpsrDevice *device, CpsrHeapType heapType, SnlfGraphicsFrameFormat format, CpsrSizeU32 size) {
@@ -176,13 +208,18 @@ SnlfGraphicsFrameAllocatorRef SnlfGraphicsFrameAllocatorInit(const CpsrDevice *d
 }
 
 void SnlfGraphicsFrameAllocatorUninit(SnlfGraphicsFrameAllocatorRef allocator) {
-  SnlfLockFreeQueue *frameQueue = &allocator->frameQueue;
+  SnlfQueue *frameQueue = &allocator->frameQueue;
   
+  // Releasing a free frame would recycle it into this queue again, so destroy it directly
   SnlfGraphicsFrameHeader *frame = NULL;
-  while ((frame = (SnlfGraphicsFrameHeader *)SnlfLockFreeQueueDequeue(frameQueue))) {
-    SnlfGraphicsFrameRelease(frame);
+  while ((frame = (SnlfGraphicsFrameHeader *)SnlfQueueDequeue(frameQueue))) {
+    SnlfGraphicsFrameGPUHeapData *heapData = (SnlfGraphicsFrameGPUHeapData *)frame->heapData;
+    SnlfGraphicsFrameDestroy(frame);
+    SnlfGraphicsFrameGpuHeapRelease(heapData);
   }
-  SnlfLockFreeQueueUninit(frameQueue);
+  SnlfQueueUninit(frameQueue);
+  SnlfDealloc(allocator->conversionBuffer);
+  allocator->conversionBuffer = NULL;
 }
 
 SnlfGraphicsFrameFormat SnlfGraphicsFrameAllocatorGetFormat(SnlfGraphicsFrameAllocatorRef allocator) {
@@ -191,6 +228,7 @@ SnlfGraphicsFrameFormat SnlfGraphicsFrameAllocatorGetFormat(SnlfGraphicsFrameAll
 
 bool SnlfGraphicsFrameAllocatorSetFormat(SnlfGraphicsFrameAllocatorRef allocator, SnlfGraphicsFrameFormat format) {
   allocator->format = format;
+  allocator->converting = false;
   
   // 4-bit RGB
   if (format == SNLF_GRAPHICS_FRAME_RGBX4
@@ -246,6 +284,22 @@ bool SnlfGraphicsFrameAllocatorSetFormat(SnlfGraphicsFrameAllocatorRef allocator
     return true;
   }
   
+  // Other formats are converted into RGBA16F, YUV as BT.709 limited range
+  const SnlfYUVFrameDescriptor descriptor = {
+    .primaries = SNLF_CP_BT709,
+    .sampleAspectRatio = { 1, 1 },
+    .yRange = { 16.F / 255.F, 235.F / 255.F },
+    .uvRange = { 16.F / 255.F, 240.F / 255.F },
+    .coefficients = SNLF_CM_BT709,
+  };
+  const CpsrPixelFormatCapabilities capabilities = CpsrDeviceGetPixelFormatCapabilities(allocator->device, CPSR_PIXELFORMAT_RGBA16_FLOAT);
+  if (capabilities.load
+      && !SnlfFrameConverterInit(&allocator->converter, format, SnlfGraphicsFrameFormatIsYUV(format) ? &descriptor : NULL)) {
+    allocator->nativeFormat = CPSR_PIXELFORMAT_RGBA16_FLOAT;
+    allocator->converting = true;
+    return true;
+  }
+  
   return false;
 }
 
@@ -256,4 +310,6 @@ CpsrSizeU32 SnlfGraphicsFrameAllocatorGetSize(SnlfGraphicsFrameAllocatorRef allo
 
 void SnlfGraphicsFrameAllocatorSetSize(SnlfGraphicsFrameAllocatorRef allocator, CpsrSizeU32 size) {
   allocator->size = size;
+  SnlfDealloc(allocator->conversionBuffer);
+  allocator->conversionBuffer = NULL;
 }
@@ -42,6 +42,7 @@ SnlfInputRef SnlfInputRegister(SnlfCoreRef core, SnlfInputDescriptor *descriptor
   
   // Init
   osutil_atomic_store32(&input->activeCount, 0);
+  osutil_atomic_store64(&input->affinityMask, 0);
   input->identifier = ++core->inputUniqueIdentifier;
   input->descriptor = *descriptor;
   input->context = input->descriptor.init(descriptor);
@@ -122,3 +123,29 @@ const char *SnlfInputGetFriendlyName(SnlfInputRef input) {
   
   return input->descriptor.friendlyName;
 }
+
+// ---
+// Jobs
+// ---
+void SnlfInputSetAffinityMask(SnlfInputRef input, uint64_t affinityMask) {
+  assert(input);
+  
+  osutil_atomic_store64(&input->affinityMask, (int64_t)affinityMask);
+}
+
+uint64_t SnlfInputGetAffinityMask(SnlfInputRef input) {
+  assert(input);
+  
+  return (uint64_t)osutil_atomic_load64(&input->affinityMask);
+}
+
+bool SnlfInputDispatchRows(SnlfInputRef input, const SnlfRowJob *job, SnlfJobCounter *counter) {
+  assert(input);
+  assert(job);
+  
+  SnlfRowJob pinnedJob = *job;
+  if (!pinnedJob.affinityMask) {
+    pinnedJob.affinityMask = SnlfInputGetAffinityMask(input);
+  }
+  return SnlfCoreDispatchRows(input->core, &pinnedJob, counter);
+}
@@ -16,20 +16,24 @@ static void SnlfInputSourceGraphicsDataProcessMessage(intptr_t _data, const Snlf
   SnlfAssume(_data);
   SnlfInputSourceGraphicsData *data = (SnlfInputSourceGraphicsData *)_data;
   
-  const SnlfBasicMessage *message;
-  while ((message = (const SnlfBasicMessage *)SnlfLockFreeQueueDequeue(&data->messageQueue))) {
-    switch (message->type) {
-    case SNLF_MESSAGE_SOURCE_ANIMATION:
-      break;
-        
-    default:
+  intptr_t messages[SNLF_MESSAGE_BATCH_COUNT];
+  size_t count;
+  while ((count = SnlfQueueDequeueBatch(&data->messageQueue, messages, SNLF_MESSAGE_BATCH_COUNT))) {
+    for (size_t i = 0; i < count; ++i) {
+      const SnlfBasicMessage *message = (const SnlfBasicMessage *)messages[i];
+      switch (message->type) {
+      case SNLF_MESSAGE_SOURCE_ANIMATION:
         break;
+        
+      default:
+          break;
+      }
+      SnlfMessageRelease(message);
     }
-    SnlfDealloc(message);
   }
 }
 
-static void SnlfInputSourceGraphicsDataUpdate(intptr_t _data, SnlfGraphicsUpdateParams params) {
+static void SnlfInputSourceGraphicsDataCompile(intptr_t _data, SnlfDrawList *drawList, int32_t parent) {
   SnlfAssume(_data);
   
   SnlfInputSourceGraphicsData *data = (SnlfInputSourceGraphicsData *)_data;
@@ -37,18 +41,8 @@ static void SnlfInputSourceGraphicsDataUpdate(intptr_t _data, SnlfGraphicsUpdate
     SnlfInputRef input = data->source->input;
     SnlfAssume(input);
     
+    // Inputs do not draw yet
     //input->descriptor.update(input->context, params);
-  }
-}
-
-static void SnlfInputSourceGraphicsDataDraw(intptr_t _data, SnlfGraphicsDrawParams params) {
-  SnlfAssume(_data);
-  
-  SnlfInputSourceGraphicsData *data = (SnlfInputSourceGraphicsData *)_data;
-  if (data->enabled) {
-    SnlfInputRef input = data->source->input;
-    SnlfAssume(input);
-    
     //input->descriptor.draw(input->context, params);
   }
 }
@@ -57,7 +51,9 @@ void SnlfInputSourceGraphicsDataUninit(intptr_t _data) {
   SnlfAssume(_data);
   
   SnlfInputSourceGraphicsData *data = (SnlfInputSourceGraphicsData *)_data;
+  SnlfSourceDetachGraphicsData(data->source, (SnlfGraphicsData *)data);
   SnlfSourceRelease(data->source);
+  SnlfQueueUninit(&data->messageQueue);
   SnlfDealloc(data);
 }
 
@@ -76,10 +72,9 @@ SnlfGraphicsData *SnlfGraphicsDataInitForInput(SnlfSourceRef source, const SnlfG
     return NULL;
   }
   
-  SnlfLockFreeQueueInit(&data->messageQueue);
+  SnlfQueueInit(&data->messageQueue, SNLF_MESSAGE_QUEUE_CAPACITY);
   data->processMessage = SnlfInputSourceGraphicsDataProcessMessage;
-  data->update = SnlfInputSourceGraphicsDataUpdate;
-  data->draw = SnlfInputSourceGraphicsDataDraw;
+  data->compile = SnlfInputSourceGraphicsDataCompile;
   data->uninit = SnlfInputSourceGraphicsDataUninit;
   
   data->source = source;
@@ -0,0 +1,229 @@
+#include "SnlfCore+Private.h"
+
+#include <assert.h>
+
+#define LOCK(__POOL__)   pthread_mutex_lock(&__POOL__->mutex)
+#define UNLOCK(__POOL__) pthread_mutex_unlock(&__POOL__->mutex)
+
+// ---
+// Worker
+// ---
+// Takes the oldest band the logical cores of coreMask may run. Returns true when there is none.
+static inline bool SnlfJobPoolTake(SnlfJobPool *pool, uint64_t coreMask, SnlfJobBand *band) {
+  for (size_t i = 0; i < pool->bandCount; ++i) {
+    if (pool->bands[i].affinityMask & coreMask) {
+      *band = pool->bands[i];
+      memmove(pool->bands + i, pool->bands + i + 1, sizeof(SnlfJobBand) * (pool->bandCount - i - 1));
+      --pool->bandCount;
+      return false;
+    }
+  }
+  return true;
+}
+
+static void *SnlfJobWorkerLoop(void *param) {
+  SnlfJobWorker *worker = (SnlfJobWorker *)param;
+  SnlfJobPool *pool = worker->pool;
+  const uint64_t coreMask = (uint64_t)1 << worker->logicalCore;
+  
+  osutil_set_thread_name("Job Worker Thread");
+  if (osutil_set_thread_affinity(coreMask)) {
+    SnlfWarningLogFormat("Pinning a job worker to core %u failed.", worker->logicalCore);
+  }
+  
+  LOCK(pool);
+  for (;;) {
+    // Queued bands are drained before the worker quits
+    SnlfJobBand band;
+    if (SnlfJobPoolTake(pool, coreMask, &band)) {
+      if (!pool->active) {
+        break;
+      }
+      pthread_cond_wait(&pool->workCond, &pool->mutex);
+      continue;
+    }
+    UNLOCK(pool);
+  
+    band.function(band.param, band.firstRow, band.rowCount);
+  
+    LOCK(pool);
+    if (!--band.counter->pending) {
+      pthread_cond_broadcast(&pool->doneCond);
+    }
+  }
+  UNLOCK(pool);
+  return NULL;
+}
+
+// ---
+// Init/Uninit
+// ---
+bool SnlfCoreInitForJobs(SnlfCoreRef core) {
+  SnlfJobPool *pool = &core->jobPool;
+  pool->active = true;
+  pool->bandCount = 0;
+  pool->bandCapacity = 0;
+  pool->bands = NULL;
+  pool->workerMask = 0;
+  pool->workerCount = 0;
+  
+  // Half the L2 cache leaves room for whatever else the core runs
+  const int64_t l2CacheSize = osutil_get_l2_cachesize();
+  pool->bandBytes = l2CacheSize > 0 ? (size_t)l2CacheSize / 2 : SNLF_JOB_BAND_BYTES;
+  
+  if (SnlfMutexCreate(&pool->mutex)) {
+    return true;
+  }
+  pthread_cond_init(&pool->workCond, NULL);
+  pthread_cond_init(&pool->doneCond, NULL);
+  
+  int32_t logicalCores = osutil_get_logical_cores();
+  if (logicalCores < 1) {
+    logicalCores = 1;
+  } else if (logicalCores > SNLF_JOB_WORKER_COUNT_MAX) {
+    logicalCores = SNLF_JOB_WORKER_COUNT_MAX;
+  }
+  for (int32_t i = 0; i < logicalCores; ++i) {
+    SnlfJobWorker *worker = pool->workers + pool->workerCount;
+    worker->pool = pool;
+    worker->logicalCore = (uint32_t)i;
+    if (pthread_create(&worker->thread, NULL, SnlfJobWorkerLoop, worker)) {
+      SnlfErrorLogFormat("Job worker creation for core %d failed.", i);
+      continue;
+    }
+    pool->workerMask |= (uint64_t)1 << i;
+    ++pool->workerCount;
+  }
+  
+  // Keep the leading cores for the graphics and present threads unless nothing else is left
+  pool->defaultMask = pool->workerMask & ~(((uint64_t)1 << SNLF_JOB_RESERVED_CORES) - 1);
+  if (!pool->defaultMask) {
+    pool->defaultMask = pool->workerMask;
+  }
+  return false;
+}
+
+bool SnlfCoreUninitForJobs(SnlfCoreRef core) {
+  SnlfJobPool *pool = &core->jobPool;
+  
+  LOCK(pool);
+  pool->active = false;
+  pthread_cond_broadcast(&pool->workCond);
+  UNLOCK(pool);
+  for (uint32_t i = 0; i < pool->workerCount; ++i) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+  
+  SnlfDealloc(pool->bands);
+  pool->bands = NULL;
+  pool->bandCount = 0;
+  pool->bandCapacity = 0;
+  pthread_cond_destroy(&pool->doneCond);
+  pthread_cond_destroy(&pool->workCond);
+  return SnlfMutexDestroy(&pool->mutex);
+}
+
+// ---
+// Dispatch
+// ---
+static inline uint32_t SnlfJobCountCores(uint64_t mask) {
+  uint32_t count = 0;
+  for (; mask; mask &= mask - 1) {
+    ++count;
+  }
+  return count;
+}
+
+bool SnlfCoreDispatchRows(SnlfCoreRef core, const SnlfRowJob *job, SnlfJobCounter *counter) {
+  assert(core);
+  assert(job);
+  assert(job->function);
+  assert(counter);
+  
+  if (!job->rowCount) {
+    return false;
+  }
+  
+  SnlfJobPool *pool = &core->jobPool;
+  const uint64_t affinityMask = (job->affinityMask ? job->affinityMask : pool->defaultMask) & pool->workerMask;
+  if (!affinityMask) {
+    job->function(job->param, 0, job->rowCount);
+    return false;
+  }
+  
+  // Bands fit the cache, but there are at least as many as workers may run them. Even heights keep
+  // both rows of a 4:2:0 chroma row in one band.
+  uint32_t bandRows = job->bytesPerRow ? (uint32_t)(pool->bandBytes / job->bytesPerRow) : job->rowCount;
+  if (!bandRows) {
+    bandRows = 1;
+  }
+  const uint32_t coreCount = SnlfJobCountCores(affinityMask);
+  const uint32_t balancedRows = (job->rowCount + coreCount - 1) / coreCount;
+  if (bandRows > balancedRows) {
+    bandRows = balancedRows;
+  }
+  bandRows = (bandRows + 1) & ~1U;
+  const uint32_t bandCount = (job->rowCount + bandRows - 1) / bandRows;
+  
+  if (LOCK(pool)) {
+    SnlfMutexLockError();
+    return true;
+  }
+  
+  if (pool->bandCount + bandCount > pool->bandCapacity) {
+    size_t capacity = pool->bandCapacity ? pool->bandCapacity : 64;
+    while (capacity < pool->bandCount + bandCount) {
+      capacity *= 2;
+    }
+    SnlfJobBand *bands = (SnlfJobBand *)realloc(pool->bands, sizeof(SnlfJobBand) * capacity);
+    if (!bands) {
+      SnlfOutOfMemoryError();
+      UNLOCK(pool);
+      return true;
+    }
+    pool->bands = bands;
+    pool->bandCapacity = capacity;
+  }
+  
+  for (uint32_t i = 0; i < bandCount; ++i) {
+    SnlfJobBand *band = pool->bands + pool->bandCount++;
+    band->function = job->function;
+    band->param = job->param;
+    band->firstRow = i * bandRows;
+    band->rowCount = i + 1 < bandCount ? bandRows : job->rowCount - i * bandRows;
+    band->affinityMask = affinityMask;
+    band->counter = counter;
+  }
+  counter->pending += bandCount;
+  pthread_cond_broadcast(&pool->workCond);
+  
+  if (UNLOCK(pool)) {
+    SnlfMutexUnlockError();
+  }
+  return false;
+}
+
+void SnlfCoreWaitForJobs(SnlfCoreRef core, SnlfJobCounter *counter) {
+  assert(core);
+  assert(counter);
+  
+  SnlfJobPool *pool = &core->jobPool;
+  if (LOCK(pool)) {
+    SnlfMutexLockError();
+    return;
+  }
+  
+  while (counter->pending) {
+    pthread_cond_wait(&pool->doneCond, &pool->mutex);
+  }
+  
+  if (UNLOCK(pool)) {
+    SnlfMutexUnlockError();
+  }
+}
+
+uint64_t SnlfCoreGetJobAffinityMask(SnlfCoreRef core) {
+  assert(core);
+  
+  return core->jobPool.workerMask;
+}
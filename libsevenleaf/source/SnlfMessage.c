@@ -1,34 +1,210 @@
 #include "SnlfGraphics+Private.h"
 #include "SnlfMessage.h"
 
+// ---
+// Arena
+// ---
+#define SNLF_MESSAGE_POOL_EMPTY UINT32_MAX
+
+// Placed in front of every message
+typedef struct {
+  SnlfMessagePool *pool; // NULL: allocated from the heap
+  osutil_atomic_int32_t next;
+  osutil_atomic_int32_t refCount;
+} SnlfMessageSlotHeader;
+
+#define SnlfMessageSlotGetHeader(__MESSAGE__) ((SnlfMessageSlotHeader *)((uint8_t *)(__MESSAGE__) - sizeof(SnlfMessageSlotHeader)))
+#define SnlfMessageSlotGetMessage(__HEADER__) ((SnlfBasicMessage *)((uint8_t *)(__HEADER__) + sizeof(SnlfMessageSlotHeader)))
+
+static const size_t kSnlfMessageSizes[SNLF_MESSAGE_SIZE_CLASS_COUNT] = {
+  sizeof(SnlfBasicMessage),
+  sizeof(SnlfAnimationMessage),
+};
+
+static inline SnlfMessageSizeClass SnlfMessageGetSizeClass(SnlfMessageType type) {
+  switch (type) {
+  case SNLF_MESSAGE_SOURCE_ANIMATION:
+    return SNLF_MESSAGE_SIZE_CLASS_ANIMATION;
+
+  default:
+    return SNLF_MESSAGE_SIZE_CLASS_BASIC;
+  }
+}
+
+static inline SnlfMessageSlotHeader *SnlfMessagePoolGetSlot(const SnlfMessagePool *pool, uint32_t index) {
+  return (SnlfMessageSlotHeader *)(pool->slots + pool->slotSize * index);
+}
+
+static inline SnlfMessageSlotHeader *SnlfMessagePoolPop(SnlfMessagePool *pool) {
+  int64_t head = osutil_atomic_load64(&pool->head);
+  while (1) {
+    const uint32_t index = (uint32_t)head;
+    if (index == SNLF_MESSAGE_POOL_EMPTY) {
+      return NULL;
+    }
+
+    SnlfMessageSlotHeader *slot = SnlfMessagePoolGetSlot(pool, index);
+    const uint32_t next = (uint32_t)osutil_atomic_load32(&slot->next);
+    const int64_t tag = (int64_t)((uint64_t)head >> 32) + 1;
+    if (osutil_atomic_compare_exchange64(&pool->head, &head, (int64_t)((uint64_t)tag << 32 | next))) {
+      return slot;
+    }
+  }
+}
+
+static inline void SnlfMessagePoolPush(SnlfMessagePool *pool, SnlfMessageSlotHeader *slot) {
+  const uint32_t index = (uint32_t)(((uint8_t *)slot - pool->slots) / pool->slotSize);
+  int64_t head = osutil_atomic_load64(&pool->head);
+  while (1) {
+    osutil_atomic_store32(&slot->next, (int32_t)(uint32_t)head);
+
+    const int64_t tag = (int64_t)((uint64_t)head >> 32) + 1;
+    if (osutil_atomic_compare_exchange64(&pool->head, &head, (int64_t)((uint64_t)tag << 32 | index))) {
+      return;
+    }
+  }
+}
+
+bool SnlfCoreInitForMessages(SnlfCoreRef core) {
+  assert(core);
+
+  for (size_t i = 0; i < SNLF_MESSAGE_SIZE_CLASS_COUNT; ++i) {
+    SnlfMessagePool *pool = core->messageArena.pools + i;
+    pool->slotSize = SNLF_ALIGN(sizeof(SnlfMessageSlotHeader) + kSnlfMessageSizes[i]);
+    pool->slotCount = SNLF_MESSAGE_ARENA_CAPACITY;
+    pool->slots = (uint8_t *)malloc(pool->slotSize * pool->slotCount);
+    if (!pool->slots) {
+      SnlfOutOfMemoryError();
+      while (i-- > 0) {
+        SnlfDealloc(core->messageArena.pools[i].slots);
+      }
+      return true;
+    }
+
+    // Chain every slot into the free list
+    for (uint32_t j = 0; j < pool->slotCount; ++j) {
+      SnlfMessageSlotHeader *slot = SnlfMessagePoolGetSlot(pool, j);
+      slot->pool = pool;
+      osutil_atomic_store32(&slot->next, (int32_t)(j + 1 < pool->slotCount ? j + 1 : SNLF_MESSAGE_POOL_EMPTY));
+    }
+    osutil_atomic_store64(&pool->head, 0);
+  }
+  return false;
+}
+
+bool SnlfCoreUninitForMessages(SnlfCoreRef core) {
+  assert(core);
+
+  for (size_t i = 0; i < SNLF_MESSAGE_SIZE_CLASS_COUNT; ++i) {
+    SnlfMessagePool *pool = core->messageArena.pools + i;
+    SnlfDealloc(pool->slots);
+    pool->slots = NULL;
+  }
+  return false;
+}
+
+// ---
+// Message
+// ---
+SnlfBasicMessage *SnlfMessageCreate(SnlfCoreRef core, SnlfMessageType type) {
+  assert(core);
+
+  const SnlfMessageSizeClass sizeClass = SnlfMessageGetSizeClass(type);
+  SnlfMessageSlotHeader *slot = SnlfMessagePoolPop(core->messageArena.pools + sizeClass);
+  if (!slot) {
+    slot = (SnlfMessageSlotHeader *)malloc(sizeof(SnlfMessageSlotHeader) + kSnlfMessageSizes[sizeClass]);
+    if (!slot) {
+      SnlfOutOfMemoryError();
+      return NULL;
+    }
+    slot->pool = NULL;
+  }
+  osutil_atomic_store32(&slot->refCount, 1);
+
+  SnlfBasicMessage *message = SnlfMessageSlotGetMessage(slot);
+  message->type = type;
+  message->uniqueIdentifier = 0;
+  message->timestamp = osutil_gettime_as_nanoseconds();
+  message->sender = 0;
+  return message;
+}
+
 SnlfBasicMessage *SnlfMessageCreateFromSource(SnlfMessageType type, SnlfSourceRef source) {
   SnlfSourceAddRef(source);
-  
-  SnlfBasicMessage *message = SnlfAlloc(SnlfBasicMessage);
+
+  SnlfBasicMessage *message = SnlfMessageCreate(source->core, type);
   if (!message) {
     SnlfSourceRelease(source);
-    SnlfOutOfMemoryError();
     return NULL;
   }
-  
-  message->type = SNLF_MESSAGE_TRANSITION_CHANGE_SCENE;
-  message->timestamp = osutil_gettime_as_nanoseconds();
+
   message->sender = source;
   return message;
 }
 
-void SnlfMessageDispatchToRoot(SnlfCoreRef core, const SnlfBasicMessage *message) {
+int32_t SnlfMessageAddRef(const SnlfBasicMessage *message) {
+  SnlfMessageSlotHeader *slot = SnlfMessageSlotGetHeader(message);
+  int32_t ret = osutil_atomic_fetch_increment32(&slot->refCount);
+  return ++ret;
+}
+
+int32_t SnlfMessageRelease(const SnlfBasicMessage *message) {
+  SnlfMessageSlotHeader *slot = SnlfMessageSlotGetHeader(message);
+  int32_t ret = osutil_atomic_fetch_decrement32(&slot->refCount);
+  if (ret == 1) {
+    if (message->sender) {
+      SnlfSourceRelease((SnlfSourceRef)message->sender);
+    }
+    if (slot->pool) {
+      SnlfMessagePoolPush(slot->pool, slot);
+    } else {
+      SnlfDealloc(slot);
+    }
+  }
+  return --ret;
+}
+
+// ---
+// Dispatch
+// ---
+// Only animations may be dropped when the queue is full; a later animation supersedes them.
+// Everything else changes the structure the graphics thread renders and goes through the overflow.
+static inline bool SnlfMessageEnqueue(SnlfQueue *queue, const SnlfBasicMessage *message) {
+  SnlfMessageAddRef(message);
+  if (message->type == SNLF_MESSAGE_SOURCE_ANIMATION) {
+    if (SnlfQueueEnqueue(queue, message)) {
+      SnlfWarningLog("Message queue is full. Dropped the animation message.");
+      SnlfMessageRelease(message);
+    }
+    return false;
+  }
+  
+  if (SnlfQueueEnqueueReliable(queue, message)) {
+    SnlfOutOfMemoryError();
+    SnlfMessageRelease(message);
+    return true;
+  }
+  return false;
+}
+
+bool SnlfMessageDispatchToRoot(SnlfCoreRef core, const SnlfBasicMessage *message) {
+  bool ret = false;
   SnlfGraphicsThreadContext *graphicsThreadContext = core->graphicsThreadContext;
   if (graphicsThreadContext) {
-    SnlfLockFreeQueueEnqueue(&graphicsThreadContext->root->messageQueue, message);
+    ret = SnlfMessageEnqueue(&graphicsThreadContext->root->messageQueue, message);
   }
+  SnlfMessageRelease(message);
+  return ret;
 }
 
-void SnlfMessageDispatchToSource(SnlfSourceRef source, const SnlfBasicMessage *message) {
+bool SnlfMessageDispatchToSource(SnlfSourceRef source, const SnlfBasicMessage *message) {
+  bool ret = false;
   SnlfSourceAddRef(source);
   SnlfArrayForeach(source->graphicsData) {
     SnlfGraphicsData *data = *(SnlfGraphicsData **)ptr;
-    SnlfLockFreeQueueEnqueue(&data->messageQueue, message);
+    ret |= SnlfMessageEnqueue(&data->messageQueue, message);
   }
+  SnlfMessageRelease(message);
   SnlfSourceRelease(source);
+  return ret;
 }
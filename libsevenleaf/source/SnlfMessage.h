@@ -3,6 +3,8 @@
 
 #include "SnlfCore+Private.h"
 
+#include <osutil_atomic.h>
+
 #define SNLF_MESSAGE_DEFINE_BEGIN(__NAME__) \
   typedef struct _Snlf##__NAME__##Message Snlf##__NAME__##Message; \
   struct _Snlf##__NAME__##Message {\
@@ -32,6 +34,7 @@ typedef enum {
   SNLF_MESSAGE_SOURCE_ADD,
   SNLF_MESSAGE_SOURCE_REMOVE,
   SNLF_MESSAGE_SOURCE_ANIMATION,
+  SNLF_MESSAGE_SOURCE_CHANGE_CACHE,
 } SnlfMessageType;
 
 typedef enum {
@@ -52,11 +55,44 @@ SNLF_MESSAGE_DEFINE_BEGIN(Animation)
   // sound matrix
 SNLF_MESSAGE_DEFINE_END
 
+// ---
+// Arena
+// ---
+// Messages live in per-core pools, one per size class, and are recycled through a lock-free free list.
+// The free list head packs a generation tag above the slot index so a slot popped and pushed back between a
+// load and a compare-exchange does not corrupt the list. When a pool runs dry the message falls back to the heap.
+typedef enum {
+  SNLF_MESSAGE_SIZE_CLASS_BASIC,
+  SNLF_MESSAGE_SIZE_CLASS_ANIMATION,
+  SNLF_MESSAGE_SIZE_CLASS_COUNT,
+} SnlfMessageSizeClass;
+
+typedef struct {
+  osutil_atomic_int64_t head; // (tag << 32) | slot index
+  size_t slotSize;
+  uint32_t slotCount;
+  uint8_t *slots;
+} SnlfMessagePool;
+
+typedef struct {
+  SnlfMessagePool pools[SNLF_MESSAGE_SIZE_CLASS_COUNT];
+} SnlfMessageArena;
+
+// ---
+// Message
+// ---
+// Messages are reference counted. Create returns one reference owned by the caller; dispatch consumes it and
+// every queue the message lands in holds its own, which the consumer drops with SnlfMessageRelease.
+// A message created from a source holds one reference to its sender, released with the last message reference.
+// Dispatch returns true when the message could not be queued for some target. Animation messages are dropped
+// silently when a queue is full; other messages are only lost when out of memory.
+SnlfBasicMessage *SnlfMessageCreate(SnlfCoreRef core, SnlfMessageType type);
 SnlfBasicMessage *SnlfMessageCreateFromSource(SnlfMessageType type, SnlfSourceRef source);
-SnlfBasicMessage *SnlfMessageGet();
+int32_t SnlfMessageAddRef(const SnlfBasicMessage *message);
+int32_t SnlfMessageRelease(const SnlfBasicMessage *message);
 
-void SnlfMessageDispatchToRoot(SnlfCoreRef core, const SnlfBasicMessage *message);
-void SnlfMessageDispatchToSource(SnlfSourceRef source, const SnlfBasicMessage *message);
+bool SnlfMessageDispatchToRoot(SnlfCoreRef core, const SnlfBasicMessage *message);
+bool SnlfMessageDispatchToSource(SnlfSourceRef source, const SnlfBasicMessage *message);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,245 @@
+#include "SnlfGraphics+Private.h"
+
+#define LOCK(__CACHE__)   pthread_mutex_lock(&__CACHE__->mutex)
+#define UNLOCK(__CACHE__) pthread_mutex_unlock(&__CACHE__->mutex)
+
+// ---
+// Descriptor
+// ---
+void SnlfPipelineStateDescriptorInit(SnlfPipelineStateDescriptor *descriptor, const CpsrShaderFunction *vertexFunction, const CpsrShaderFunction *pixelFunction) {
+  assert(descriptor);
+  
+  memset(descriptor, 0, sizeof(SnlfPipelineStateDescriptor));
+  descriptor->vertexFunction = vertexFunction;
+  descriptor->pixelFunction = pixelFunction;
+  descriptor->blend = kCpsrBlendDefault;
+  descriptor->rasterizer = kCpsrRasterizerDefault;
+  descriptor->primitiveTopologyType = CPSR_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+  descriptor->pixelFormat = SNLF_RENDER_TARGET_PIXEL_FORMAT;
+}
+
+// Compared field by field; the descriptors hold bit fields whose padding is not guaranteed to be zero.
+static inline bool SnlfBlendDescriptorEqual(const CpsrBlendDescriptor *a, const CpsrBlendDescriptor *b) {
+  return a->blendEnable == b->blendEnable
+    && a->srcColorBlend == b->srcColorBlend
+    && a->dstColorBlend == b->dstColorBlend
+    && a->colorOperation == b->colorOperation
+    && a->srcAlphaBlend == b->srcAlphaBlend
+    && a->dstAlphaBlend == b->dstAlphaBlend
+    && a->alphaOperation == b->alphaOperation
+    && a->writeMask == b->writeMask;
+}
+
+static inline bool SnlfRasterizerDescriptorEqual(const CpsrRasterizerDescriptor *a, const CpsrRasterizerDescriptor *b) {
+  return a->fillMode == b->fillMode
+    && a->cullMode == b->cullMode
+    && a->counterClockwise == b->counterClockwise
+    && a->depthClipMode == b->depthClipMode
+    && a->depthBias == b->depthBias
+    && a->depthBiasClamp == b->depthBiasClamp
+    && a->slopeScaledDepthBias == b->slopeScaledDepthBias
+    && a->rasterSampleCount == b->rasterSampleCount;
+}
+
+static inline bool SnlfPipelineStateDescriptorEqual(const SnlfPipelineStateDescriptor *a, const SnlfPipelineStateDescriptor *b) {
+  return a->vertexFunction == b->vertexFunction
+    && a->pixelFunction == b->pixelFunction
+    && a->primitiveTopologyType == b->primitiveTopologyType
+    && a->pixelFormat == b->pixelFormat
+    && SnlfBlendDescriptorEqual(&a->blend, &b->blend)
+    && SnlfRasterizerDescriptorEqual(&a->rasterizer, &b->rasterizer);
+}
+
+// ---
+// Init/Uninit
+// ---
+bool SnlfPipelineCacheInit(SnlfPipelineCache *cache, const CpsrDevice *device) {
+  assert(cache);
+  
+  cache->device = device;
+  cache->entryCount = 0;
+  cache->entryCapacity = 0;
+  cache->entries = NULL;
+  cache->frameNumber = 0;
+  cache->retiredCount = 0;
+  cache->retiredCapacity = 0;
+  cache->retireds = NULL;
+  return SnlfMutexCreate(&cache->mutex);
+}
+
+// Destroys the pipeline states still referenced or retired as well. No frame may be in flight.
+void SnlfPipelineCacheUninit(SnlfPipelineCache *cache) {
+  assert(cache);
+  
+  for (size_t i = 0; i < cache->entryCount; ++i) {
+    CpsrGraphicsPipelineStateDestroy(cache->entries[i].pipelineState);
+  }
+  SnlfDealloc(cache->entries);
+  cache->entries = NULL;
+  cache->entryCount = 0;
+  cache->entryCapacity = 0;
+  
+  for (size_t i = 0; i < cache->retiredCount; ++i) {
+    CpsrGraphicsPipelineStateDestroy(cache->retireds[i].pipelineState);
+  }
+  SnlfDealloc(cache->retireds);
+  cache->retireds = NULL;
+  cache->retiredCount = 0;
+  cache->retiredCapacity = 0;
+  SnlfMutexDestroy(&cache->mutex);
+}
+
+// ---
+// Acquire/Release
+// ---
+static inline CpsrGraphicsPipelineState *SnlfPipelineCacheCreatePipelineState(const CpsrDevice *device, const SnlfPipelineStateDescriptor *descriptor) {
+  CpsrGraphicsPipelineState *pipelineState = CpsrGraphicsPipelineStateCreate(device);
+  if (!pipelineState) {
+    return NULL;
+  }
+  
+  CpsrGraphicsPipelineStateSetVertexFunction(pipelineState, descriptor->vertexFunction);
+  CpsrGraphicsPipelineStateSetPixelFunction(pipelineState, descriptor->pixelFunction);
+  CpsrGraphicsPipelineStateSetBlendState(pipelineState, 0, &descriptor->blend);
+  CpsrGraphicsPipelineStateSetRasterizerState(pipelineState, &descriptor->rasterizer);
+  CpsrGraphicsPipelineStateSetPrimitiveTopologyType(pipelineState, descriptor->primitiveTopologyType);
+  CpsrSetRenderTargetPixelFormat(pipelineState, 0, descriptor->pixelFormat);
+  return pipelineState;
+}
+
+// Called under the lock.
+static inline void SnlfPipelineCacheRetire(SnlfPipelineCache *cache, CpsrGraphicsPipelineState *pipelineState) {
+  if (cache->retiredCount == cache->retiredCapacity) {
+    const size_t capacity = cache->retiredCapacity ? 2 * cache->retiredCapacity : 4;
+    SnlfPipelineCacheRetired *retireds = (SnlfPipelineCacheRetired *)realloc(cache->retireds, sizeof(SnlfPipelineCacheRetired) * capacity);
+    if (!retireds) {
+      // Leak rather than destroy a pipeline state a frame in flight may still use
+      SnlfOutOfMemoryError();
+      return;
+    }
+    cache->retireds = retireds;
+    cache->retiredCapacity = capacity;
+  }
+  
+  SnlfPipelineCacheRetired *retired = cache->retireds + cache->retiredCount++;
+  retired->pipelineState = pipelineState;
+  retired->frameNumber = cache->frameNumber;
+}
+
+CpsrGraphicsPipelineState *SnlfPipelineCacheAcquire(SnlfPipelineCache *cache, const SnlfPipelineStateDescriptor *descriptor) {
+  assert(cache);
+  assert(descriptor);
+  assert(descriptor->vertexFunction);
+  assert(descriptor->pixelFunction);
+  
+  if (LOCK(cache)) {
+    SnlfMutexLockError();
+    return NULL;
+  }
+  
+  CpsrGraphicsPipelineState *pipelineState = NULL;
+  for (size_t i = 0; i < cache->entryCount; ++i) {
+    SnlfPipelineCacheEntry *entry = cache->entries + i;
+    if (SnlfPipelineStateDescriptorEqual(&entry->descriptor, descriptor)) {
+      ++entry->referenceCount;
+      pipelineState = entry->pipelineState;
+      break;
+    }
+  }
+  
+  if (!pipelineState) {
+    if (cache->entryCount == cache->entryCapacity) {
+      const size_t capacity = cache->entryCapacity ? 2 * cache->entryCapacity : 16;
+      SnlfPipelineCacheEntry *entries = (SnlfPipelineCacheEntry *)realloc(cache->entries, sizeof(SnlfPipelineCacheEntry) * capacity);
+      if (!entries) {
+        SnlfOutOfMemoryError();
+        UNLOCK(cache);
+        return NULL;
+      }
+      cache->entries = entries;
+      cache->entryCapacity = capacity;
+    }
+  
+    pipelineState = SnlfPipelineCacheCreatePipelineState(cache->device, descriptor);
+    if (pipelineState) {
+      SnlfPipelineCacheEntry *entry = cache->entries + cache->entryCount++;
+      entry->descriptor = *descriptor;
+      entry->pipelineState = pipelineState;
+      entry->referenceCount = 1;
+    } else {
+      SnlfErrorLog("Create pipeline state failed.");
+    }
+  }
+  
+  if (UNLOCK(cache)) {
+    SnlfMutexUnlockError();
+  }
+  return pipelineState;
+}
+
+void SnlfPipelineCacheRelease(SnlfPipelineCache *cache, CpsrGraphicsPipelineState *pipelineState) {
+  assert(cache);
+  assert(pipelineState);
+  
+  if (LOCK(cache)) {
+    SnlfMutexLockError();
+    return;
+  }
+  
+  for (size_t i = 0; i < cache->entryCount; ++i) {
+    SnlfPipelineCacheEntry *entry = cache->entries + i;
+    if (entry->pipelineState != pipelineState) {
+      continue;
+    }
+  
+    assert(entry->referenceCount);
+    if (!--entry->referenceCount) {
+      SnlfPipelineCacheRetire(cache, pipelineState);
+      *entry = cache->entries[--cache->entryCount];
+    }
+    break;
+  }
+  
+  if (UNLOCK(cache)) {
+    SnlfMutexUnlockError();
+  }
+}
+
+// ---
+// Retirement
+// ---
+// Called by the graphics thread after each frame. completedFrameNumber is the last frame the frame fence has
+// passed; without a present thread every frame has completed on submission.
+void SnlfPipelineCacheEndFrame(SnlfPipelineCache *cache, uint64_t submittedFrameNumber, uint64_t completedFrameNumber) {
+  assert(cache);
+  
+  if (LOCK(cache)) {
+    SnlfMutexLockError();
+    return;
+  }
+  
+  cache->frameNumber = submittedFrameNumber;
+  for (size_t i = 0; i < cache->retiredCount;) {
+    SnlfPipelineCacheRetired *retired = cache->retireds + i;
+    if (retired->frameNumber > completedFrameNumber) {
+      ++i;
+      continue;
+    }
+    CpsrGraphicsPipelineStateDestroy(retired->pipelineState);
+    *retired = cache->retireds[--cache->retiredCount];
+  }
+  
+  if (UNLOCK(cache)) {
+    SnlfMutexUnlockError();
+  }
+}
+
+CpsrGraphicsPipelineState *SnlfGraphicsContextAcquirePipelineState(const SnlfGraphicsContext *context, const SnlfPipelineStateDescriptor *descriptor) {
+  assert(context);
+  return SnlfPipelineCacheAcquire(context->pipelineCache, descriptor);
+}
+
+void SnlfGraphicsContextReleasePipelineState(const SnlfGraphicsContext *context, CpsrGraphicsPipelineState *pipelineState) {
+  assert(context);
+  SnlfPipelineCacheRelease(context->pipelineCache, pipelineState);
+}
@@ -0,0 +1,100 @@
+#ifndef _SNLF_QUEUE_PRIVATE_H
+#define _SNLF_QUEUE_PRIVATE_H
+
+#include "SnlfCore+Private.h"
+
+// ---
+// Queue
+// ---
+// Multi-producer/single-consumer queue used by graphics data messages and the frame allocator.
+// With SNLF_USE_MPSC_RING it is a bounded ring that never allocates after init; Enqueue returns true when it
+// is full. EnqueueReliable never fails for lack of room: items the ring cannot take go to an unbounded overflow
+// list, which is dequeued after the ring. While the overflow holds items every enqueue goes there as well, so
+// the order is kept, and it returns true only when out of memory.
+// Otherwise it is the unbounded SnlfLockFreeQueue; both enqueues return true when out of memory.
+// Consumers drain with DequeueBatch, which returns how many items it stored.
+#if SNLF_USE_MPSC_RING
+#include "containers/SnlfLockFreeQueue.h"
+#include "containers/SnlfMpscRing.h"
+
+#include <osutil_atomic.h>
+
+typedef struct {
+  SnlfMpscRing ring;
+  SnlfLockFreeQueue overflow;
+  osutil_atomic_int32_t overflowCount;  // Items enqueued to overflow and not yet dequeued
+} SnlfQueue;
+
+static inline bool SnlfQueueInit(SnlfQueue *queue, size_t capacity) {
+  if (SnlfMpscRingInit(&queue->ring, capacity)) {
+    return true;
+  }
+  if (SnlfLockFreeQueueInit(&queue->overflow)) {
+    SnlfMpscRingUninit(&queue->ring);
+    return true;
+  }
+  osutil_atomic_store32(&queue->overflowCount, 0);
+  return false;
+}
+
+static inline void SnlfQueueUninit(SnlfQueue *queue) {
+  SnlfLockFreeQueueUninit(&queue->overflow);
+  SnlfMpscRingUninit(&queue->ring);
+}
+
+// Returns true when the ring is full or backed up into the overflow.
+static inline bool _SnlfQueueEnqueue(SnlfQueue *queue, intptr_t data) {
+  if (osutil_atomic_load32(&queue->overflowCount)) {
+    return true;
+  }
+  return SnlfMpscRingEnqueue(&queue->ring, data);
+}
+
+static inline bool _SnlfQueueEnqueueReliable(SnlfQueue *queue, intptr_t data) {
+  if (!osutil_atomic_load32(&queue->overflowCount) && !SnlfMpscRingEnqueue(&queue->ring, data)) {
+    return false;
+  }
+  
+  // Counted before it is published, so later enqueues follow it into the overflow
+  osutil_atomic_fetch_increment32(&queue->overflowCount);
+  if (SnlfLockFreeQueueEnqueue(&queue->overflow, data)) {
+    osutil_atomic_fetch_decrement32(&queue->overflowCount);
+    return true;
+  }
+  return false;
+}
+
+// Consumer only. Overflow items are newer than every item in the ring.
+static inline size_t _SnlfQueueDequeueBatch(SnlfQueue *queue, intptr_t *items, size_t maxCount) {
+  size_t count = SnlfMpscRingDequeueBatch(&queue->ring, items, maxCount);
+  if (count < maxCount && osutil_atomic_load32(&queue->overflowCount)) {
+    const size_t overflowCount = SnlfLockFreeQueueDequeueBatch(&queue->overflow, items + count, maxCount - count);
+    osutil_atomic_fetch_add32(&queue->overflowCount, -(int32_t)overflowCount);
+    count += overflowCount;
+  }
+  return count;
+}
+
+static inline intptr_t _SnlfQueueDequeue(SnlfQueue *queue) {
+  intptr_t data;
+  return _SnlfQueueDequeueBatch(queue, &data, 1) ? data : 0;
+}
+
+#define SnlfQueueEnqueue(__QUEUE__, __DATA__)         _SnlfQueueEnqueue(__QUEUE__, (intptr_t)(__DATA__))
+#define SnlfQueueEnqueueReliable(__QUEUE__, __DATA__) _SnlfQueueEnqueueReliable(__QUEUE__, (intptr_t)(__DATA__))
+#define SnlfQueueDequeue(__QUEUE__)                   _SnlfQueueDequeue(__QUEUE__)
+#define SnlfQueueDequeueBatch(__QUEUE__, __ITEMS__, __MAX_COUNT__) _SnlfQueueDequeueBatch(__QUEUE__, __ITEMS__, __MAX_COUNT__)
+#else
+#include "containers/SnlfLockFreeQueue.h"
+
+typedef SnlfLockFreeQueue SnlfQueue;
+
+#define SnlfQueueInit(__QUEUE__, __CAPACITY__) SnlfLockFreeQueueInit(__QUEUE__)
+#define SnlfQueueUninit(__QUEUE__)             SnlfLockFreeQueueUninit(__QUEUE__)
+#define SnlfQueueEnqueue(__QUEUE__, __DATA__)  SnlfLockFreeQueueEnqueue(__QUEUE__, (intptr_t)(__DATA__))
+#define SnlfQueueEnqueueReliable(__QUEUE__, __DATA__) SnlfLockFreeQueueEnqueue(__QUEUE__, (intptr_t)(__DATA__))
+#define SnlfQueueDequeue(__QUEUE__)            SnlfLockFreeQueueDequeue(__QUEUE__)
+#define SnlfQueueDequeueBatch(__QUEUE__, __ITEMS__, __MAX_COUNT__) SnlfLockFreeQueueDequeueBatch(__QUEUE__, __ITEMS__, __MAX_COUNT__)
+#endif
+
+#endif // _SNLF_QUEUE_PRIVATE_H
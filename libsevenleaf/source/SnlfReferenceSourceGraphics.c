@@ -0,0 +1,89 @@
+#include "SnlfGraphics+Private.h"
+
+// ---
+// Reference Source Graphics
+// ---
+typedef struct {
+  DEFINE_SNLF_GRAPHICS_COMMON_DATA;
+  
+  SnlfSourceRef source;
+  SnlfDrawList *drawList;
+  SnlfGraphicsData *target;  // Graphics data of the referenced source, shared through the draw list
+  
+  bool enabled   : 1;
+  bool animating : 1;
+} SnlfReferenceSourceGraphicsData;
+
+static void SnlfReferenceSourceGraphicsData_ProcessMessage(intptr_t _data, const SnlfGraphicsContext *context) {
+  SnlfAssume(_data);
+  SnlfReferenceSourceGraphicsData *data = (SnlfReferenceSourceGraphicsData *)_data;
+  
+  intptr_t messages[SNLF_MESSAGE_BATCH_COUNT];
+  size_t count;
+  while ((count = SnlfQueueDequeueBatch(&data->messageQueue, messages, SNLF_MESSAGE_BATCH_COUNT))) {
+    for (size_t i = 0; i < count; ++i) {
+      const SnlfBasicMessage *message = (const SnlfBasicMessage *)messages[i];
+      switch (message->type) {
+      case SNLF_MESSAGE_SOURCE_ANIMATION:
+        break;
+        
+      default:
+          break;
+      }
+      SnlfMessageRelease(message);
+    }
+  }
+}
+
+static void SnlfReferenceSourceGraphicsData_Compile(intptr_t _data, SnlfDrawList *drawList, int32_t parent) {
+  SnlfAssume(_data);
+  SnlfReferenceSourceGraphicsData *data = (SnlfReferenceSourceGraphicsData *)_data;
+  if (data->enabled && data->target) {
+    const int32_t node = SnlfDrawListAppendNode(drawList, parent, data->source);
+    if (node < 0) {
+      return;
+    }
+    SnlfDrawListAppendReference(drawList, node, data->source->reference, data->target);
+  }
+}
+
+void SnlfReferenceSourceGraphicsData_Uninit(intptr_t _data) {
+  SnlfAssume(_data);
+  SnlfReferenceSourceGraphicsData *data = (SnlfReferenceSourceGraphicsData *)_data;
+  if (data->target) {
+    SnlfDrawListReleaseTarget(data->drawList, data->target);
+  }
+  SnlfSourceDetachGraphicsData(data->source, (SnlfGraphicsData *)data);
+  SnlfSourceRelease(data->source);
+  SnlfQueueUninit(&data->messageQueue);
+  SnlfDealloc(data);
+}
+
+SnlfGraphicsData *SnlfGraphicsDataInitForReference(SnlfSourceRef source, const SnlfGraphicsContext *context) {
+  SnlfReferenceSourceGraphicsData *data = SnlfAlloc(SnlfReferenceSourceGraphicsData);
+  if (!data) {
+    SnlfOutOfMemoryError();
+    SnlfSourceRelease(source);
+    return NULL;
+  }
+  
+  if (SnlfArrayAppend(source->graphicsData, data)) {
+    SnlfOutOfMemoryError();
+    SnlfDealloc(data);
+    SnlfSourceRelease(source);
+    return NULL;
+  }
+  
+  SnlfQueueInit(&data->messageQueue, SNLF_MESSAGE_QUEUE_CAPACITY);
+  data->processMessage = SnlfReferenceSourceGraphicsData_ProcessMessage;
+  data->compile = SnlfReferenceSourceGraphicsData_Compile;
+  data->uninit = SnlfReferenceSourceGraphicsData_Uninit;
+  
+  data->source = source;
+  data->drawList = context->drawList;
+  data->target = SnlfDrawListAcquireTarget(data->drawList, source->reference, context);
+  
+  data->enabled = true;
+  data->animating = false;
+  return (SnlfGraphicsData *)data;
+}
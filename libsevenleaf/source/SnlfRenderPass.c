@@ -0,0 +1,196 @@
+#include "SnlfGraphics+Private.h"
+
+// ---
+// Render Pass
+// ---
+void SnlfRenderPassInit(SnlfRenderPass *renderPass, const SnlfGraphicsContext *context) {
+  assert(renderPass);
+  assert(context);
+  
+  memset(renderPass, 0, sizeof(SnlfRenderPass));
+  renderPass->context = context;
+}
+
+static inline void SnlfRenderPassResetState(SnlfRenderPass *renderPass) {
+  renderPass->pipelineState = NULL;
+  renderPass->primitiveTopology = -1;
+  memset(renderPass->vertexBuffers, 0, sizeof(renderPass->vertexBuffers));
+  memset(renderPass->constantBuffers, 0, sizeof(renderPass->constantBuffers));
+  memset(renderPass->constantBufferOffsets, 0, sizeof(renderPass->constantBufferOffsets));
+  memset(renderPass->textures, 0, sizeof(renderPass->textures));
+}
+
+void SnlfRenderPassBegin(SnlfRenderPass *renderPass, const CpsrTexture2D *renderTarget) {
+  assert(renderPass);
+  assert(renderTarget);
+  
+  if (renderPass->renderTarget == renderTarget) {
+    return;
+  }
+  
+  SnlfRenderPassEnd(renderPass);
+  renderPass->renderTarget = renderTarget;
+}
+
+void SnlfRenderPassClear(SnlfRenderPass *renderPass, CpsrClearColor color) {
+  assert(renderPass);
+  assert(renderPass->renderTarget);
+  
+  // A clear is a load action, so it starts a new pass on the same render target
+  const CpsrTexture2D *renderTarget = renderPass->renderTarget;
+  SnlfRenderPassEnd(renderPass);
+  renderPass->renderTarget = renderTarget;
+  renderPass->clearEnable = true;
+  renderPass->clearColor = color;
+}
+
+void SnlfRenderPassEnd(SnlfRenderPass *renderPass) {
+  assert(renderPass);
+  
+  if (!renderPass->renderTarget) {
+    return;
+  }
+  
+  SnlfDrawBatchFlush(renderPass->context->drawBatch, renderPass->context);
+  
+  // A clear without any draw still needs a pass to run it
+  if (!renderPass->graphicsContext && renderPass->clearEnable) {
+    _SnlfRenderPassSetPipelineState(renderPass, renderPass->context->drawSimplePipelineState);
+  }
+  
+  if (renderPass->graphicsContext) {
+    CpsrGraphicsContextClose(renderPass->graphicsContext);
+    CpsrGraphicsContextDestroy(renderPass->graphicsContext);
+    renderPass->graphicsContext = NULL;
+  }
+  renderPass->renderTarget = NULL;
+  renderPass->clearEnable = false;
+  SnlfRenderPassResetState(renderPass);
+}
+
+// ---
+// Cached state
+// ---
+// The underscored variants are used by the draw batch. The public ones flush pending draw items first, so
+// items submitted before a direct draw are encoded before it and the batch never sees half-bound state.
+#define SNLF_RENDER_PASS_FLUSH(__RENDER_PASS__) \
+  SnlfDrawBatchFlush((__RENDER_PASS__)->context->drawBatch, (__RENDER_PASS__)->context)
+
+bool _SnlfRenderPassSetPipelineState(SnlfRenderPass *renderPass, CpsrGraphicsPipelineState *pipelineState) {
+  assert(renderPass);
+  assert(renderPass->renderTarget);
+  assert(pipelineState);
+  
+  if (renderPass->pipelineState == pipelineState) {
+    return false;
+  }
+  
+  // Pipeline states come from the pipeline cache and already match the render target format
+  if (!renderPass->graphicsContext) {
+    CpsrGraphicsContext *graphicsContext = CpsrGraphicsContextCreate(renderPass->context->commandBuffer);
+    if (!graphicsContext) {
+      SnlfOutOfMemoryError();
+      return true;
+    }
+    
+    CpsrGraphicsContextSetRenderTargetFromTexture2D(graphicsContext, renderPass->renderTarget);
+    if (renderPass->clearEnable) {
+      CpsrGraphicsContextClearRenderTarget(graphicsContext, 0, renderPass->clearColor);
+    }
+    if (CpsrGraphicsContextSetPipelineState(graphicsContext, pipelineState)) {
+      CpsrGraphicsContextDestroy(graphicsContext);
+      return true;
+    }
+    renderPass->graphicsContext = graphicsContext;
+    renderPass->clearEnable = false;
+  } else if (CpsrGraphicsContextSetPipelineState(renderPass->graphicsContext, pipelineState)) {
+    return true;
+  }
+  
+  renderPass->pipelineState = pipelineState;
+  return false;
+}
+
+void _SnlfRenderPassSetVertexBuffer(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *vertexBuffer) {
+  assert(renderPass->graphicsContext);
+  assert(index < CPSR_VERTEX_BUFFER_COUNT);
+  
+  if (renderPass->vertexBuffers[index] != vertexBuffer) {
+    CpsrGraphicsContextSetVertexBuffer(renderPass->graphicsContext, index, vertexBuffer);
+    renderPass->vertexBuffers[index] = vertexBuffer;
+  }
+}
+
+void _SnlfRenderPassSetConstantBuffer(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *constantBuffer) {
+  _SnlfRenderPassSetConstantBufferWithOffset(renderPass, index, constantBuffer, 0);
+}
+
+void _SnlfRenderPassSetConstantBufferWithOffset(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *constantBuffer, uint32_t offset) {
+  assert(renderPass->graphicsContext);
+  assert(index < CPSR_CONSTANT_BUFFER_COUNT);
+  
+  if (renderPass->constantBuffers[index] != constantBuffer || renderPass->constantBufferOffsets[index] != offset) {
+    CpsrGraphicsContextSetConstantBufferWithOffset(renderPass->graphicsContext, index, constantBuffer, offset);
+    renderPass->constantBuffers[index] = constantBuffer;
+    renderPass->constantBufferOffsets[index] = offset;
+  }
+}
+
+void _SnlfRenderPassSetTexture(SnlfRenderPass *renderPass, uint8_t index, const CpsrTexture2D *texture) {
+  assert(renderPass->graphicsContext);
+  assert(index < SNLF_RENDER_PASS_TEXTURE_COUNT);
+  
+  if (renderPass->textures[index] != texture) {
+    CpsrGraphicsContextSetTexture(renderPass->graphicsContext, index, texture);
+    renderPass->textures[index] = texture;
+  }
+}
+
+void _SnlfRenderPassSetPrimitiveTopology(SnlfRenderPass *renderPass, CpsrPrimitiveTopology primitiveTopology) {
+  assert(renderPass->graphicsContext);
+  
+  if (renderPass->primitiveTopology != (int32_t)primitiveTopology) {
+    CpsrGraphicsContextSetPrimitiveTopology(renderPass->graphicsContext, primitiveTopology);
+    renderPass->primitiveTopology = (int32_t)primitiveTopology;
+  }
+}
+
+bool SnlfRenderPassSetPipelineState(SnlfRenderPass *renderPass, CpsrGraphicsPipelineState *pipelineState) {
+  SNLF_RENDER_PASS_FLUSH(renderPass);
+  return _SnlfRenderPassSetPipelineState(renderPass, pipelineState);
+}
+
+void SnlfRenderPassSetVertexBuffer(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *vertexBuffer) {
+  SNLF_RENDER_PASS_FLUSH(renderPass);
+  _SnlfRenderPassSetVertexBuffer(renderPass, index, vertexBuffer);
+}
+
+void SnlfRenderPassSetConstantBuffer(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *constantBuffer) {
+  SNLF_RENDER_PASS_FLUSH(renderPass);
+  _SnlfRenderPassSetConstantBuffer(renderPass, index, constantBuffer);
+}
+
+void SnlfRenderPassSetConstantBufferWithOffset(SnlfRenderPass *renderPass, uint8_t index, const CpsrBuffer *constantBuffer, uint32_t offset) {
+  SNLF_RENDER_PASS_FLUSH(renderPass);
+  _SnlfRenderPassSetConstantBufferWithOffset(renderPass, index, constantBuffer, offset);
+}
+
+void SnlfRenderPassSetTexture(SnlfRenderPass *renderPass, uint8_t index, const CpsrTexture2D *texture) {
+  SNLF_RENDER_PASS_FLUSH(renderPass);
+  _SnlfRenderPassSetTexture(renderPass, index, texture);
+}
+
+void SnlfRenderPassSetPrimitiveTopology(SnlfRenderPass *renderPass, CpsrPrimitiveTopology primitiveTopology) {
+  SNLF_RENDER_PASS_FLUSH(renderPass);
+  _SnlfRenderPassSetPrimitiveTopology(renderPass, primitiveTopology);
+}
+
+void SnlfRenderPassDraw(SnlfRenderPass *renderPass, uint32_t vertexStart, uint32_t vertexCount) {
+  assert(renderPass->graphicsContext);
+  CpsrGraphicsContextDraw(renderPass->graphicsContext, vertexStart, vertexCount);
+}
+
+void SnlfRenderPassDrawInstanced(SnlfRenderPass *renderPass, uint32_t vertexStart, uint32_t vertexCount, uint32_t instanceCount) {
+  assert(renderPass->graphicsContext);
+  CpsrGraphicsContextDrawInstanced(renderPass->graphicsContext, vertexStart, vertexCount, instanceCount);
+}
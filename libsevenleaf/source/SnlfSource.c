@@ -9,13 +9,13 @@
 bool SnlfCoreInitForSources(SnlfCoreRef core) {
   SnlfArrayInit(core->sources);
   SnlfArrayInit(core->sourceHandlers);
-  return SnlfRecursiveMutexCreate(&core->sourceMutex);
+  return SnlfEpochInit(&core->sourceEpoch) || SnlfRecursiveMutexCreate(&core->sourceMutex);
 }
 
 bool SnlfCoreUninitForSources(SnlfCoreRef core) {
   SnlfArrayRelease(core->sources);
   SnlfArrayRelease(core->sourceHandlers);
-  return SnlfMutexDestroy(&core->sourceMutex);
+  return SnlfEpochUninit(&core->sourceEpoch) | SnlfMutexDestroy(&core->sourceMutex);
 }
 
 // ---
@@ -28,6 +28,15 @@ extern inline SnlfSourceRef SnlfSourceCreateDefault(SnlfCoreRef core) {
     return NULL;
   }
   
+  SnlfSourceSnapshot *snapshot = SnlfAlloc(SnlfSourceSnapshot);
+  if (!snapshot) {
+    SnlfOutOfMemoryError();
+    SnlfDealloc(source);
+    return NULL;
+  }
+  snapshot->transform = matrix4x4_idt();
+  snapshot->revision = 0;
+  
   // Set core & reference count
   source->core = core;
   osutil_atomic_store32(&source->refCount, 1);
@@ -45,7 +54,9 @@ extern inline SnlfSourceRef SnlfSourceCreateDefault(SnlfCoreRef core) {
   SnlfArrayInit(source->children);
   
   // Init graphics resources
-  source->transform = matrix4x4_idt();
+  osutil_atomic_store_pointer(&source->snapshot, (intptr_t)snapshot);
+  osutil_atomic_store32(&source->contentRevision, 0);
+  osutil_atomic_store32(&source->cacheAsBitmap, false);
   SnlfArrayInit(source->graphicsData);
   SnlfArrayInit(source->backdropTransformers);
   SnlfArrayInit(source->userTransformers);
@@ -102,7 +113,31 @@ SnlfSourceRef SnlfSourceCreateFromGraphicsGenerator(SnlfCoreRef core, SnlfGraphi
   return source;
 }
 
+SnlfSourceRef SnlfSourceCreateFromReference(SnlfSourceRef reference) {
+  assert(reference);
+  SnlfSourceAddRef(reference);
+  
+  SnlfSourceRef source = SnlfSourceCreateDefault(reference->core);
+  if (!source) {
+    SnlfSourceRelease(reference);
+    return NULL;
+  }
+  
+  source->type = SNLF_SOURCE_REFERENCE;
+  source->reference = reference;
+  return source;
+}
+
 extern inline bool SnlfSourceDestroy(SnlfSourceRef source) {
+  // Graphics data hold a reference, so no reader is left on the snapshot
+  SnlfDealloc(osutil_atomic_load_pointer(&source->snapshot));
+  
+  if (source->type == SNLF_SOURCE_REFERENCE) {
+    SnlfSourceRelease(source->reference);
+    SnlfDealloc(source);
+    return false;
+  }
+  
   // Remove children
   for (size_t i = 0; i < source->children.size; ++i) {
     SnlfSourceRef child = source->children.data[i];
@@ -119,14 +154,83 @@ SNLF_IMPLEMENTS_REFCOUNT_CUSTOM(Source)
 // ---
 // Property
 // ---
+// Writers swap snapshots under the source mutex, so a locked reader never sees one retired.
 matrix4x4_t SnlfSourceGetTransform(SnlfSourceRef source) {
   assert(source);
-  return source->transform;
+  
+  SnlfCoreRef core = source->core;
+  if (LOCK(core)) {
+    SnlfMutexLockError();
+    return matrix4x4_idt();
+  }
+  
+  const SnlfSourceSnapshot *snapshot = (const SnlfSourceSnapshot *)osutil_atomic_load_pointer(&source->snapshot);
+  const matrix4x4_t transform = snapshot->transform;
+  
+  if (UNLOCK(core)) {
+    SnlfMutexUnlockError();
+  }
+  return transform;
 }
 
 void SnlfSourceSetTransform(SnlfSourceRef source, matrix4x4_t transform) {
   assert(source);
-  source->transform = transform;
+  
+  SnlfSourceSnapshot *snapshot = SnlfAlloc(SnlfSourceSnapshot);
+  if (!snapshot) {
+    SnlfOutOfMemoryError();
+    return;
+  }
+  
+  SnlfCoreRef core = source->core;
+  if (LOCK(core)) {
+    SnlfMutexLockError();
+    SnlfDealloc(snapshot);
+    return;
+  }
+  
+  // The new revision marks the node and, through its world matrix, its subtree dirty for the graphics thread
+  SnlfSourceSnapshot *previous = (SnlfSourceSnapshot *)osutil_atomic_load_pointer(&source->snapshot);
+  snapshot->transform = transform;
+  snapshot->revision = previous->revision + 1;
+  osutil_atomic_store_pointer(&source->snapshot, (intptr_t)snapshot);
+  SnlfEpochRetire(&core->sourceEpoch, previous);
+  
+  if (UNLOCK(core)) {
+    SnlfMutexUnlockError();
+  }
+}
+
+bool SnlfSourceGetCacheAsBitmap(SnlfSourceRef source) {
+  assert(source);
+  return osutil_atomic_load32(&source->cacheAsBitmap) != 0;
+}
+
+void SnlfSourceSetCacheAsBitmap(SnlfSourceRef source, bool cacheAsBitmap) {
+  assert(source);
+  
+  // The graphics thread reads the flag while compiling
+  int32_t expected = !cacheAsBitmap;
+  if (!osutil_atomic_compare_exchange32(&source->cacheAsBitmap, &expected, cacheAsBitmap)) {
+    return;
+  }
+  if (source->type != SNLF_SOURCE_GROUP) {
+    return;
+  }
+  
+  // The graphics thread recompiles its draw list to add or drop the cache
+  SnlfBasicMessage *message = SnlfMessageCreateFromSource(SNLF_MESSAGE_SOURCE_CHANGE_CACHE, source);
+  if (!message) {
+    return;
+  }
+  SnlfMessageDispatchToSource(source, message);
+}
+
+void SnlfSourceInvalidate(SnlfSourceRef source) {
+  assert(source);
+  
+  // Invalidates every cache that contains the source
+  osutil_atomic_fetch_increment32(&source->contentRevision);
 }
 
 uint32_t SnlfSourceGetPropertyCount(SnlfSourceRef source) {
@@ -146,7 +250,11 @@ SnlfBox SnlfSourceGetProperty(SnlfSourceRef source, identifier_t identifier) {
 }
 
 bool SnlfSourceSetProperty(SnlfSourceRef source, identifier_t identifier, SnlfBox value) {
+  assert(source);
+  assert(source->type == SNLF_SOURCE_GRAPHICS_GENERATOR);
   
+  SnlfSourceInvalidate(source);
+  return false;
 }
 
 // ---
@@ -246,6 +354,29 @@ static inline bool SnlfSourceArrayRaiseChange(SnlfCoreRef core, SnlfSourceRef so
   return false;
 }
 
+// Whether target can be reached from source through children and references. Called under the lock.
+static bool SnlfSourceReaches(SnlfSourceRef source, SnlfSourceRef target) {
+  if (source == target) {
+    return true;
+  }
+  
+  switch (source->type) {
+  case SNLF_SOURCE_GROUP:
+    for (SnlfArraySizeType i = 0; i < source->children.size; ++i) {
+      if (SnlfSourceReaches(source->children.data[i], target)) {
+        return true;
+      }
+    }
+    return false;
+    
+  case SNLF_SOURCE_REFERENCE:
+    return SnlfSourceReaches(source->reference, target);
+    
+  default:
+    return false;
+  }
+}
+
 bool SnlfSourceAppend(SnlfSourceRef child, SnlfSourceRef parent) {
   assert(parent);
   assert(child);
@@ -261,6 +392,17 @@ bool SnlfSourceAppend(SnlfSourceRef child, SnlfSourceRef parent) {
     return true;
   }
   
+  // A reference back to the parent or one of its ancestors would contain itself
+  if (SnlfSourceReaches(child, parent)) {
+    SnlfErrorLog("The source references its parent or one of its ancestors.");
+    SnlfSourceRelease(parent);
+    SnlfSourceRelease(child);
+    if (UNLOCK(core)) {
+      SnlfMutexUnlockError();
+    }
+    return true;
+  }
+  
   if (SnlfArrayAppend(parent->children, child)) {
     SnlfSourceRelease(parent);
     SnlfSourceRelease(child);
@@ -278,7 +420,7 @@ bool SnlfSourceAppend(SnlfSourceRef child, SnlfSourceRef parent) {
   if (!message) {
     return true;
   }
-  SnlfMessageDispatchToSource(parent, message);
+  const bool dispatchFailed = SnlfMessageDispatchToSource(parent, message);
 
   // Dispatch to callback
   SnlfArrayChangedArgs args;
@@ -289,11 +431,16 @@ bool SnlfSourceAppend(SnlfSourceRef child, SnlfSourceRef parent) {
   
   bool ret = SnlfSourceArrayRaiseChange(core, child, args);
   SnlfSourceRelease(parent);
-  return ret;
+  return ret || dispatchFailed;
 }
 
 bool SnlfSourceInsertAt(SnlfArraySizeType index, SnlfSourceRef source, SnlfSourceRef parent) {
   assert(source);
+  
+  if (SnlfSourceReaches(source, parent)) {
+    SnlfErrorLog("The source references its parent or one of its ancestors.");
+    return true;
+  }
   SnlfSourceAddRef(source);
   
   if (SnlfArrayInsertAt(parent->children, index, source)) {
@@ -324,6 +471,14 @@ bool SnlfSourceRemoveFromParent(SnlfSourceRef source) {
       // TODO: exit
       return true;
     }
+    source->parent = NULL;
+    
+    // Dispatch to internal. A parent being destroyed has no graphics data left to notify.
+    bool dispatchFailed = false;
+    if (parent->graphicsData.size) {
+      SnlfBasicMessage *message = SnlfMessageCreateFromSource(SNLF_MESSAGE_SOURCE_REMOVE, source);
+      dispatchFailed = !message || SnlfMessageDispatchToSource(parent, message);
+    }
     
     SnlfArrayChangedArgs args;
     args.operation = SNLF_OPERATION_REMOVE;
@@ -333,7 +488,7 @@ bool SnlfSourceRemoveFromParent(SnlfSourceRef source) {
     
     bool ret = SnlfSourceArrayRaiseChange(core, source, args);
     SnlfSourceRelease(source);
-    return ret;
+    return ret || dispatchFailed;
   }
   
   // Remove source from root.
@@ -25,34 +25,71 @@ static void SnlfSourceAddSource(SnlfSourceGraphicsData *data, SnlfSourceRef sour
   }
 }
 
-static void SnlfSourceRemoveSource(SnlfSourceGraphicsData *data) {
+// Removes the graphics data of source from the children. Frames in flight may still draw it, so it is retired
+// rather than uninitialized.
+static void SnlfSourceRemoveSource(SnlfSourceGraphicsData *data, SnlfSourceRef source, const SnlfGraphicsContext *context) {
   assert(data);
+  assert(source);
   
-  data->uninit(data);
+  SnlfCoreRef core = source->core;
+  if (LOCK(core)) {
+    SnlfMutexLockError();
+    return;
+  }
+  
+  // The child whose graphics data the source holds
+  SnlfGraphicsData *childData = NULL;
+  for (SnlfArraySizeType i = 0; i < data->children.size && !childData; ++i) {
+    for (SnlfArraySizeType j = 0; j < source->graphicsData.size; ++j) {
+      if (data->children.data[i] == source->graphicsData.data[j]) {
+        childData = data->children.data[i];
+        SnlfArrayRemoveAt(data->children, i);
+        break;
+      }
+    }
+  }
+  
+  if (UNLOCK(core)) {
+    SnlfMutexUnlockError();
+  }
+  
+  if (childData) {
+    SnlfGraphicsDataRetire(context->retirement, childData);
+  }
 }
 
 static void SnlfSourceGraphicsData_ProcessMessage(intptr_t _data, const SnlfGraphicsContext *context) {
   assert(_data);
   SnlfSourceGraphicsData *data = (SnlfSourceGraphicsData *)_data;
   
-  SnlfBasicMessage *message;
-  while ((message = (SnlfBasicMessage *)SnlfLockFreeQueueDequeue(&data->messageQueue))) {
-    switch (message->type) {
-    case SNLF_MESSAGE_SOURCE_ADD:
-      SnlfSourceAddSource(data, (SnlfSourceRef)message->sender, context);
-      break;
+  intptr_t messages[SNLF_MESSAGE_BATCH_COUNT];
+  size_t count;
+  while ((count = SnlfQueueDequeueBatch(&data->messageQueue, messages, SNLF_MESSAGE_BATCH_COUNT))) {
+    for (size_t i = 0; i < count; ++i) {
+      SnlfBasicMessage *message = (SnlfBasicMessage *)messages[i];
+      switch (message->type) {
+      case SNLF_MESSAGE_SOURCE_ADD:
+        SnlfSourceAddSource(data, (SnlfSourceRef)message->sender, context);
+        SnlfDrawListInvalidate(context->drawList);
+        break;
         
-    case SNLF_MESSAGE_SOURCE_REMOVE:
-      SnlfSourceRemoveSource(data);
-      break;
+      case SNLF_MESSAGE_SOURCE_REMOVE:
+        SnlfSourceRemoveSource(data, (SnlfSourceRef)message->sender, context);
+        SnlfDrawListInvalidate(context->drawList);
+        break;
         
-    case SNLF_MESSAGE_SOURCE_ANIMATION:
-      break;
+      case SNLF_MESSAGE_SOURCE_ANIMATION:
+        break;
         
-    default:
+      case SNLF_MESSAGE_SOURCE_CHANGE_CACHE:
+        SnlfDrawListInvalidate(context->drawList);
         break;
+        
+      default:
+          break;
+      }
+      SnlfMessageRelease(message);
     }
-    SnlfDealloc(message);
   }
   
   SnlfArrayForeach(data->children) {
@@ -61,28 +98,21 @@ static void SnlfSourceGraphicsData_ProcessMessage(intptr_t _data, const SnlfGrap
   }
 }
 
-static void SnlfSourceGraphicsData_Update(intptr_t _data, SnlfGraphicsUpdateParams params) {
+static void SnlfSourceGraphicsData_Compile(intptr_t _data, SnlfDrawList *drawList, int32_t parent) {
   assert(_data);
   
   SnlfSourceGraphicsData *data = (SnlfSourceGraphicsData *)_data;
   if (data->enabled) {
-    params.world = matrix4x4_mul(params.world, data->source->transform);
-    
-    SnlfArrayForeach(data->children) {
-      SnlfGraphicsData *child = *(SnlfGraphicsData **)ptr;
-      child->update(child, params);
+    const bool cache = osutil_atomic_load32(&data->source->cacheAsBitmap) && !SnlfDrawListBeginCache(drawList);
+    const int32_t node = SnlfDrawListAppendNode(drawList, parent, data->source);
+    if (node >= 0) {
+      SnlfArrayForeach(data->children) {
+        SnlfGraphicsData *child = *(SnlfGraphicsData **)ptr;
+        SnlfGraphicsDataCompile(child, drawList, node);
+      }
     }
-  }
-}
-
-static void SnlfSourceGraphicsData_Draw(intptr_t _data, SnlfGraphicsDrawParams params) {
-  assert(_data);
-  
-  SnlfSourceGraphicsData *data = (SnlfSourceGraphicsData *)_data;
-  if (data->enabled) {
-    SnlfArrayForeach(data->children) {
-      SnlfGraphicsData *childData = *(SnlfGraphicsData **)ptr;
-      childData->draw(childData, params);
+    if (cache) {
+      SnlfDrawListEndCache(drawList);
     }
   }
 }
@@ -95,10 +125,34 @@ void SnlfSourceGraphicsData_Uninit(intptr_t _data) {
     SnlfGraphicsData *child = *(SnlfGraphicsData **)ptr;
     SnlfGraphicsDataUninit(child);
   }
+  SnlfSourceDetachGraphicsData(data->source, (SnlfGraphicsData *)data);
   SnlfSourceRelease(data->source);
+  SnlfQueueUninit(&data->messageQueue);
   SnlfDealloc(data);
 }
 
+void SnlfSourceDetachGraphicsData(SnlfSourceRef source, SnlfGraphicsData *data) {
+  assert(source);
+  assert(data);
+  
+  SnlfCoreRef core = source->core;
+  if (LOCK(core)) {
+    SnlfMutexLockError();
+    return;
+  }
+  
+  for (SnlfArraySizeType i = 0; i < source->graphicsData.size; ++i) {
+    if (source->graphicsData.data[i] == data) {
+      SnlfArrayRemoveAt(source->graphicsData, i);
+      break;
+    }
+  }
+  
+  if (UNLOCK(core)) {
+    SnlfMutexUnlockError();
+  }
+}
+
 static inline void SnlfGraphicsDataInitChildSources(SnlfSourceGraphicsData *parentData, const SnlfGraphicsContext *context) {
   SnlfSourceRef parent = parentData->source;
   assert(parent);
@@ -131,6 +185,7 @@ static inline void SnlfGraphicsDataInitChildSources(SnlfSourceGraphicsData *pare
 
 extern SnlfGraphicsData *SnlfGraphicsDataInitForInput(SnlfSourceRef source, const SnlfGraphicsContext *context);
 extern SnlfGraphicsData *SnlfGraphicsDataInitForGraphicsGenerator(SnlfSourceRef source, const SnlfGraphicsContext *context);
+extern SnlfGraphicsData *SnlfGraphicsDataInitForReference(SnlfSourceRef source, const SnlfGraphicsContext *context);
 
 SnlfGraphicsData *SnlfGraphicsDataInitFromSource(SnlfSourceRef source, const SnlfGraphicsContext *context) {
   SnlfSourceAddRef(source);
@@ -143,6 +198,8 @@ SnlfGraphicsData *SnlfGraphicsDataInitFromSource(SnlfSourceRef source, const Snl
     return SnlfGraphicsDataInitForGraphicsGenerator(source, context);
       
   case SNLF_SOURCE_REFERENCE:
+    return SnlfGraphicsDataInitForReference(source, context);
+      
   default:
     break;
   }
@@ -161,10 +218,9 @@ SnlfGraphicsData *SnlfGraphicsDataInitFromSource(SnlfSourceRef source, const Snl
     return NULL;
   }
   
-  SnlfLockFreeQueueInit(&data->messageQueue);
+  SnlfQueueInit(&data->messageQueue, SNLF_MESSAGE_QUEUE_CAPACITY);
   data->processMessage = SnlfSourceGraphicsData_ProcessMessage;
-  data->update = SnlfSourceGraphicsData_Update;
-  data->draw = SnlfSourceGraphicsData_Draw;
+  data->compile = SnlfSourceGraphicsData_Compile;
   data->uninit = SnlfSourceGraphicsData_Uninit;
   
   data->source = source;
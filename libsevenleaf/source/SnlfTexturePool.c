@@ -0,0 +1,131 @@
+#include "SnlfGraphics+Private.h"
+
+// ---
+// Texture Pool
+// ---
+void SnlfTexturePoolInit(SnlfTexturePool *pool, const CpsrDevice *device) {
+  assert(pool);
+  memset(pool, 0, sizeof(SnlfTexturePool));
+  pool->device = device;
+}
+
+// Destroys the textures still acquired as well.
+void SnlfTexturePoolUninit(SnlfTexturePool *pool) {
+  assert(pool);
+  
+  for (size_t i = 0; i < pool->freeCount; ++i) {
+    CpsrTexture2DDestroy(pool->frees[i].texture);
+  }
+  for (size_t i = 0; i < pool->usedCount; ++i) {
+    CpsrTexture2DDestroy(pool->useds[i].texture);
+  }
+  SnlfDealloc(pool->frees);
+  SnlfDealloc(pool->useds);
+  memset(pool, 0, sizeof(SnlfTexturePool));
+}
+
+// Destroys free textures no frame has asked for in SNLF_TEXTURE_POOL_IDLE_FRAMES frames. By then every frame
+// that could have sampled them has completed.
+void SnlfTexturePoolBegin(SnlfTexturePool *pool) {
+  assert(pool);
+  
+  const uint64_t frameNumber = ++pool->frameNumber;
+  size_t count = 0;
+  for (size_t i = 0; i < pool->freeCount; ++i) {
+    if (frameNumber - pool->frees[i].frameNumber > SNLF_TEXTURE_POOL_IDLE_FRAMES) {
+      CpsrTexture2DDestroy(pool->frees[i].texture);
+    } else {
+      pool->frees[count++] = pool->frees[i];
+    }
+  }
+  pool->freeCount = count;
+}
+
+static inline bool SnlfTexturePoolAppend(SnlfTexturePoolEntry **entries, size_t *count, size_t *capacity, const SnlfTexturePoolEntry *entry) {
+  if (*count == *capacity) {
+    const size_t newCapacity = *capacity ? 2 * *capacity : 8;
+    SnlfTexturePoolEntry *newEntries = (SnlfTexturePoolEntry *)realloc(*entries, sizeof(SnlfTexturePoolEntry) * newCapacity);
+    if (!newEntries) {
+      return true;
+    }
+    *entries = newEntries;
+    *capacity = newCapacity;
+  }
+  (*entries)[(*count)++] = *entry;
+  return false;
+}
+
+static inline bool SnlfTexture2DDescriptorEqual(const CpsrTexture2DDescriptor *a, const CpsrTexture2DDescriptor *b) {
+  return CpsrSizeU32Equal(a->size, b->size)
+    && a->arrayLength == b->arrayLength
+    && a->pixelFormat == b->pixelFormat
+    && a->usage == b->usage;
+}
+
+CpsrTexture2D *SnlfTexturePoolAcquire(SnlfTexturePool *pool, const CpsrTexture2DDescriptor *descriptor) {
+  assert(pool);
+  assert(descriptor);
+  
+  // The most recently released texture first; it is the likeliest to still be resident
+  SnlfTexturePoolEntry entry;
+  entry.texture = NULL;
+  for (size_t i = pool->freeCount; i > 0; --i) {
+    if (SnlfTexture2DDescriptorEqual(&pool->frees[i - 1].descriptor, descriptor)) {
+      entry = pool->frees[i - 1];
+      pool->frees[i - 1] = pool->frees[--pool->freeCount];
+      break;
+    }
+  }
+  
+  if (!entry.texture) {
+    entry.texture = CpsrTexture2DCreate(pool->device, descriptor, CPSR_HEAP_TYPE_DEFAULT);
+    if (!entry.texture) {
+      SnlfOutOfMemoryError();
+      return NULL;
+    }
+    entry.descriptor = *descriptor;
+  }
+  entry.frameNumber = pool->frameNumber;
+  
+  if (SnlfTexturePoolAppend(&pool->useds, &pool->usedCount, &pool->usedCapacity, &entry)) {
+    SnlfOutOfMemoryError();
+    CpsrTexture2DDestroy(entry.texture);
+    return NULL;
+  }
+  return entry.texture;
+}
+
+void SnlfTexturePoolRelease(SnlfTexturePool *pool, CpsrTexture2D *texture) {
+  assert(pool);
+  assert(texture);
+  
+  for (size_t i = 0; i < pool->usedCount; ++i) {
+    if (pool->useds[i].texture != texture) {
+      continue;
+    }
+  
+    SnlfTexturePoolEntry entry = pool->useds[i];
+    pool->useds[i] = pool->useds[--pool->usedCount];
+    entry.frameNumber = pool->frameNumber;
+    if (SnlfTexturePoolAppend(&pool->frees, &pool->freeCount, &pool->freeCapacity, &entry)) {
+      CpsrTexture2DDestroy(texture);
+    }
+    return;
+  }
+  assert(false);
+}
+
+CpsrTexture2D *SnlfGraphicsContextAcquireTexture(const SnlfGraphicsContext *context, const CpsrTexture2DDescriptor *descriptor) {
+  assert(context);
+  
+  if (!context->texturePool) {
+    return NULL;
+  }
+  return SnlfTexturePoolAcquire(context->texturePool, descriptor);
+}
+
+void SnlfGraphicsContextReleaseTexture(const SnlfGraphicsContext *context, CpsrTexture2D *texture) {
+  assert(context);
+  assert(context->texturePool);
+  SnlfTexturePoolRelease(context->texturePool, texture);
+}
@@ -0,0 +1,255 @@
+#include "SnlfCore+Private.h"
+#include "SnlfColorManagement+Private.h"
+
+#include <assert.h>
+#include <math.h>
+
+#define SNLF_TONE_MAPPING_CURVE_PRECISION 12
+#define SNLF_PQ_PEAK_LUMINANCE            10000.0
+
+// ---
+// Curves
+// ---
+// PQ code of linear light and back.
+static inline double SnlfToneMappingPQEncode(double light) {
+  const SnlfTransferCharacteristics pq = { .type = SNLF_TC_PQ };
+  return SnlfTransferEncode(&pq, light * (SNLF_REFERENCE_WHITE_LUMINANCE / SNLF_PQ_PEAK_LUMINANCE));
+}
+
+static inline double SnlfToneMappingPQDecode(double code) {
+  const SnlfTransferCharacteristics pq = { .type = SNLF_TC_PQ };
+  return SnlfTransferDecode(&pq, code) * (SNLF_PQ_PEAK_LUMINANCE / SNLF_REFERENCE_WHITE_LUMINANCE);
+}
+
+static double SnlfToneMappingEvaluateCurve(const SnlfToneMappingParameters *parameters, double light) {
+  if (!(light > 0.0)) {
+    return 0.0;
+  }
+  if (parameters->sourcePeak <= parameters->targetPeak) {
+    return fmin(light, parameters->targetPeak);
+  }
+  
+  double result;
+  switch (parameters->curve) {
+  case SNLF_TONE_MAPPING_BT2390: {
+    const double ks = parameters->kneeStart;
+    double e = (SnlfToneMappingPQEncode(light) - parameters->pqBlack) / parameters->pqRange;
+    e = e > 0.0 ? (e < 1.0 ? e : 1.0) : 0.0;
+    if (e > ks) {
+      const double t = (e - ks) / (1.0 - ks);
+      const double t2 = t * t;
+      const double t3 = t2 * t;
+      e = (2.0 * t3 - 3.0 * t2 + 1.0) * ks + (t3 - 2.0 * t2 + t) * (1.0 - ks) + (-2.0 * t3 + 3.0 * t2) * parameters->maxLuminance;
+    }
+  
+    // Black level lift, which lowers the source black onto the target black
+    const double inverse = 1.0 - e;
+    e += parameters->minLuminance * (inverse * inverse) * (inverse * inverse);
+    result = SnlfToneMappingPQDecode(fmax(e * parameters->pqRange + parameters->pqBlack, 0.0));
+    break;
+  }
+  case SNLF_TONE_MAPPING_REINHARD: {
+    const double l = light / parameters->targetPeak;
+    const double white = parameters->sourcePeak / parameters->targetPeak;
+    result = parameters->targetPeak * l * (1.0 + l / (white * white)) / (1.0 + l);
+    break;
+  }
+  default:
+    result = light;
+    break;
+  }
+  return fmin(result, parameters->targetPeak);
+}
+
+float SnlfToneMappingEvaluate(const SnlfToneMappingParameters *parameters, float light) {
+  assert(parameters);
+  
+  return (float)SnlfToneMappingEvaluateCurve(parameters, light);
+}
+
+static double SnlfToneMapperCurve(const void *param, double value) {
+  const SnlfToneMappingParameters *parameters = (const SnlfToneMappingParameters *)param;
+  return SnlfToneMappingEvaluateCurve(parameters, value * fmax(parameters->sourcePeak, parameters->targetPeak));
+}
+
+// ---
+// Parameters
+// ---
+static inline SnlfTransferLUT *SnlfToneMapperGetSpareCurve(SnlfToneMapperRef toneMapper) {
+  return toneMapper->curves[toneMapper->curves[0] == toneMapper->curve ? 1 : 0];
+}
+
+// Builds the curve into the spare buffer; conversions keep reading the current one until it is swapped in.
+static void SnlfToneMapperSetSourcePeak(SnlfToneMapperRef toneMapper, float peakLuminance) {
+  SnlfToneMappingParameters *parameters = &toneMapper->pendingParameters;
+  parameters->curve = toneMapper->parameters.curve;
+  parameters->targetPeak = toneMapper->parameters.targetPeak;
+  parameters->sourcePeak = peakLuminance / SNLF_REFERENCE_WHITE_LUMINANCE;
+  
+  // The target black is zero, so a black lift never raises it
+  const float black = toneMapper->blackLuminance < peakLuminance ? toneMapper->blackLuminance : 0.F;
+  const double pqBlack = SnlfToneMappingPQEncode(black / SNLF_REFERENCE_WHITE_LUMINANCE);
+  const double pqRange = SnlfToneMappingPQEncode(parameters->sourcePeak) - pqBlack;
+  const double maxLuminance = (SnlfToneMappingPQEncode(parameters->targetPeak) - pqBlack) / pqRange;
+  parameters->pqBlack = (float)pqBlack;
+  parameters->pqRange = (float)pqRange;
+  parameters->kneeStart = (float)fmax(1.5 * maxLuminance - 0.5, 0.0);
+  parameters->maxLuminance = (float)maxLuminance;
+  parameters->minLuminance = (float)((SnlfToneMappingPQEncode(0.0) - pqBlack) / pqRange);
+  
+  const double peak = fmax(parameters->sourcePeak, parameters->targetPeak);
+  SnlfTransferLUTFill(SnlfToneMapperGetSpareCurve(toneMapper), peak, SnlfToneMapperCurve, parameters);
+  toneMapper->pending = true;
+}
+
+static void SnlfToneMapperSwapCurve(SnlfToneMapperRef toneMapper) {
+  toneMapper->parameters = toneMapper->pendingParameters;
+  toneMapper->curve = SnlfToneMapperGetSpareCurve(toneMapper);
+  toneMapper->pending = false;
+}
+
+// ---
+// Init/Uninit
+// ---
+SnlfToneMapperRef SnlfToneMapperInit(SnlfToneMappingCurve curve, float targetLuminance, bool dynamic) {
+  assert(targetLuminance > 0.F);
+  
+  SnlfToneMapperRef toneMapper = SnlfAllocRef(SnlfToneMapper);
+  if (!toneMapper) {
+    SnlfOutOfMemoryError();
+    return NULL;
+  }
+  
+  for (size_t i = 0; i < 2; ++i) {
+    toneMapper->curves[i] = SnlfTransferLUTAlloc(SNLF_TRANSFER_ENCODE, SNLF_TONE_MAPPING_CURVE_PRECISION);
+    if (!toneMapper->curves[i]) {
+      while (i--) {
+        SnlfDealloc(toneMapper->curves[i]);
+      }
+      SnlfDealloc(toneMapper);
+      return NULL;
+    }
+  }
+  toneMapper->curve = toneMapper->curves[0];
+  
+  toneMapper->parameters.curve = (uint32_t)curve;
+  toneMapper->parameters.targetPeak = targetLuminance / SNLF_REFERENCE_WHITE_LUMINANCE;
+  toneMapper->metadataPeakLuminance = SNLF_HDR10_PEAK_LUMINANCE;
+  toneMapper->blackLuminance = 0.F;
+  toneMapper->dynamic = dynamic;
+  for (size_t i = 0; i < SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT; ++i) {
+    osutil_atomic_store32(toneMapper->histogram + i, 0);
+  }
+  SnlfToneMapperSetSourcePeak(toneMapper, toneMapper->metadataPeakLuminance);
+  SnlfToneMapperSwapCurve(toneMapper);
+  return toneMapper;
+}
+
+void SnlfToneMapperUninit(SnlfToneMapperRef toneMapper) {
+  assert(toneMapper);
+  
+  SnlfDealloc(toneMapper->curves[0]);
+  SnlfDealloc(toneMapper->curves[1]);
+  SnlfDealloc(toneMapper);
+}
+
+// ---
+// Metadata
+// ---
+void SnlfToneMapperSetMetadata(SnlfToneMapperRef toneMapper, const SnlfHDR10Descriptor *descriptor) {
+  assert(toneMapper);
+  assert(descriptor);
+  
+  float peakLuminance = SNLF_HDR10_PEAK_LUMINANCE;
+  if (descriptor->maxContentLightLevel) {
+    peakLuminance = (float)descriptor->maxContentLightLevel;
+  } else if (descriptor->maxMasteringLuminance > 0.F) {
+    peakLuminance = descriptor->maxMasteringLuminance;
+  }
+  const float blackLuminance = descriptor->minMasteringLuminance > 0.F ? descriptor->minMasteringLuminance : 0.F;
+  if (peakLuminance == toneMapper->metadataPeakLuminance && blackLuminance == toneMapper->blackLuminance) {
+    return;
+  }
+  
+  toneMapper->metadataPeakLuminance = peakLuminance;
+  toneMapper->blackLuminance = blackLuminance;
+  SnlfToneMapperSetSourcePeak(toneMapper, peakLuminance);
+}
+
+// ---
+// Histogram
+// ---
+void SnlfToneMapperMergeHistogram(SnlfToneMapperRef toneMapper, const uint32_t bins[SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT]) {
+  for (size_t i = 0; i < SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT; ++i) {
+    if (bins[i]) {
+      osutil_atomic_fetch_add32(toneMapper->histogram + i, (int32_t)bins[i]);
+    }
+  }
+}
+
+void SnlfToneMapperEndFrame(SnlfToneMapperRef toneMapper) {
+  assert(toneMapper);
+  
+  if (!toneMapper->dynamic) {
+    if (toneMapper->pending) {
+      SnlfToneMapperSwapCurve(toneMapper);
+    }
+    return;
+  }
+  
+  uint64_t total = 0;
+  uint32_t bins[SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT];
+  for (size_t i = 0; i < SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT; ++i) {
+    bins[i] = (uint32_t)osutil_atomic_load32(toneMapper->histogram + i);
+    osutil_atomic_store32(toneMapper->histogram + i, 0);
+    total += bins[i];
+  }
+  
+  // New metadata starts over from its peak, regardless of the frame measured under the old curve
+  if (toneMapper->pending) {
+    SnlfToneMapperSwapCurve(toneMapper);
+    return;
+  }
+  if (!total) {
+    return;
+  }
+  
+  // The upper edge of the bin that holds the percentile
+  const uint64_t threshold = (uint64_t)ceil((double)total * SNLF_TONE_MAPPING_PERCENTILE);
+  uint64_t count = 0;
+  size_t bin = 0;
+  for (; bin + 1 < SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT; ++bin) {
+    count += bins[bin];
+    if (count >= threshold) {
+      break;
+    }
+  }
+  const uint32_t edge = (uint32_t)bin + 1;
+  const uint32_t interval = edge & ((1U << SNLF_LUMINANCE_HISTOGRAM_BIN_BITS) - 1);
+  const int32_t exponent = SNLF_LUMINANCE_HISTOGRAM_MIN_EXPONENT + (int32_t)(edge >> SNLF_LUMINANCE_HISTOGRAM_BIN_BITS);
+  const double measured = ldexp(1.0 + (double)interval / (1U << SNLF_LUMINANCE_HISTOGRAM_BIN_BITS), exponent);
+  
+  // Dark frames keep at least the target peak, which leaves them untouched
+  float target = (float)(measured * SNLF_REFERENCE_WHITE_LUMINANCE);
+  const float targetLuminance = toneMapper->parameters.targetPeak * SNLF_REFERENCE_WHITE_LUMINANCE;
+  if (target > toneMapper->metadataPeakLuminance) {
+    target = toneMapper->metadataPeakLuminance;
+  }
+  if (target < targetLuminance) {
+    target = targetLuminance;
+  }
+  
+  const float current = toneMapper->parameters.sourcePeak * SNLF_REFERENCE_WHITE_LUMINANCE;
+  const float peakLuminance = current + (target - current) * SNLF_TONE_MAPPING_ADAPTATION;
+  // Changes below 0.1% are not worth rebuilding the curve
+  if (fabsf(peakLuminance - current) > current * 0.001F) {
+    SnlfToneMapperSetSourcePeak(toneMapper, peakLuminance);
+    SnlfToneMapperSwapCurve(toneMapper);
+  }
+}
+
+const SnlfToneMappingParameters *SnlfToneMapperGetParameters(SnlfToneMapperRef toneMapper) {
+  assert(toneMapper);
+  
+  return &toneMapper->parameters;
+}
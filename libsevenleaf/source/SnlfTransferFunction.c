@@ -0,0 +1,262 @@
+#include "SnlfCore+Private.h"
+#include "SnlfColorManagement+Private.h"
+
+#include <assert.h>
+#include <math.h>
+
+#define LOCK()   pthread_mutex_lock(&gTransferLUTMutex)
+#define UNLOCK() pthread_mutex_unlock(&gTransferLUTMutex)
+
+// ---
+// Transfer characteristics
+// ---
+bool SnlfGetTransferCharacteristics(SnlfTransferCharacteristicsType type, SnlfTransferCharacteristics *transferCharacteristics) {
+  assert(transferCharacteristics);
+  
+  SnlfTransferCharacteristics tc;
+  tc.type = type;
+  tc.gamma = 0.F;
+  tc.offset = 0.F;
+  tc.linearThreshold = 0.F;
+  tc.linearSlope = 1.F;
+  tc.peakLuminance = SNLF_REFERENCE_WHITE_LUMINANCE;
+  switch (type) {
+  case SNLF_TC_LINEAR:
+    tc.gamma = 1.F;
+    break;
+  case SNLF_TC_GAMMA18:
+    tc.gamma = 1.8F;
+    break;
+  case SNLF_TC_GAMMA20:
+    tc.gamma = 2.F;
+    break;
+  case SNLF_TC_GAMMA22:
+  case SNLF_TC_BT1886_G22:
+    tc.gamma = 2.2F;
+    break;
+  case SNLF_TC_BT709:
+  case SNLF_TC_BT601:
+  case SNLF_TC_SMPTE240M:
+  case SNLF_TC_BT2020_10:
+  case SNLF_TC_BT2020_12:
+  case SNLF_TC_GAMMA24:
+  case SNLF_TC_BT1886:
+    tc.gamma = 2.4F;
+    break;
+  case SNLF_TC_GAMMA26:
+    tc.gamma = 2.6F;
+    break;
+  case SNLF_TC_GAMMA28:
+    tc.gamma = 2.8F;
+    break;
+  case SNLF_TC_SRGB:
+    tc.gamma = 2.4F;
+    tc.offset = 0.055F;
+    tc.linearThreshold = 0.0031308F;
+    tc.linearSlope = 12.92F;
+    break;
+  case SNLF_TC_PRO_PHOTO:
+    tc.gamma = 1.8F;
+    tc.linearThreshold = 1.F / 512.F;
+    tc.linearSlope = 16.F;
+    break;
+  case SNLF_TC_SMPTE428:
+    // 48 cd/m2 cinema white shows as reference white
+    tc.gamma = 2.6F;
+    tc.peakLuminance = SNLF_REFERENCE_WHITE_LUMINANCE * 52.37F / 48.F;
+    break;
+  case SNLF_TC_PQ:
+    tc.peakLuminance = 10000.F;
+    break;
+  case SNLF_TC_HLG:
+    tc.peakLuminance = SNLF_HLG_PEAK_LUMINANCE;
+    break;
+  default:
+    return true;
+  }
+  *transferCharacteristics = tc;
+  return false;
+}
+
+// ---
+// Curves
+// ---
+// Both work on light normalized to the peak luminance.
+#define SNLF_PQ_M1 (2610.0 / 16384.0)
+#define SNLF_PQ_M2 (2523.0 / 4096.0 * 128.0)
+#define SNLF_PQ_C1 (3424.0 / 4096.0)
+#define SNLF_PQ_C2 (2413.0 / 4096.0 * 32.0)
+#define SNLF_PQ_C3 (2392.0 / 4096.0 * 32.0)
+#define SNLF_HLG_A 0.17883277
+#define SNLF_HLG_B 0.28466892
+#define SNLF_HLG_C 0.55991073
+#define SNLF_HLG_SYSTEM_GAMMA 1.2
+
+double SnlfTransferDecode(const SnlfTransferCharacteristics *tc, double code) {
+  switch (tc->type) {
+  case SNLF_TC_PQ: {
+    const double power = pow(code, 1.0 / SNLF_PQ_M2);
+    return pow(fmax(power - SNLF_PQ_C1, 0.0) / (SNLF_PQ_C2 - SNLF_PQ_C3 * power), 1.0 / SNLF_PQ_M1);
+  }
+  case SNLF_TC_HLG: {
+    const double scene = code <= 0.5 ? code * code / 3.0 : (exp((code - SNLF_HLG_C) / SNLF_HLG_A) + SNLF_HLG_B) / 12.0;
+    return pow(scene, SNLF_HLG_SYSTEM_GAMMA);
+  }
+  default:
+    if (code < (double)tc->linearSlope * tc->linearThreshold) {
+      return code / tc->linearSlope;
+    }
+    return pow((code + tc->offset) / (1.0 + tc->offset), tc->gamma);
+  }
+}
+
+double SnlfTransferEncode(const SnlfTransferCharacteristics *tc, double light) {
+  switch (tc->type) {
+  case SNLF_TC_PQ: {
+    const double power = pow(light, SNLF_PQ_M1);
+    return pow((SNLF_PQ_C1 + SNLF_PQ_C2 * power) / (1.0 + SNLF_PQ_C3 * power), SNLF_PQ_M2);
+  }
+  case SNLF_TC_HLG: {
+    const double scene = pow(light, 1.0 / SNLF_HLG_SYSTEM_GAMMA);
+    return scene <= 1.0 / 12.0 ? sqrt(3.0 * scene) : SNLF_HLG_A * log(12.0 * scene - SNLF_HLG_B) + SNLF_HLG_C;
+  }
+  default:
+    if (light < tc->linearThreshold) {
+      return light * tc->linearSlope;
+    }
+    return (1.0 + tc->offset) * pow(light, 1.0 / tc->gamma) - tc->offset;
+  }
+}
+
+// ---
+// LUT
+// ---
+SnlfTransferLUT *SnlfTransferLUTAlloc(SnlfTransferDirection direction, uint32_t precision) {
+  const uint32_t intervalBits = precision - 7;
+  const uint32_t count = direction == SNLF_TRANSFER_DECODE ? 1U << precision : (uint32_t)-SNLF_TRANSFER_LUT_MIN_EXPONENT << intervalBits;
+  
+  SnlfTransferLUT *lut = (SnlfTransferLUT *)malloc(sizeof(SnlfTransferLUT) + sizeof(float) * (count + 2));
+  if (!lut) {
+    SnlfOutOfMemoryError();
+    return NULL;
+  }
+  
+  lut->type = SNLF_TC_CUSTOM;
+  lut->direction = direction;
+  lut->precision = precision;
+  lut->count = count;
+  lut->shift = direction == SNLF_TRANSFER_DECODE ? 0 : 23 - intervalBits;
+  lut->fractionScale = direction == SNLF_TRANSFER_DECODE ? 0.F : 1.F / (float)(1U << lut->shift);
+  lut->scale = 1.F;
+  lut->lowSlope = 0.F;
+  return lut;
+}
+
+void SnlfTransferLUTFill(SnlfTransferLUT *lut, double peak, SnlfTransferCurve curve, const void *param) {
+  assert(lut);
+  assert(curve);
+  
+  const uint32_t count = lut->count;
+  if (lut->direction == SNLF_TRANSFER_DECODE) {
+    for (uint32_t i = 0; i <= count; ++i) {
+      lut->entries[i] = (float)curve(param, (double)i / count);
+    }
+  } else {
+    const uint32_t intervalBits = lut->precision - 7;
+    lut->scale = (float)(1.0 / peak);
+    for (uint32_t i = 0; i <= count; ++i) {
+      const uint32_t interval = i & ((1U << intervalBits) - 1);
+      const int32_t exponent = SNLF_TRANSFER_LUT_MIN_EXPONENT + (int32_t)(i >> intervalBits);
+      lut->entries[i] = (float)curve(param, ldexp(1.0 + (double)interval / (1U << intervalBits), exponent));
+    }
+    lut->lowSlope = lut->entries[0] / SNLF_TRANSFER_LUT_LOWEST;
+  }
+  lut->entries[count + 1] = lut->entries[count];
+}
+
+static double SnlfTransferLUTDecodeCurve(const void *param, double code) {
+  const SnlfTransferCharacteristics *tc = (const SnlfTransferCharacteristics *)param;
+  return tc->peakLuminance / SNLF_REFERENCE_WHITE_LUMINANCE * SnlfTransferDecode(tc, code);
+}
+
+static double SnlfTransferLUTEncodeCurve(const void *param, double light) {
+  return SnlfTransferEncode((const SnlfTransferCharacteristics *)param, light);
+}
+
+static SnlfTransferLUT *SnlfTransferLUTCreate(const SnlfTransferCharacteristics *tc, SnlfTransferDirection direction, uint32_t precision) {
+  SnlfTransferLUT *lut = SnlfTransferLUTAlloc(direction, precision);
+  if (!lut) {
+    return NULL;
+  }
+  
+  // Linear light of code 1.0
+  const double peak = tc->peakLuminance / SNLF_REFERENCE_WHITE_LUMINANCE;
+  lut->type = tc->type;
+  SnlfTransferLUTFill(lut, peak, direction == SNLF_TRANSFER_DECODE ? SnlfTransferLUTDecodeCurve : SnlfTransferLUTEncodeCurve, tc);
+  return lut;
+}
+
+static pthread_mutex_t gTransferLUTMutex = PTHREAD_MUTEX_INITIALIZER;
+static SnlfTransferLUT *gTransferLUTs[SNLF_TRANSFER_LUT_CACHE_COUNT];
+static size_t gTransferLUTCount = 0;
+
+const SnlfTransferLUT *SnlfGetTransferLUT(SnlfTransferCharacteristicsType type, SnlfTransferDirection direction, uint32_t precision) {
+  if (precision != 10 && precision != 12 && precision != 16) {
+    SnlfErrorLogFormat("Unsupported transfer LUT precision (%u).", precision);
+    return NULL;
+  }
+  
+  SnlfTransferCharacteristics tc;
+  if (SnlfGetTransferCharacteristics(type, &tc)) {
+    SnlfErrorLogFormat("Unsupported transfer characteristics (%d).", (int)type);
+    return NULL;
+  }
+  
+  if (LOCK()) {
+    SnlfMutexLockError();
+    return NULL;
+  }
+  
+  SnlfTransferLUT *lut = NULL;
+  for (size_t i = 0; i < gTransferLUTCount; ++i) {
+    SnlfTransferLUT *entry = gTransferLUTs[i];
+    if (entry->type == type && entry->direction == direction && entry->precision == precision) {
+      lut = entry;
+      break;
+    }
+  }
+  
+  // LUTs stay for the rest of the process; converters hold on to them
+  if (!lut) {
+    assert(gTransferLUTCount < SNLF_TRANSFER_LUT_CACHE_COUNT);
+    lut = SnlfTransferLUTCreate(&tc, direction, precision);
+    if (lut) {
+      gTransferLUTs[gTransferLUTCount++] = lut;
+    }
+  }
+  
+  if (UNLOCK()) {
+    SnlfMutexUnlockError();
+  }
+  return lut;
+}
+
+void SnlfTransferLUTApply(const SnlfTransferLUT *lut, const float *source, float *destination, size_t count) {
+  assert(lut);
+  assert(source);
+  assert(destination);
+  
+  size_t i = 0;
+#if defined(_SIMD_X86_SSE4_1)
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(destination + i, SnlfTransferLUTEvaluate4(lut, _mm_loadu_ps(source + i)));
+  }
+#elif defined(_SIMD_ARM_NEON)
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(destination + i, SnlfTransferLUTEvaluate4(lut, vld1q_f32(source + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    destination[i] = SnlfTransferLUTEvaluate(lut, source[i]);
+  }
+}
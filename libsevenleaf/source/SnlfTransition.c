@@ -47,7 +47,7 @@ bool SnlfTransitionDispatch(SnlfCoreRef core, SnlfSourceRef source) {
   if (!message) {
     return true;
   }
-  SnlfMessageDispatchToRoot(core, message);
+  const bool ret = SnlfMessageDispatchToRoot(core, message);
   
   // Dispatch to callback
   SnlfTransitionDispatchChanged(core, previousSource, source);
@@ -55,7 +55,7 @@ bool SnlfTransitionDispatch(SnlfCoreRef core, SnlfSourceRef source) {
   if (UNLOCK(core)) {
     // TODO: Log
   }
-  return false;
+  return ret;
 }
 
 // ---
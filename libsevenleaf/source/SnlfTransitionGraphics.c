@@ -13,40 +13,48 @@ struct _SnlfTransitionGraphicsData {
   
   SnlfGraphicsData *previous;
   SnlfGraphicsData *current;
+  SnlfDrawList *drawList;
+  SnlfGraphicsDataRetirement *retirement;
   
   timestamp_t transitionBegin;
   duration_t transitionDuration;
 };
 
+// Frames in flight may still draw the previous scene, so it is retired rather than uninitialized.
 static inline void SnlfTransitionUninitPreviousData(SnlfTransitionGraphicsData *data) {
-  SnlfGraphicsDataUninit(data->previous);
+  SnlfGraphicsDataRetire(data->retirement, data->previous);
   data->previous = NULL;
+  SnlfDrawListInvalidate(data->drawList);
 }
 
 static void SnlfTransitionGraphicsData_ProcessMessage(intptr_t _data, const SnlfGraphicsContext *context) {
   assert(_data);
   SnlfTransitionGraphicsData *data = (SnlfTransitionGraphicsData *)_data;
   
-  SnlfBasicMessage *message;
-  while ((message = (SnlfBasicMessage *)SnlfLockFreeQueueDequeue(&data->messageQueue))) {
-    switch (message->type) {
-    case SNLF_MESSAGE_TRANSITION_CHANGE_SCENE:
-      if (data->previous) {
-        SnlfTransitionUninitPreviousData(data);
-      }
-      if (data->current) {
-        data->transitionBegin = 0;
-        data->transitionDuration = 0;
-        data->previous = data->current;
-      }
-      data->current = SnlfGraphicsDataInitFromSource((SnlfSourceRef)message->sender, context);
-      break;
+  intptr_t messages[SNLF_MESSAGE_BATCH_COUNT];
+  size_t count;
+  while ((count = SnlfQueueDequeueBatch(&data->messageQueue, messages, SNLF_MESSAGE_BATCH_COUNT))) {
+    for (size_t i = 0; i < count; ++i) {
+      SnlfBasicMessage *message = (SnlfBasicMessage *)messages[i];
+      switch (message->type) {
+      case SNLF_MESSAGE_TRANSITION_CHANGE_SCENE:
+        if (data->previous) {
+          SnlfTransitionUninitPreviousData(data);
+        }
+        if (data->current) {
+          data->transitionBegin = 0;
+          data->transitionDuration = 0;
+          data->previous = data->current;
+        }
+        data->current = SnlfGraphicsDataInitFromSource((SnlfSourceRef)message->sender, context);
+        SnlfDrawListInvalidate(data->drawList);
+        break;
         
-    default:
-      break;
+      default:
+        break;
+      }
+      SnlfMessageRelease(message);
     }
-    SnlfSourceRelease((SnlfSourceRef)message->sender);
-    SnlfDealloc(message);
   }
   
   SnlfGraphicsData *previous = data->previous;
@@ -60,67 +68,59 @@ static void SnlfTransitionGraphicsData_ProcessMessage(intptr_t _data, const Snlf
   }
 }
 
-static void SnlfTransitionGraphicsData_Update(intptr_t _data, SnlfGraphicsUpdateParams params) {
+static void SnlfTransitionGraphicsData_Compile(intptr_t _data, SnlfDrawList *drawList, int32_t parent) {
   assert(_data);
   SnlfTransitionGraphicsData *data = (SnlfTransitionGraphicsData *)_data;
   
-  // Config transition state
-  if (data->previous) {
-    if (data->transitionBegin == 0) {
-      data->transitionBegin = params.timestamp;
-    }
-    
-    duration_t duration = params.timestamp - data->transitionBegin;
-    if (data->transitionDuration <= duration) {
-      SnlfTransitionUninitPreviousData(data);
-    }
-  }
-  
   SnlfGraphicsData *previous = data->previous;
   if (previous) {
-    SnlfGraphicsDataUpdate(previous, params);
+    SnlfGraphicsDataCompile(previous, drawList, parent);
   }
   
-  if (data->current) {
-    SnlfGraphicsDataUpdate(data->current, params);
+  SnlfGraphicsData *current = data->current;
+  if (current) {
+    SnlfGraphicsDataCompile(current, drawList, parent);
   }
 }
 
-static void SnlfTransitionGraphicsData_Draw(intptr_t _data, SnlfGraphicsDrawParams params) {
-  assert(_data);
-  SnlfTransitionGraphicsData *data = (SnlfTransitionGraphicsData *)_data;
-  
-  SnlfGraphicsData *previous = data->previous;
-  if (previous) {
-    SnlfGraphicsDataDraw(previous, params);
-  }
+void SnlfTransitionGraphicsDataUpdate(SnlfTransitionGraphicsData *data, timestamp_t timestamp) {
+  assert(data);
   
-  SnlfGraphicsData *current = data->current;
-  if (current) {
-    SnlfGraphicsDataDraw(current, params);
+  // Config transition state
+  if (data->previous) {
+    if (data->transitionBegin == 0) {
+      data->transitionBegin = timestamp;
+    }
+    
+    duration_t duration = timestamp - data->transitionBegin;
+    if (data->transitionDuration <= duration) {
+      SnlfTransitionUninitPreviousData(data);
+    }
   }
 }
 
 void SnlfTransitionGraphicsData_Uninit(intptr_t _data) {
   assert(_data);
   SnlfTransitionGraphicsData *data = (SnlfTransitionGraphicsData *)_data;
+  SnlfQueueUninit(&data->messageQueue);
   SnlfDealloc(data);
 }
 
 SnlfTransitionGraphicsData *SnlfTransitionGraphicsDataInit(SnlfCoreRef core, const SnlfGraphicsContext *context) {
   SnlfTransitionGraphicsData *data = SnlfAlloc(SnlfTransitionGraphicsData);
-  if (!context) {
+  if (!data) {
     SnlfOutOfMemoryError();
     return NULL;
   }
   
-  SnlfLockFreeQueueInit(&data->messageQueue);
+  SnlfQueueInit(&data->messageQueue, SNLF_MESSAGE_QUEUE_CAPACITY);
   data->processMessage = SnlfTransitionGraphicsData_ProcessMessage;
-  data->update = SnlfTransitionGraphicsData_Update;
-  data->draw = SnlfTransitionGraphicsData_Draw;
+  data->compile = SnlfTransitionGraphicsData_Compile;
   data->uninit = SnlfTransitionGraphicsData_Uninit;
   
   data->previous = NULL;
   data->current = NULL;
+  data->drawList = context->drawList;
+  data->retirement = context->retirement;
   return data;
 }
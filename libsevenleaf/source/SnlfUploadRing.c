@@ -0,0 +1,126 @@
+#include "SnlfGraphics+Private.h"
+
+#define SNLF_UPLOAD_RING_ALIGN(__SIZE__) \
+  (((__SIZE__) + SNLF_UPLOAD_RING_ALIGNMENT - 1) & ~(size_t)(SNLF_UPLOAD_RING_ALIGNMENT - 1))
+
+// ---
+// Upload Ring
+// ---
+void SnlfUploadRingInit(SnlfUploadRing *ring, const CpsrDevice *device) {
+  assert(ring);
+  memset(ring, 0, sizeof(SnlfUploadRing));
+  ring->device = device;
+}
+
+void SnlfUploadRingUninit(SnlfUploadRing *ring) {
+  assert(ring);
+  
+  for (size_t i = 0; i < SNLF_OUTPUT_BUFFER_COUNT; ++i) {
+    SnlfUploadRingFrame *frame = ring->frames + i;
+    for (size_t j = 0; j < frame->bufferCount; ++j) {
+      CpsrBufferDestroy(frame->buffers[j].buffer);
+    }
+    SnlfDealloc(frame->buffers);
+  }
+  memset(ring, 0, sizeof(SnlfUploadRing));
+}
+
+void SnlfUploadRingBegin(SnlfUploadRing *ring, size_t frameIndex) {
+  assert(ring);
+  assert(frameIndex < SNLF_OUTPUT_BUFFER_COUNT);
+  
+  ring->frameIndex = frameIndex;
+  ring->frames[frameIndex].bufferIndex = 0;
+  ring->frames[frameIndex].offset = 0;
+}
+
+static inline bool SnlfUploadRingCreateBuffer(const CpsrDevice *device, size_t size, SnlfUploadRingBuffer *buffer) {
+  CpsrBuffer *native = CpsrBufferCreateFromSize(device, size, CPSR_HEAP_TYPE_UPLOAD, CPSR_CONSTANT_BUFFER);
+  if (!native) {
+    return true;
+  }
+  
+  void *data;
+  if (CpsrBufferMap(native, &data)) {
+    CpsrBufferDestroy(native);
+    return true;
+  }
+  
+  buffer->buffer = native;
+  buffer->data = (uint8_t *)data;
+  buffer->size = size;
+  return false;
+}
+
+// Moves to the next buffer of the frame that holds size bytes, growing or replacing buffers as needed.
+static inline SnlfUploadRingBuffer *SnlfUploadRingNextBuffer(SnlfUploadRing *ring, SnlfUploadRingFrame *frame, size_t size) {
+  const size_t bufferSize = size > SNLF_UPLOAD_RING_BUFFER_SIZE ? size : SNLF_UPLOAD_RING_BUFFER_SIZE;
+  if (frame->bufferIndex < frame->bufferCount) {
+    SnlfUploadRingBuffer *buffer = frame->buffers + frame->bufferIndex;
+    if (buffer->size >= size) {
+      return buffer;
+    }
+  
+    // Too small for an oversized allocation
+    SnlfUploadRingBuffer replacement;
+    if (SnlfUploadRingCreateBuffer(ring->device, bufferSize, &replacement)) {
+      return NULL;
+    }
+    CpsrBufferDestroy(buffer->buffer);
+    *buffer = replacement;
+    return buffer;
+  }
+  
+  if (frame->bufferCount == frame->bufferCapacity) {
+    const size_t capacity = frame->bufferCapacity ? 2 * frame->bufferCapacity : 2;
+    SnlfUploadRingBuffer *buffers = (SnlfUploadRingBuffer *)realloc(frame->buffers, sizeof(SnlfUploadRingBuffer) * capacity);
+    if (!buffers) {
+      return NULL;
+    }
+    frame->buffers = buffers;
+    frame->bufferCapacity = capacity;
+  }
+  
+  SnlfUploadRingBuffer *buffer = frame->buffers + frame->bufferCount;
+  if (SnlfUploadRingCreateBuffer(ring->device, bufferSize, buffer)) {
+    return NULL;
+  }
+  ++frame->bufferCount;
+  return buffer;
+}
+
+bool SnlfUploadRingAllocate(SnlfUploadRing *ring, size_t size, SnlfGraphicsConstants *constants) {
+  assert(ring);
+  assert(size);
+  assert(constants);
+  
+  SnlfUploadRingFrame *frame = ring->frames + ring->frameIndex;
+  SnlfUploadRingBuffer *buffer = frame->bufferIndex < frame->bufferCount ? frame->buffers + frame->bufferIndex : NULL;
+  if (!buffer || frame->offset + size > buffer->size) {
+    if (buffer) {
+      ++frame->bufferIndex;
+      frame->offset = 0;
+    }
+  
+    buffer = SnlfUploadRingNextBuffer(ring, frame, size);
+    if (!buffer) {
+      SnlfOutOfMemoryError();
+      return true;
+    }
+  }
+  
+  constants->buffer = buffer->buffer;
+  constants->offset = (uint32_t)frame->offset;
+  constants->data = buffer->data + frame->offset;
+  frame->offset = SNLF_UPLOAD_RING_ALIGN(frame->offset + size);
+  return false;
+}
+
+bool SnlfGraphicsContextAllocateConstants(const SnlfGraphicsContext *context, size_t size, SnlfGraphicsConstants *constants) {
+  assert(context);
+  
+  if (!context->uploadRing) {
+    return true;
+  }
+  return SnlfUploadRingAllocate(context->uploadRing, size, constants);
+}
@@ -51,6 +51,24 @@ vertex VertexOut DrawSimpleVS(constant SimpleVertexIn *vertIn,
   return vertOut;
 }
 
+// ---
+// DrawSimpleInstancedVS
+// ---
+vertex VertexOut DrawSimpleInstancedVS(constant SimpleVertexIn *vertIn,
+                                       constant Uniforms *uniforms [[buffer(16)]],
+                                       uint vid [[vertex_id]],
+                                       uint iid [[instance_id]]) {
+  const float2 position = vertIn[vid].position;
+
+  VertexOut vertOut;
+  vertOut.position = uniforms[iid].transform * float4(position, 1.0, 1.0);
+
+  float2 uv = 0.5 * (position + 1.0);
+  uv.y = 1.0 - uv.y;
+  vertOut.textureCoordinate = uv;
+  return vertOut;
+}
+
 // ---
 // DrawHalfPS
 // ---
@@ -0,0 +1,82 @@
+#include "../SnlfGraphics+Private.h"
+
+#include <compositor/vector/matrix4x4_t.h>
+
+typedef struct {
+  matrix4x4_t transform;
+} Uniforms;
+
+// ---
+// DrawVS
+// ---
+typedef struct {
+  float position[2];
+  float texCoord[2];
+} VertexIn;
+
+static void DrawVS(const CpsrNativeShaderResources *resources,
+                   uint32_t vertexId,
+                   uint32_t instanceId,
+                   CpsrNativeVertexOut *vertexOut) {
+  const VertexIn *vertIn = (const VertexIn *)resources->vertexBuffers[0] + vertexId;
+  const Uniforms *uniforms = (const Uniforms *)resources->constantBuffers[0];
+
+  const float32x4_t position = float32x4_initv(vertIn->position[0], vertIn->position[1], 1.F, 1.F);
+  vertexOut->position = matrix4x4_transform(position, uniforms->transform);
+  vertexOut->varyings[0] = float32x4_initv(vertIn->texCoord[0], vertIn->texCoord[1], 0.F, 0.F);
+}
+
+// ---
+// DrawSimpleVS
+// ---
+static void DrawSimpleVS(const CpsrNativeShaderResources *resources,
+                         uint32_t vertexId,
+                         uint32_t instanceId,
+                         CpsrNativeVertexOut *vertexOut) {
+  const float *position = (const float *)resources->vertexBuffers[0] + 2 * vertexId;
+  const Uniforms *uniforms = (const Uniforms *)resources->constantBuffers[0];
+
+  vertexOut->position = matrix4x4_transform(float32x4_initv(position[0], position[1], 1.F, 1.F), uniforms->transform);
+
+  const float u = .5F * (position[0] + 1.F);
+  const float v = 1.F - .5F * (position[1] + 1.F);
+  vertexOut->varyings[0] = float32x4_initv(u, v, 0.F, 0.F);
+}
+
+// ---
+// DrawSimpleInstancedVS
+// ---
+static void DrawSimpleInstancedVS(const CpsrNativeShaderResources *resources,
+                                  uint32_t vertexId,
+                                  uint32_t instanceId,
+                                  CpsrNativeVertexOut *vertexOut) {
+  const float *position = (const float *)resources->vertexBuffers[0] + 2 * vertexId;
+  const Uniforms *uniforms = (const Uniforms *)resources->constantBuffers[0] + instanceId;
+
+  vertexOut->position = matrix4x4_transform(float32x4_initv(position[0], position[1], 1.F, 1.F), uniforms->transform);
+
+  const float u = .5F * (position[0] + 1.F);
+  const float v = 1.F - .5F * (position[1] + 1.F);
+  vertexOut->varyings[0] = float32x4_initv(u, v, 0.F, 0.F);
+}
+
+// ---
+// DrawHalfPS / DrawSinglePS
+// ---
+static float32x4_t DrawPS(const CpsrNativeShaderResources *resources, const CpsrNativeVertexOut *pixelIn) {
+  simd_alignas(16) float uv[4];
+  float32x4_getxp(pixelIn->varyings[0], uv + 0);
+  float32x4_getyp(pixelIn->varyings[0], uv + 1);
+  return CpsrTexture2DSample(resources->textures[0], uv[0], uv[1]);
+}
+
+// clang-format off
+const CpsrNativeShaderEntry kSnlfDrawShaders[] = {
+  { "DrawVS",                CPSR_NATIVE_SHADER_VERTEX, 1, { .vertex = DrawVS } },
+  { "DrawSimpleVS",          CPSR_NATIVE_SHADER_VERTEX, 1, { .vertex = DrawSimpleVS } },
+  { "DrawSimpleInstancedVS", CPSR_NATIVE_SHADER_VERTEX, 1, { .vertex = DrawSimpleInstancedVS } },
+  { "DrawHalfPS",            CPSR_NATIVE_SHADER_PIXEL,  1, { .pixel = DrawPS } },
+  { "DrawSinglePS",          CPSR_NATIVE_SHADER_PIXEL,  1, { .pixel = DrawPS } },
+};
+// clang-format on
+const size_t kSnlfDrawShadersCount = sizeof(kSnlfDrawShaders) / sizeof(CpsrNativeShaderEntry);
@@ -0,0 +1,48 @@
+#include "../SnlfGraphics+Private.h"
+
+#include <compositor/vector/matrix4x4_t.h>
+
+typedef struct {
+  matrix4x4_t transform;
+  float32x4_t color;
+} Uniforms;
+
+// ---
+// DrawColor
+// ---
+static void DrawColorVS(const CpsrNativeShaderResources *resources,
+                        uint32_t vertexId,
+                        uint32_t instanceId,
+                        CpsrNativeVertexOut *vertexOut) {
+  const float *position = (const float *)resources->vertexBuffers[0] + 2 * vertexId;
+  const Uniforms *uniforms = (const Uniforms *)resources->constantBuffers[0];
+
+  vertexOut->position = matrix4x4_transform(float32x4_initv(position[0], position[1], 1.F, 1.F), uniforms->transform);
+  vertexOut->varyings[0] = uniforms->color;
+}
+
+static void DrawColorInstancedVS(const CpsrNativeShaderResources *resources,
+                                 uint32_t vertexId,
+                                 uint32_t instanceId,
+                                 CpsrNativeVertexOut *vertexOut) {
+  const float *position = (const float *)resources->vertexBuffers[0] + 2 * vertexId;
+  const Uniforms *uniforms = (const Uniforms *)resources->constantBuffers[0];
+  const int16_t *offset = (const int16_t *)resources->constantBuffers[1] + 2 * instanceId;
+
+  const float32x4_t instancePosition = float32x4_initv(position[0] + offset[0], position[1] + offset[1], 1.F, 1.F);
+  vertexOut->position = matrix4x4_transform(instancePosition, uniforms->transform);
+  vertexOut->varyings[0] = uniforms->color;
+}
+
+static float32x4_t DrawColorPS(const CpsrNativeShaderResources *resources, const CpsrNativeVertexOut *pixelIn) {
+  return pixelIn->varyings[0];
+}
+
+// clang-format off
+const CpsrNativeShaderEntry kSnlfDrawColorShaders[] = {
+  { "DrawColorVS",          CPSR_NATIVE_SHADER_VERTEX, 1, { .vertex = DrawColorVS } },
+  { "DrawColorInstancedVS", CPSR_NATIVE_SHADER_VERTEX, 1, { .vertex = DrawColorInstancedVS } },
+  { "DrawColorPS",          CPSR_NATIVE_SHADER_PIXEL,  1, { .pixel = DrawColorPS } },
+};
+// clang-format on
+const size_t kSnlfDrawColorShadersCount = sizeof(kSnlfDrawColorShaders) / sizeof(CpsrNativeShaderEntry);
@@ -0,0 +1,45 @@
+#include "../SnlfGraphics+Private.h"
+
+#define SNLF_POSTERIZATION_BLOCK_SIZE 64
+
+typedef struct {
+  float strength;
+} Uniforms;
+
+static void posterization(const CpsrNativeShaderResources *resources,
+                          uint32_t x,
+                          uint32_t y,
+                          uint32_t z,
+                          uint32_t count) {
+  const CpsrTexture2D *inTexture = resources->textures[0];
+  const CpsrTexture2D *outTexture = resources->writeTextures[0];
+  const CpsrSizeU32 size = CpsrTexture2DGetSize(outTexture);
+  if (x >= size.width || y >= size.height) {
+    return;
+  }
+  if (count > size.width - x) {
+    count = size.width - x;
+  }
+
+  const Uniforms *uniforms = (const Uniforms *)resources->constantBuffers[0];
+  const float32x4_t strength = float32x4_inits(uniforms->strength);
+
+  simd_alignas(16) float32x4_t colors[SNLF_POSTERIZATION_BLOCK_SIZE];
+  for (uint32_t offset = 0; offset < count; offset += SNLF_POSTERIZATION_BLOCK_SIZE) {
+    const uint32_t blockSize = count - offset < SNLF_POSTERIZATION_BLOCK_SIZE ? count - offset : SNLF_POSTERIZATION_BLOCK_SIZE;
+    CpsrTexture2DReadRow(inTexture, x + offset, y, blockSize, colors);
+    for (uint32_t i = 0; i < blockSize; ++i) {
+      const float32x4_t inColor = colors[i];
+      const float32x4_t outColor = float32x4_div(float32x4_ceil(float32x4_mul(strength, inColor)), strength);
+      colors[i] = float32x4_setw(outColor, float32x4_getw(inColor));
+    }
+    CpsrTexture2DStoreRow(outTexture, x + offset, y, blockSize, colors);
+  }
+}
+
+// clang-format off
+const CpsrNativeShaderEntry kSnlfPosterizationShaders[] = {
+  { "posterization", CPSR_NATIVE_SHADER_COMPUTE_ROW, 0, { .computeRow = posterization } },
+};
+// clang-format on
+const size_t kSnlfPosterizationShadersCount = sizeof(kSnlfPosterizationShaders) / sizeof(CpsrNativeShaderEntry);
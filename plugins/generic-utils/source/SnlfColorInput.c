@@ -1,24 +1,61 @@
 #include "SnlfModule.h"
 
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <compositor/CpsrNativeShader.h>
+
+extern const CpsrNativeShaderEntry kColorInputShaders[];
+extern const size_t kColorInputShadersCount;
+#endif
+
 struct SnlfColorInputUniforms {
   matrix4x4_t transform;
   float32x4_t color;
 };
 
 struct SnlfColorInputContext {
-  CpsrGraphicsPipelineState *pipelineState;
+  const SnlfGraphicsContext *graphicsContext;
+  CpsrShaderLibrary *library;
+  CpsrShaderFunction *vertexColorInput;
+  CpsrGraphicsPipelineState *pipelineState;  // Shared through the pipeline cache
   CpsrBuffer *vertexBuffer;
-  CpsrBuffer *uniformsBuffer;
+  struct SnlfColorInputUniforms uniforms;
 };
 
+static void SnlfColorInputUninit(intptr_t _context);
+
 static intptr_t SnlfColorInputInit(const SnlfGraphicsContext *graphicsContext) {
+  struct SnlfColorInputContext *context = (struct SnlfColorInputContext *)calloc(1, sizeof(struct SnlfColorInputContext));
+  if (!context) {
+    SnlfOutOfMemoryError();
+    return NULL;
+  }
+  context->graphicsContext = graphicsContext;
+  
   const CpsrDevice *device = SnlfGraphicsContextGetDevice(graphicsContext);
   CpsrShaderLibrary *library = CpsrShaderLibraryCreate(device, "./Plugins/libgeneric/");
+  if (!library) {
+    SnlfErrorLog("Create shader library failed.");
+    SnlfColorInputUninit((intptr_t)context);
+    return NULL;
+  }
+  context->library = library;
+  
   CpsrShaderFunction *vertexColorInput = CpsrShaderFunctionCreateFromLibrary(library, "vertexColorInput");
-  CpsrGraphicsPipelineState *pipelineState = CpsrGraphicsPipelineStateCreate(device);
-  CpsrGraphicsPipelineStateSetPrimitiveTopologyType(pipelineState, CPSR_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE);
-  CpsrGraphicsPipelineStateSetVertexFunction(pipelineState, vertexColorInput);
-  CpsrGraphicsPipelineStateSetPixelFunction(pipelineState, SnlfGraphicsContextGetShaderFunction(graphicsContext, SNLF_SHADER_PIXEL_DRAW_COLOR));
+  if (!vertexColorInput) {
+    SnlfErrorLog("Create shader function \"vertexColorInput\" failed.");
+    SnlfColorInputUninit((intptr_t)context);
+    return NULL;
+  }
+  context->vertexColorInput = vertexColorInput;
+  
+  SnlfPipelineStateDescriptor descriptor;
+  SnlfPipelineStateDescriptorInit(&descriptor, vertexColorInput, SnlfGraphicsContextGetShaderFunction(graphicsContext, SNLF_SHADER_PIXEL_DRAW_COLOR));
+  CpsrGraphicsPipelineState *pipelineState = SnlfGraphicsContextAcquirePipelineState(graphicsContext, &descriptor);
+  if (!pipelineState) {
+    SnlfColorInputUninit((intptr_t)context);
+    return NULL;
+  }
+  context->pipelineState = pipelineState;
   
   float data[] = {
   // x   y
@@ -30,41 +67,34 @@ static intptr_t SnlfColorInputInit(const SnlfGraphicsContext *graphicsContext) {
   CpsrBuffer *vertexBuffer = CpsrBufferCreateFromData(device, data, sizeof(data), CPSR_VERTEX_BUFFER);
   if (!vertexBuffer) {
     SnlfOutOfMemoryError();
+    SnlfColorInputUninit((intptr_t)context);
     return NULL;
   }
-  
-  CpsrBuffer *uniformsBuffer = CpsrBufferCreateFromSize(device, sizeof(struct SnlfColorInputUniforms), CPSR_HEAP_TYPE_UPLOAD, CPSR_CONSTANT_BUFFER);
-  if (!uniformsBuffer) {
-    SnlfOutOfMemoryError();
-    CpsrBufferDestroy(vertexBuffer);
-    return NULL;
-  }
-  
-  struct SnlfColorInputContext *context = (struct SnlfColorInputContext *)malloc(sizeof(struct SnlfColorInputContext));
-  if (!context) {
-    SnlfOutOfMemoryError();
-    CpsrBufferDestroy(vertexBuffer);
-    CpsrBufferDestroy(uniformsBuffer);
-    return NULL;
-  }
-  
-  context->pipelineState = pipelineState;
   context->vertexBuffer = vertexBuffer;
-  context->uniformsBuffer = uniformsBuffer;
   return context;
 }
 
 static void SnlfColorInputUninit(intptr_t _context) {
   struct SnlfColorInputContext *context = (struct SnlfColorInputContext *)_context;
-  CpsrBufferDestroy(context->vertexBuffer);
-  CpsrBufferDestroy(context->uniformsBuffer);
-  CpsrGraphicsPipelineStateDestroy(context->pipelineState);
+  if (context->vertexBuffer) {
+    CpsrBufferDestroy(context->vertexBuffer);
+  }
+  if (context->pipelineState) {
+    SnlfGraphicsContextReleasePipelineState(context->graphicsContext, context->pipelineState);
+  }
+  if (context->vertexColorInput) {
+    CpsrShaderFunctionDestroy(context->vertexColorInput);
+  }
+  if (context->library) {
+    CpsrShaderLibraryDestroy(context->library);
+  }
   free(context);
 }
 
 static void SnlfColorInputUpdate(intptr_t _context, SnlfGraphicsUpdateParams params) {
   struct SnlfColorInputContext *context = (struct SnlfColorInputContext *)_context;
   
+  // Uniforms are uploaded as a draw item instance when drawn
   struct SnlfColorInputUniforms uniforms;
   uniforms.transform = params.world;
   switch ((params.timestamp / 1000000000) % 6) {
@@ -92,24 +122,38 @@ static void SnlfColorInputUpdate(intptr_t _context, SnlfGraphicsUpdateParams par
     uniforms.color = float32x4_initv(1.F, 0.F, 1.F, 1.F);
     break;
   }
-  CpsrBufferWrite(context->uniformsBuffer, &uniforms);
+  context->uniforms = uniforms;
 }
 
 static void SnlfColorInputDraw(intptr_t _context, SnlfGraphicsDrawParams params) {
   struct SnlfColorInputContext *context = (struct SnlfColorInputContext *)_context;
   
-  CpsrSetRenderTargetPixelFormatFromTexture2D(context->pipelineState, 0, params.renderTarget);
+  SnlfGraphicsDrawItem item;
+  item.pipelineState = context->pipelineState;
+  item.instance = &context->uniforms;
+  item.instanceSize = sizeof(struct SnlfColorInputUniforms);
+  item.texture = NULL;
+  if (!SnlfGraphicsContextSubmitDrawItem(params.context, params.renderTarget, &item)) {
+    return;
+  }
   
-  CpsrGraphicsContext *graphicsContext = SnlfGraphicsContextCreateGraphicsContext(params.context);
-  CpsrGraphicsContextSetRenderTargetFromTexture2D(graphicsContext, params.renderTarget);
-  if (!CpsrGraphicsContextSetPipelineState(graphicsContext, context->pipelineState)) {
-    CpsrGraphicsContextSetVertexBuffer(graphicsContext, 0, context->vertexBuffer);
-    CpsrGraphicsContextSetConstantBuffer(graphicsContext, 0, context->uniformsBuffer);
-    CpsrGraphicsContextSetPrimitiveTopology(graphicsContext, CPSR_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
-    CpsrGraphicsContextDraw(graphicsContext, 0, 6);
-    CpsrGraphicsContextClose(graphicsContext);
+  SnlfGraphicsConstants uniforms;
+  if (SnlfGraphicsContextAllocateConstants(params.context, sizeof(struct SnlfColorInputUniforms), &uniforms)) {
+    return;
   }
-  CpsrGraphicsContextDestroy(graphicsContext);
+  memcpy(uniforms.data, &context->uniforms, sizeof(struct SnlfColorInputUniforms));
+  
+  SnlfRenderPass *renderPass = params.renderPass;
+  if (!SnlfRenderPassSetPipelineState(renderPass, context->pipelineState)) {
+    SnlfRenderPassSetVertexBuffer(renderPass, 0, context->vertexBuffer);
+    SnlfRenderPassSetConstantBufferWithOffset(renderPass, 0, uniforms.buffer, uniforms.offset);
+    SnlfRenderPassSetPrimitiveTopology(renderPass, CPSR_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
+    SnlfRenderPassDraw(renderPass, 0, 4);
+  }
+}
+
+static bool SnlfColorInputIsOpaque(intptr_t _context) {
+  return true;
 }
 
 SnlfGraphicsGenerator colorInputGenerator = {
@@ -119,6 +163,7 @@ SnlfGraphicsGenerator colorInputGenerator = {
   .uninit        = SnlfColorInputUninit,
   .update        = SnlfColorInputUpdate,
   .draw          = SnlfColorInputDraw,
+  .isOpaque      = SnlfColorInputIsOpaque,
 };
 
 void SnlfModuleGetInfo(SnlfModuleDescriptor *descriptor) {
@@ -134,9 +179,15 @@ bool SnlfModuleCanLoad(const SnlfLibraryDescriptor *libraryDescriptor) {
 }
 
 intptr_t SnlfModuleLoad(SnlfCoreRef core) {
+#if !defined(_WIN32) && !defined(__APPLE__)
+  CpsrShaderLibraryRegisterNative("./Plugins/libgeneric/", kColorInputShaders, kColorInputShadersCount);
+#endif
   return (intptr_t)SnlfGraphicsGeneratorRegister(core, &colorInputGenerator);
 }
 
 bool SnlfModuleUnload(intptr_t context) {
+#if !defined(_WIN32) && !defined(__APPLE__)
+  CpsrShaderLibraryUnregisterNative(kColorInputShaders);
+#endif
   return false;
 }
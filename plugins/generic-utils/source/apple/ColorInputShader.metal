@@ -13,8 +13,10 @@ struct Uniforms {
 };
 
 vertex VertexOut vertexColorInput(constant float2 *position,
-                                  constant Uniforms& uniforms [[buffer(16)]],
-                                  uint vid [[vertex_id]]) {
+                                  constant Uniforms *instances [[buffer(16)]],
+                                  uint vid [[vertex_id]],
+                                  uint iid [[instance_id]]) {
+  constant Uniforms& uniforms = instances[iid];
   VertexOut vertOut;
   vertOut.position = uniforms.transform * float4(position[vid], 1.0, 1.0);
   vertOut.color = uniforms.color; //0.5 * (half4(position[vid].x, 0, position[vid].y, 1) + 1);
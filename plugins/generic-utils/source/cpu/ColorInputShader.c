@@ -0,0 +1,26 @@
+#include <compositor/CpsrNativeShader.h>
+
+#include <compositor/vector/matrix4x4_t.h>
+
+typedef struct {
+  matrix4x4_t transform;
+  float32x4_t color;
+} Uniforms;
+
+static void vertexColorInput(const CpsrNativeShaderResources *resources,
+                             uint32_t vertexId,
+                             uint32_t instanceId,
+                             CpsrNativeVertexOut *vertexOut) {
+  const float *position = (const float *)resources->vertexBuffers[0] + 2 * vertexId;
+  const Uniforms *uniforms = (const Uniforms *)resources->constantBuffers[0] + instanceId;
+
+  vertexOut->position = matrix4x4_transform(float32x4_initv(position[0], position[1], 1.F, 1.F), uniforms->transform);
+  vertexOut->varyings[0] = uniforms->color;
+}
+
+// clang-format off
+const CpsrNativeShaderEntry kColorInputShaders[] = {
+  { "vertexColorInput", CPSR_NATIVE_SHADER_VERTEX, 1, { .vertex = vertexColorInput } },
+};
+// clang-format on
+const size_t kColorInputShadersCount = sizeof(kColorInputShaders) / sizeof(CpsrNativeShaderEntry);
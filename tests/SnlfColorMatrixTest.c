@@ -0,0 +1,160 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "SnlfColorManagement.h"
+#include "SnlfGraphicsFrame.h"
+
+// Checks the color matrices against their closed forms:
+//   coefficients: R'G'B' colors encoded to 16-bit Y'CbCr codes with Kr and Kb, in full and limited range, must
+//                 come back from the converter matrix as they were
+//   primaries:    the BT.2020 to BT.709 transform and its inverse must match the matrices of ITU-R BT.2087, and
+//                 multiply to the identity
+#define SNLF_TEST_CODE_TOLERANCE      1e-4
+#define SNLF_TEST_PRIMARIES_TOLERANCE 1e-4
+
+typedef struct {
+  SnlfMatrixCoefficientsType type;
+  const char *name;
+  double kr, kb;
+} SnlfTestCoefficients;
+
+static const SnlfTestCoefficients kCoefficients[] = {
+  { SNLF_CM_BT709,     "BT.709",     0.2126, 0.0722 },
+  { SNLF_CM_BT2020NCL, "BT.2020",    0.2627, 0.0593 },
+  { SNLF_CM_BT470BG,   "BT.601 625", 0.299,  0.114  },
+  { SNLF_CM_SMPTE170M, "BT.601 525", 0.299,  0.114  },
+};
+
+// Black, white, gray, the primaries, the secondaries and an arbitrary color
+static const double kColors[][3] = {
+  { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 }, { 0.5, 0.5, 0.5 },
+  { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 },
+  { 0.0, 1.0, 1.0 }, { 1.0, 0.0, 1.0 }, { 1.0, 1.0, 0.0 },
+  { 0.8, 0.3, 0.1 },
+};
+
+// ITU-R BT.2087-0, rounded to four decimals
+static const double kBT2020ToBT709[9] = {
+   1.6605, -0.5876, -0.0728,
+  -0.1246,  1.1329, -0.0083,
+  -0.0182, -0.1006,  1.1187,
+};
+
+static const double kBT709ToBT2020[9] = {
+  0.6274, 0.3293, 0.0433,
+  0.0691, 0.9195, 0.0114,
+  0.0164, 0.0880, 0.8956,
+};
+
+static inline double SnlfTestQuantize(double value, SnlfColorRange range) {
+  return round(65535.0 * (range.black + value * (range.peak - range.black)));
+}
+
+static int SnlfTestCoefficientsMatrix(const SnlfTestCoefficients *coefficients, bool limited) {
+  SnlfYUVFrameDescriptor descriptor;
+  memset(&descriptor, 0, sizeof(SnlfYUVFrameDescriptor));
+  if (limited) {
+    descriptor.yRange.black = 16.F / 255.F;
+    descriptor.yRange.peak = 235.F / 255.F;
+    descriptor.uvRange.black = 16.F / 255.F;
+    descriptor.uvRange.peak = 240.F / 255.F;
+  } else {
+    descriptor.yRange.peak = 1.F;
+    descriptor.uvRange.peak = 1.F;
+  }
+  descriptor.coefficients = coefficients->type;
+  
+  SnlfFrameConverter converter;
+  if (SnlfFrameConverterInit(&converter, SNLF_GRAPHICS_FRAME_P016, &descriptor)) {
+    printf("%s: not supported\n", coefficients->name);
+    return 1;
+  }
+  
+  const double kr = coefficients->kr, kb = coefficients->kb, kg = 1.0 - kr - kb;
+  double maxError = 0.0;
+  for (size_t i = 0; i < sizeof(kColors) / sizeof(kColors[0]); ++i) {
+    const double *rgb = kColors[i];
+    const double y = kr * rgb[0] + kg * rgb[1] + kb * rgb[2];
+    const double codes[3] = {
+      SnlfTestQuantize(y, descriptor.yRange),
+      SnlfTestQuantize((rgb[2] - y) / (2.0 * (1.0 - kb)) + 0.5, descriptor.uvRange),
+      SnlfTestQuantize((rgb[0] - y) / (2.0 * (1.0 - kr)) + 0.5, descriptor.uvRange),
+    };
+    for (size_t j = 0; j < 3; ++j) {
+      const float *row = converter.matrix + 4 * j;
+      const double value = row[0] * codes[0] + row[1] * codes[1] + row[2] * codes[2] + row[3];
+      maxError = fmax(maxError, fabs(value - rgb[j]));
+    }
+  }
+  
+  printf("%s, %s range: %.3g\n", coefficients->name, limited ? "limited" : "full", maxError);
+  return maxError > SNLF_TEST_CODE_TOLERANCE ? 1 : 0;
+}
+
+static double SnlfTestMatrixError(const float actual[9], const double expected[9]) {
+  double maxError = 0.0;
+  for (size_t i = 0; i < 9; ++i) {
+    maxError = fmax(maxError, fabs(actual[i] - expected[i]));
+  }
+  return maxError;
+}
+
+static int SnlfTestPrimaries(void) {
+  SnlfColorPrimaries bt709, bt2020;
+  SnlfGetColorPrimaries(SNLF_CP_BT709, &bt709);
+  SnlfGetColorPrimaries(SNLF_CP_BT2020, &bt2020);
+  
+  SnlfColorTransform forward, inverse, identity;
+  if (SnlfColorTransformInit(&forward, &bt2020, &bt709)
+    || SnlfColorTransformInit(&inverse, &bt709, &bt2020)
+    || SnlfColorTransformInit(&identity, &bt709, &bt709)) {
+    printf("Primaries: degenerate\n");
+    return 1;
+  }
+  
+  int failures = 0;
+  const double forwardError = SnlfTestMatrixError(forward.matrix, kBT2020ToBT709);
+  const double inverseError = SnlfTestMatrixError(inverse.matrix, kBT709ToBT2020);
+  printf("BT.2020 to BT.709: %.3g, BT.709 to BT.2020: %.3g\n", forwardError, inverseError);
+  if (forwardError > SNLF_TEST_PRIMARIES_TOLERANCE || inverseError > SNLF_TEST_PRIMARIES_TOLERANCE) {
+    ++failures;
+  }
+  
+  // Both share D65, so the round trip and white are exact up to float precision
+  double roundTripError = 0.0, whiteError = 0.0;
+  for (size_t i = 0; i < 3; ++i) {
+    double white = 0.0;
+    for (size_t j = 0; j < 3; ++j) {
+      double product = 0.0;
+      for (size_t k = 0; k < 3; ++k) {
+        product += (double)forward.matrix[3 * i + k] * inverse.matrix[3 * k + j];
+      }
+      roundTripError = fmax(roundTripError, fabs(product - (i == j ? 1.0 : 0.0)));
+      white += forward.matrix[3 * i + j];
+    }
+    whiteError = fmax(whiteError, fabs(white - 1.0));
+  }
+  printf("Round trip: %.3g, white: %.3g\n", roundTripError, whiteError);
+  if (roundTripError > 1e-6 || whiteError > 1e-6) {
+    ++failures;
+  }
+  
+  if (!identity.identity) {
+    printf("BT.709 to BT.709: not the identity\n");
+    ++failures;
+  }
+  return failures;
+}
+
+int main(int argc, char *argv[]) {
+  int failures = 0;
+  for (size_t i = 0; i < sizeof(kCoefficients) / sizeof(SnlfTestCoefficients); ++i) {
+    failures += SnlfTestCoefficientsMatrix(&kCoefficients[i], false);
+    failures += SnlfTestCoefficientsMatrix(&kCoefficients[i], true);
+  }
+  failures += SnlfTestPrimaries();
+  
+  printf("%d failures\n", failures);
+  return failures ? 1 : 0;
+}
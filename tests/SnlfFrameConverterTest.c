@@ -0,0 +1,116 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SnlfGraphicsFrame.h"
+
+// Compares the SIMD conversion of every supported layout with the scalar reference on random frames.
+// Widths cover whole blocks, partial blocks and single pixels; the results must match within one unit in the
+// last place of the half-float output.
+#define SNLF_TEST_HEIGHT 5
+
+static const SnlfGraphicsFrameFormat kFormats[] = {
+  SNLF_GRAPHICS_FRAME_RGBX4, SNLF_GRAPHICS_FRAME_RGBA4, SNLF_GRAPHICS_FRAME_XBGR4, SNLF_GRAPHICS_FRAME_ABGR4,
+  SNLF_GRAPHICS_FRAME_RGB5X1, SNLF_GRAPHICS_FRAME_RGB5A1, SNLF_GRAPHICS_FRAME_BGR5X1, SNLF_GRAPHICS_FRAME_BGR5A1,
+  SNLF_GRAPHICS_FRAME_X1RGB5, SNLF_GRAPHICS_FRAME_A1RGB5, SNLF_GRAPHICS_FRAME_X1BGR5, SNLF_GRAPHICS_FRAME_A1BGR5,
+  SNLF_GRAPHICS_FRAME_R5G6B5,
+  SNLF_GRAPHICS_FRAME_RGBX8, SNLF_GRAPHICS_FRAME_RGBA8, SNLF_GRAPHICS_FRAME_BGRX8, SNLF_GRAPHICS_FRAME_BGRA8,
+  SNLF_GRAPHICS_FRAME_RGB10X2, SNLF_GRAPHICS_FRAME_RGB10A2, SNLF_GRAPHICS_FRAME_BGR10X2, SNLF_GRAPHICS_FRAME_BGR10A2,
+  SNLF_GRAPHICS_FRAME_X2RGB10, SNLF_GRAPHICS_FRAME_A2RGB10, SNLF_GRAPHICS_FRAME_X2BGR10, SNLF_GRAPHICS_FRAME_A2BGR10,
+  SNLF_GRAPHICS_FRAME_RGBX16, SNLF_GRAPHICS_FRAME_RGBA16,
+  SNLF_GRAPHICS_FRAME_NV11,
+  SNLF_GRAPHICS_FRAME_NV12, SNLF_GRAPHICS_FRAME_NV21, SNLF_GRAPHICS_FRAME_I420, SNLF_GRAPHICS_FRAME_YV12,
+  SNLF_GRAPHICS_FRAME_IMC2, SNLF_GRAPHICS_FRAME_IMC3, SNLF_GRAPHICS_FRAME_IMC4,
+  SNLF_GRAPHICS_FRAME_I422, SNLF_GRAPHICS_FRAME_UYVY, SNLF_GRAPHICS_FRAME_VYUY, SNLF_GRAPHICS_FRAME_YUYV,
+  SNLF_GRAPHICS_FRAME_YVYU,
+  SNLF_GRAPHICS_FRAME_I444, SNLF_GRAPHICS_FRAME_AYUV,
+  SNLF_GRAPHICS_FRAME_P010, SNLF_GRAPHICS_FRAME_P210, SNLF_GRAPHICS_FRAME_Y210, SNLF_GRAPHICS_FRAME_Y410,
+  SNLF_GRAPHICS_FRAME_V210,
+  SNLF_GRAPHICS_FRAME_P012, SNLF_GRAPHICS_FRAME_P212, SNLF_GRAPHICS_FRAME_Y212, SNLF_GRAPHICS_FRAME_Y412,
+  SNLF_GRAPHICS_FRAME_P016, SNLF_GRAPHICS_FRAME_P216, SNLF_GRAPHICS_FRAME_Y216, SNLF_GRAPHICS_FRAME_Y416,
+};
+
+static const uint32_t kWidths[] = { 1, 2, 3, 5, 6, 12, 15, 16, 17, 31, 32, 33, 48, 61, 64, 79 };
+
+static inline float SnlfTestHalfToFloat(uint16_t value) {
+  const int exponent = (value >> 10) & 0x1F;
+  const int mantissa = value & 0x3FF;
+  const float magnitude = exponent ? ldexpf((float)(mantissa | 0x400), exponent - 25) : ldexpf((float)mantissa, -24);
+  return value & 0x8000 ? -magnitude : magnitude;
+}
+
+// Adjacent half floats, or both zero regardless of their sign.
+static inline bool SnlfTestHalfNear(uint16_t a, uint16_t b) {
+  if ((a & 0x7FFF) == 0 && (b & 0x7FFF) == 0) {
+    return true;
+  }
+  return (a & 0x8000) == (b & 0x8000) && abs((int)(a & 0x7FFF) - (int)(b & 0x7FFF)) <= 1;
+}
+
+static int SnlfTestConvert(SnlfGraphicsFrameFormat format, const SnlfYUVFrameDescriptor *descriptor, uint32_t width) {
+  SnlfFrameConverter converter;
+  if (SnlfFrameConverterInit(&converter, format, SnlfGraphicsFrameFormatIsYUV(format) ? descriptor : NULL)) {
+    printf("%.4s: not supported\n", (const char *)&format);
+    return 1;
+  }
+  
+  // Every plane is large and padded enough for any layout at this width
+  SnlfFrameConverterSource source;
+  source.size.width = width;
+  source.size.height = SNLF_TEST_HEIGHT;
+  uint8_t *planes[3];
+  for (size_t i = 0; i < 3; ++i) {
+    source.bytesPerRow[i] = 8 * width + 64;
+    planes[i] = (uint8_t *)malloc(source.bytesPerRow[i] * SNLF_TEST_HEIGHT);
+    for (size_t j = 0; j < source.bytesPerRow[i] * SNLF_TEST_HEIGHT; ++j) {
+      planes[i][j] = (uint8_t)rand();
+    }
+    source.planes[i] = planes[i];
+  }
+  
+  const size_t bytesPerRow = 4 * sizeof(uint16_t) * width;
+  uint16_t *actual = (uint16_t *)calloc(SNLF_TEST_HEIGHT, bytesPerRow);
+  uint16_t *expected = (uint16_t *)calloc(SNLF_TEST_HEIGHT, bytesPerRow);
+  SnlfFrameConverterConvert(&converter, &source, 0, SNLF_TEST_HEIGHT, actual, bytesPerRow);
+  SnlfFrameConverterConvertReference(&converter, &source, 0, SNLF_TEST_HEIGHT, expected, bytesPerRow);
+  
+  int failures = 0;
+  for (size_t i = 0; i < 4 * width * SNLF_TEST_HEIGHT; ++i) {
+    if (!SnlfTestHalfNear(actual[i], expected[i])) {
+      if (!failures) {
+        printf("%.4s: width %u, pixel %zu, component %zu: %f (SIMD) != %f (reference)\n",
+               (const char *)&format, width, i / 4, i % 4, SnlfTestHalfToFloat(actual[i]), SnlfTestHalfToFloat(expected[i]));
+      }
+      ++failures;
+    }
+  }
+  
+  free(expected);
+  free(actual);
+  for (size_t i = 0; i < 3; ++i) {
+    free(planes[i]);
+  }
+  return failures;
+}
+
+int main(int argc, char *argv[]) {
+  SnlfYUVFrameDescriptor descriptor;
+  memset(&descriptor, 0, sizeof(SnlfYUVFrameDescriptor));
+  descriptor.yRange.black = 16.F / 255.F;
+  descriptor.yRange.peak = 235.F / 255.F;
+  descriptor.uvRange.black = 16.F / 255.F;
+  descriptor.uvRange.peak = 240.F / 255.F;
+  descriptor.coefficients = SNLF_CM_BT709;
+  
+  srand(1);
+  int failures = 0;
+  for (size_t i = 0; i < sizeof(kFormats) / sizeof(SnlfGraphicsFrameFormat); ++i) {
+    for (size_t j = 0; j < sizeof(kWidths) / sizeof(uint32_t); ++j) {
+      failures += SnlfTestConvert(kFormats[i], &descriptor, kWidths[j]);
+    }
+  }
+  
+  printf("%d mismatches\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,93 @@
+#include <stdio.h>
+
+#include "SnlfGraphics+Private.h"
+
+// Removes graphics data while frames are pipelined and checks that it is uninitialized only after the frame
+// fence has passed every frame that drew it. The present thread is modeled by a queue of submitted frames that
+// execute SNLF_TEST_FRAME_LATENCY frames late; each frame draws the graphics data alive when it was encoded.
+#define SNLF_TEST_FRAME_COUNT    32
+#define SNLF_TEST_FRAME_LATENCY  2
+#define SNLF_TEST_DATA_COUNT     4
+
+typedef struct {
+  DEFINE_SNLF_GRAPHICS_COMMON_DATA;
+  
+  bool alive;     // In the tree
+  bool uninited;
+} SnlfTestGraphicsData;
+
+static SnlfTestGraphicsData gData[SNLF_TEST_DATA_COUNT];
+
+// Graphics data drawn by each submitted frame
+static bool gDrawn[SNLF_TEST_FRAME_COUNT + 1][SNLF_TEST_DATA_COUNT];
+
+static int gFailures = 0;
+
+static void SnlfTestGraphicsData_Uninit(intptr_t _data) {
+  SnlfTestGraphicsData *data = (SnlfTestGraphicsData *)_data;
+  if (data->uninited) {
+    printf("graphics data %zu: uninitialized twice\n", (size_t)(data - gData));
+    ++gFailures;
+  }
+  data->uninited = true;
+}
+
+// Executes a frame on the modeled present thread, which reads every graphics data the frame drew.
+static void SnlfTestExecute(uint64_t frameNumber) {
+  for (size_t i = 0; i < SNLF_TEST_DATA_COUNT; ++i) {
+    if (gDrawn[frameNumber][i] && gData[i].uninited) {
+      printf("frame %llu: graphics data %zu was uninitialized while in flight\n", (unsigned long long)frameNumber, i);
+      ++gFailures;
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  for (size_t i = 0; i < SNLF_TEST_DATA_COUNT; ++i) {
+    gData[i].uninit = SnlfTestGraphicsData_Uninit;
+    gData[i].alive = true;
+    gData[i].uninited = false;
+  }
+  
+  SnlfGraphicsDataRetirement retirement;
+  SnlfGraphicsDataRetirementInit(&retirement);
+  
+  // Graphics data i is removed while frame 4 * (i + 1) is encoded
+  uint64_t frameNumber = 0;
+  uint64_t completedFrameNumber = 0;
+  for (uint32_t frame = 1; frame <= SNLF_TEST_FRAME_COUNT; ++frame) {
+    for (size_t i = 0; i < SNLF_TEST_DATA_COUNT; ++i) {
+      if (gData[i].alive && frame == 4 * (i + 1)) {
+        gData[i].alive = false;
+        SnlfGraphicsDataRetire(&retirement, (SnlfGraphicsData *)(gData + i));
+      }
+    }
+  
+    // Encode and submit
+    ++frameNumber;
+    for (size_t i = 0; i < SNLF_TEST_DATA_COUNT; ++i) {
+      gDrawn[frameNumber][i] = gData[i].alive;
+    }
+  
+    // The present thread catches up to the latency
+    while (completedFrameNumber + SNLF_TEST_FRAME_LATENCY < frameNumber) {
+      SnlfTestExecute(++completedFrameNumber);
+    }
+    SnlfGraphicsDataRetirementEndFrame(&retirement, frameNumber, completedFrameNumber);
+  }
+  
+  // Shutdown waits for the present thread before uninitializing what is left
+  while (completedFrameNumber < frameNumber) {
+    SnlfTestExecute(++completedFrameNumber);
+  }
+  SnlfGraphicsDataRetirementUninit(&retirement);
+  for (size_t i = 0; i < SNLF_TEST_DATA_COUNT; ++i) {
+    if (!gData[i].uninited) {
+      printf("graphics data %zu: never uninitialized\n", i);
+      ++gFailures;
+    }
+  }
+  
+  printf("%d failures\n", gFailures);
+  return gFailures ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "SnlfColorManagement+Private.h"
+
+// Checks both tone mapping curves, on static and dynamic tone mappers with an SDR target:
+//   range:    PQ codes decoded, tone-mapped with the curve LUT and encoded to BT.709 are non-decreasing and stay
+//             within 0-1
+//   peak:     the source peak maps onto the target peak, which BT.709 encodes to 1.0
+//   metadata: new metadata leaves the curve alone until SnlfToneMapperEndFrame, then applies its peak
+//   dynamic:  the source peak moves toward the measured peak, never above the metadata peak nor below the target
+#define SNLF_TEST_SAMPLE_COUNT   100000
+#define SNLF_TEST_PEAK_TOLERANCE 1e-3
+#define SNLF_TEST_FRAME_COUNT    64
+
+static const SnlfToneMappingCurve kCurves[] = {
+  SNLF_TONE_MAPPING_BT2390, SNLF_TONE_MAPPING_REINHARD,
+};
+
+static const char *const kCurveNames[] = {
+  "BT.2390", "Reinhard",
+};
+
+static inline SnlfHDR10Descriptor SnlfTestMetadata(uint32_t maxContentLightLevel) {
+  SnlfHDR10Descriptor descriptor;
+  memset(&descriptor, 0, sizeof(SnlfHDR10Descriptor));
+  descriptor.maxContentLightLevel = maxContentLightLevel;
+  descriptor.maxMasteringLuminance = 4000.F;
+  return descriptor;
+}
+
+static inline float SnlfTestMap(SnlfToneMapperRef toneMapper, float light) {
+  return SnlfTransferLUTEvaluate(toneMapper->curve, light);
+}
+
+static int SnlfTestRange(const char *name, SnlfToneMapperRef toneMapper) {
+  const SnlfTransferLUT *decode = SnlfGetTransferLUT(SNLF_TC_PQ, SNLF_TRANSFER_DECODE, 16);
+  const SnlfTransferLUT *encode = SnlfGetTransferLUT(SNLF_TC_BT709, SNLF_TRANSFER_ENCODE, 16);
+  if (!decode || !encode) {
+    printf("%s: LUTs not available\n", name);
+    return 1;
+  }
+  
+  float previous = 0.F, lowest = 0.F, highest = 0.F;
+  bool decreasing = false;
+  for (uint32_t i = 0; i <= SNLF_TEST_SAMPLE_COUNT; ++i) {
+    const float code = (float)i / SNLF_TEST_SAMPLE_COUNT;
+    const float output = SnlfTransferLUTEvaluate(encode, SnlfTestMap(toneMapper, SnlfTransferLUTEvaluate(decode, code)));
+    decreasing |= output < previous;
+    lowest = fminf(lowest, output);
+    highest = fmaxf(highest, output);
+    previous = output;
+  }
+  
+  printf("%s: %f-%f%s\n", name, lowest, highest, decreasing ? ", decreasing" : "");
+  return decreasing || lowest < 0.F || highest > 1.F ? 1 : 0;
+}
+
+static int SnlfTestPeak(const char *name, SnlfToneMapperRef toneMapper) {
+  const SnlfToneMappingParameters *parameters = SnlfToneMapperGetParameters(toneMapper);
+  const float exact = SnlfToneMappingEvaluate(parameters, parameters->sourcePeak);
+  const float interpolated = SnlfTestMap(toneMapper, parameters->sourcePeak);
+  printf("%s: peak %.0f cd/m2 to %f (exact), %f (LUT)\n", name, parameters->sourcePeak * SNLF_REFERENCE_WHITE_LUMINANCE, exact, interpolated);
+  return fabsf(exact - 1.F) > SNLF_TEST_PEAK_TOLERANCE || fabsf(interpolated - 1.F) > SNLF_TEST_PEAK_TOLERANCE ? 1 : 0;
+}
+
+// The metadata peak must show up in the parameters and the curve only after the frame ends.
+static int SnlfTestMetadataChange(const char *name, SnlfToneMapperRef toneMapper, uint32_t maxContentLightLevel) {
+  const float light = 4.F;
+  const float sourcePeak = SnlfToneMapperGetParameters(toneMapper)->sourcePeak;
+  const float before = SnlfTestMap(toneMapper, light);
+  
+  const SnlfHDR10Descriptor descriptor = SnlfTestMetadata(maxContentLightLevel);
+  SnlfToneMapperSetMetadata(toneMapper, &descriptor);
+  const bool early = SnlfToneMapperGetParameters(toneMapper)->sourcePeak != sourcePeak
+    || SnlfTestMap(toneMapper, light) != before;
+  
+  SnlfToneMapperEndFrame(toneMapper);
+  const float expected = (float)maxContentLightLevel / SNLF_REFERENCE_WHITE_LUMINANCE;
+  const bool applied = fabsf(SnlfToneMapperGetParameters(toneMapper)->sourcePeak - expected) <= expected * 1e-6F
+    && SnlfTestMap(toneMapper, light) != before;
+  
+  printf("%s: metadata %u cd/m2%s%s\n", name, maxContentLightLevel, early ? ", applied early" : "", applied ? "" : ", not applied");
+  return early || !applied ? 1 : 0;
+}
+
+// Feeds frames whose pixels all sit at light until the source peak settles.
+static int SnlfTestAdaptation(const char *name, SnlfToneMapperRef toneMapper, float light) {
+  uint32_t bins[SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT];
+  memset(bins, 0, sizeof(bins));
+  bins[SnlfLuminanceHistogramGetBin(light)] = 1000;
+  
+  const SnlfToneMappingParameters *parameters = SnlfToneMapperGetParameters(toneMapper);
+  const float metadataPeak = toneMapper->metadataPeakLuminance / SNLF_REFERENCE_WHITE_LUMINANCE;
+  const float initial = parameters->sourcePeak;
+  bool reversed = false, outside = false;
+  float previous = initial;
+  for (uint32_t i = 0; i < SNLF_TEST_FRAME_COUNT; ++i) {
+    SnlfToneMapperMergeHistogram(toneMapper, bins);
+    SnlfToneMapperEndFrame(toneMapper);
+  
+    // Every step heads toward the measurement, from the side it started
+    const float sourcePeak = parameters->sourcePeak;
+    reversed |= (sourcePeak - previous) * (previous - light) > 0.F;
+    outside |= sourcePeak > metadataPeak || sourcePeak < parameters->targetPeak;
+    previous = sourcePeak;
+  }
+  
+  // The measurement is the upper edge of the bin, so it lands within one bin above light
+  const float expected = fminf(fmaxf(light, parameters->targetPeak), metadataPeak);
+  const bool settled = previous >= expected * 0.99F && previous <= expected * 1.2F;
+  printf("%s: %.0f cd/m2 frames from %.0f to %.0f cd/m2%s%s%s\n", name,
+         light * SNLF_REFERENCE_WHITE_LUMINANCE, initial * SNLF_REFERENCE_WHITE_LUMINANCE, previous * SNLF_REFERENCE_WHITE_LUMINANCE,
+         reversed ? ", reversed" : "", outside ? ", out of bounds" : "", settled ? "" : ", not settled");
+  return reversed || outside || !settled ? 1 : 0;
+}
+
+static int SnlfTestStatic(SnlfToneMappingCurve curve, const char *curveName) {
+  char name[64];
+  snprintf(name, sizeof(name), "%s, static", curveName);
+  SnlfToneMapperRef toneMapper = SnlfToneMapperInit(curve, SNLF_REFERENCE_WHITE_LUMINANCE, false);
+  if (!toneMapper) {
+    printf("%s: not supported\n", name);
+    return 1;
+  }
+  
+  int failures = SnlfTestRange(name, toneMapper);
+  failures += SnlfTestPeak(name, toneMapper);
+  failures += SnlfTestMetadataChange(name, toneMapper, 4000);
+  failures += SnlfTestRange(name, toneMapper);
+  failures += SnlfTestPeak(name, toneMapper);
+  failures += SnlfTestMetadataChange(name, toneMapper, 600);
+  failures += SnlfTestPeak(name, toneMapper);
+  
+  // Static tone mappers ignore the histogram
+  uint32_t bins[SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT];
+  memset(bins, 0, sizeof(bins));
+  bins[SnlfLuminanceHistogramGetBin(2.F)] = 1000;
+  const float sourcePeak = SnlfToneMapperGetParameters(toneMapper)->sourcePeak;
+  SnlfToneMapperMergeHistogram(toneMapper, bins);
+  SnlfToneMapperEndFrame(toneMapper);
+  if (SnlfToneMapperGetParameters(toneMapper)->sourcePeak != sourcePeak) {
+    printf("%s: adapted\n", name);
+    ++failures;
+  }
+  
+  SnlfToneMapperUninit(toneMapper);
+  return failures;
+}
+
+static int SnlfTestDynamic(SnlfToneMappingCurve curve, const char *curveName) {
+  char name[64];
+  snprintf(name, sizeof(name), "%s, dynamic", curveName);
+  SnlfToneMapperRef toneMapper = SnlfToneMapperInit(curve, SNLF_REFERENCE_WHITE_LUMINANCE, true);
+  if (!toneMapper) {
+    printf("%s: not supported\n", name);
+    return 1;
+  }
+  
+  int failures = SnlfTestMetadataChange(name, toneMapper, 4000);
+  failures += SnlfTestAdaptation(name, toneMapper, 2.F);
+  failures += SnlfTestRange(name, toneMapper);
+  failures += SnlfTestPeak(name, toneMapper);
+  
+  // Frames brighter than the metadata stop at its peak; dark frames at the target peak
+  failures += SnlfTestAdaptation(name, toneMapper, 48.F);
+  failures += SnlfTestAdaptation(name, toneMapper, 0.1F);
+  failures += SnlfTestRange(name, toneMapper);
+  
+  // A frame measured under the old metadata is discarded; the new peak applies as it is
+  uint32_t bins[SNLF_LUMINANCE_HISTOGRAM_BIN_COUNT];
+  memset(bins, 0, sizeof(bins));
+  bins[SnlfLuminanceHistogramGetBin(2.F)] = 1000;
+  SnlfToneMapperMergeHistogram(toneMapper, bins);
+  failures += SnlfTestMetadataChange(name, toneMapper, 1000);
+  failures += SnlfTestPeak(name, toneMapper);
+  
+  SnlfToneMapperUninit(toneMapper);
+  return failures;
+}
+
+int main(int argc, char *argv[]) {
+  int failures = 0;
+  for (size_t i = 0; i < sizeof(kCurves) / sizeof(SnlfToneMappingCurve); ++i) {
+    failures += SnlfTestStatic(kCurves[i], kCurveNames[i]);
+    failures += SnlfTestDynamic(kCurves[i], kCurveNames[i]);
+  }
+  
+  printf("%d failures\n", failures);
+  return failures ? 1 : 0;
+}
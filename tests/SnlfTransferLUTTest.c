@@ -0,0 +1,80 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "SnlfColorManagement+Private.h"
+
+// Compares the transfer LUTs with the closed-form curves they are sampled from, at points between the grid
+// points where the interpolation is furthest off. Both directions are measured as code values:
+//   decode: the closed-form code of the interpolated light against the input code
+//   encode: the interpolated code against the closed-form code
+// Errors must stay within half a code step at the precision of the LUT, 0.5 / (2^precision - 1), over the whole
+// range.
+#define SNLF_TEST_SAMPLE_COUNT 100000
+
+static const SnlfTransferCharacteristicsType kTypes[] = {
+  SNLF_TC_PQ, SNLF_TC_HLG, SNLF_TC_SRGB, SNLF_TC_BT1886,
+};
+
+static const char *const kTypeNames[] = {
+  "PQ", "HLG", "sRGB", "BT.1886",
+};
+
+static const uint32_t kPrecisions[] = { 10, 12, 16 };
+
+static double SnlfTestDecodeError(const SnlfTransferCharacteristics *tc, const SnlfTransferLUT *lut) {
+  const double peak = tc->peakLuminance / SNLF_REFERENCE_WHITE_LUMINANCE;
+  double maxError = 0.0;
+  for (uint32_t i = 0; i <= SNLF_TEST_SAMPLE_COUNT; ++i) {
+    const double code = (double)i / SNLF_TEST_SAMPLE_COUNT;
+    const double light = SnlfTransferLUTEvaluate(lut, (float)code);
+    const double error = fabs(SnlfTransferEncode(tc, fmax(light / peak, 0.0)) - code);
+    maxError = fmax(maxError, error);
+  }
+  return maxError;
+}
+
+static double SnlfTestEncodeError(const SnlfTransferCharacteristics *tc, const SnlfTransferLUT *lut) {
+  const double peak = tc->peakLuminance / SNLF_REFERENCE_WHITE_LUMINANCE;
+  double maxError = 0.0;
+  for (uint32_t i = 0; i <= SNLF_TEST_SAMPLE_COUNT; ++i) {
+    // Light from 2^-32 of the peak up to the peak, spaced evenly in octaves
+    const double light = peak * exp2(-32.0 * (1.0 - (double)i / SNLF_TEST_SAMPLE_COUNT));
+    const double code = SnlfTransferLUTEvaluate(lut, (float)light);
+    const double error = fabs(code - SnlfTransferEncode(tc, light / peak));
+    maxError = fmax(maxError, error);
+  }
+  return maxError;
+}
+
+int main(int argc, char *argv[]) {
+  int failures = 0;
+  for (size_t i = 0; i < sizeof(kTypes) / sizeof(SnlfTransferCharacteristicsType); ++i) {
+    SnlfTransferCharacteristics tc;
+    if (SnlfGetTransferCharacteristics(kTypes[i], &tc)) {
+      printf("%s: not supported\n", kTypeNames[i]);
+      ++failures;
+      continue;
+    }
+  
+    for (size_t j = 0; j < sizeof(kPrecisions) / sizeof(uint32_t); ++j) {
+      const SnlfTransferLUT *decode = SnlfGetTransferLUT(kTypes[i], SNLF_TRANSFER_DECODE, kPrecisions[j]);
+      const SnlfTransferLUT *encode = SnlfGetTransferLUT(kTypes[i], SNLF_TRANSFER_ENCODE, kPrecisions[j]);
+      if (!decode || !encode) {
+        printf("%s: %u-bit LUTs not available\n", kTypeNames[i], kPrecisions[j]);
+        ++failures;
+        continue;
+      }
+  
+      const double decodeError = SnlfTestDecodeError(&tc, decode);
+      const double encodeError = SnlfTestEncodeError(&tc, encode);
+      const double bound = 0.5 / ((1U << kPrecisions[j]) - 1);
+      printf("%s, %u-bit: decode %.3g, encode %.3g (bound %.3g)\n", kTypeNames[i], kPrecisions[j], decodeError, encodeError, bound);
+      if (decodeError > bound || encodeError > bound) {
+        ++failures;
+      }
+    }
+  }
+  
+  printf("%d failures\n", failures);
+  return failures ? 1 : 0;
+}